@@ -176,11 +176,8 @@ public class ArithmeticVisitor : BaseArithmeticVisitor<decimal>
         // Evaluate the arguments
         var args = node.Arguments.Select(arg => arg.Accept(this)).ToArray();
 
-        // Evaluate the function - getting both result and description
-        var (result, _) = EvaluateFunction(node.Name, args, node.Position);
-
-        // Just return the result (ignore the description)
-        return result;
+        // Evaluate the function, without describing it
+        return EvaluateFunctionValue(node.Name, args, node.Position);
     }
 
     /// <summary>
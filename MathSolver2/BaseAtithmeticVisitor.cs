@@ -59,7 +59,7 @@ public abstract class BaseArithmeticVisitor<T> : ILatexExpressionVisitor<T>
     /// </summary>
     /// <param name="node">The expression node to evaluate.</param>
     /// <returns>The evaluated result.</returns>
-    public T Evaluate(IExpressionNode node)
+    public virtual T Evaluate(IExpressionNode node)
     {
         return node.Accept(this);
     }
@@ -249,6 +249,21 @@ public abstract class BaseArithmeticVisitor<T> : ILatexExpressionVisitor<T>
         return Math.Round(value, Math.Max(0, decimalPlaces));
     }
 
+    /// <summary>
+    /// Evaluates a function and formats its result according to the arithmetic settings.
+    /// </summary>
+    /// <param name="functionName">The name of the function.</param>
+    /// <param name="args">The arguments to pass to the function.</param>
+    /// <param name="position">The source position for error reporting.</param>
+    /// <returns>The formatted result of the function.</returns>
+    protected decimal EvaluateFunctionValue(
+        string functionName,
+        decimal[] args,
+        SourcePosition position)
+    {
+        return FormatNumber(MathFunctions.Evaluate(functionName, args, position));
+    }
+
     /// <summary>
     /// Evaluates a function and returns both the result and a description of the operation.
     /// </summary>
@@ -261,32 +276,10 @@ public abstract class BaseArithmeticVisitor<T> : ILatexExpressionVisitor<T>
         decimal[] args,
         SourcePosition position)
     {
-        // Get the raw result
-        var rawResult = MathFunctions.Evaluate(functionName, args, position);
-
-        // Format the result according to arithmetic settings
-        var formattedResult = FormatNumber(rawResult);
-
-        // Get the operation description
-        var descriptionFormat = MathFunctions.GetDescriptionFormat(functionName);
-        string description;
-
-        if (args.Length == 1)
-        {
-            description = string.Format(descriptionFormat, args[0]);
-        }
-        else if (args.Length > 1)
-        {
-            description = string.Format(descriptionFormat, (object[])args.Select(a => (object)a).ToArray());
-        }
-        else
-        {
-            description = descriptionFormat;
-        }
+        var formattedResult = EvaluateFunctionValue(functionName, args, position);
 
         // Add the formatting information to the description
-        var formatInfo = GetFormatInfo();
-        description = $"{description}, {formatInfo}";
+        var description = $"{MathFunctions.Describe(functionName, args)}, {GetFormatInfo()}";
 
         return (formattedResult, description);
     }
@@ -1,24 +1,94 @@
 ﻿namespace MathSolver2;
 
+/// <summary>
+/// Kinds of calculation steps recorded by the step-by-step evaluation.
+/// Each kind formats its expression, operation and result in its own way.
+/// </summary>
+internal enum StepKind
+{
+    /// <summary>A step created with its texts already formatted.</summary>
+    Text,
+
+    /// <summary>Substitution of a mathematical constant.</summary>
+    Constant,
+
+    /// <summary>Substitution of a variable.</summary>
+    Variable,
+
+    /// <summary>Addition of two operands.</summary>
+    Addition,
+
+    /// <summary>Subtraction of two operands.</summary>
+    Subtraction,
+
+    /// <summary>Multiplication of two operands.</summary>
+    Multiplication,
+
+    /// <summary>Division of two operands.</summary>
+    Division,
+
+    /// <summary>Exponentiation of a base.</summary>
+    Exponent,
+
+    /// <summary>Evaluation of an expression in parentheses.</summary>
+    Parenthesis,
+
+    /// <summary>Call of a function.</summary>
+    Function,
+
+    /// <summary>Factorial of an integer.</summary>
+    Factorial,
+
+    /// <summary>Setup of a summation or a product.</summary>
+    IteratorSetup,
+
+    /// <summary>Assignment of the iteration variable of a summation or a product.</summary>
+    IterationVariable,
+
+    /// <summary>Accumulation of a term into a summation or a product.</summary>
+    IterationTerm,
+
+    /// <summary>Completion of a summation or a product.</summary>
+    IteratorComplete
+}
+
 /// <summary>
 /// Represents a single step in a calculation.
 /// </summary>
+/// <remarks>
+/// Steps recorded by <see cref="StepByStepArithmeticVisitor"/> keep the operands of the step
+/// and format their texts the first time they are read, so an evaluation whose steps are
+/// never shown does not pay for formatting them.
+/// </remarks>
 public class CalculationStep
 {
+    private string? _expression;
+    private string? _operation;
+    private string? _result;
+
+    private StepKind _kind;
+    private IExpressionNode? _node;
+    private FormattingVisitor? _formatter;
+    private string? _formatInfo;
+    private decimal _left;
+    private decimal _right;
+    private decimal _value;
+    private decimal[]? _arguments;
+
     /// <summary>
     /// Gets the expression before this step.
     /// </summary>
-    public string Expression { get; }
+    public string Expression => _expression ??= FormatExpression();
 
     /// <summary>
     /// Gets the operation performed in this step.
     /// </summary>
-    public string Operation { get; }
+    public string Operation => _operation ??= FormatOperation();
 
     /// <summary>
     /// Gets the expression after this step.
     /// </summary>
-    public string Result { get; }
+    public string Result => _result ??= FormatResult();
 
     /// <summary>
     /// Initializes a new instance of the <see cref="CalculationStep"/> class.
@@ -28,9 +98,67 @@ public class CalculationStep
     /// <param name="result">The expression after this step.</param>
     public CalculationStep(string expression, string operation, string result)
     {
-        Expression = expression;
-        Operation = operation;
-        Result = result;
+        _kind = StepKind.Text;
+        _expression = expression;
+        _operation = operation;
+        _result = result;
+    }
+
+    /// <summary>
+    /// Initializes a new instance of the <see cref="CalculationStep"/> class to be recorded later.
+    /// </summary>
+    internal CalculationStep()
+    {
+        _kind = StepKind.Text;
+    }
+
+    /// <summary>
+    /// Records a step, clearing the texts of the step this instance held before.
+    /// </summary>
+    /// <param name="kind">The kind of step.</param>
+    /// <param name="node">The node the step evaluates.</param>
+    /// <param name="formatter">The formatter of the expression of the step.</param>
+    /// <param name="formatInfo">The description of the formatting applied.</param>
+    /// <param name="left">The left operand, or the first value the step describes.</param>
+    /// <param name="right">The right operand, or the second value the step describes.</param>
+    /// <param name="value">The value the step results in.</param>
+    /// <param name="arguments">The arguments of a function call, if any.</param>
+    internal void Record(
+        StepKind kind,
+        IExpressionNode node,
+        FormattingVisitor formatter,
+        string formatInfo,
+        decimal left,
+        decimal right,
+        decimal value,
+        decimal[]? arguments)
+    {
+        _kind = kind;
+        _node = node;
+        _formatter = formatter;
+        _formatInfo = formatInfo;
+        _left = left;
+        _right = right;
+        _value = value;
+        _arguments = arguments;
+        _expression = null;
+        _operation = null;
+        _result = null;
+    }
+
+    /// <summary>
+    /// Clears the step so it holds no reference to the evaluation it was recorded in.
+    /// </summary>
+    internal void Clear()
+    {
+        _kind = StepKind.Text;
+        _node = null;
+        _formatter = null;
+        _formatInfo = null;
+        _arguments = null;
+        _expression = null;
+        _operation = null;
+        _result = null;
     }
 
     /// <summary>
@@ -41,4 +169,149 @@ public class CalculationStep
     {
         return $"{Expression} => {Operation} => {Result}";
     }
+
+    /// <summary>
+    /// Formats the expression before this step.
+    /// </summary>
+    /// <returns>The expression before this step.</returns>
+    private string FormatExpression()
+    {
+        switch (_kind)
+        {
+            case StepKind.Constant:
+            case StepKind.Variable:
+                return ((VariableNode)_node!).Name;
+
+            case StepKind.IterationVariable:
+                return $"{IterationVariableName} = {(int)_left}";
+
+            case StepKind.IterationTerm:
+                return IsProduct ? $"product * {_right}" : $"sum + {_right}";
+
+            case StepKind.Text:
+                return string.Empty;
+
+            default:
+                return _formatter!.Format(_node!);
+        }
+    }
+
+    /// <summary>
+    /// Formats the operation performed in this step.
+    /// </summary>
+    /// <returns>The operation performed in this step.</returns>
+    private string FormatOperation()
+    {
+        switch (_kind)
+        {
+            case StepKind.Constant:
+                return $"Substitute mathematical constant {((VariableNode)_node!).Name}";
+
+            case StepKind.Variable:
+                return $"Substitute variable {((VariableNode)_node!).Name}";
+
+            case StepKind.Addition:
+                return $"Add {_left} and {_right}, {_formatInfo}";
+
+            case StepKind.Subtraction:
+                return $"Subtract {_right} from {_left}, {_formatInfo}";
+
+            case StepKind.Multiplication:
+                return $"Multiply {_left} by {_right}, {_formatInfo}";
+
+            case StepKind.Division:
+                return $"Divide {_left} by {_right}, {_formatInfo}";
+
+            case StepKind.Exponent:
+                return $"{DescribeExponent()}, {_formatInfo}";
+
+            case StepKind.Parenthesis:
+                return "Evaluate parentheses";
+
+            case StepKind.Function:
+                var functionName = ((FunctionNode)_node!).Name;
+                return $"{MathFunctions.Describe(functionName, _arguments!)}, {_formatInfo}";
+
+            case StepKind.Factorial:
+                return $"Calculate factorial of {_left}, {_formatInfo}";
+
+            case StepKind.IteratorSetup:
+                return $"Setup {IteratorName} with {IterationVariableName} from {(int)_left} to {(int)_right}";
+
+            case StepKind.IterationVariable:
+                return $"Set iteration variable {IterationVariableName} to {(int)_left}";
+
+            case StepKind.IterationTerm:
+                return IsProduct ?
+                    $"Multiply term value {_right} with current product {_left}, {_formatInfo}" :
+                    $"Add term value {_right} to current sum {_left}, {_formatInfo}";
+
+            case StepKind.IteratorComplete:
+                return $"Complete {IteratorName} from {(int)_left} to {(int)_right}";
+
+            default:
+                return string.Empty;
+        }
+    }
+
+    /// <summary>
+    /// Formats the expression after this step.
+    /// </summary>
+    /// <returns>The expression after this step.</returns>
+    private string FormatResult()
+    {
+        switch (_kind)
+        {
+            case StepKind.IteratorSetup:
+                return IsProduct ? "Calculate each term and multiply" : "Calculate each term and sum";
+
+            case StepKind.IterationVariable:
+                return ((int)_left).ToString();
+
+            case StepKind.Text:
+                return string.Empty;
+
+            default:
+                return _value.ToString();
+        }
+    }
+
+    /// <summary>
+    /// Describes an exponentiation of the left operand to the power of the right operand.
+    /// </summary>
+    /// <returns>The description of the exponentiation.</returns>
+    private string DescribeExponent()
+    {
+        if (_right == 0)
+        {
+            return "Any number raised to power 0 is 1";
+        }
+
+        if (_left == 0)
+        {
+            return "0 raised to any non-zero power is 0";
+        }
+
+        if (_right == 1)
+        {
+            return "Any number raised to power 1 is the number itself";
+        }
+
+        return $"Raise {_left} to the power of {_right}";
+    }
+
+    /// <summary>
+    /// Gets whether the step belongs to a product rather than a summation.
+    /// </summary>
+    private bool IsProduct => _node is ProductNode;
+
+    /// <summary>
+    /// Gets the name of the iterator the step belongs to.
+    /// </summary>
+    private string IteratorName => IsProduct ? "product" : "summation";
+
+    /// <summary>
+    /// Gets the name of the iteration variable of the iterator the step belongs to.
+    /// </summary>
+    private string IterationVariableName => ((IteratorNode)_node!).Variable;
 }
\ No newline at end of file
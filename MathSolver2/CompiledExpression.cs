@@ -0,0 +1,67 @@
+﻿namespace MathSolver2;
+
+/// <summary>
+/// An expression compiled by <see cref="ExpressionCompiler"/>, to be evaluated with many variable bindings.
+/// </summary>
+public sealed class CompiledExpression
+{
+    private readonly Func<decimal[], decimal> _function;
+    private readonly string[] _variables;
+    private readonly SourcePosition[] _positions;
+
+    /// <summary>
+    /// Gets the names of the variables the expression reads, in the order of their bindings.
+    /// </summary>
+    public IReadOnlyList<string> Variables => _variables;
+
+    /// <summary>
+    /// Initializes a new instance of the <see cref="CompiledExpression"/> class.
+    /// </summary>
+    /// <param name="function">The compiled delegate, reading the variables from an array of bindings.</param>
+    /// <param name="variables">The names of the variables, in the order of their bindings.</param>
+    /// <param name="positions">The position of the first use of each variable, for error reporting.</param>
+    internal CompiledExpression(Func<decimal[], decimal> function, string[] variables, SourcePosition[] positions)
+    {
+        _function = function;
+        _variables = variables;
+        _positions = positions;
+    }
+
+    /// <summary>
+    /// Evaluates the expression with the values of its variables, in the order of <see cref="Variables"/>.
+    /// </summary>
+    /// <param name="values">The values of the variables.</param>
+    /// <returns>The result of the evaluation.</returns>
+    /// <exception cref="ArgumentException">Thrown when the number of values does not match the number of variables.</exception>
+    /// <exception cref="EvaluationException">Thrown when there is an evaluation error.</exception>
+    public decimal Evaluate(params decimal[] values)
+    {
+        if (values.Length != _variables.Length)
+        {
+            throw new ArgumentException(
+                $"Expected {_variables.Length} variable value(s), got {values.Length}", nameof(values));
+        }
+
+        return _function(values);
+    }
+
+    /// <summary>
+    /// Evaluates the expression with the values of its variables taken from a dictionary.
+    /// </summary>
+    /// <param name="variables">Dictionary of variable names and their values.</param>
+    /// <returns>The result of the evaluation.</returns>
+    /// <exception cref="EvaluationException">Thrown when a variable is not defined or there is an evaluation error.</exception>
+    public decimal Evaluate(IReadOnlyDictionary<string, decimal> variables)
+    {
+        var values = new decimal[_variables.Length];
+        for (var i = 0; i < values.Length; i++)
+        {
+            if (!variables.TryGetValue(_variables[i], out values[i]))
+            {
+                throw new EvaluationException($"Variable '{_variables[i]}' is not defined", _positions[i]);
+            }
+        }
+
+        return _function(values);
+    }
+}
\ No newline at end of file
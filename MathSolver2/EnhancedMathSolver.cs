@@ -6,7 +6,14 @@
 /// </summary>
 public class EnhancedMathSolver
 {
+    /// <summary>
+    /// Maximum number of parsed expressions kept; the cache is cleared when it is full
+    /// </summary>
+    private const int MaxParsedExpressions = 1024;
+
     private readonly Dictionary<string, decimal> _variables;
+    private readonly Dictionary<string, IExpressionNode> _parsedExpressions;
+    private readonly StepPool _stepPool;
     private ArithmeticType _arithmeticType;
     private int _precision;
     private bool _useSignificantDigits;
@@ -26,6 +33,8 @@ public class EnhancedMathSolver
         CalculationDirection direction = CalculationDirection.LeftToRight)
     {
         _variables = new Dictionary<string, decimal>();
+        _parsedExpressions = new Dictionary<string, IExpressionNode>();
+        _stepPool = new StepPool();
         _arithmeticType = arithmeticType;
         _precision = precision;
         _useSignificantDigits = useSignificantDigits;
@@ -91,8 +100,7 @@ public class EnhancedMathSolver
         try
         {
             // Parse the expression
-            var parser = new ExpressionParser(expression); // Changed to var
-            var root = parser.Parse(); // Changed to var
+            var root = Parse(expression);
 
             // Evaluate the expression with arithmetic settings
             var visitor = new ArithmeticVisitor( // Changed to var
@@ -132,12 +140,11 @@ public class EnhancedMathSolver
         try
         {
             // Parse the expression
-            var parser = new ExpressionParser(expression); // Changed to var
-            var root = parser.Parse(); // Changed to var
+            var root = Parse(expression);
 
             // Evaluate the expression step by step with arithmetic settings
-            var visitor = new StepByStepArithmeticVisitor( // Changed to var
-                _variables, _arithmeticType, _precision, _useSignificantDigits);
+            var visitor = new StepByStepArithmeticVisitor(
+                _variables, _arithmeticType, _precision, _useSignificantDigits, _stepPool);
             var result = visitor.Evaluate(root); // Changed to var
 
             // Create the result object
@@ -155,7 +162,8 @@ public class EnhancedMathSolver
                 Direction = _direction.ToString(),
                 ActualResult = result.Value,
                 FormattedResult = FormatNumber(result.Value),
-                Steps = result.Steps
+                Steps = result.Steps,
+                StepPool = _stepPool
             };
         }
         catch (ParserException ex)
@@ -168,6 +176,29 @@ public class EnhancedMathSolver
         }
     }
 
+    /// <summary>
+    /// Compiles an expression with the current arithmetic settings, to be evaluated with many variable bindings
+    /// </summary>
+    /// <param name="expression">The expression to compile</param>
+    /// <returns>The compiled expression; its evaluation errors are thrown as <see cref="EvaluationException"/></returns>
+    /// <exception cref="ArgumentException">Thrown when there is a parse error</exception>
+    public CompiledExpression Compile(string expression)
+    {
+        try
+        {
+            // Parse the expression
+            var root = Parse(expression);
+
+            // Compile the expression with arithmetic settings
+            var compiler = new ExpressionCompiler(_arithmeticType, _precision, _useSignificantDigits);
+            return compiler.Compile(root);
+        }
+        catch (ParserException ex)
+        {
+            throw new ArgumentException($"Parse error: {ex.Message} at position {ex.Position}");
+        }
+    }
+
     /// <summary>
     /// Formats an expression in standard or LaTeX notation
     /// </summary>
@@ -180,8 +211,7 @@ public class EnhancedMathSolver
         try
         {
             // Parse the expression
-            var parser = new ExpressionParser(expression); // Changed to var
-            var root = parser.Parse(); // Changed to var
+            var root = Parse(expression);
 
             // Format the expression
             var visitor = new FormattingVisitor(format); // Changed to var
@@ -203,8 +233,7 @@ public class EnhancedMathSolver
     {
         try
         {
-            var parser = new ExpressionParser(expression); // Changed to var
-            parser.Parse();
+            Parse(expression);
 
             error = null;
             return true;
@@ -216,6 +245,31 @@ public class EnhancedMathSolver
         }
     }
 
+    /// <summary>
+    /// Parses an expression, reusing the tree of an earlier parse of the same expression
+    /// </summary>
+    /// <param name="expression">The expression to parse</param>
+    /// <returns>The root of the expression tree</returns>
+    /// <exception cref="ParserException">Thrown when the expression cannot be parsed</exception>
+    private IExpressionNode Parse(string expression)
+    {
+        if (_parsedExpressions.TryGetValue(expression, out var root))
+        {
+            return root;
+        }
+
+        // The trees are never changed once parsed, so they can be shared by every evaluation
+        root = new ExpressionParser(expression).Parse();
+
+        if (_parsedExpressions.Count >= MaxParsedExpressions)
+        {
+            _parsedExpressions.Clear();
+        }
+        _parsedExpressions[expression] = root;
+
+        return root;
+    }
+
     /// <summary>
     /// Formats a number according to the specified arithmetic settings
     /// </summary>
@@ -351,7 +405,11 @@ public class EnhancedMathSolver
 /// <summary>
 /// Result of a calculation with steps
 /// </summary>
-public class CalculationResult
+/// <remarks>
+/// Disposing the result returns its steps to the solver that created it, to be reused by its next
+/// evaluations; the steps must not be used afterwards. A result that is not disposed keeps its steps.
+/// </remarks>
+public class CalculationResult : IDisposable
 {
     /// <summary>
     /// The original expression
@@ -387,4 +445,22 @@ public class CalculationResult
     /// The steps taken in the calculation
     /// </summary>
     public List<CalculationStep> Steps { get; set; }
+
+    /// <summary>
+    /// The pool the steps are returned to when the result is disposed
+    /// </summary>
+    internal StepPool? StepPool { get; set; }
+
+    /// <summary>
+    /// Returns the steps to the pool they were taken from
+    /// </summary>
+    public void Dispose()
+    {
+        if (StepPool != null && Steps != null)
+        {
+            StepPool.Return(Steps);
+            Steps = new List<CalculationStep>();
+        }
+        StepPool = null;
+    }
 }
\ No newline at end of file
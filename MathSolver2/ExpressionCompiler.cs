@@ -0,0 +1,407 @@
+﻿using System.Linq.Expressions;
+using System.Reflection;
+
+namespace MathSolver2;
+
+/// <summary>
+/// Compiles an expression tree to a delegate with arithmetic formatting applied at each calculation step.
+/// </summary>
+/// <remarks>
+/// The compiled delegate computes the same values as <see cref="ArithmeticVisitor"/>, without walking
+/// the tree: numbers and constants are formatted once, at compile time, the formatting is left out
+/// altogether in normal arithmetic, and the variables are read from an array of bindings instead of
+/// a dictionary, so one compiled expression can be evaluated with many bindings.
+/// </remarks>
+public class ExpressionCompiler : BaseArithmeticVisitor<Expression>
+{
+    private static readonly MethodInfo DivideMethod = GetHelper(nameof(Divide));
+    private static readonly MethodInfo PowerMethod = GetHelper(nameof(Power));
+    private static readonly MethodInfo FactorialMethod = GetHelper(nameof(Factorial));
+    private static readonly MethodInfo CheckBoundsMethod = GetHelper(nameof(CheckBounds));
+    private static readonly MethodInfo ToBoundMethod = GetHelper(nameof(ToBound));
+    private static readonly MethodInfo EvaluateFunctionMethod = typeof(MathFunctions).GetMethod(nameof(MathFunctions.Evaluate))!;
+
+    private readonly ParameterExpression _bindings = Expression.Parameter(typeof(decimal[]), "bindings");
+    private readonly Dictionary<string, int> _slots = new Dictionary<string, int>();
+    private readonly List<string> _variableNames = new List<string>();
+    private readonly List<SourcePosition> _variablePositions = new List<SourcePosition>();
+    private readonly Dictionary<string, ParameterExpression> _iterationVariables = new Dictionary<string, ParameterExpression>();
+    private readonly Expression? _format;
+
+    /// <summary>
+    /// Creates a new expression compiler with the specified settings.
+    /// </summary>
+    /// <param name="arithmeticType">Type of arithmetic to use for calculations.</param>
+    /// <param name="precision">Precision to use for rounding or truncation.</param>
+    /// <param name="useSignificantDigits">Whether to use significant digits for formatting.</param>
+    public ExpressionCompiler(
+        ArithmeticType arithmeticType,
+        int precision,
+        bool useSignificantDigits) : base(new Dictionary<string, decimal>(), arithmeticType, precision, useSignificantDigits)
+    {
+        // Normal arithmetic formats nothing, so the formatting is selected once here
+        if (arithmeticType != ArithmeticType.Normal)
+        {
+            _format = Expression.Constant(new Func<decimal, decimal>(FormatNumber));
+        }
+    }
+
+    /// <summary>
+    /// Compiles an expression tree.
+    /// </summary>
+    /// <param name="node">The root of the expression tree.</param>
+    /// <returns>The compiled expression.</returns>
+    public CompiledExpression Compile(IExpressionNode node)
+    {
+        _slots.Clear();
+        _variableNames.Clear();
+        _variablePositions.Clear();
+        _iterationVariables.Clear();
+
+        var body = node.Accept(this);
+        var function = Expression.Lambda<Func<decimal[], decimal>>(body, _bindings).Compile();
+
+        return new CompiledExpression(function, _variableNames.ToArray(), _variablePositions.ToArray());
+    }
+
+    #region Visitor Methods
+
+    /// <summary>
+    /// Visits a number node and returns its formatted value.
+    /// </summary>
+    /// <param name="node">The number node to visit.</param>
+    /// <returns>The formatted value of the number node.</returns>
+    public override Expression VisitNumber(NumberNode node)
+    {
+        return Expression.Constant(FormatNumber(node.Value));
+    }
+
+    /// <summary>
+    /// Visits a variable node and returns the read of its value.
+    /// </summary>
+    /// <param name="node">The variable node to visit.</param>
+    /// <returns>The formatted constant, or the formatted read of the iteration variable or of the binding.</returns>
+    public override Expression VisitVariable(VariableNode node)
+    {
+        if (MathConstants.TryGetValue(node.Name, out var constValue))
+        {
+            return Expression.Constant(FormatNumber(constValue));
+        }
+
+        if (_iterationVariables.TryGetValue(node.Name, out var iterationVariable))
+        {
+            return Format(iterationVariable);
+        }
+
+        if (!_slots.TryGetValue(node.Name, out var slot))
+        {
+            slot = _variableNames.Count;
+            _slots[node.Name] = slot;
+            _variableNames.Add(node.Name);
+            _variablePositions.Add(node.Position);
+        }
+
+        return Format(Expression.ArrayIndex(_bindings, Expression.Constant(slot)));
+    }
+
+    /// <summary>
+    /// Visits an addition node and returns the formatted addition.
+    /// </summary>
+    /// <param name="node">The addition node to visit.</param>
+    /// <returns>The formatted addition.</returns>
+    public override Expression VisitAddition(AdditionNode node)
+    {
+        return Format(Expression.Add(node.Left.Accept(this), node.Right.Accept(this)));
+    }
+
+    /// <summary>
+    /// Visits a subtraction node and returns the formatted subtraction.
+    /// </summary>
+    /// <param name="node">The subtraction node to visit.</param>
+    /// <returns>The formatted subtraction.</returns>
+    public override Expression VisitSubtraction(SubtractionNode node)
+    {
+        return Format(Expression.Subtract(node.Left.Accept(this), node.Right.Accept(this)));
+    }
+
+    /// <summary>
+    /// Visits a multiplication node and returns the formatted multiplication.
+    /// </summary>
+    /// <param name="node">The multiplication node to visit.</param>
+    /// <returns>The formatted multiplication.</returns>
+    public override Expression VisitMultiplication(MultiplicationNode node)
+    {
+        return Format(Expression.Multiply(node.Left.Accept(this), node.Right.Accept(this)));
+    }
+
+    /// <summary>
+    /// Visits a division node and returns the formatted division.
+    /// </summary>
+    /// <param name="node">The division node to visit.</param>
+    /// <returns>The formatted division, throwing on division by zero.</returns>
+    public override Expression VisitDivision(DivisionNode node)
+    {
+        return Format(Expression.Call(
+            DivideMethod,
+            node.Numerator.Accept(this),
+            node.Denominator.Accept(this),
+            Expression.Constant(node.Position)));
+    }
+
+    /// <summary>
+    /// Visits an exponent node and returns the formatted exponentiation.
+    /// </summary>
+    /// <param name="node">The exponent node to visit.</param>
+    /// <returns>The exponentiation, with the special cases of <see cref="ArithmeticVisitor"/>.</returns>
+    public override Expression VisitExponent(ExponentNode node)
+    {
+        var @base = Expression.Variable(typeof(decimal), "base");
+        var exponent = Expression.Variable(typeof(decimal), "exponent");
+
+        // Any number raised to power 0 is 1, and 0 raised to any other power is 0, both unformatted
+        return Expression.Block(
+            new[] { @base, exponent },
+            Expression.Assign(@base, node.Base.Accept(this)),
+            Expression.Assign(exponent, node.Exponent.Accept(this)),
+            Expression.Condition(
+                Expression.Equal(exponent, Expression.Constant(0m)),
+                Expression.Constant(1m),
+                Expression.Condition(
+                    Expression.Equal(@base, Expression.Constant(0m)),
+                    Expression.Constant(0m),
+                    Format(Expression.Call(PowerMethod, @base, exponent)))));
+    }
+
+    /// <summary>
+    /// Visits a parenthesis node and returns the enclosed expression.
+    /// </summary>
+    /// <param name="node">The parenthesis node to visit.</param>
+    /// <returns>The enclosed expression.</returns>
+    public override Expression VisitParenthesis(ParenthesisNode node)
+    {
+        return node.Expression.Accept(this);
+    }
+
+    /// <summary>
+    /// Visits a function node and returns the formatted call of the function.
+    /// </summary>
+    /// <param name="node">The function node to visit.</param>
+    /// <returns>The formatted call of the function.</returns>
+    public override Expression VisitFunction(FunctionNode node)
+    {
+        var args = Expression.NewArrayInit(typeof(decimal), node.Arguments.Select(arg => arg.Accept(this)));
+        var position = Expression.Constant(node.Position);
+
+        // A known function is called directly; an unknown one still fails when evaluated, as it does in the visitors
+        Expression call = MathFunctions.TryGetFunction(node.Name, out var function) ?
+            Expression.Invoke(Expression.Constant(function), args, position) :
+            Expression.Call(EvaluateFunctionMethod, Expression.Constant(node.Name), args, position);
+
+        return Format(call);
+    }
+
+    /// <summary>
+    /// Visits a factorial node and returns the formatted factorial.
+    /// </summary>
+    /// <param name="node">The factorial node to visit.</param>
+    /// <returns>The formatted factorial, throwing when the value is not a non-negative integer.</returns>
+    public override Expression VisitFactorial(FactorialNode node)
+    {
+        return Format(Expression.Call(FactorialMethod, node.Expression.Accept(this), Expression.Constant(node.Position)));
+    }
+
+    /// <summary>
+    /// Visits a summation node and returns the loop computing the summation.
+    /// </summary>
+    /// <param name="node">The summation node to visit.</param>
+    /// <returns>The loop computing the summation.</returns>
+    public override Expression VisitSummation(SummationNode node)
+    {
+        return CompileIterator(node, 0m, Expression.Add, "Summation bounds must be integers");
+    }
+
+    /// <summary>
+    /// Visits a product node and returns the loop computing the product.
+    /// </summary>
+    /// <param name="node">The product node to visit.</param>
+    /// <returns>The loop computing the product.</returns>
+    public override Expression VisitProduct(ProductNode node)
+    {
+        return CompileIterator(node, 1m, Expression.Multiply, "Product bounds must be integers");
+    }
+
+    #endregion
+
+    /// <summary>
+    /// Formats a value according to the arithmetic settings.
+    /// </summary>
+    /// <param name="value">The value to format.</param>
+    /// <returns>The formatted value, or the value itself in normal arithmetic.</returns>
+    private Expression Format(Expression value)
+    {
+        return _format == null ? value : Expression.Invoke(_format, value);
+    }
+
+    /// <summary>
+    /// Compiles the loop of a summation or a product. The iteration variable is a local of the loop,
+    /// hiding a binding of the same name while the expression of the iterator is compiled.
+    /// </summary>
+    /// <param name="node">The iterator node.</param>
+    /// <param name="seed">The initial value of the result.</param>
+    /// <param name="accumulate">Builds the accumulation of a term into the result.</param>
+    /// <param name="boundsMessage">The error message for bounds that are not integers.</param>
+    /// <returns>The loop computing the iterator.</returns>
+    private Expression CompileIterator(
+        IteratorNode node,
+        decimal seed,
+        Func<Expression, Expression, BinaryExpression> accumulate,
+        string boundsMessage)
+    {
+        // The bounds are outside the scope of the iteration variable
+        var start = Expression.Variable(typeof(decimal), "start");
+        var end = Expression.Variable(typeof(decimal), "end");
+        var startBound = node.Start.Accept(this);
+        var endBound = node.End.Accept(this);
+
+        var counter = Expression.Variable(typeof(int), "counter");
+        var last = Expression.Variable(typeof(int), "last");
+        var iterationVariable = Expression.Variable(typeof(decimal), node.Variable);
+        var result = Expression.Variable(typeof(decimal), "result");
+        var done = Expression.Label(typeof(decimal), "done");
+
+        var hasOuterVariable = _iterationVariables.TryGetValue(node.Variable, out var outerVariable);
+        _iterationVariables[node.Variable] = iterationVariable;
+
+        Expression term;
+        try
+        {
+            term = node.Expression.Accept(this);
+        }
+        finally
+        {
+            if (hasOuterVariable)
+            {
+                _iterationVariables[node.Variable] = outerVariable!;
+            }
+            else
+            {
+                _iterationVariables.Remove(node.Variable);
+            }
+        }
+
+        return Expression.Block(
+            new[] { start, end, counter, last, iterationVariable, result },
+            Expression.Assign(start, startBound),
+            Expression.Assign(end, endBound),
+            Expression.Call(CheckBoundsMethod, start, end, Expression.Constant(boundsMessage), Expression.Constant(node.Position)),
+            Expression.Assign(counter, Expression.Call(ToBoundMethod, start)),
+            Expression.Assign(last, Expression.Call(ToBoundMethod, end)),
+            Expression.Assign(result, Expression.Constant(seed)),
+            Expression.Loop(
+                Expression.IfThenElse(
+                    Expression.LessThanOrEqual(counter, last),
+                    Expression.Block(
+                        Expression.Assign(iterationVariable, Expression.Convert(counter, typeof(decimal))),
+                        Expression.Assign(result, Format(accumulate(result, term))),
+                        Expression.PreIncrementAssign(counter)),
+                    Expression.Break(done, result)),
+                done));
+    }
+
+    /// <summary>
+    /// Gets one of the helpers the compiled expressions call.
+    /// </summary>
+    /// <param name="name">The name of the helper.</param>
+    /// <returns>The helper.</returns>
+    private static MethodInfo GetHelper(string name)
+    {
+        return typeof(ExpressionCompiler).GetMethod(name, BindingFlags.NonPublic | BindingFlags.Static)!;
+    }
+
+    /// <summary>
+    /// Divides two values.
+    /// </summary>
+    /// <param name="numerator">The numerator.</param>
+    /// <param name="denominator">The denominator.</param>
+    /// <param name="position">The source position for error reporting.</param>
+    /// <returns>The quotient.</returns>
+    /// <exception cref="EvaluationException">Thrown when division by zero occurs.</exception>
+    private static decimal Divide(decimal numerator, decimal denominator, SourcePosition position)
+    {
+        if (denominator == 0)
+        {
+            throw new EvaluationException("Division by zero", position);
+        }
+
+        return numerator / denominator;
+    }
+
+    /// <summary>
+    /// Raises a non-zero base to a non-zero exponent.
+    /// </summary>
+    /// <param name="base">The base.</param>
+    /// <param name="exponent">The exponent.</param>
+    /// <returns>The power.</returns>
+    private static decimal Power(decimal @base, decimal exponent)
+    {
+        // Check if exponent is an integer
+        if (Math.Abs(exponent - Math.Round(exponent)) < MathConstants.Epsilon)
+        {
+            return (decimal)Math.Pow((double)@base, (int)Math.Round(exponent));
+        }
+
+        return (decimal)Math.Pow((double)@base, (double)exponent);
+    }
+
+    /// <summary>
+    /// Calculates the factorial of a value.
+    /// </summary>
+    /// <param name="value">The value.</param>
+    /// <param name="position">The source position for error reporting.</param>
+    /// <returns>The factorial.</returns>
+    /// <exception cref="EvaluationException">Thrown when the value is not a non-negative integer.</exception>
+    private static decimal Factorial(decimal value, SourcePosition position)
+    {
+        if (value < 0 || Math.Abs(value - Math.Round(value)) > MathConstants.Epsilon)
+        {
+            throw new EvaluationException("Factorial is only defined for non-negative integers", position);
+        }
+
+        var n = (int)Math.Round(value);
+
+        var result = 1m;
+        for (var i = 2; i <= n; i++)
+        {
+            result *= i;
+        }
+
+        return result;
+    }
+
+    /// <summary>
+    /// Checks that the bounds of an iterator are integers.
+    /// </summary>
+    /// <param name="start">The start value.</param>
+    /// <param name="end">The end value.</param>
+    /// <param name="message">The error message for bounds that are not integers.</param>
+    /// <param name="position">The source position for error reporting.</param>
+    /// <exception cref="EvaluationException">Thrown when a bound is not an integer.</exception>
+    private static void CheckBounds(decimal start, decimal end, string message, SourcePosition position)
+    {
+        if (Math.Abs(start - Math.Round(start)) > MathConstants.Epsilon ||
+            Math.Abs(end - Math.Round(end)) > MathConstants.Epsilon)
+        {
+            throw new EvaluationException(message, position);
+        }
+    }
+
+    /// <summary>
+    /// Converts a checked bound of an iterator to an integer.
+    /// </summary>
+    /// <param name="value">The bound.</param>
+    /// <returns>The bound as an integer.</returns>
+    private static int ToBound(decimal value)
+    {
+        return (int)Math.Round(value);
+    }
+}
\ No newline at end of file
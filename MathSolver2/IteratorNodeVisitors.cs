@@ -1,7 +1,7 @@
 ﻿namespace MathSolver2;
 
 /// <summary>
-/// Extension methods for the EnhancedStepByStepVisitor to handle iterator nodes.
+/// Extension methods for the StepByStepArithmeticVisitor to handle iterator nodes.
 /// </summary>
 public static class IteratorNodeVisitors
 {
@@ -11,17 +11,13 @@ public static class IteratorNodeVisitors
     /// <param name="visitor">The arithmetic visitor used for evaluating expressions.</param>
     /// <param name="node">The summation node to be visited.</param>
     /// <param name="variables">The dictionary of variables and their current values.</param>
-    /// <param name="formatter">The formatter used to format expressions.</param>
     /// <param name="formatNumber">A function to format numeric results.</param>
-    /// <param name="getFormatInfo">A function to retrieve formatting information.</param>
     /// <returns>A <see cref="StepByStepResult"/> containing the result and the steps taken.</returns>
     public static StepByStepResult VisitSummation(
         this StepByStepArithmeticVisitor visitor,
         SummationNode node,
         Dictionary<string, decimal> variables,
-        FormattingVisitor formatter,
-        Func<decimal, decimal> formatNumber,
-        Func<string> getFormatInfo)
+        Func<decimal, decimal> formatNumber)
     {
         // Get the start value with steps
         var startResult = node.Start.Accept(visitor);
@@ -29,10 +25,6 @@ public static class IteratorNodeVisitors
         // Get the end value with steps
         var endResult = node.End.Accept(visitor);
 
-        // Collect all steps so far
-        var allSteps = new List<CalculationStep>(startResult.Steps);
-        allSteps.AddRange(endResult.Steps);
-
         // We need to handle non-integer bounds as an error
         if (Math.Abs(startResult.Value - Math.Round(startResult.Value)) > MathConstants.Epsilon ||
             Math.Abs(endResult.Value - Math.Round(endResult.Value)) > MathConstants.Epsilon)
@@ -49,12 +41,8 @@ public static class IteratorNodeVisitors
 
         try
         {
-            // Format and add the summation setup step
-            var expression = formatter.Format(node);
-            allSteps.Add(new CalculationStep(
-                expression,
-                $"Setup summation with {node.Variable} from {startInt} to {endInt}",
-                $"Calculate each term and sum"));
+            // Add the summation setup step
+            visitor.RecordStep(StepKind.IteratorSetup, node, startInt, endInt, 0);
 
             // Initialize the result
             var result = 0m;
@@ -66,38 +54,25 @@ public static class IteratorNodeVisitors
                 variables[node.Variable] = i;
 
                 // Record the current value of the iteration variable
-                var currentExpression = $"{node.Variable} = {i}";
-                allSteps.Add(new CalculationStep(
-                    currentExpression,
-                    $"Set iteration variable {node.Variable} to {i}",
-                    i.ToString()));
+                visitor.RecordStep(StepKind.IterationVariable, node, i, 0, i);
 
-                // Evaluate the expression with the current value
+                // Evaluate the expression with the current value, recording its steps
                 var termResult = node.Expression.Accept(visitor);
 
-                // Add the term result steps
-                allSteps.AddRange(termResult.Steps);
-
                 // Add step for adding this term to the sum
                 var newResult = result + termResult.Value;
                 var formattedNewResult = formatNumber(newResult);
 
-                allSteps.Add(new CalculationStep(
-                    $"sum + {termResult.Value}",
-                    $"Add term value {termResult.Value} to current sum {result}, {getFormatInfo()}",
-                    formattedNewResult.ToString()));
+                visitor.RecordStep(StepKind.IterationTerm, node, result, termResult.Value, formattedNewResult);
 
                 // Update the result
                 result = formattedNewResult;
             }
 
             // Add final summation result step
-            allSteps.Add(new CalculationStep(
-                expression,
-                $"Complete summation from {startInt} to {endInt}",
-                result.ToString()));
+            visitor.RecordStep(StepKind.IteratorComplete, node, startInt, endInt, result);
 
-            return new StepByStepResult(result, allSteps);
+            return visitor.Result(result);
         }
         finally
         {
@@ -119,17 +94,13 @@ public static class IteratorNodeVisitors
     /// <param name="visitor">The arithmetic visitor used for evaluating expressions.</param>
     /// <param name="node">The product node to be visited.</param>
     /// <param name="variables">The dictionary of variables and their current values.</param>
-    /// <param name="formatter">The formatter used to format expressions.</param>
     /// <param name="formatNumber">A function to format numeric results.</param>
-    /// <param name="getFormatInfo">A function to retrieve formatting information.</param>
     /// <returns>A <see cref="StepByStepResult"/> containing the result and the steps taken.</returns>
     public static StepByStepResult VisitProduct(
         this StepByStepArithmeticVisitor visitor,
         ProductNode node,
         Dictionary<string, decimal> variables,
-        FormattingVisitor formatter,
-        Func<decimal, decimal> formatNumber,
-        Func<string> getFormatInfo)
+        Func<decimal, decimal> formatNumber)
     {
         // Get the start value with steps
         var startResult = node.Start.Accept(visitor);
@@ -137,10 +108,6 @@ public static class IteratorNodeVisitors
         // Get the end value with steps
         var endResult = node.End.Accept(visitor);
 
-        // Collect all steps so far
-        var allSteps = new List<CalculationStep>(startResult.Steps);
-        allSteps.AddRange(endResult.Steps);
-
         // We need to handle non-integer bounds as an error
         if (Math.Abs(startResult.Value - Math.Round(startResult.Value)) > MathConstants.Epsilon ||
             Math.Abs(endResult.Value - Math.Round(endResult.Value)) > MathConstants.Epsilon)
@@ -157,12 +124,8 @@ public static class IteratorNodeVisitors
 
         try
         {
-            // Format and add the product setup step
-            var expression = formatter.Format(node);
-            allSteps.Add(new CalculationStep(
-                expression,
-                $"Setup product with {node.Variable} from {startInt} to {endInt}",
-                $"Calculate each term and multiply"));
+            // Add the product setup step
+            visitor.RecordStep(StepKind.IteratorSetup, node, startInt, endInt, 0);
 
             // Initialize the result
             var result = 1m;
@@ -174,38 +137,25 @@ public static class IteratorNodeVisitors
                 variables[node.Variable] = i;
 
                 // Record the current value of the iteration variable
-                var currentExpression = $"{node.Variable} = {i}";
-                allSteps.Add(new CalculationStep(
-                    currentExpression,
-                    $"Set iteration variable {node.Variable} to {i}",
-                    i.ToString()));
+                visitor.RecordStep(StepKind.IterationVariable, node, i, 0, i);
 
-                // Evaluate the expression with the current value
+                // Evaluate the expression with the current value, recording its steps
                 var termResult = node.Expression.Accept(visitor);
 
-                // Add the term result steps
-                allSteps.AddRange(termResult.Steps);
-
                 // Add step for multiplying this term to the product
                 var newResult = result * termResult.Value;
                 var formattedNewResult = formatNumber(newResult);
 
-                allSteps.Add(new CalculationStep(
-                    $"product * {termResult.Value}",
-                    $"Multiply term value {termResult.Value} with current product {result}, {getFormatInfo()}",
-                    formattedNewResult.ToString()));
+                visitor.RecordStep(StepKind.IterationTerm, node, result, termResult.Value, formattedNewResult);
 
                 // Update the result
                 result = formattedNewResult;
             }
 
             // Add final product result step
-            allSteps.Add(new CalculationStep(
-                expression,
-                $"Complete product from {startInt} to {endInt}",
-                result.ToString()));
+            visitor.RecordStep(StepKind.IteratorComplete, node, startInt, endInt, result);
 
-            return new StepByStepResult(result, allSteps);
+            return visitor.Result(result);
         }
         finally
         {
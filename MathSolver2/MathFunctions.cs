@@ -105,6 +105,35 @@ public static class MathFunctions
         throw new EvaluationException($"Unsupported function: {functionName}", position);
     }
 
+    /// <summary>
+    /// Gets the handler of a function by its name, so it can be called without looking it up again.
+    /// </summary>
+    /// <param name="functionName">The name of the function.</param>
+    /// <param name="function">The handler of the function, if found.</param>
+    /// <returns><c>true</c> if the function exists; otherwise, <c>false</c>.</returns>
+    internal static bool TryGetFunction(string functionName, out Func<decimal[], SourcePosition, decimal> function)
+    {
+        return _functions.TryGetValue(functionName, out function!);
+    }
+
+    /// <summary>
+    /// Describes a call of a function with its description format.
+    /// </summary>
+    /// <param name="functionName">The name of the function.</param>
+    /// <param name="args">The arguments the function was called with.</param>
+    /// <returns>The description of the call.</returns>
+    internal static string Describe(string functionName, decimal[] args)
+    {
+        var descriptionFormat = GetDescriptionFormat(functionName);
+
+        if (args.Length == 0)
+        {
+            return descriptionFormat;
+        }
+
+        return string.Format(descriptionFormat, args.Select(a => (object)a).ToArray());
+    }
+
     /// <summary>
     /// Gets the description format for a function by its name.
     /// </summary>
@@ -3,9 +3,17 @@
 /// <summary>
 /// Evaluates an expression tree step by step with arithmetic formatting and records each calculation.
 /// </summary>
+/// <remarks>
+/// The steps are recorded into one list, in the order they are taken, and are formatted only
+/// when their texts are read. With a step pool, the steps are taken from the pool instead of
+/// being allocated.
+/// </remarks>
 public class StepByStepArithmeticVisitor : BaseArithmeticVisitor<StepByStepResult>
 {
     private readonly FormattingVisitor _formatter;
+    private readonly StepPool? _pool;
+    private readonly string _formatInfo;
+    private List<CalculationStep> _steps;
 
     /// <summary>
     /// Creates a new step-by-step arithmetic visitor with the specified settings.
@@ -18,9 +26,75 @@ public class StepByStepArithmeticVisitor : BaseArithmeticVisitor<StepByStepResul
         Dictionary<string, decimal> variables,
         ArithmeticType arithmeticType,
         int precision,
-        bool useSignificantDigits) : base(variables, arithmeticType, precision, useSignificantDigits)
+        bool useSignificantDigits) : this(variables, arithmeticType, precision, useSignificantDigits, null) { }
+
+    /// <summary>
+    /// Creates a new step-by-step arithmetic visitor that takes its steps from a pool.
+    /// </summary>
+    /// <param name="variables">A dictionary of variable names and their values.</param>
+    /// <param name="arithmeticType">The type of arithmetic to use (e.g., standard or scientific).</param>
+    /// <param name="precision">The number of decimal places to use in calculations.</param>
+    /// <param name="useSignificantDigits">Whether to use significant digits for formatting.</param>
+    /// <param name="pool">The pool to take the steps from, or null to allocate them.</param>
+    internal StepByStepArithmeticVisitor(
+        Dictionary<string, decimal> variables,
+        ArithmeticType arithmeticType,
+        int precision,
+        bool useSignificantDigits,
+        StepPool? pool) : base(variables, arithmeticType, precision, useSignificantDigits)
     {
         _formatter = new FormattingVisitor();
+        _pool = pool;
+        _formatInfo = GetFormatInfo();
+        _steps = new List<CalculationStep>();
+    }
+
+    /// <summary>
+    /// Evaluates the expression step by step and records calculations.
+    /// </summary>
+    /// <param name="node">The expression node to evaluate.</param>
+    /// <returns>The evaluated result, with the steps of this evaluation only.</returns>
+    public override StepByStepResult Evaluate(IExpressionNode node)
+    {
+        _steps = new List<CalculationStep>();
+        return node.Accept(this);
+    }
+
+    /// <summary>
+    /// Gets the number of steps recorded so far.
+    /// </summary>
+    internal int StepCount => _steps.Count;
+
+    /// <summary>
+    /// Records a step of the evaluation.
+    /// </summary>
+    /// <param name="kind">The kind of step.</param>
+    /// <param name="node">The node the step evaluates.</param>
+    /// <param name="left">The left operand, or the first value the step describes.</param>
+    /// <param name="right">The right operand, or the second value the step describes.</param>
+    /// <param name="value">The value the step results in.</param>
+    /// <param name="arguments">The arguments of a function call, if any.</param>
+    internal void RecordStep(
+        StepKind kind,
+        IExpressionNode node,
+        decimal left,
+        decimal right,
+        decimal value,
+        decimal[]? arguments = null)
+    {
+        var step = _pool?.Rent() ?? new CalculationStep();
+        step.Record(kind, node, _formatter, _formatInfo, left, right, value, arguments);
+        _steps.Add(step);
+    }
+
+    /// <summary>
+    /// Creates the result of a node evaluated to a value.
+    /// </summary>
+    /// <param name="value">The value of the node.</param>
+    /// <returns>The result, sharing the steps recorded so far.</returns>
+    internal StepByStepResult Result(decimal value)
+    {
+        return new StepByStepResult(value, _steps);
     }
 
     #region Visitor Methods
@@ -32,8 +106,7 @@ public class StepByStepArithmeticVisitor : BaseArithmeticVisitor<StepByStepResul
     /// <returns>A result containing the value of the number and no steps.</returns>
     public override StepByStepResult VisitNumber(NumberNode node)
     {
-        var value = FormatNumber(node.Value);
-        return new StepByStepResult(value, new List<CalculationStep>());
+        return Result(FormatNumber(node.Value));
     }
 
     /// <summary>
@@ -48,28 +121,13 @@ public class StepByStepArithmeticVisitor : BaseArithmeticVisitor<StepByStepResul
         if (MathConstants.TryGetValue(node.Name, out var constValue))
         {
             var formattedConstValue = FormatNumber(constValue);
-
-            var steps = new List<CalculationStep>
-            {
-                new CalculationStep(
-                    node.Name,
-                    $"Substitute mathematical constant {node.Name}",
-                    formattedConstValue.ToString())
-            };
-
-            return new StepByStepResult(formattedConstValue, steps);
+            RecordStep(StepKind.Constant, node, 0, 0, formattedConstValue);
+            return Result(formattedConstValue);
         }
         if (Variables.TryGetValue(node.Name, out var value))
         {
-            var steps = new List<CalculationStep>
-            {
-                new CalculationStep(
-                    node.Name,
-                    $"Substitute variable {node.Name}",
-                    value.ToString())
-            };
-
-            return new StepByStepResult(value, steps);
+            RecordStep(StepKind.Variable, node, 0, 0, value);
+            return Result(value);
         }
 
         throw new EvaluationException($"Variable '{node.Name}' is not defined", node.Position);
@@ -82,24 +140,13 @@ public class StepByStepArithmeticVisitor : BaseArithmeticVisitor<StepByStepResul
     /// <returns>A result containing the sum and the calculation steps.</returns>
     public override StepByStepResult VisitAddition(AdditionNode node)
     {
-        var leftResult = node.Left.Accept(this);
-        var rightResult = node.Right.Accept(this);
-
-        var allSteps = new List<CalculationStep>(leftResult.Steps);
-        allSteps.AddRange(rightResult.Steps);
+        var left = node.Left.Accept(this).Value;
+        var right = node.Right.Accept(this).Value;
 
-        var rawResult = leftResult.Value + rightResult.Value;
-        var formattedResult = FormatNumber(rawResult);
-
-        var formatInfo = GetFormatInfo();
-        var expression = _formatter.Format(node);
+        var formattedResult = FormatNumber(left + right);
+        RecordStep(StepKind.Addition, node, left, right, formattedResult);
 
-        allSteps.Add(new CalculationStep(
-            expression,
-            $"Add {leftResult.Value} and {rightResult.Value}, {formatInfo}",
-            formattedResult.ToString()));
-
-        return new StepByStepResult(formattedResult, allSteps);
+        return Result(formattedResult);
     }
 
     /// <summary>
@@ -109,24 +156,13 @@ public class StepByStepArithmeticVisitor : BaseArithmeticVisitor<StepByStepResul
     /// <returns>A result containing the difference and the calculation steps.</returns>
     public override StepByStepResult VisitSubtraction(SubtractionNode node)
     {
-        var leftResult = node.Left.Accept(this);
-        var rightResult = node.Right.Accept(this);
+        var left = node.Left.Accept(this).Value;
+        var right = node.Right.Accept(this).Value;
 
-        var allSteps = new List<CalculationStep>(leftResult.Steps);
-        allSteps.AddRange(rightResult.Steps);
+        var formattedResult = FormatNumber(left - right);
+        RecordStep(StepKind.Subtraction, node, left, right, formattedResult);
 
-        var rawResult = leftResult.Value - rightResult.Value;
-        var formattedResult = FormatNumber(rawResult);
-
-        var formatInfo = GetFormatInfo();
-        var expression = _formatter.Format(node);
-
-        allSteps.Add(new CalculationStep(
-            expression,
-            $"Subtract {rightResult.Value} from {leftResult.Value}, {formatInfo}",
-            formattedResult.ToString()));
-
-        return new StepByStepResult(formattedResult, allSteps);
+        return Result(formattedResult);
     }
 
     /// <summary>
@@ -136,24 +172,13 @@ public class StepByStepArithmeticVisitor : BaseArithmeticVisitor<StepByStepResul
     /// <returns>A result containing the product and the calculation steps.</returns>
     public override StepByStepResult VisitMultiplication(MultiplicationNode node)
     {
-        var leftResult = node.Left.Accept(this);
-        var rightResult = node.Right.Accept(this);
-
-        var allSteps = new List<CalculationStep>(leftResult.Steps);
-        allSteps.AddRange(rightResult.Steps);
-
-        var rawResult = leftResult.Value * rightResult.Value;
-        var formattedResult = FormatNumber(rawResult);
-
-        var formatInfo = GetFormatInfo();
-        var expression = _formatter.Format(node);
+        var left = node.Left.Accept(this).Value;
+        var right = node.Right.Accept(this).Value;
 
-        allSteps.Add(new CalculationStep(
-            expression,
-            $"Multiply {leftResult.Value} by {rightResult.Value}, {formatInfo}",
-            formattedResult.ToString()));
+        var formattedResult = FormatNumber(left * right);
+        RecordStep(StepKind.Multiplication, node, left, right, formattedResult);
 
-        return new StepByStepResult(formattedResult, allSteps);
+        return Result(formattedResult);
     }
 
     /// <summary>
@@ -164,29 +189,18 @@ public class StepByStepArithmeticVisitor : BaseArithmeticVisitor<StepByStepResul
     /// <exception cref="EvaluationException">Thrown if division by zero occurs.</exception>
     public override StepByStepResult VisitDivision(DivisionNode node)
     {
-        var numeratorResult = node.Numerator.Accept(this);
-        var denominatorResult = node.Denominator.Accept(this);
+        var numerator = node.Numerator.Accept(this).Value;
+        var denominator = node.Denominator.Accept(this).Value;
 
-        var allSteps = new List<CalculationStep>(numeratorResult.Steps);
-        allSteps.AddRange(denominatorResult.Steps);
-
-        if (denominatorResult.Value == 0)
+        if (denominator == 0)
         {
             throw new EvaluationException("Division by zero", node.Position);
         }
 
-        var rawResult = numeratorResult.Value / denominatorResult.Value;
-        var formattedResult = FormatNumber(rawResult);
-
-        var formatInfo = GetFormatInfo();
-        var expression = _formatter.Format(node);
-
-        allSteps.Add(new CalculationStep(
-            expression,
-            $"Divide {numeratorResult.Value} by {denominatorResult.Value}, {formatInfo}",
-            formattedResult.ToString()));
+        var formattedResult = FormatNumber(numerator / denominator);
+        RecordStep(StepKind.Division, node, numerator, denominator, formattedResult);
 
-        return new StepByStepResult(formattedResult, allSteps);
+        return Result(formattedResult);
     }
 
     /// <summary>
@@ -196,59 +210,43 @@ public class StepByStepArithmeticVisitor : BaseArithmeticVisitor<StepByStepResul
     /// <returns>A result containing the power and the calculation steps.</returns>
     public override StepByStepResult VisitExponent(ExponentNode node)
     {
-        var baseResult = node.Base.Accept(this);
-        var exponentResult = node.Exponent.Accept(this);
-
-        var allSteps = new List<CalculationStep>(baseResult.Steps);
-        allSteps.AddRange(exponentResult.Steps);
+        var @base = node.Base.Accept(this).Value;
+        var exponent = node.Exponent.Accept(this).Value;
 
         decimal rawResult;
-        string operation;
 
-        // Handle special cases
-        if (exponentResult.Value == 0)
+        // Handle special cases; the step describes them from its operands
+        if (exponent == 0)
         {
             rawResult = 1;
-            operation = $"Any number raised to power 0 is 1";
         }
-        else if (baseResult.Value == 0)
+        else if (@base == 0)
         {
             rawResult = 0;
-            operation = $"0 raised to any non-zero power is 0";
         }
-        else if (exponentResult.Value == 1)
+        else if (exponent == 1)
         {
-            rawResult = baseResult.Value;
-            operation = $"Any number raised to power 1 is the number itself";
+            rawResult = @base;
         }
         else
         {
             // Check if exponent is an integer
-            if (Math.Abs(exponentResult.Value - Math.Round(exponentResult.Value)) < MathConstants.Epsilon)
+            if (Math.Abs(exponent - Math.Round(exponent)) < MathConstants.Epsilon)
             {
-                var intExponent = (int)Math.Round(exponentResult.Value);
-                rawResult = (decimal)Math.Pow((double)baseResult.Value, intExponent);
+                var intExponent = (int)Math.Round(exponent);
+                rawResult = (decimal)Math.Pow((double)@base, intExponent);
             }
             else
             {
                 // For non-integer exponents, use Math.Pow
-                rawResult = (decimal)Math.Pow((double)baseResult.Value, (double)exponentResult.Value);
+                rawResult = (decimal)Math.Pow((double)@base, (double)exponent);
             }
-
-            operation = $"Raise {baseResult.Value} to the power of {exponentResult.Value}";
         }
 
         var formattedResult = FormatNumber(rawResult);
+        RecordStep(StepKind.Exponent, node, @base, exponent, formattedResult);
 
-        var formatInfo = GetFormatInfo();
-        var expression = _formatter.Format(node);
-
-        allSteps.Add(new CalculationStep(
-            expression,
-            $"{operation}, {formatInfo}",
-            formattedResult.ToString()));
-
-        return new StepByStepResult(formattedResult, allSteps);
+        return Result(formattedResult);
     }
 
     /// <summary>
@@ -258,21 +256,16 @@ public class StepByStepArithmeticVisitor : BaseArithmeticVisitor<StepByStepResul
     /// <returns>A result containing the value of the inner expression and the calculation steps.</returns>
     public override StepByStepResult VisitParenthesis(ParenthesisNode node)
     {
-        var innerResult = node.Expression.Accept(this);
+        var firstStep = StepCount;
+        var value = node.Expression.Accept(this).Value;
 
         // Add a step showing the parentheses are being evaluated
-        var expression = _formatter.Format(node);
-        var allSteps = new List<CalculationStep>(innerResult.Steps);
-
-        if (innerResult.Steps.Count > 0)
+        if (StepCount > firstStep)
         {
-            allSteps.Add(new CalculationStep(
-                expression,
-                "Evaluate parentheses",
-                innerResult.Value.ToString()));
+            RecordStep(StepKind.Parenthesis, node, 0, 0, value);
         }
 
-        return new StepByStepResult(innerResult.Value, allSteps);
+        return Result(value);
     }
 
     /// <summary>
@@ -282,30 +275,18 @@ public class StepByStepArithmeticVisitor : BaseArithmeticVisitor<StepByStepResul
     /// <returns>A result containing the function's value and the calculation steps.</returns>
     public override StepByStepResult VisitFunction(FunctionNode node)
     {
-        // Evaluate arguments and collect steps
-        var argResults = node.Arguments.Select(arg => arg.Accept(this)).ToList();
-        var allSteps = new List<CalculationStep>();
-        foreach (var argResult in argResults)
+        // Evaluate arguments, recording their steps
+        var argValues = new decimal[node.Arguments.Count];
+        for (var i = 0; i < argValues.Length; i++)
         {
-            allSteps.AddRange(argResult.Steps);
+            argValues[i] = node.Arguments[i].Accept(this).Value;
         }
 
-        // Get argument values
-        var argValues = argResults.Select(r => r.Value).ToArray();
-
-        // Evaluate the function - getting both result and description
-        var (result, description) = EvaluateFunction(node.Name, argValues, node.Position);
-
-        // Format the expression
-        var expression = _formatter.Format(node);
-
-        // Add the calculation step
-        allSteps.Add(new CalculationStep(
-            expression,
-            description,
-            result.ToString()));
+        // Evaluate the function; the step describes it when it is read
+        var result = EvaluateFunctionValue(node.Name, argValues, node.Position);
+        RecordStep(StepKind.Function, node, 0, 0, result, argValues);
 
-        return new StepByStepResult(result, allSteps);
+        return Result(result);
     }
 
     /// <summary>
@@ -316,10 +297,7 @@ public class StepByStepArithmeticVisitor : BaseArithmeticVisitor<StepByStepResul
     /// <exception cref="EvaluationException">Thrown if the value is not a non-negative integer.</exception>
     public override StepByStepResult VisitFactorial(FactorialNode node)
     {
-        var innerResult = node.Expression.Accept(this);
-        var allSteps = new List<CalculationStep>(innerResult.Steps);
-
-        var value = innerResult.Value;
+        var value = node.Expression.Accept(this).Value;
 
         // Check if value is a non-negative integer
         if (value < 0 || Math.Abs(value - Math.Round(value)) > MathConstants.Epsilon)
@@ -337,16 +315,9 @@ public class StepByStepArithmeticVisitor : BaseArithmeticVisitor<StepByStepResul
         }
 
         var formattedResult = FormatNumber(rawResult);
+        RecordStep(StepKind.Factorial, node, n, 0, formattedResult);
 
-        var formatInfo = GetFormatInfo();
-        var expression = _formatter.Format(node);
-
-        allSteps.Add(new CalculationStep(
-            expression,
-            $"Calculate factorial of {n}, {formatInfo}",
-            formattedResult.ToString()));
-
-        return new StepByStepResult(formattedResult, allSteps);
+        return Result(formattedResult);
     }
 
     /// <summary>
@@ -360,9 +331,7 @@ public class StepByStepArithmeticVisitor : BaseArithmeticVisitor<StepByStepResul
             this,
             node,
             Variables,
-            _formatter,
-            FormatNumber,
-            GetFormatInfo);
+            FormatNumber);
     }
 
     /// <summary>
@@ -376,9 +345,7 @@ public class StepByStepArithmeticVisitor : BaseArithmeticVisitor<StepByStepResul
             this,
             node,
             Variables,
-            _formatter,
-            FormatNumber,
-            GetFormatInfo);
+            FormatNumber);
     }
 
     #endregion
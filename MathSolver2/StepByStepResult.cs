@@ -3,7 +3,12 @@
 /// <summary>
 /// Represents the result of a step-by-step evaluation, including the final value and all calculation steps.
 /// </summary>
-public class StepByStepResult
+/// <remarks>
+/// A step-by-step evaluation records its steps into a single list, in the order they are taken.
+/// The results of the nodes evaluated along the way share that list, so the steps of a node
+/// are the ones recorded after the steps of the nodes evaluated before it.
+/// </remarks>
+public readonly struct StepByStepResult
 {
     /// <summary>
     /// Gets the final calculated value.
@@ -16,7 +21,7 @@ public class StepByStepResult
     public List<CalculationStep> Steps { get; }
 
     /// <summary>
-    /// Initializes a new instance of the <see cref="StepByStepResult"/> class.
+    /// Initializes a new instance of the <see cref="StepByStepResult"/> struct.
     /// </summary>
     /// <param name="value">The final calculated value.</param>
     /// <param name="steps">The list of calculation steps. If null, an empty list is used.</param>
@@ -0,0 +1,53 @@
+﻿namespace MathSolver2;
+
+/// <summary>
+/// Pool of calculation steps, reused by the step-by-step evaluations of a solver
+/// once the results holding them are disposed.
+/// </summary>
+internal sealed class StepPool
+{
+    /// <summary>
+    /// Maximum number of steps the pool keeps; steps returned beyond it are left to the garbage collector.
+    /// </summary>
+    private const int MaxPooledSteps = 4096;
+
+    private readonly Stack<CalculationStep> _steps = new Stack<CalculationStep>();
+
+    /// <summary>
+    /// Takes a step from the pool, or creates one if the pool is empty.
+    /// </summary>
+    /// <returns>A step to record.</returns>
+    public CalculationStep Rent()
+    {
+        lock (_steps)
+        {
+            if (_steps.Count > 0)
+            {
+                return _steps.Pop();
+            }
+        }
+
+        return new CalculationStep();
+    }
+
+    /// <summary>
+    /// Returns steps to the pool. The steps must not be used afterwards.
+    /// </summary>
+    /// <param name="steps">The steps to return.</param>
+    public void Return(IEnumerable<CalculationStep> steps)
+    {
+        lock (_steps)
+        {
+            foreach (var step in steps)
+            {
+                if (_steps.Count >= MaxPooledSteps)
+                {
+                    break;
+                }
+
+                step.Clear();
+                _steps.Push(step);
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -77,7 +77,6 @@ public class Token
         Type = type;
         Value = value;
         Position = position;
-        Console.WriteLine($"Token: {Type} {Value} at {Position}");
     }
 
     /// <summary>
@@ -15,6 +15,12 @@ static GUISettings _settings_ = {
     .highlight_color = 0x10        /**< Default highlight color */
 };
 
+/** Number of frames begun and not yet ended. */
+static int frame_depth = 0;
+
+/** Whether a refresh was asked for during the current frame. */
+static bool frame_pending = false;
+
 /**
  * @brief Returns a pointer to the current GUI settings.
  * @return Pointer to the GUISettings structure.
@@ -39,6 +45,40 @@ void GUI_init(void) {
     gfx_SetFontHeight(GUI_CHAR_HEIGHT); 
 }
 
+/**
+ * @brief Shows what was drawn in the draw buffer on the screen.
+ *
+ * Inside a frame the buffer is only shown when the outermost frame ends,
+ * so widgets that update on the same keystroke are shown with one blit.
+ */
+void GUI_refresh(void) {
+    if (frame_depth > 0) {
+        frame_pending = true;  /**< Shown by GUI_end_frame */
+        return;
+    }
+    gfx_BlitBuffer();  /**< Copy the draw buffer to the screen to display the changes */
+}
+
+/**
+ * @brief Starts a frame; refreshes until the matching GUI_end_frame are batched.
+ *
+ * Frames may be nested, only the outermost one shows the buffer.
+ */
+void GUI_begin_frame(void) {
+    frame_depth++;
+}
+
+/**
+ * @brief Ends a frame, and shows the draw buffer if a refresh was asked for during it.
+ */
+void GUI_end_frame(void) {
+    if (frame_depth == 0) return;
+    if (--frame_depth == 0 && frame_pending) {
+        frame_pending = false;
+        gfx_BlitBuffer();
+    }
+}
+
 /**
  * @brief Ends the GUI system and releases resources.
  */
@@ -194,7 +234,7 @@ void GUI_print_text(int x, int y, const char* text) {
     // log_debuglog_debug("GUI_print_text() called");
     
     // Log text length for debugging
-    log_message("Text length: %d", strlen(text));
+    LOG_TRACE("Text length: %d", strlen(text));
     
     // Call internal function with full-width parameters
     _GUI_print_text_internal(x, y, text, -1, false);
@@ -9,7 +9,7 @@
 #define INPUT_FIELD_H
 
 #include <stdbool.h>
-#include "kb_handler.h"
+#include "../../../common/headers/kb_handler.h"
 #include "kb_mapping.h"
 
 /**
@@ -35,9 +35,11 @@ struct InputField {
     bool has_border;          // Whether to draw a border
     
     // Text properties
-    char* text;               // Text content
+    char* text;               // Text buffer, with a gap where it was last edited
     int text_length;          // Length of the text
-    int buffer_size;          // Total buffer size allocated
+    int buffer_size;          // Size of the buffer, text and gap
+    int gap_start;            // Start of the gap (index of the first free character)
+    int gap_end;              // End of the gap (index of the first character after it)
     int cursor_position;      // Cursor position in the text (character index)
     int scroll_offset;        // Horizontal scroll offset (character index)
     int max_visible_chars;    // Maximum number of visible characters
@@ -4,7 +4,7 @@
 #include <stdbool.h>
 #include <tice.h>
 #include <keypadc.h>
-#include "kb_handler.h"
+#include "../../../common/headers/kb_handler.h"
 
 /**
  * Constants for special key values that don't have direct character representations
@@ -14,6 +14,7 @@
 
 #include <ti/real.h>
 #include "log_public.h"
+#include "../../../common/log_macros.h"
 
 #ifndef LOG_TAG
 #define LOG_TAG ""
@@ -5,18 +5,28 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include "headers/gui.h"
-#include "headers/kb_handler.h"
+#include "../../common/headers/kb_handler.h"
 #include "headers/kb_mapping.h"
 #include "headers/input_field.h"
 
 #define LOG_TAG "input_field"
 #include "headers/log.h"
 
-// Default initial buffer size
-#define INITIAL_BUFFER_SIZE 64
+// Number of input fields that can hold text at the same time
+#define MAX_INPUT_FIELDS 4
+
+// Size of the buffer of an input field, terminator included
+#define TEXT_BUFFER_SIZE 256
+
+// Text buffers of the fields, taken from a fixed arena instead of the heap
+static char text_arena[MAX_INPUT_FIELDS][TEXT_BUFFER_SIZE];
+static bool text_arena_used[MAX_INPUT_FIELDS];
 
 // Forward declarations of internal functions
-static bool ensure_buffer_size(InputField* field, int needed_size);
+static char* arena_alloc(void);
+static void arena_free(char* buffer);
+static void move_gap(InputField* field, int position);
+static char text_char_at(InputField* field, int index);
 static void ensure_cursor_visible(InputField* field);
 static void process_character_input(InputField* field, char c);
 static void process_function_key(InputField* field, int func_code);
@@ -33,7 +43,7 @@ static void draw_mode_indicator_default(KeyboardMode mode, int x, int y);
  * @param has_border Whether to draw a border
  */
 void input_field_init(InputField* field, int x, int y, int width, bool has_border) {
-    log_debug("input_field_init() called");
+    LOG_DEBUG("input_field_init() called");
     
     memset(field, 0, sizeof(InputField));
     field->x = x;
@@ -44,14 +54,11 @@ void input_field_init(InputField* field, int x, int y, int width, bool has_borde
     // Calculate maximum visible characters
     field->max_visible_chars = (width - 2*PADDING_X) / GUI_CHAR_WIDTH;
     
-    // Allocate initial buffer
-    field->buffer_size = INITIAL_BUFFER_SIZE;
-    field->text = (char*)malloc(field->buffer_size);
-    if (field->text) {
-        field->text[0] = '\0';
-    } else {
-        log_error("Failed to allocate text buffer");
-    }
+    // Take a buffer from the arena; the whole of it starts as the gap
+    field->text = arena_alloc();
+    field->buffer_size = field->text ? TEXT_BUFFER_SIZE : 0;
+    field->gap_start = 0;
+    field->gap_end = field->buffer_size;
     
     // Initialize other values
     field->text_length = 0;
@@ -71,46 +78,78 @@ void input_field_init(InputField* field, int x, int y, int width, bool has_borde
  * @param field Pointer to InputField structure
  */
 void input_field_free(InputField* field) {
-    log_debug("input_field_free() called");
+    LOG_DEBUG("input_field_free() called");
     
     if (field->text) {
-        free(field->text);
+        arena_free(field->text);
         field->text = NULL;
     }
     field->buffer_size = 0;
+    field->gap_start = 0;
+    field->gap_end = 0;
     field->text_length = 0;
 }
 
 /**
- * Ensure the buffer is large enough for the given size.
+ * Take a text buffer from the arena.
  * 
- * @param field Pointer to InputField structure
- * @param needed_size Size needed including null terminator
- * @return true if buffer is large enough or was successfully resized
+ * @return A buffer of TEXT_BUFFER_SIZE characters, or NULL if all are in use
  */
-static bool ensure_buffer_size(InputField* field, int needed_size) {
-    if (!field->text) return false;
-    
-    if (needed_size <= field->buffer_size) {
-        return true; // Already large enough
+static char* arena_alloc(void) {
+    for (int i = 0; i < MAX_INPUT_FIELDS; i++) {
+        if (!text_arena_used[i]) {
+            text_arena_used[i] = true;
+            return text_arena[i];
+        }
     }
-    
-    // Calculate new size (double until sufficient)
-    int new_size = field->buffer_size;
-    while (new_size < needed_size) {
-        new_size *= 2;
+    LOG_ERROR("Failed to allocate text buffer");
+    return NULL;
+}
+
+/**
+ * Give a text buffer back to the arena.
+ * 
+ * @param buffer The buffer taken with arena_alloc
+ */
+static void arena_free(char* buffer) {
+    for (int i = 0; i < MAX_INPUT_FIELDS; i++) {
+        if (text_arena[i] == buffer) {
+            text_arena_used[i] = false;
+        }
     }
-    
-    // Reallocate
-    char* new_buffer = (char*)realloc(field->text, new_size);
-    if (!new_buffer) {
-        log_error("Failed to resize text buffer");
-        return false;
+}
+
+/**
+ * Move the gap to a position in the text. Edits at the gap need no
+ * shifting; moving it costs the characters it moves over.
+ * 
+ * @param field Pointer to InputField structure
+ * @param position Character index to move the gap to
+ */
+static void move_gap(InputField* field, int position) {
+    if (position < field->gap_start) {
+        int count = field->gap_start - position;
+        memmove(field->text + field->gap_end - count, field->text + position, count);
+        field->gap_start -= count;
+        field->gap_end -= count;
+    } else if (position > field->gap_start) {
+        int count = position - field->gap_start;
+        memmove(field->text + field->gap_start, field->text + field->gap_end, count);
+        field->gap_start += count;
+        field->gap_end += count;
     }
-    
-    field->text = new_buffer;
-    field->buffer_size = new_size;
-    return true;
+}
+
+/**
+ * Get a character of the text, wherever the gap is.
+ * 
+ * @param field Pointer to InputField structure
+ * @param index Character index, below text_length
+ * @return The character
+ */
+static char text_char_at(InputField* field, int index) {
+    return index < field->gap_start ? field->text[index]
+                                    : field->text[index + field->gap_end - field->gap_start];
 }
 
 /**
@@ -119,10 +158,11 @@ static bool ensure_buffer_size(InputField* field, int needed_size) {
  * @param field Pointer to InputField structure
  */
 void input_field_clear(InputField* field) {
-    log_debug("input_field_clear() called");
+    LOG_DEBUG("input_field_clear() called");
     
     if (field->text) {
-        field->text[0] = '\0';
+        field->gap_start = 0;
+        field->gap_end = field->buffer_size;
         field->text_length = 0;
         field->cursor_position = 0;
         field->scroll_offset = 0;
@@ -136,26 +176,38 @@ void input_field_clear(InputField* field) {
  * @param text Text to set
  */
 void input_field_set_text(InputField* field, const char* text) {
-    log_debug("input_field_set_text() called");
+    LOG_DEBUG("input_field_set_text() called");
     
+    if (!field->text) return;
+    
+    // One character of the buffer is kept for the terminator
     int length = strlen(text);
-    if (ensure_buffer_size(field, length + 1)) {
-        strcpy(field->text, text);
-        field->text_length = length;
-        
-        // Reset cursor and scroll
-        field->cursor_position = length;
-        ensure_cursor_visible(field);
+    if (length > field->buffer_size - 1) {
+        LOG_WARNING("Text truncated to %d characters", field->buffer_size - 1);
+        length = field->buffer_size - 1;
     }
+    memcpy(field->text, text, length);
+    field->text_length = length;
+    field->gap_start = length;
+    field->gap_end = field->buffer_size;
+    
+    // Reset cursor and scroll
+    field->cursor_position = length;
+    ensure_cursor_visible(field);
 }
 
 /**
  * Get the current text content of the field.
+ * The gap is moved to the end of the text, which leaves the text as a
+ * string at the start of the buffer, valid until the next edit.
  * 
  * @param field Pointer to InputField structure
  * @return The current text content
  */
 const char* input_field_get_text(InputField* field) {
+    if (!field->text) return "";
+    move_gap(field, field->text_length);
+    field->text[field->text_length] = '\0';
     return field->text;
 }
 
@@ -166,13 +218,16 @@ const char* input_field_get_text(InputField* field) {
  * @param text Text to append
  */
 void input_field_append(InputField* field, const char* text) {
-    log_debug("input_field_append() called");
+    LOG_DEBUG("input_field_append() called");
     
     int append_length = strlen(text);
     int new_length = field->text_length + append_length;
     
-    if (ensure_buffer_size(field, new_length + 1)) {
-        strcat(field->text, text);
+    // One character of the gap is kept for the terminator
+    if (field->text && append_length < field->gap_end - field->gap_start) {
+        move_gap(field, field->text_length);
+        memcpy(field->text + field->gap_start, text, append_length);
+        field->gap_start += append_length;
         field->text_length = new_length;
         
         // Move cursor to end
@@ -188,16 +243,13 @@ void input_field_append(InputField* field, const char* text) {
  * @param c Character to insert
  */
 void input_field_insert_char(InputField* field, char c) {
-    log_debug("input_field_insert_char() called");
+    LOG_DEBUG("input_field_insert_char() called");
     
-    if (ensure_buffer_size(field, field->text_length + 2)) {
-        // Shift characters after cursor
-        for (int i = field->text_length; i >= field->cursor_position; i--) {
-            field->text[i + 1] = field->text[i];
-        }
-        
-        // Insert the new character
-        field->text[field->cursor_position] = c;
+    // One character of the gap is kept for the terminator
+    if (field->text && field->gap_end - field->gap_start > 1) {
+        // Insert the new character into the gap
+        move_gap(field, field->cursor_position);
+        field->text[field->gap_start++] = c;
         field->text_length++;
         field->cursor_position++;
         
@@ -211,14 +263,12 @@ void input_field_insert_char(InputField* field, char c) {
  * @param field Pointer to InputField structure
  */
 void input_field_backspace(InputField* field) {
-    log_debug("input_field_backspace() called");
+    LOG_DEBUG("input_field_backspace() called");
     
     if (field->cursor_position > 0) {
-        // Shift characters at and after cursor
-        for (int i = field->cursor_position - 1; i < field->text_length; i++) {
-            field->text[i] = field->text[i + 1];
-        }
-        
+        // Widen the gap over the character before the cursor
+        move_gap(field, field->cursor_position);
+        field->gap_start--;
         field->text_length--;
         field->cursor_position--;
         
@@ -232,15 +282,13 @@ void input_field_backspace(InputField* field) {
  * @param field Pointer to InputField structure
  */
 void input_field_delete(InputField* field) {
-    log_debug("input_field_delete() called");
+    LOG_DEBUG("input_field_delete() called");
     
     // Only proceed if we're not at the end of the text
     if (field->cursor_position < field->text_length) {
-        // Shift characters after cursor
-        for (int i = field->cursor_position; i < field->text_length; i++) {
-            field->text[i] = field->text[i + 1];
-        }
-        
+        // Widen the gap over the character at the cursor
+        move_gap(field, field->cursor_position);
+        field->gap_end++;
         field->text_length--;
         
         // Cursor position stays the same
@@ -501,7 +549,7 @@ bool input_field_process_key(InputField* field, CombinedKey key) {
  * @return Result code indicating how focus was lost
  */
 InputResult input_field_get_focus(InputField* field) {
-    log_debug("input_field_get_focus() called");
+    LOG_DEBUG("input_field_get_focus() called");
     
     field->is_active = true;
     
@@ -522,21 +570,30 @@ InputResult input_field_get_focus(InputField* field) {
     unsigned long last_key_process_time = 0;
     int key_debounce_delay = 150;    // ms to wait before processing same key again (increased from 120ms)
     
+    // Nothing changes on screen until a key is processed
+    bool needs_redraw = true;
+    
     while (processing) {
         // Process keyboard events directly
         kb_Scan();
         
-        // Draw the field
-        input_field_draw(field);
-        
-        // Draw the keyboard mode indicator if callback is set
-        if (field->mode_indicator_callback) {
-            field->mode_indicator_callback(field->kbd_mode, field->x, field->y - 10);
+        if (needs_redraw) {
+            GUI_begin_frame();
+            
+            // Draw the field
+            input_field_draw(field);
+            
+            // Draw the keyboard mode indicator if callback is set
+            if (field->mode_indicator_callback) {
+                field->mode_indicator_callback(field->kbd_mode, field->x, field->y - 10);
+            }
+            
+            // Render all changes to the screen
+            GUI_refresh();
+            GUI_end_frame();
+            needs_redraw = false;
         }
         
-        // Render all changes to the screen
-        gfx_BlitBuffer();
-        
         // Current time for repeat and debounce logic
         unsigned long current_time = get_millis();
         
@@ -610,6 +667,8 @@ InputResult input_field_get_focus(InputField* field) {
                 
                 // Process the key if needed
                 if (should_process_key) {
+                    needs_redraw = true;
+                    
                     // Handle special exit keys
                     if (key == MAKE_KEY(6, kb_Clear)) {
                         if (field->text_length > 0) {
@@ -784,8 +843,9 @@ void input_field_draw(InputField* field) {
         visible_length = max_display_chars;
     }
     
-    if (visible_length > 0) {
-        strncpy(visible_text, field->text + field->scroll_offset, visible_length);
+    // Read the visible text around the gap
+    for (int i = 0; i < visible_length; i++) {
+        visible_text[i] = text_char_at(field, field->scroll_offset + i);
     }
     visible_text[visible_length < 0 ? 0 : visible_length] = '\0';
     
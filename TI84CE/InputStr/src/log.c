@@ -12,7 +12,7 @@
 #include <stdbool.h>
 #include <fileioc.h>
 #include "headers/ui.h"
-#include "headers/kb_handler.h"
+#include "../../common/headers/kb_handler.h"
 #include "headers/log_private.h"
 
 /* ============================== Logger Variables ============================== */
@@ -74,15 +74,6 @@ void log_message(const char* format, ...) {
     va_end(args);    
 }
 
-/**
- * Logs a debug message.
- * 
- * @param message The debug message to log.
- */
-void log_debug(const char* message) {
-    log_message("DEBUG: %s", message);
-}
-
 /**
  * Logs a variable value.
  * 
@@ -102,12 +93,3 @@ void log_variable(const char* name, real_t value) {
 void log_operation(const char* operation, char* result) {
     log_message("OP: %s = %.6f", operation, result);
 }
-
-/**
- * Logs an error message.
- * 
- * @param error The error message.
- */
-void log_error(const char* error) {
-    log_message("ERROR: %s", error);
-}
@@ -3,7 +3,7 @@
 #include <string.h>
 #include <stdio.h>
 #include "headers/gui.h"
-#include "headers/kb_handler.h"
+#include "../../common/headers/kb_handler.h"
 #include "headers/input_field.h"
 
 // Custom mode indicator callback
@@ -67,7 +67,7 @@ int main(void) {
     GUI_write_text(10, 20, "Enter your name:");
     GUI_write_text(10, 70, "Enter your equation:");
     GUI_write_text(10, 150, "Press Enter to submit, Clear to exit");
-    gfx_BlitBuffer();
+    GUI_refresh();
     
     // Process input for the first field
     result = input_field_get_focus(&name_field);
@@ -94,7 +94,7 @@ int main(void) {
             GUI_write_text(10, 50, equation_buffer);
             
             GUI_write_text(10, 80, "Press any key to exit");
-            gfx_BlitBuffer();
+            GUI_refresh();
             
             // Wait for a key press before exiting
             kb_wait_any();
@@ -104,7 +104,7 @@ int main(void) {
             // User pressed Clear on an empty field
             gfx_FillScreen(255);
             GUI_write_text_centered(LCD_HEIGHT/2, "Operation canceled");
-            gfx_BlitBuffer();
+            GUI_refresh();
             delay(1000);
             break;
             
@@ -11,7 +11,7 @@
 #include <string.h>
 #include <stdio.h>
 #include <ti/screen.h>
-#include "headers/kb_handler.h"
+#include "../../common/headers/kb_handler.h"
 #include "headers/ui_private.h"
 
 /* ============================== State Variables ============================== */
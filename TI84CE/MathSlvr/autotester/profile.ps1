@@ -0,0 +1,99 @@
+param(
+    [Parameter(Mandatory=$true)]
+    [string]$Rom,                       # CE ROM image for CEmu
+
+    [Parameter(Mandatory=$true)]
+    [string]$Libs,                      # clibs.8xg of the CE toolchain
+
+    [Parameter(Mandatory=$false)]
+    [int]$Threshold = 5                 # Slowdown of a zone, in percent, reported as a regression
+)
+
+<#
+ # Profiles MathSolver in CEmu.
+ #
+ # Builds a release with PROFILE=1, replays the keys of profile.json with
+ # the CEmu autotester, and reads the report the program writes to the
+ # debug console on exit. Each zone is appended to profile.csv with the
+ # commit it was built from, and compared with the last run recorded for
+ # another commit. The autotester key names are CEmu's.
+ #
+ # Usage: .\autotester\profile.ps1 -Rom <rom> -Libs <clibs.8xg>, from the
+ # MathSlvr directory.
+ #>
+
+$myPath = Split-Path -Parent $MyInvocation.MyCommand.Path
+$project = Split-Path -Parent $myPath
+$results = Join-Path $myPath profile.csv
+
+# Build with the profiler
+Push-Location $project
+$env:PROFILE = "1"
+& (Join-Path (Split-Path -Parent $project) build.ps1) release
+Remove-Item Env:\PROFILE
+$built = $LASTEXITCODE -eq 0
+$commit = (git rev-parse --short HEAD).Trim()
+Pop-Location
+if (-not $built) {
+    Write-Host "Build failed, nothing profiled." -ForegroundColor Red
+    exit 1
+}
+
+# The ROM and the libraries are given here, so profile.json holds no local paths
+$test = Get-Content (Join-Path $myPath profile.json) -Raw | ConvertFrom-Json
+$test.rom = (Resolve-Path $Rom).Path
+$test.transfer_files = @((Join-Path $project bin MATHSLVR.8xp), (Resolve-Path $Libs).Path)
+$testFile = Join-Path ([System.IO.Path]::GetTempPath()) "mathslvr-profile.json"
+$test | ConvertTo-Json -Depth 4 | Set-Content $testFile
+
+Write-Host "Replaying profile.json in CEmu..." -ForegroundColor Green
+$output = autotester $testFile 2>&1
+Remove-Item $testFile
+
+# PROFILE <zone> calls=<n> cycles=<n> mean=<n> us=<n>
+$zones = @()
+foreach ($line in $output) {
+    if ("$line" -match '^PROFILE (\w+) calls=(\d+) cycles=(\d+) mean=(\d+) us=(\d+)') {
+        $zones += [PSCustomObject]@{
+            Date   = (Get-Date -Format "yyyy-MM-dd HH:mm")
+            Commit = $commit
+            Zone   = $Matches[1]
+            Calls  = [long]$Matches[2]
+            Cycles = [long]$Matches[3]
+            Mean   = [long]$Matches[4]
+        }
+    }
+}
+if ($zones.Count -eq 0) {
+    Write-Host "No profile report in the autotester output:" -ForegroundColor Red
+    $output | ForEach-Object { Write-Host $_ }
+    exit 1
+}
+
+# Compare each zone with the last run of another commit
+$previous = @()
+if (Test-Path $results) {
+    $previous = Import-Csv $results | Where-Object { $_.Commit -ne $commit }
+}
+$regressions = 0
+foreach ($zone in $zones) {
+    $before = $previous | Where-Object { $_.Zone -eq $zone.Zone } | Select-Object -Last 1
+    $change = ""
+    $color = [System.ConsoleColor]::White
+    if ($before -and [long]$before.Cycles -gt 0) {
+        $percent = ($zone.Cycles - [long]$before.Cycles) * 100.0 / [long]$before.Cycles
+        $change = "{0:+0.0;-0.0}% since {1}" -f $percent, $before.Commit
+        if ($percent -gt $Threshold) {
+            $color = [System.ConsoleColor]::Red
+            $regressions++
+        }
+    }
+    Write-Host ("{0,-18} {1,8} calls {2,12} cycles {3,10} per call  {4}" -f
+                $zone.Zone, $zone.Calls, $zone.Cycles, $zone.Mean, $change) -ForegroundColor $color
+}
+
+$zones | Export-Csv $results -Append -NoTypeInformation
+if ($regressions -gt 0) {
+    Write-Host "$regressions zone(s) slower by more than $Threshold%." -ForegroundColor Red
+    exit 1
+}
@@ -0,0 +1,351 @@
+/**
+ * MathSolver for TI-84 CE - Host Benchmark
+ *
+ * Runs the math core natively over a corpus of expressions. Each one is
+ * timed, and its answer is checked against the golden outputs, so a
+ * change to the core can be measured without a calculator and shown
+ * not to change any answer.
+ *
+ * Each line of the corpus is a mode (normal, truncate or round), a
+ * precision, "dec" for decimal places or "sig" for significant digits,
+ * and the expression. Blank lines and lines starting with # are skipped.
+ * The variables x and y are 3 and -2. An expression is evaluated with its
+ * steps, like ENTER does; a line that starts with "compiled" compiles it
+ * instead and runs it in the bytecode VM, like tables and graphs do, and
+ * a line that starts with "solve" and an integer guess solves it as an
+ * equation from that guess.
+ *
+ * Usage: bench [-u] [-t ms] corpus.txt [golden.txt]
+ *   -u     Print the golden outputs of the corpus instead of checking them
+ *   -t ms  Time each expression for at least ms milliseconds (default 20)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "headers/mathsolver.h"
+#include "host.h"
+
+/** Longest line of the corpus or the golden outputs */
+#define MAX_LINE_LENGTH 256
+
+/** Default time each expression is run for (in ms) */
+#define DEFAULT_TIME_MS 20
+
+/**
+ * How an expression of the corpus is run.
+ */
+typedef enum {
+    CASE_STEPS,    /**< Evaluated with its steps */
+    CASE_COMPILED, /**< Run in the bytecode VM */
+    CASE_SOLVE     /**< Solved as an equation */
+} CaseKind;
+
+/**
+ * Expression of the corpus with its settings.
+ */
+typedef struct {
+    int line;                       /**< Line of the corpus */
+    CaseKind kind;                  /**< How the expression is run */
+    char prefix[24];                /**< The kind as written before the mode, or empty */
+    int guess;                      /**< Guess of a solve case */
+    char mode[16];                  /**< Name of the arithmetic mode */
+    ArithmeticType arithmetic_mode; /**< Arithmetic mode */
+    int precision;                  /**< Precision */
+    bool use_significant_digits;    /**< Whether the precision is in significant digits */
+    char expression[MAX_INPUT_LENGTH + 1]; /**< Expression */
+} BenchCase;
+
+/** Heap allocations made by the math core, counted by the wrappers below */
+static unsigned long heap_allocations = 0;
+
+/** Program of a compiled case */
+static CompiledExpression bench_program;
+
+/* ============================== Heap Counting ============================== */
+
+/*
+ * The makefile builds the math core with malloc, calloc and realloc
+ * renamed to these, so every allocation it makes is counted. The core
+ * allocates from its node pool only, so the count should stay at 0.
+ */
+
+void* host_malloc(size_t size) {
+    heap_allocations++;
+    return malloc(size);
+}
+
+void* host_calloc(size_t count, size_t size) {
+    heap_allocations++;
+    return calloc(count, size);
+}
+
+void* host_realloc(void* pointer, size_t size) {
+    heap_allocations++;
+    return realloc(pointer, size);
+}
+
+void host_free(void* pointer) {
+    free(pointer);
+}
+
+/* ============================== Corpus ============================== */
+
+/**
+ * Reads the next expression of the corpus.
+ *
+ * @param corpus The corpus file.
+ * @param line Line number of the last line read, updated.
+ * @param bench_case Pointer to the case to fill.
+ * @return True if an expression was read, false at the end of the corpus.
+ */
+static bool read_case(FILE* corpus, int* line, BenchCase* bench_case) {
+    char text[MAX_LINE_LENGTH];
+    while (fgets(text, sizeof(text), corpus) != NULL) {
+        (*line)++;
+        text[strcspn(text, "\r\n")] = '\0';
+        if (text[0] == '\0' || text[0] == '#') {
+            continue;
+        }
+
+        char type[8];
+        int start = 0;
+        bench_case->kind = CASE_STEPS;
+        if (strncmp(text, "compiled ", 9) == 0) {
+            bench_case->kind = CASE_COMPILED;
+            start = 9;
+        } else if (sscanf(text, "solve %d %n", &bench_case->guess, &start) == 1) {
+            bench_case->kind = CASE_SOLVE;
+        }
+        snprintf(bench_case->prefix, sizeof(bench_case->prefix), "%.*s", start, text);
+        char* settings = text + start;
+        if (sscanf(settings, "%15s %d %7s %n", bench_case->mode, &bench_case->precision, type, &start) != 3 ||
+            settings[start] == '\0' || strlen(settings + start) > MAX_INPUT_LENGTH) {
+            fprintf(stderr, "corpus line %d: expected mode, precision, dec or sig, expression\n", *line);
+            continue;
+        }
+
+        if (strcmp(bench_case->mode, "truncate") == 0) {
+            bench_case->arithmetic_mode = ARITHMETIC_TRUNCATE;
+        } else if (strcmp(bench_case->mode, "round") == 0) {
+            bench_case->arithmetic_mode = ARITHMETIC_ROUND;
+        } else {
+            bench_case->arithmetic_mode = ARITHMETIC_NORMAL;
+        }
+        bench_case->use_significant_digits = strcmp(type, "sig") == 0;
+        bench_case->line = *line;
+        strcpy(bench_case->expression, settings + start);
+        return true;
+    }
+    return false;
+}
+
+/* ============================== Running ============================== */
+
+/**
+ * Gets the current time.
+ *
+ * @return The time in nanoseconds.
+ */
+static double now_ns(void) {
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return (double)time.tv_sec * 1e9 + (double)time.tv_nsec;
+}
+
+/**
+ * Evaluates the expression of a case with the arithmetic settings of the
+ * case. A compiled case has no steps; the value it gives where it is not
+ * defined is told apart with a note. A solve case shows why it found no
+ * root, and leaves the variables as they were.
+ *
+ * @param bench_case The case.
+ * @param result Pointer to the result.
+ * @param note Pointer set to a note on the result, or NULL.
+ * @return True if the expression could be evaluated, false otherwise.
+ */
+static bool run_case(const BenchCase* bench_case, CalculationResult* result, const char** note) {
+    *note = NULL;
+    if (bench_case->kind == CASE_STEPS) {
+        return evaluate_expression_string(bench_case->expression, result);
+    }
+
+    if (bench_case->kind == CASE_SOLVE) {
+        static Variable saved_variables[MAX_VARIABLES];
+        memcpy(saved_variables, variables, sizeof(variables));
+        SolveStatus status = solve_equation(bench_case->expression, os_Int24ToReal(bench_case->guess), result);
+        memcpy(variables, saved_variables, sizeof(variables));
+        if (status == SOLVE_NO_ROOT) {
+            strcpy(result->formatted_result, "no root");
+        } else if (status == SOLVE_NO_VARIABLE) {
+            strcpy(result->formatted_result, "no variable");
+        }
+        return status != SOLVE_INVALID;
+    }
+
+    ArithmeticFormat format = get_arithmetic_format(bench_case->arithmetic_mode, bench_case->precision,
+                                                    bench_case->use_significant_digits);
+    memset(result, 0, sizeof(CalculationResult));
+    if (!compile_expression_string(bench_case->expression, &bench_program, &format)) {
+        return false;
+    }
+    result->value = run_program(&bench_program, &format);
+    format_real(result->value, result->formatted_result);
+    if (is_value_undefined()) {
+        *note = "undefined";
+    }
+    return true;
+}
+
+/**
+ * Writes a result as a line of the golden outputs: the case, the text
+ * shown, the digits of the value, the number of steps, a note on the
+ * result and the OS error the calculator would have stopped with, if any.
+ *
+ * @param bench_case The case.
+ * @param evaluated Whether the expression could be evaluated.
+ * @param result Pointer to the result.
+ * @param note The note, or NULL.
+ * @param error The OS error, or NULL.
+ * @param line Buffer for the line.
+ */
+static void golden_line(const BenchCase* bench_case, bool evaluated, const CalculationResult* result,
+                        const char* note, const char* error, char* line) {
+    int length = sprintf(line, "%s%s %d %s %s => ", bench_case->prefix, bench_case->mode,
+                         bench_case->precision, bench_case->use_significant_digits ? "sig" : "dec",
+                         bench_case->expression);
+    if (!evaluated) {
+        sprintf(line + length, "parse error");
+        return;
+    }
+
+    // The TI font has its own minus sign and exponent characters
+    for (const char* c = result->formatted_result; *c; c++) {
+        line[length++] = *c == '\x1A' ? '-' : *c == '\x1B' ? 'E' : *c;
+    }
+
+    const real_t* value = &result->value;
+    length += sprintf(line + length, " [%02X %02X ", (uint8_t)value->sign, (uint8_t)value->exp);
+    for (int i = 0; i < 7; i++) {
+        length += sprintf(line + length, "%02X", value->mant[i]);
+    }
+    length += sprintf(line + length, "] steps %d", result->step_count);
+    if (note != NULL) {
+        length += sprintf(line + length, " %s", note);
+    }
+    if (error != NULL) {
+        sprintf(line + length, " %s", error);
+    }
+}
+
+/**
+ * Evaluates the expression of a case over and over for at least some time.
+ *
+ * @param bench_case The case.
+ * @param min_ns Time to run for (in ns).
+ * @return The mean time of an evaluation (in ns).
+ */
+static double time_case(const BenchCase* bench_case, double min_ns) {
+    CalculationResult result;
+    const char* note;
+    long runs = 0;
+    double elapsed = 0;
+    long batch = 1;
+    do {
+        double start = now_ns();
+        for (long i = 0; i < batch; i++) {
+            run_case(bench_case, &result, &note);
+        }
+        elapsed += now_ns() - start;
+        runs += batch;
+        batch *= 2;
+    } while (elapsed < min_ns);
+    return elapsed / runs;
+}
+
+int main(int argc, char** argv) {
+    bool update = false;
+    double min_ns = DEFAULT_TIME_MS * 1e6;
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        if (strcmp(argv[arg], "-u") == 0) {
+            update = true;
+        } else if (strcmp(argv[arg], "-t") == 0 && arg + 1 < argc) {
+            min_ns = atof(argv[++arg]) * 1e6;
+        } else {
+            break;
+        }
+    }
+    if (arg >= argc || (!update && arg + 2 != argc)) {
+        fprintf(stderr, "usage: %s [-u] [-t ms] corpus.txt [golden.txt]\n", argv[0]);
+        return 2;
+    }
+
+    FILE* corpus = fopen(argv[arg], "r");
+    FILE* golden = update ? NULL : fopen(argv[arg + 1], "r");
+    if (corpus == NULL || (!update && golden == NULL)) {
+        fprintf(stderr, "%s: cannot open %s\n", argv[0], corpus == NULL ? argv[arg] : argv[arg + 1]);
+        return 2;
+    }
+
+    mathsolver_init();
+    set_variable("x", os_Int24ToReal(3));
+    set_variable("y", os_Int24ToReal(-2));
+
+    if (!update) {
+        printf("%12s %6s %6s %5s  %s\n", "ns/eval", "nodes", "steps", "heap", "expression");
+    }
+
+    BenchCase bench_case;
+    int line = 0;
+    int cases = 0;
+    int mismatches = 0;
+    double total_ns = 0;
+    while (read_case(corpus, &line, &bench_case)) {
+        set_arithmetic_mode(bench_case.arithmetic_mode, bench_case.precision, bench_case.use_significant_digits);
+
+        // One run gives the answer and the counts
+        CalculationResult result;
+        host_real_error = NULL;
+        heap_allocations = 0;
+        const char* note;
+        bool evaluated = run_case(&bench_case, &result, &note);
+        int nodes = node_pool_index;
+        unsigned long heap = heap_allocations;
+
+        char actual[MAX_LINE_LENGTH * 2];
+        golden_line(&bench_case, evaluated, &result, note, host_real_error, actual);
+        cases++;
+        if (update) {
+            printf("%s\n", actual);
+            continue;
+        }
+
+        double ns = time_case(&bench_case, min_ns);
+        total_ns += ns;
+        printf("%12.0f %6d %6d %5lu  %s%s %d %s %s\n", ns, nodes, result.step_count, heap,
+               bench_case.prefix, bench_case.mode,
+               bench_case.precision, bench_case.use_significant_digits ? "sig" : "dec", bench_case.expression);
+
+        char expected[MAX_LINE_LENGTH * 2];
+        if (fgets(expected, sizeof(expected), golden) == NULL) {
+            expected[0] = '\0';
+        }
+        expected[strcspn(expected, "\r\n")] = '\0';
+        if (strcmp(expected, actual) != 0) {
+            mismatches++;
+            printf("  MISMATCH at corpus line %d\n    expected: %s\n    actual:   %s\n",
+                   bench_case.line, expected, actual);
+        }
+    }
+
+    fclose(corpus);
+    if (update) {
+        return 0;
+    }
+    fclose(golden);
+
+    printf("%d expressions, %.0f ns for one evaluation of each, %d mismatches\n", cases, total_ns, mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,280 @@
+/**
+ * MathSolver Host Benchmark - AppVars
+ *
+ * The fileioc functions of the CE toolchain on AppVars held in memory.
+ * They behave like the library where the math core relies on it: an
+ * archived AppVar cannot be written, "w" empties an AppVar and "a"
+ * writes at its end, and a seek past the end fails with EOF.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <fileioc.h>
+
+/** Most AppVars that can exist at once */
+#define MAX_APPVARS    16
+
+/** Most AppVars that can be open at once, as on the calculator */
+#define MAX_HANDLES    5
+
+/** Longest name of an AppVar */
+#define MAX_NAME_LENGTH 8
+
+/**
+ * AppVar held in memory.
+ */
+typedef struct {
+    bool exists;                        /**< Whether the slot holds an AppVar */
+    char name[MAX_NAME_LENGTH + 1];     /**< Name of the AppVar */
+    uint8_t* data;                      /**< Contents */
+    size_t size;                        /**< Size of the contents */
+    bool archived;                      /**< Whether the AppVar is in the archive */
+} AppVar;
+
+/**
+ * Open AppVar.
+ */
+typedef struct {
+    bool open;          /**< Whether the handle is in use */
+    int appvar;         /**< Slot of the AppVar */
+    size_t offset;      /**< Current offset in the AppVar */
+} Handle;
+
+static AppVar appvars[MAX_APPVARS];
+
+/** Handles, 0 not being one */
+static Handle handles[MAX_HANDLES + 1];
+
+/**
+ * Finds an AppVar by its name.
+ *
+ * @param name The name.
+ * @return The slot of the AppVar, or -1 if there is none by that name.
+ */
+static int find_appvar(const char* name) {
+    for (int i = 0; i < MAX_APPVARS; i++) {
+        if (appvars[i].exists && strncmp(appvars[i].name, name, MAX_NAME_LENGTH) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Gets the AppVar of an open handle.
+ *
+ * @param handle The handle.
+ * @return Pointer to the AppVar, or NULL if the handle is not open.
+ */
+static AppVar* appvar_of(uint8_t handle) {
+    if (handle == 0 || handle > MAX_HANDLES || !handles[handle].open) {
+        return NULL;
+    }
+    return &appvars[handles[handle].appvar];
+}
+
+/**
+ * Changes the size of an AppVar, zeroing what it gains.
+ *
+ * @param appvar The AppVar.
+ * @param size The new size.
+ * @return True if the memory could be had, false otherwise.
+ */
+static bool set_size(AppVar* appvar, size_t size) {
+    uint8_t* data = realloc(appvar->data, size ? size : 1);
+    if (data == NULL) {
+        return false;
+    }
+    if (size > appvar->size) {
+        memset(data + appvar->size, 0, size - appvar->size);
+    }
+    appvar->data = data;
+    appvar->size = size;
+    return true;
+}
+
+/**
+ * Opens an AppVar.
+ *
+ * @param name Name of the AppVar.
+ * @param mode "r" or "r+" for one that exists, "w" or "w+" to empty or
+ *             create it, "a" or "a+" to write at its end.
+ * @return The handle, or 0 if the AppVar could not be opened.
+ */
+uint8_t ti_Open(const char* name, const char* mode) {
+    int slot = find_appvar(name);
+    if (slot < 0) {
+        if (mode[0] == 'r') {
+            return 0;
+        }
+        for (slot = 0; slot < MAX_APPVARS && appvars[slot].exists; slot++);
+        if (slot == MAX_APPVARS) {
+            return 0;
+        }
+        memset(&appvars[slot], 0, sizeof(AppVar));
+        appvars[slot].exists = true;
+        strncpy(appvars[slot].name, name, MAX_NAME_LENGTH);
+    } else if (mode[0] == 'w') {
+        appvars[slot].size = 0;
+    }
+
+    for (uint8_t handle = 1; handle <= MAX_HANDLES; handle++) {
+        if (!handles[handle].open) {
+            handles[handle].open = true;
+            handles[handle].appvar = slot;
+            handles[handle].offset = mode[0] == 'a' ? appvars[slot].size : 0;
+            return handle;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Closes an open AppVar.
+ */
+int ti_Close(uint8_t handle) {
+    if (appvar_of(handle) == NULL) {
+        return 0;
+    }
+    handles[handle].open = false;
+    return 1;
+}
+
+/**
+ * Reads items from the current offset of an AppVar.
+ *
+ * @return The number of whole items read.
+ */
+size_t ti_Read(void* data, size_t size, size_t count, uint8_t handle) {
+    AppVar* appvar = appvar_of(handle);
+    if (appvar == NULL || size == 0) {
+        return 0;
+    }
+    size_t available = (appvar->size - handles[handle].offset) / size;
+    if (count > available) {
+        count = available;
+    }
+    memcpy(data, appvar->data + handles[handle].offset, size * count);
+    handles[handle].offset += size * count;
+    return count;
+}
+
+/**
+ * Writes items at the current offset of an AppVar, growing it if needed.
+ *
+ * @return The number of items written, 0 for an archived AppVar.
+ */
+size_t ti_Write(const void* data, size_t size, size_t count, uint8_t handle) {
+    AppVar* appvar = appvar_of(handle);
+    if (appvar == NULL || appvar->archived) {
+        return 0;
+    }
+    size_t end = handles[handle].offset + size * count;
+    if (end > appvar->size && !set_size(appvar, end)) {
+        return 0;
+    }
+    memcpy(appvar->data + handles[handle].offset, data, size * count);
+    handles[handle].offset = end;
+    return count;
+}
+
+/**
+ * Moves the current offset of an AppVar.
+ *
+ * @return 0, or EOF if the offset would be outside the AppVar.
+ */
+int ti_Seek(int offset, unsigned int origin, uint8_t handle) {
+    AppVar* appvar = appvar_of(handle);
+    if (appvar == NULL) {
+        return EOF;
+    }
+    long base = origin == SEEK_CUR ? (long)handles[handle].offset :
+                origin == SEEK_END ? (long)appvar->size : 0;
+    long position = base + offset;
+    if (position < 0 || position > (long)appvar->size) {
+        return EOF;
+    }
+    handles[handle].offset = (size_t)position;
+    return 0;
+}
+
+/**
+ * Moves the current offset of an AppVar to its start.
+ */
+int ti_Rewind(uint8_t handle) {
+    return ti_Seek(0, SEEK_SET, handle);
+}
+
+/**
+ * Gets the current offset of an AppVar.
+ */
+uint16_t ti_Tell(uint8_t handle) {
+    return appvar_of(handle) ? (uint16_t)handles[handle].offset : 0;
+}
+
+/**
+ * Gets the size of an AppVar.
+ */
+uint16_t ti_GetSize(uint8_t handle) {
+    AppVar* appvar = appvar_of(handle);
+    return appvar ? (uint16_t)appvar->size : 0;
+}
+
+/**
+ * Changes the size of an AppVar in RAM.
+ *
+ * @return The new size, or -1 if it could not be changed.
+ */
+int ti_Resize(size_t size, uint8_t handle) {
+    AppVar* appvar = appvar_of(handle);
+    if (appvar == NULL || appvar->archived || !set_size(appvar, size)) {
+        return -1;
+    }
+    if (handles[handle].offset > size) {
+        handles[handle].offset = size;
+    }
+    return (int)size;
+}
+
+/**
+ * Deletes an AppVar.
+ *
+ * @return Nonzero if it was deleted, 0 if there is none by that name.
+ */
+int ti_Delete(const char* name) {
+    int slot = find_appvar(name);
+    if (slot < 0) {
+        return 0;
+    }
+    free(appvars[slot].data);
+    memset(&appvars[slot], 0, sizeof(AppVar));
+    return 1;
+}
+
+/**
+ * Gets a pointer to the contents of an AppVar at its current offset.
+ */
+void* ti_GetDataPtr(uint8_t handle) {
+    AppVar* appvar = appvar_of(handle);
+    return appvar ? appvar->data + handles[handle].offset : NULL;
+}
+
+/**
+ * Moves an AppVar to the archive or back to RAM.
+ */
+int ti_SetArchiveStatus(bool archived, uint8_t handle) {
+    AppVar* appvar = appvar_of(handle);
+    if (appvar == NULL) {
+        return 0;
+    }
+    appvar->archived = archived;
+    return 1;
+}
+
+/**
+ * Tells whether an AppVar is in the archive.
+ */
+int ti_IsArchived(uint8_t handle) {
+    AppVar* appvar = appvar_of(handle);
+    return appvar ? appvar->archived : 0;
+}
@@ -0,0 +1,18 @@
+/**
+ * MathSolver Host Benchmark - Host Definitions
+ *
+ * What the stand-ins for the calculator libraries share with the
+ * benchmark.
+ */
+
+#ifndef HOST_H
+#define HOST_H
+
+/**
+ * Error the OS would have stopped the program with, like "ERR:DOMAIN",
+ * since it was last set to NULL. The stand-ins return zero, or the
+ * largest number for an overflow, and go on.
+ */
+extern const char* host_real_error;
+
+#endif // HOST_H
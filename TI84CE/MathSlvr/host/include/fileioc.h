@@ -0,0 +1,30 @@
+/**
+ * MathSolver Host Benchmark - fileioc.h Stand-in
+ *
+ * The AppVar functions of the CE toolchain's fileioc library, on AppVars
+ * kept in memory by fileioc.c. Nothing is written to disk.
+ */
+
+#ifndef HOST_FILEIOC_H
+#define HOST_FILEIOC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+uint8_t ti_Open(const char *name, const char *mode);
+int ti_Close(uint8_t handle);
+size_t ti_Read(void *data, size_t size, size_t count, uint8_t handle);
+size_t ti_Write(const void *data, size_t size, size_t count, uint8_t handle);
+int ti_Seek(int offset, unsigned int origin, uint8_t handle);
+int ti_Rewind(uint8_t handle);
+uint16_t ti_Tell(uint8_t handle);
+uint16_t ti_GetSize(uint8_t handle);
+int ti_Resize(size_t size, uint8_t handle);
+int ti_Delete(const char *name);
+void *ti_GetDataPtr(uint8_t handle);
+int ti_SetArchiveStatus(bool archived, uint8_t handle);
+int ti_IsArchived(uint8_t handle);
+
+#endif // HOST_FILEIOC_H
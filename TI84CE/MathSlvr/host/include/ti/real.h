@@ -0,0 +1,55 @@
+/**
+ * MathSolver Host Benchmark - ti/real.h Stand-in
+ *
+ * The real_t type of the TI-84 CE OS and the os_Real* functions the math
+ * core calls, implemented on the host in real.c.
+ *
+ * A real_t is a sign byte (bit 7), an exponent biased by 0x80 and a
+ * 14-digit BCD mantissa, two digits a byte, the first digit before the
+ * decimal point.
+ */
+
+#ifndef HOST_TI_REAL_H
+#define HOST_TI_REAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** The CE has 24-bit integers; 32 bits hold every value they do */
+typedef int32_t int24_t;
+typedef uint32_t uint24_t;
+
+/**
+ * Floating point number of the TI-84 CE OS.
+ */
+typedef struct {
+    int8_t sign;       /**< Bit 7 set for a negative number */
+    int8_t exp;        /**< Decimal exponent plus 0x80 */
+    uint8_t mant[7];   /**< 14 BCD digits, most significant first */
+} real_t;
+
+real_t os_Int24ToReal(int24_t arg);
+int24_t os_RealToInt24(const real_t *arg);
+
+real_t os_RealAdd(const real_t *arg1, const real_t *arg2);
+real_t os_RealSub(const real_t *arg1, const real_t *arg2);
+real_t os_RealMul(const real_t *arg1, const real_t *arg2);
+real_t os_RealDiv(const real_t *arg1, const real_t *arg2);
+real_t os_RealNeg(const real_t *arg);
+int os_RealCompare(const real_t *arg1, const real_t *arg2);
+
+real_t os_RealInt(const real_t *arg);
+real_t os_RealRound(const real_t *arg, char digits);
+real_t os_RealRoundInt(const real_t *arg);
+
+real_t os_RealPow(const real_t *base, const real_t *exp);
+real_t os_RealSqrt(const real_t *arg);
+real_t os_RealLog(const real_t *arg);
+real_t os_RealExp(const real_t *arg);
+real_t os_RealSinRad(const real_t *arg);
+real_t os_RealCosRad(const real_t *arg);
+real_t os_RealTanRad(const real_t *arg);
+
+int os_RealToStr(char *result, const real_t *arg, int8_t maxLength, uint8_t mode, int8_t digits);
+
+#endif // HOST_TI_REAL_H
@@ -0,0 +1,19 @@
+/**
+ * MathSolver Host Benchmark - tice.h Stand-in
+ *
+ * Just enough of the CE toolchain's tice.h to build the math core with
+ * a host compiler.
+ */
+
+#ifndef HOST_TICE_H
+#define HOST_TICE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ti/real.h>
+
+/* The home screen of the host is always in Normal mode */
+#define OS_FORMAT_FLAGS 0
+
+#endif // HOST_TICE_H
@@ -0,0 +1,610 @@
+/**
+ * MathSolver Host Benchmark - TI Real Numbers
+ *
+ * The os_Real* functions of the TI-84 CE OS, for the host. Numbers keep
+ * the layout of the OS, 14 BCD digits and an exponent from -99 to 99,
+ * and every result is rounded to 14 digits, so sums, products, rounding
+ * and formatting give the answers of the calculator. The other functions
+ * are computed in long double and rounded to 14 digits; they can differ
+ * from the OS in the last digit.
+ *
+ * Where the OS stops the program with an error, these functions record
+ * the error in host_real_error and go on.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ti/real.h>
+#include "host.h"
+
+/** Digits in the mantissa of a real_t */
+#define REAL_DIGITS     14
+
+/** Significant digits the OS shows */
+#define DISPLAY_DIGITS  10
+
+/** Largest exponent of a real_t, the smallest being its negative */
+#define MAX_EXPONENT    99
+
+/** Characters of the TI font for the negative sign and the exponent */
+#define CHAR_NEGATIVE   '\x1A'
+#define CHAR_EXPONENT   '\x1B'
+
+/** Holds the digits of a product or quotient of two mantissas exactly */
+__extension__ typedef unsigned __int128 wide_t;
+__extension__ typedef __int128 signed_wide_t;
+
+/**
+ * A real_t taken apart. Its value is mantissa * 10^(exponent - 13),
+ * the mantissa having 14 digits, or being 0 for zero.
+ */
+typedef struct {
+    bool negative;
+    uint64_t mantissa;
+    int exponent;
+} Unpacked;
+
+const char* host_real_error = NULL;
+
+/* ============================== Packing ============================== */
+
+/**
+ * Gets a power of ten.
+ *
+ * @param n The power, from 0 to 38.
+ * @return 10^n.
+ */
+static wide_t power_of_ten(int n) {
+    wide_t result = 1;
+    while (n-- > 0) {
+        result *= 10;
+    }
+    return result;
+}
+
+/**
+ * Gets the digits of a real_t.
+ *
+ * @param real The number.
+ * @return The number taken apart.
+ */
+static Unpacked unpack(const real_t* real) {
+    Unpacked number = { (real->sign & 0x80) != 0, 0, (uint8_t)real->exp - 0x80 };
+    for (int i = 0; i < 7; i++) {
+        number.mantissa = number.mantissa * 100 + (real->mant[i] >> 4) * 10 + (real->mant[i] & 0x0F);
+    }
+    if (number.mantissa == 0) {
+        number.negative = false;
+        number.exponent = 0;
+    }
+    return number;
+}
+
+/**
+ * Gets the real_t zero.
+ *
+ * @return Zero.
+ */
+static real_t real_zero(void) {
+    real_t zero;
+    memset(&zero, 0, sizeof(zero));
+    zero.exp = (int8_t)0x80;
+    return zero;
+}
+
+/**
+ * Records an error of the OS, keeping the first one.
+ *
+ * @param error The error, as the OS shows it.
+ * @param value The value to go on with.
+ * @return The value.
+ */
+static real_t real_error(const char* error, real_t value) {
+    if (host_real_error == NULL) {
+        host_real_error = error;
+    }
+    return value;
+}
+
+/**
+ * Builds a real_t from digits, rounding them half up to 14 digits.
+ *
+ * @param negative Whether the number is negative.
+ * @param digits The digits, as an integer.
+ * @param scale Power of ten the digits are multiplied by.
+ * @return The number; ERR:OVERFLOW past the largest exponent, zero under the smallest.
+ */
+static real_t pack(bool negative, wide_t digits, int scale) {
+    if (digits == 0) {
+        return real_zero();
+    }
+
+    int count = 0;
+    for (wide_t rest = digits; rest != 0; rest /= 10) {
+        count++;
+    }
+    if (count > REAL_DIGITS) {
+        wide_t divisor = power_of_ten(count - REAL_DIGITS);
+        wide_t remainder = digits % divisor;
+        digits /= divisor;
+        scale += count - REAL_DIGITS;
+        if (remainder * 2 >= divisor) {
+            digits++;
+            if (digits == power_of_ten(REAL_DIGITS)) {
+                digits /= 10;
+                scale++;
+            }
+        }
+    } else {
+        digits *= power_of_ten(REAL_DIGITS - count);
+        scale -= REAL_DIGITS - count;
+    }
+
+    int exponent = scale + REAL_DIGITS - 1;
+    if (exponent < -MAX_EXPONENT) {
+        return real_zero();
+    }
+    if (exponent > MAX_EXPONENT) {
+        exponent = MAX_EXPONENT;
+        digits = power_of_ten(REAL_DIGITS) - 1;
+        real_error("ERR:OVERFLOW", real_zero());
+    }
+
+    real_t real;
+    real.sign = negative ? (int8_t)0x80 : 0;
+    real.exp = (int8_t)(0x80 + exponent);
+    uint64_t rest = (uint64_t)digits;
+    for (int i = 6; i >= 0; i--) {
+        uint8_t low = rest % 10;
+        rest /= 10;
+        real.mant[i] = (uint8_t)((rest % 10) << 4 | low);
+        rest /= 10;
+    }
+    return real;
+}
+
+/**
+ * Builds a real_t from a number taken apart.
+ *
+ * @param number The number.
+ * @return The real_t.
+ */
+static real_t repack(Unpacked number) {
+    return pack(number.negative, number.mantissa, number.exponent - (REAL_DIGITS - 1));
+}
+
+/**
+ * Converts a real_t to a long double.
+ *
+ * @param real The number.
+ * @return The nearest long double.
+ */
+static long double to_long_double(const real_t* real) {
+    Unpacked number = unpack(real);
+    long double value = (long double)number.mantissa * powl(10.0L, number.exponent - (REAL_DIGITS - 1));
+    return number.negative ? -value : value;
+}
+
+/**
+ * Converts a long double to a real_t, as a function of the OS would
+ * return it.
+ *
+ * @param value The value.
+ * @return The nearest real_t; ERR:DOMAIN if the value is not a number.
+ */
+static real_t from_long_double(long double value) {
+    if (isnan(value)) {
+        return real_error("ERR:DOMAIN", real_zero());
+    }
+    if (isinf(value)) {
+        return pack(value < 0, 1, MAX_EXPONENT + 1);
+    }
+    if (value == 0) {
+        return real_zero();
+    }
+
+    // More digits than a real_t holds, so pack does the rounding
+    char text[48];
+    snprintf(text, sizeof(text), "%.19Le", fabsl(value));
+    wide_t digits = 0;
+    const char* c = text;
+    for (; *c != 'e'; c++) {
+        if (*c != '.') {
+            digits = digits * 10 + (*c - '0');
+        }
+    }
+    return pack(value < 0, digits, atoi(c + 1) - 19);
+}
+
+/* ============================== Conversions ============================== */
+
+/**
+ * Converts an integer to a real_t.
+ */
+real_t os_Int24ToReal(int24_t arg) {
+    int64_t value = arg;
+    return pack(value < 0, (wide_t)(value < 0 ? -value : value), 0);
+}
+
+/**
+ * Converts a real_t to an integer, dropping its fractional part.
+ */
+int24_t os_RealToInt24(const real_t* arg) {
+    Unpacked number = unpack(arg);
+    if (number.exponent < 0) {
+        return 0;
+    }
+    if (number.exponent > 7) {
+        real_error("ERR:OVERFLOW", real_zero());
+        return number.negative ? -8388608 : 8388607;
+    }
+    int24_t value = (int24_t)(number.mantissa / (uint64_t)power_of_ten(REAL_DIGITS - 1 - number.exponent));
+    return number.negative ? -value : value;
+}
+
+/* ============================== Arithmetic ============================== */
+
+/**
+ * Adds two real_t numbers.
+ */
+real_t os_RealAdd(const real_t* arg1, const real_t* arg2) {
+    Unpacked a = unpack(arg1);
+    Unpacked b = unpack(arg2);
+    if (a.mantissa == 0) return *arg2;
+    if (b.mantissa == 0) return *arg1;
+    if (a.exponent < b.exponent) {
+        Unpacked swap = a;
+        a = b;
+        b = swap;
+    }
+
+    // Past the guard digits the smaller number cannot change the sum
+    int shift = a.exponent - b.exponent;
+    if (shift > REAL_DIGITS + 2) {
+        return repack(a);
+    }
+
+    signed_wide_t sum = (signed_wide_t)((wide_t)a.mantissa * power_of_ten(shift)) * (a.negative ? -1 : 1) +
+                        (signed_wide_t)b.mantissa * (b.negative ? -1 : 1);
+    return pack(sum < 0, (wide_t)(sum < 0 ? -sum : sum), b.exponent - (REAL_DIGITS - 1));
+}
+
+/**
+ * Subtracts a real_t from another.
+ */
+real_t os_RealSub(const real_t* arg1, const real_t* arg2) {
+    real_t negated = os_RealNeg(arg2);
+    return os_RealAdd(arg1, &negated);
+}
+
+/**
+ * Multiplies two real_t numbers.
+ */
+real_t os_RealMul(const real_t* arg1, const real_t* arg2) {
+    Unpacked a = unpack(arg1);
+    Unpacked b = unpack(arg2);
+    return pack(a.negative != b.negative, (wide_t)a.mantissa * b.mantissa,
+                a.exponent + b.exponent - 2 * (REAL_DIGITS - 1));
+}
+
+/**
+ * Divides a real_t by another; ERR:DIVIDE BY 0 for a zero divisor.
+ */
+real_t os_RealDiv(const real_t* arg1, const real_t* arg2) {
+    Unpacked a = unpack(arg1);
+    Unpacked b = unpack(arg2);
+    if (b.mantissa == 0) {
+        return real_error("ERR:DIVIDE BY 0", real_zero());
+    }
+
+    // Twenty more digits than needed, and one for anything left over
+    wide_t dividend = (wide_t)a.mantissa * power_of_ten(20);
+    wide_t quotient = dividend / b.mantissa;
+    quotient = quotient * 10 + (dividend % b.mantissa != 0);
+    return pack(a.negative != b.negative, quotient, a.exponent - b.exponent - 21);
+}
+
+/**
+ * Negates a real_t; zero stays positive.
+ */
+real_t os_RealNeg(const real_t* arg) {
+    real_t result = *arg;
+    if (unpack(arg).mantissa != 0) {
+        result.sign ^= (int8_t)0x80;
+    }
+    return result;
+}
+
+/**
+ * Compares two real_t numbers.
+ *
+ * @return A negative number, zero or a positive number as the first is smaller, equal or larger.
+ */
+int os_RealCompare(const real_t* arg1, const real_t* arg2) {
+    Unpacked a = unpack(arg1);
+    Unpacked b = unpack(arg2);
+    if (a.negative != b.negative) {
+        return a.negative ? -1 : 1;
+    }
+
+    int order;
+    if (a.mantissa == 0 || b.mantissa == 0) {
+        order = (a.mantissa != 0) - (b.mantissa != 0);
+    } else if (a.exponent != b.exponent) {
+        order = a.exponent < b.exponent ? -1 : 1;
+    } else {
+        order = (a.mantissa > b.mantissa) - (a.mantissa < b.mantissa);
+    }
+    return a.negative ? -order : order;
+}
+
+/* ============================== Rounding ============================== */
+
+/**
+ * Gets the integer part of a real_t, rounding toward zero.
+ */
+real_t os_RealInt(const real_t* arg) {
+    Unpacked number = unpack(arg);
+    if (number.exponent >= REAL_DIGITS - 1) {
+        return *arg;
+    }
+    if (number.exponent < 0) {
+        return real_zero();
+    }
+    uint64_t unit = (uint64_t)power_of_ten(REAL_DIGITS - 1 - number.exponent);
+    number.mantissa -= number.mantissa % unit;
+    return repack(number);
+}
+
+/**
+ * Rounds a real_t to a number of decimal places, halves away from zero.
+ */
+real_t os_RealRound(const real_t* arg, char digits) {
+    Unpacked number = unpack(arg);
+    int kept = number.exponent + 1 + digits;
+    if (number.mantissa == 0 || kept >= REAL_DIGITS) {
+        return *arg;
+    }
+    if (kept < 0) {
+        return real_zero();
+    }
+
+    wide_t unit = power_of_ten(REAL_DIGITS - kept);
+    wide_t rounded = number.mantissa / unit;
+    if ((number.mantissa % unit) * 2 >= unit) {
+        rounded++;
+    }
+    return pack(number.negative, rounded * unit, number.exponent - (REAL_DIGITS - 1));
+}
+
+/**
+ * Rounds a real_t to an integer, halves away from zero.
+ */
+real_t os_RealRoundInt(const real_t* arg) {
+    return os_RealRound(arg, 0);
+}
+
+/* ============================== Functions ============================== */
+
+/**
+ * Raises a real_t to a power; ERR:DOMAIN when the result is not a real
+ * number, and for 0^0 and 0 to a negative power.
+ */
+real_t os_RealPow(const real_t* base, const real_t* exp) {
+    if (to_long_double(base) == 0 && to_long_double(exp) <= 0) {
+        return real_error("ERR:DOMAIN", real_zero());
+    }
+    return from_long_double(powl(to_long_double(base), to_long_double(exp)));
+}
+
+/**
+ * Gets the square root of a real_t; ERR:DOMAIN for a negative number.
+ */
+real_t os_RealSqrt(const real_t* arg) {
+    return from_long_double(sqrtl(to_long_double(arg)));
+}
+
+/**
+ * Gets the natural logarithm of a real_t; ERR:DOMAIN for a number not above zero.
+ */
+real_t os_RealLog(const real_t* arg) {
+    long double value = to_long_double(arg);
+    if (value <= 0) {
+        return real_error("ERR:DOMAIN", real_zero());
+    }
+    return from_long_double(logl(value));
+}
+
+/**
+ * Gets e raised to a real_t.
+ */
+real_t os_RealExp(const real_t* arg) {
+    return from_long_double(expl(to_long_double(arg)));
+}
+
+/**
+ * Gets the sine of an angle in radians.
+ */
+real_t os_RealSinRad(const real_t* arg) {
+    return from_long_double(sinl(to_long_double(arg)));
+}
+
+/**
+ * Gets the cosine of an angle in radians.
+ */
+real_t os_RealCosRad(const real_t* arg) {
+    return from_long_double(cosl(to_long_double(arg)));
+}
+
+/**
+ * Gets the tangent of an angle in radians.
+ */
+real_t os_RealTanRad(const real_t* arg) {
+    return from_long_double(tanl(to_long_double(arg)));
+}
+
+/* ============================== Formatting ============================== */
+
+/**
+ * Rounds a mantissa to its first digits, halves up.
+ *
+ * @param mantissa The 14-digit mantissa.
+ * @param count Digits to keep, from 1 to 14.
+ * @param exponent Exponent of the number, raised when the rounding carries.
+ * @param text Buffer the kept digits are written to, without a terminator.
+ */
+static void round_digits(uint64_t mantissa, int count, int* exponent, char* text) {
+    uint64_t unit = (uint64_t)power_of_ten(REAL_DIGITS - count);
+    uint64_t kept = mantissa / unit + ((mantissa % unit) * 2 >= unit);
+    if (kept == (uint64_t)power_of_ten(count)) {
+        kept /= 10;
+        (*exponent)++;
+    }
+    for (int i = count - 1; i >= 0; i--) {
+        text[i] = (char)('0' + kept % 10);
+        kept /= 10;
+    }
+}
+
+/**
+ * Writes a number in scientific notation, like 1.25E-7.
+ *
+ * @param out Where to write.
+ * @param digits The digits, the first one before the decimal point.
+ * @param count Number of digits.
+ * @param exponent The exponent.
+ * @return The end of what was written.
+ */
+static char* write_scientific(char* out, const char* digits, int count, int exponent) {
+    *out++ = digits[0];
+    if (count > 1) {
+        *out++ = '.';
+        memcpy(out, digits + 1, count - 1);
+        out += count - 1;
+    }
+    *out++ = CHAR_EXPONENT;
+    if (exponent < 0) {
+        *out++ = CHAR_NEGATIVE;
+        exponent = -exponent;
+    }
+    return out + sprintf(out, "%d", exponent);
+}
+
+/**
+ * Writes a number in normal notation, like 12.5 or .0031.
+ *
+ * @param out Where to write.
+ * @param digits The digits, the first one at the place of the exponent.
+ * @param count Number of digits.
+ * @param exponent The exponent.
+ * @param decimals Decimal places to show, or -1 for those the digits have.
+ * @return The end of what was written.
+ */
+static char* write_normal(char* out, const char* digits, int count, int exponent, int decimals) {
+    for (int i = 0; i <= exponent; i++) {
+        *out++ = i < count ? digits[i] : '0';
+    }
+    int fraction = count - (exponent + 1);
+    if (fraction > 0 || decimals > 0) {
+        *out++ = '.';
+        for (int i = 0; i < -exponent - 1; i++) {
+            *out++ = '0';
+        }
+        for (int i = exponent >= 0 ? exponent + 1 : 0; i < count; i++) {
+            *out++ = digits[i];
+        }
+    }
+    return out;
+}
+
+/**
+ * Writes a real_t as the home screen shows it in Normal mode: ten
+ * significant digits at most, in scientific notation from 1E10 and
+ * under .001, without a leading zero.
+ *
+ * @param result Buffer to write to.
+ * @param arg The number.
+ * @param maxLength Size of the buffer, or 0 for no limit.
+ * @param mode Display mode; only Normal is emulated.
+ * @param digits Decimal places, as in Fix mode, or -1 for Float mode.
+ * @return The length of the text.
+ */
+int os_RealToStr(char* result, const real_t* arg, int8_t maxLength, uint8_t mode, int8_t digits) {
+    (void)mode;
+    char text[40];
+    char* out = text;
+    Unpacked number = unpack(arg);
+
+    if (number.mantissa == 0) {
+        *out++ = '0';
+        if (digits > 0) {
+            *out++ = '.';
+            memset(out, '0', digits);
+            out += digits;
+        }
+    } else {
+        if (number.negative) {
+            *out++ = CHAR_NEGATIVE;
+        }
+
+        // The notation follows the value as it is shown
+        char shown[REAL_DIGITS];
+        int exponent = number.exponent;
+        round_digits(number.mantissa, DISPLAY_DIGITS, &exponent, shown);
+        bool scientific = exponent >= DISPLAY_DIGITS || exponent < -3;
+
+        if (digits < 0) {
+            int count = DISPLAY_DIGITS;
+            while (count > 1 && shown[count - 1] == '0') {
+                count--;
+            }
+            out = scientific ? write_scientific(out, shown, count, exponent)
+                             : write_normal(out, shown, count, exponent, -1);
+        } else if (scientific) {
+            int count = digits + 1 < DISPLAY_DIGITS ? digits + 1 : DISPLAY_DIGITS;
+            exponent = number.exponent;
+            round_digits(number.mantissa, count, &exponent, shown);
+            out = write_scientific(out, shown, count, exponent);
+        } else {
+            exponent = number.exponent;
+            int count = exponent + 1 + digits;
+            if (count > DISPLAY_DIGITS) {
+                count = DISPLAY_DIGITS;
+            }
+            if (count > 0) {
+                round_digits(number.mantissa, count, &exponent, shown);
+                if (exponent != number.exponent) {
+                    // The carry added an integer digit, the decimals stay
+                    shown[count++] = '0';
+                }
+            } else if (count == 0 && number.mantissa >= 5 * (uint64_t)power_of_ten(REAL_DIGITS - 1)) {
+                // Rounds up to the first decimal place shown
+                exponent++;
+                shown[0] = '1';
+                count = 1;
+            } else {
+                // Rounds to zero, which is shown without its sign
+                out = text;
+                *out++ = '0';
+                if (digits > 0) {
+                    *out++ = '.';
+                    memset(out, '0', digits);
+                    out += digits;
+                }
+                count = -1;
+            }
+            if (count > 0) {
+                out = write_normal(out, shown, count, exponent, digits);
+            }
+        }
+    }
+
+    *out = '\0';
+    if (maxLength > 0 && out - text >= maxLength) {
+        text[maxLength - 1] = '\0';
+    }
+    strcpy(result, text);
+    return (int)strlen(result);
+}
@@ -5,6 +5,7 @@
 #include <ti/real.h>
 #include "headers/log.h"
 #include "headers/mathsolver.h"
+#include "headers/profile.h"
 #include "headers/arithmetic_private.h"
 
 /**
@@ -56,31 +57,56 @@ bool get_use_significant_digits(void) {
     return current_use_significant_digits;
 }
 
+/** A power of ten as a real_t: mantissa 1.0, exponent biased by 0x80 */
+#define POW10(n) { 0, (int8_t)(uint8_t)(0x80 + (n)), { 0x10, 0, 0, 0, 0, 0, 0 } }
+
+/** Ten consecutive powers of ten starting at 10^n */
+#define POW10_ROW(n) \
+    POW10(n),     POW10(n + 1), POW10(n + 2), POW10(n + 3), POW10(n + 4), \
+    POW10(n + 5), POW10(n + 6), POW10(n + 7), POW10(n + 8), POW10(n + 9)
+
+/**
+ * Powers of ten over the whole exponent range of a real_t.
+ * Built by the compiler, so nothing is computed at run time.
+ */
+const real_t POWERS_OF_TEN[POW10_MAX_EXPONENT - POW10_MIN_EXPONENT + 1] = {
+    POW10_ROW(-99),
+    POW10_ROW(-89),
+    POW10_ROW(-79),
+    POW10_ROW(-69),
+    POW10_ROW(-59),
+    POW10_ROW(-49),
+    POW10_ROW(-39),
+    POW10_ROW(-29),
+    POW10_ROW(-19),
+    POW10_ROW(-9),
+    POW10_ROW(1),
+    POW10_ROW(11),
+    POW10_ROW(21),
+    POW10_ROW(31),
+    POW10_ROW(41),
+    POW10_ROW(51),
+    POW10_ROW(61),
+    POW10_ROW(71),
+    POW10_ROW(81),
+    POW10(91), POW10(92), POW10(93), POW10(94), POW10(95), POW10(96), POW10(97), POW10(98), POW10(99)
+};
+
 /**
- * Creates a real_t representing the power of 10
+ * Gets a real_t representing a power of 10.
+ * Powers outside the range of a real_t are clamped to it.
  * 
- * @param power The power of 10 to create
+ * @param power The power of 10 to get
  * @return A real_t representing 10^power
  */
 static real_t power_of_10(int power) {
-    real_t ten = os_Int24ToReal(10);
-    real_t result = os_Int24ToReal(1);
-    
-    // Handle negative power
-    bool is_negative = power < 0;
-    power = abs(power);
-    
-    // Calculate 10^|power|
-    for (int i = 0; i < power; i++) {
-        result = os_RealMul(&result, &ten);
-    }
-    
-    // Invert if negative power
-    if (is_negative) {
-        result = os_RealInv(&result);
+    if (power < POW10_MIN_EXPONENT) {
+        power = POW10_MIN_EXPONENT;
+    } else if (power > POW10_MAX_EXPONENT) {
+        power = POW10_MAX_EXPONENT;
     }
     
-    return result;
+    return POWERS_OF_TEN[power - POW10_MIN_EXPONENT];
 }
 
 /**
@@ -108,100 +134,134 @@ static real_t truncate_to_decimal_places(real_t value, int decimal_places) {
     return os_RealDiv(&int_part, &multiplier);
 }
 
+/*
+ * A real_t holds 14 BCD digits, two per mantissa byte with the first digit
+ * in the high nibble of mant[0], and a decimal exponent biased by 0x80.
+ * The order of magnitude of a nonzero value is its exponent, so the digit
+ * kernels below work on the mantissa directly, without logs or powers of ten.
+ */
+
+/** Number of BCD digits in a real_t mantissa */
+#define REAL_DIGITS 14
+
+/** Exponent bias of a real_t */
+#define REAL_EXP_BIAS 0x80
+
+/** Largest exponent a real_t can hold (10^99) */
+#define REAL_EXP_MAX (REAL_EXP_BIAS + 99)
+
+/**
+ * Gets a digit of the mantissa of a real_t.
+ * 
+ * @param value Pointer to the value.
+ * @param index Index of the digit, 0 being the most significant.
+ * @return The digit.
+ */
+static uint8_t get_bcd_digit(const real_t* value, int index) {
+    uint8_t pair = value->mant[index >> 1];
+    return (index & 1) ? (pair & 0x0F) : (pair >> 4);
+}
+
 /**
- * Determines the order of magnitude of a real_t value
+ * Clears every mantissa digit from a given index on.
  * 
- * @param value The value to analyze
- * @return The order of magnitude as an integer
+ * @param value Pointer to the value to change.
+ * @param index Index of the first digit to clear.
  */
-static int get_order_of_magnitude(real_t value) {
-    // Handle zero value
-    real_t zero = os_Int24ToReal(0);
-    if (os_RealCompare(&value, &zero) == 0) {
-        return 0;
+static void clear_bcd_digits(real_t* value, int index) {
+    int byte = index >> 1;
+    if (index & 1) {
+        value->mant[byte] &= 0xF0;
+        byte++;
     }
-    
-    // Get absolute value
-    real_t abs_value = value;
-    if (value.sign != 0) {
-        abs_value = os_RealNeg(&value);
+    for (; byte < 7; byte++) {
+        value->mant[byte] = 0;
     }
-    
-    // Calculate log10 of the value
-    real_t ten = os_Int24ToReal(10);
-    real_t log_value = os_RealLog(&abs_value);
-    real_t log_ten = os_RealLog(&ten);
-    real_t log10_value = os_RealDiv(&log_value, &log_ten);
-    
-    // Convert to integer and return
-    int order = os_RealToInt24(&log10_value);
-    
-    return order;
 }
 
 /**
- * Truncates a value to a specific number of significant digits.
+ * Truncates the mantissa of a value to its first digits, toward zero.
  * 
  * @param value The value to truncate.
- * @param sig_digits The number of significant digits to keep.
+ * @param digits The number of digits to keep (1 to REAL_DIGITS).
  * @return The truncated value.
  */
-static real_t truncate_to_significant_digits(real_t value, int sig_digits) {
-    log_message("Truncating to %d significant digits", sig_digits);
-    
-    if (sig_digits <= 0) {
-        sig_digits = 1;
+static real_t truncate_bcd_digits(real_t value, int digits) {
+    if (digits < REAL_DIGITS) {
+        clear_bcd_digits(&value, digits);
     }
+    return value;
+}
 
-    // Check if value is zero
-    if (os_RealCompare(&value, &ZERO) == 0) {
-        return ZERO;
+/**
+ * Rounds the mantissa of a value to its first digits, half away from zero.
+ * 
+ * @param value The value to round.
+ * @param digits The number of digits to keep (1 to REAL_DIGITS).
+ * @return The rounded value.
+ */
+static real_t round_bcd_digits(real_t value, int digits) {
+    if (digits >= REAL_DIGITS) {
+        return value;
     }
-    
-    // Get order of magnitude
-    real_t absValue = os_RealAbs(&value);
-    log_message("Absolute value: %f", os_RealToFloat(&absValue));
-    real_t order = os_RealLog10(&absValue);
-    log_message("Log10: %f", os_RealToFloat(&order));
-
-    real_t floor_order = os_RealFloor(&order);
-    log_message("Floor order: %f", os_RealToFloat(&floor_order));
-
-    int order_int = os_RealToInt24(&floor_order);
-    log_message("Order of magnitude: %d", order_int);
 
-    real_t magnitute = power_of_10(order_int);
-    log_message("Magnitude: %f", os_RealToFloat(&magnitute));
+    bool round_up = get_bcd_digit(&value, digits) >= 5;
+    clear_bcd_digits(&value, digits);
+    if (!round_up) {
+        return value;
+    }
 
-    // Normalize value
-    real_t scaled_value = os_RealDiv(&value, &magnitute);
-    log_message("Scaled value: %f", os_RealToFloat(&scaled_value));
-    
-    // Scale value to the correct number of significant digits
-    real_t multiplier = power_of_10(sig_digits - 1);
-    log_message("Multiplier: %f", os_RealToFloat(&multiplier));
+    real_t truncated = value;
+    if (!increment_bcd_digits(&value, digits)) {
+        // 10^100 does not fit, keep the truncated value instead of overflowing
+        return truncated;
+    }
+    return value;
+}
 
-    real_t truncated_value = os_RealMul(&scaled_value, &multiplier);
-    log_message("Scale up: %f", os_RealToFloat(&truncated_value));
+/**
+ * Adds one to the last of the first digits of a mantissa, carrying
+ * through nines. When every digit is a nine, the value becomes 1 followed
+ * by zeros and its exponent goes up by one.
+ * 
+ * @param value Pointer to the value to change.
+ * @param digits The number of digits the increment applies to.
+ * @return False if the value would go past 10^99, in which case it is left undefined.
+ */
+static bool increment_bcd_digits(real_t* value, int digits) {
+    for (int index = digits - 1; index >= 0; index--) {
+        uint8_t* pair = &value->mant[index >> 1];
+        uint8_t shift = (index & 1) ? 0 : 4;
+        uint8_t digit = (*pair >> shift) & 0x0F;
 
-    if (scaled_value.sign < 0) 
-    {
-        truncated_value = os_RealCeil(&truncated_value);
-        log_message("Ceil: %f", os_RealToFloat(&truncated_value));
-    }
-    else
-    {
-        truncated_value = os_RealFloor(&truncated_value);
-        log_message("Floor: %f", os_RealToFloat(&truncated_value));
+        *pair &= (uint8_t)~(0x0F << shift);
+        if (digit < 9) {
+            *pair |= (uint8_t)((digit + 1) << shift);
+            return true;
+        }
     }
 
-    truncated_value = os_RealDiv(&truncated_value, &multiplier);
-    log_message("Scaled down: %f", os_RealToFloat(&truncated_value));
+    if ((uint8_t)value->exp >= REAL_EXP_MAX) {
+        return false;
+    }
+    value->mant[0] = 0x10;
+    value->exp = (int8_t)((uint8_t)value->exp + 1);
+    return true;
+}
 
-    truncated_value = os_RealMul(&truncated_value, &magnitute);
-    log_message("Final value: %f", os_RealToFloat(&truncated_value));
+/**
+ * Truncates a value to a specific number of significant digits.
+ * 
+ * @param value The value to truncate.
+ * @param sig_digits The number of significant digits to keep.
+ * @return The truncated value.
+ */
+static real_t truncate_to_significant_digits(real_t value, int sig_digits) {
+    if (sig_digits <= 0) {
+        sig_digits = 1;
+    }
 
-    return truncated_value;
+    return truncate_bcd_digits(value, sig_digits);
 }
 
 /**
@@ -216,112 +276,582 @@ static real_t round_to_significant_digits(real_t value, int sig_digits) {
         sig_digits = 1;
     }
     
-    // Check if value is zero
-    real_t zero = os_Int24ToReal(0);
-    if (os_RealCompare(&value, &zero) == 0) {
-        return zero;
+    // Zero has no leading digit to round from
+    if (value.mant[0] == 0) {
+        return value;
     }
     
-    // Get order of magnitude
-    int order = get_order_of_magnitude(value);
-    
-    // Calculate decimal places needed for this many significant digits
-    int decimal_places = sig_digits - order - 1;
-    
-    // Round to the calculated number of decimal places
+    return round_bcd_digits(value, sig_digits);
+}
+
+/**
+ * Rounds a value to a specific number of decimal places.
+ * 
+ * @param value The value to round.
+ * @param decimal_places The number of decimal places to keep.
+ * @return The rounded value.
+ */
+static real_t round_to_decimal_places(real_t value, int decimal_places) {
     return os_RealRound(&value, decimal_places);
 }
 
+/** The largest value a real_t can hold */
+static const real_t REAL_LARGEST = REAL_LITERAL(0x00, REAL_EXP_MAX, 0x99, 0x99, 0x99, 0x99, 0x99, 0x99, 0x99);
+
+/** Cap on the exponent of a literal while it is read, far outside the real_t range */
+#define LITERAL_EXP_LIMIT 1000
+
+/**
+ * Converts a decimal literal to a real_t, digit by digit.
+ * Reads digits with an optional decimal point, then an optional exponent
+ * (e or E, an optional sign and digits), and stops at the first character
+ * that does not fit. The literal does not need to be null terminated and
+ * may have any number of digits: the mantissa is rounded to 14 digits,
+ * values below 10^-99 become zero and values above 10^99 saturate.
+ * 
+ * @param text The literal.
+ * @param length The number of characters available in the literal.
+ * @return The value of the literal.
+ */
+real_t parse_real(const char* text, int length) {
+    real_t value = REAL_LITERAL(0x00, REAL_EXP_BIAS, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+    int digits = 0;
+    int exponent = -1;
+    bool seen_point = false;
+    bool round_up = false;
+    int index = 0;
+
+    // Mantissa; the exponent follows the position of the first significant digit
+    for (; index < length; index++) {
+        char c = text[index];
+        if (c == '.' && !seen_point) {
+            seen_point = true;
+            continue;
+        }
+        if (c < '0' || c > '9') {
+            break;
+        }
+
+        uint8_t digit = (uint8_t)(c - '0');
+        if (digits == 0 && digit == 0) {
+            // Leading zeros only move the exponent once past the point
+            if (seen_point) {
+                exponent--;
+            }
+            continue;
+        }
+
+        if (!seen_point) {
+            exponent++;
+        }
+        if (digits < REAL_DIGITS) {
+            value.mant[digits >> 1] |= (uint8_t)((digits & 1) ? digit : digit << 4);
+        } else if (digits == REAL_DIGITS) {
+            round_up = digit >= 5;
+        }
+        if (digits <= REAL_DIGITS) {
+            digits++;
+        }
+    }
+
+    // Optional exponent
+    if (index < length && (text[index] == 'e' || text[index] == 'E')) {
+        int scan = index + 1;
+        bool negative = false;
+        if (scan < length && (text[scan] == '+' || text[scan] == '-')) {
+            negative = text[scan] == '-';
+            scan++;
+        }
+
+        int explicit_exponent = 0;
+        for (; scan < length && text[scan] >= '0' && text[scan] <= '9'; scan++) {
+            if (explicit_exponent < LITERAL_EXP_LIMIT) {
+                explicit_exponent = explicit_exponent * 10 + (text[scan] - '0');
+            }
+        }
+        exponent += negative ? -explicit_exponent : explicit_exponent;
+    }
+
+    if (digits == 0 || exponent < POW10_MIN_EXPONENT) {
+        return ZERO;
+    }
+    if (exponent > POW10_MAX_EXPONENT) {
+        return REAL_LARGEST;
+    }
+
+    value.exp = (int8_t)(uint8_t)(REAL_EXP_BIAS + exponent);
+    if (round_up) {
+        real_t truncated = value;
+        if (!increment_bcd_digits(&value, REAL_DIGITS)) {
+            return truncated;
+        }
+    }
+    return value;
+}
+
+/** The value 1 */
+static const real_t REAL_ONE = REAL_LITERAL(0x00, 0x80, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+
+/**
+ * Largest magnitude handled by the integer fast path (2^23 - 1).
+ * Sums and differences of two such values still fit in a long.
+ */
+#define FAST_INT_MAX 8388607L
+
+/**
+ * Reads a real_t as a native integer.
+ * Only exact integers up to FAST_INT_MAX are accepted; the check looks
+ * at the BCD digits directly, so it never calls the OS.
+ * 
+ * @param value Pointer to the value to read.
+ * @param result Pointer to store the integer.
+ * @return True if the value is an exact integer in range, false otherwise.
+ */
+static bool real_to_fast_int(const real_t* value, long* result) {
+    if (value->mant[0] == 0) {
+        *result = 0;
+        return true;
+    }
+
+    // FAST_INT_MAX has 7 digits, so the exponent must be between 0 and 6
+    int exponent = (uint8_t)value->exp - REAL_EXP_BIAS;
+    if (exponent < 0 || exponent > 6) {
+        return false;
+    }
+
+    long integer = 0;
+    for (int index = 0; index <= exponent; index++) {
+        integer = integer * 10 + get_bcd_digit(value, index);
+    }
+
+    // Any digit after the decimal point makes it a fraction
+    for (int index = exponent + 1; index < REAL_DIGITS; index++) {
+        if (get_bcd_digit(value, index) != 0) {
+            return false;
+        }
+    }
+
+    if (integer > FAST_INT_MAX) {
+        return false;
+    }
+
+    *result = (value->sign & 0x80) ? -integer : integer;
+    return true;
+}
+
+/**
+ * Gets the real_t of an integer computed by the fast path.
+ * 
+ * @param integer The integer, at most FAST_INT_MAX in magnitude.
+ * @return The integer as a real_t.
+ */
+static real_t fast_int_to_real(long integer) {
+    return os_Int24ToReal((int24_t)integer);
+}
+
+/**
+ * Adds two values, with native integer arithmetic when both are small
+ * exact integers.
+ * 
+ * @param left The left operand.
+ * @param right The right operand.
+ * @return The sum.
+ */
+real_t real_add(real_t left, real_t right) {
+    long a, b;
+    if (real_to_fast_int(&left, &a) && real_to_fast_int(&right, &b)) {
+        long sum = a + b;
+        if (labs(sum) <= FAST_INT_MAX) {
+            return fast_int_to_real(sum);
+        }
+    }
+    return os_RealAdd(&left, &right);
+}
+
+/**
+ * Subtracts two values, with native integer arithmetic when both are small
+ * exact integers.
+ * 
+ * @param left The left operand.
+ * @param right The right operand.
+ * @return The difference.
+ */
+real_t real_sub(real_t left, real_t right) {
+    long a, b;
+    if (real_to_fast_int(&left, &a) && real_to_fast_int(&right, &b)) {
+        long difference = a - b;
+        if (labs(difference) <= FAST_INT_MAX) {
+            return fast_int_to_real(difference);
+        }
+    }
+    return os_RealSub(&left, &right);
+}
+
+/**
+ * Multiplies two values, with native integer arithmetic when both are small
+ * exact integers and the product stays in range.
+ * 
+ * @param left The left operand.
+ * @param right The right operand.
+ * @return The product.
+ */
+real_t real_mul(real_t left, real_t right) {
+    long a, b;
+    if (real_to_fast_int(&left, &a) && real_to_fast_int(&right, &b)) {
+        // Checked by division so the product never overflows a long
+        if (a == 0 || labs(b) <= FAST_INT_MAX / labs(a)) {
+            return fast_int_to_real(a * b);
+        }
+    }
+    return os_RealMul(&left, &right);
+}
+
+/**
+ * Divides two values, with native integer arithmetic when both are small
+ * exact integers and the quotient is exact. The divisor must not be zero.
+ * 
+ * @param left The dividend.
+ * @param right The divisor.
+ * @return The quotient.
+ */
+real_t real_div(real_t left, real_t right) {
+    long a, b;
+    if (real_to_fast_int(&left, &a) && real_to_fast_int(&right, &b) &&
+        b != 0 && a % b == 0) {
+        return fast_int_to_real(a / b);
+    }
+    return os_RealDiv(&left, &right);
+}
+
+/**
+ * Raises a value to a power. Integral exponents use repeated squaring
+ * with real_mul, which is faster than the log/exp route of os_RealPow and
+ * exact for integer results; any other exponent goes to os_RealPow.
+ * A negative exponent is applied by inverting base^|n|, so when base^|n|
+ * could leave the range of a real_t, where the power itself may not, the
+ * power goes to os_RealPow too.
+ * 
+ * @param base The base.
+ * @param exponent The exponent.
+ * @return The power.
+ */
+real_t real_pow(real_t base, real_t exponent) {
+    long n;
+
+    // Zero bases keep the OS semantics (0^0 and 0^-n are errors)
+    if (base.mant[0] == 0 || !real_to_fast_int(&exponent, &n)) {
+        return os_RealPow(&base, &exponent);
+    }
+
+    bool invert = n < 0;
+    n = labs(n);
+
+    // base^|n| lies between 10^(n e) and 10^(n (e + 1)), e the exponent of the base
+    long magnitude = (long)(uint8_t)base.exp - REAL_EXP_BIAS;
+    if (invert && (n * (magnitude + 1) > 99 || n * magnitude < -99)) {
+        return os_RealPow(&base, &exponent);
+    }
+
+    real_t result = REAL_ONE;
+    while (n > 0) {
+        if (n & 1) {
+            result = real_mul(result, base);
+        }
+        n >>= 1;
+        if (n > 0) {
+            // Only square when another bit needs it, so no square overflows needlessly
+            base = real_mul(base, base);
+        }
+    }
+
+    if (invert) {
+        result = os_RealDiv(&REAL_ONE, &result);
+    }
+    return result;
+}
+
+/**
+ * Selects the formatting of an arithmetic mode. An evaluation selects it
+ * once and formats each of its values with APPLY_FORMAT.
+ * 
+ * @param type The arithmetic type.
+ * @param precision The number of decimal places or significant digits.
+ * @param use_significant_digits Whether to use significant digits.
+ * @return The formatting; its function is NULL in normal arithmetic.
+ */
+ArithmeticFormat get_arithmetic_format(ArithmeticType type, int precision, bool use_significant_digits) {
+    ArithmeticFormat format = { NULL, precision };
+    if (type == ARITHMETIC_TRUNCATE) {
+        format.function = use_significant_digits ? truncate_to_significant_digits : truncate_to_decimal_places;
+    } else if (type == ARITHMETIC_ROUND) {
+        format.function = use_significant_digits ? round_to_significant_digits : round_to_decimal_places;
+    }
+    return format;
+}
+
 /**
  * Applies arithmetic formatting to a value.
  * 
  * @param value The value to format.
+ * @param format The formatting of the arithmetic mode.
  * @return The formatted value.
  */
-real_t apply_arithmetic_format(real_t value) {
-    switch (current_arithmetic_type) {
-        case ARITHMETIC_NORMAL:
-            return value;
-            
-        case ARITHMETIC_TRUNCATE:
-            if (current_use_significant_digits) {
-                return truncate_to_significant_digits(value, current_precision);
-            } else {
-                return truncate_to_decimal_places(value, current_precision);
+real_t apply_arithmetic_format(real_t value, const ArithmeticFormat* format) {
+    PROFILE_START(PROFILE_ARITHMETIC_FORMAT);
+    APPLY_FORMAT(format, value);
+    PROFILE_STOP(PROFILE_ARITHMETIC_FORMAT);
+    return value;
+}
+
+/* ============================== Formatting ============================== */
+
+/** Most significant digits the home screen shows */
+#define DISPLAY_DIGITS 10
+
+/** Characters of the TI font for the negative sign and the exponent */
+#define CHAR_NEGATIVE '\x1A'
+#define CHAR_EXPONENT '\x1B'
+
+/** Display flags of the OS; bit 0 is set in Sci mode and bit 1 in Eng mode */
+#ifndef OS_FORMAT_FLAGS
+#define OS_FORMAT_FLAGS (*(const volatile uint8_t*)0xD0008A)
+#endif
+
+/** Number of values whose text is kept by format_real_in_mode */
+#define FORMAT_CACHE_SIZE 8
+
+/**
+ * Value formatted lately, with its text.
+ */
+typedef struct {
+    real_t value;                   /**< The value */
+    int8_t decimals;                /**< Decimal places it was shown with, or -1 for float */
+    char text[MAX_TOKEN_LENGTH];    /**< The text */
+} FormattedReal;
+
+/** Values formatted lately, so one shown again, like a step operand, is not formatted again */
+static FormattedReal format_cache[FORMAT_CACHE_SIZE];
+
+/** Number of entries of the cache in use */
+static uint8_t format_cache_count = 0;
+
+/** Entry of the cache the next value replaces */
+static uint8_t format_cache_next = 0;
+
+/**
+ * Formats a real_t number as a string, with the current arithmetic settings.
+ * 
+ * @param value The value to format.
+ * @param buffer The buffer to store the formatted string, MAX_TOKEN_LENGTH long.
+ */
+void format_real(real_t value, char* buffer) {
+    format_real_in_mode(value, current_arithmetic_type, current_precision, current_use_significant_digits, buffer);
+}
+
+/**
+ * Formats a real_t number as a string, straight from the digits of its
+ * mantissa, the way the home screen shows it in Normal mode. Normal
+ * arithmetic and significant digits show the value in float; decimal
+ * places show it in fix. In normal arithmetic the OS notation is used,
+ * so when the OS is in Sci or Eng mode the OS does the formatting.
+ * 
+ * @param value The value to format.
+ * @param type The arithmetic type the value was computed in.
+ * @param precision The number of decimal places or significant digits.
+ * @param use_significant_digits Whether the precision is in significant digits.
+ * @param buffer The buffer to store the formatted string, MAX_TOKEN_LENGTH long.
+ */
+void format_real_in_mode(real_t value, ArithmeticType type, int precision, bool use_significant_digits,
+                         char* buffer) {
+    PROFILE_START(PROFILE_FORMAT_REAL);
+    int8_t decimals = (type == ARITHMETIC_NORMAL || use_significant_digits) ? -1 : (int8_t)precision;
+
+    if (type == ARITHMETIC_NORMAL && (OS_FORMAT_FLAGS & 0x03) != 0) {
+        os_RealToStr(buffer, &value, MAX_TOKEN_LENGTH, 0, -1);
+    } else {
+        int found = -1;
+        for (int i = 0; i < format_cache_count; i++) {
+            if (format_cache[i].decimals == decimals &&
+                memcmp(&format_cache[i].value, &value, sizeof(real_t)) == 0) {
+                found = i;
+                break;
             }
-            
-        case ARITHMETIC_ROUND:
-            if (current_use_significant_digits) {
-                return round_to_significant_digits(value, current_precision);
-            } else {
-                return os_RealRound(&value, current_precision);
+        }
+
+        if (found < 0) {
+            found = format_cache_next;
+            format_cache_next = (format_cache_next + 1) % FORMAT_CACHE_SIZE;
+            if (format_cache_count < FORMAT_CACHE_SIZE) {
+                format_cache_count++;
             }
-            
-        default:
-            return value;
+            format_cache[found].value = value;
+            format_cache[found].decimals = decimals;
+            *write_real(&value, decimals, format_cache[found].text) = '\0';
+        }
+        strcpy(buffer, format_cache[found].text);
     }
+    PROFILE_STOP(PROFILE_FORMAT_REAL);
 }
 
 /**
- * Formats a real_t number as a string.
+ * Writes the text of a real_t: ten significant digits at most, in
+ * scientific notation from 1E10 and under .001, without a leading zero.
+ * In float the trailing zeros are left out as the digits are written;
+ * in fix the decimal places are always shown, up to ten digits in all.
+ * The longest text is 16 characters, so it fits MAX_TOKEN_LENGTH.
  * 
- * @param value The value to format.
- * @param buffer The buffer to store the formatted string.
+ * @param value Pointer to the value.
+ * @param decimals Decimal places, or -1 for float.
+ * @param out Where to write, not terminated.
+ * @return The end of what was written.
  */
-void format_real(real_t value, char* buffer) {
-    // Use TI's built-in real to string conversion
-    int mode = 0; // Use current mode
-    int8_t digits = -1; // Float mode
-    
-    if (current_arithmetic_type != ARITHMETIC_NORMAL) {
-        mode = 1; // Normal mode
-        if (current_use_significant_digits) {
-            digits = -1; // Float mode
-        } else {
-            digits = current_precision; // Fix mode
+static char* write_real(const real_t* value, int decimals, char* out) {
+    // One more digit than shown, for the one a rounding carry adds in fix
+    char digits[DISPLAY_DIGITS + 1];
+    char* start = out;
+
+    if (value->mant[0] == 0) {
+        return write_zero(out, decimals);
+    }
+    if (value->sign & 0x80) {
+        *out++ = CHAR_NEGATIVE;
+    }
+
+    // The notation follows the value as it is shown
+    int exponent = (uint8_t)value->exp - REAL_EXP_BIAS;
+    int shown = exponent + round_display_digits(value, DISPLAY_DIGITS, digits);
+    bool scientific = shown >= DISPLAY_DIGITS || shown < -3;
+
+    if (decimals < 0) {
+        int count = DISPLAY_DIGITS;
+        while (count > 1 && digits[count - 1] == '0') {
+            count--;
         }
+        return scientific ? write_scientific(out, digits, count, shown)
+                          : write_normal(out, digits, count, shown, -1);
     }
-    
-    os_RealToStr(buffer, &value, MAX_TOKEN_LENGTH, mode, digits);
-    
-    // Remove trailing zeros if in float mode
-    if (digits == -1) {
-        int len = strlen(buffer);
-        char* decimal = strchr(buffer, '.');
-        
-        if (decimal != NULL) {
-            // Start from the end and remove trailing zeros
-            while (len > 0 && buffer[len-1] == '0') {
-                buffer[--len] = '\0';
-            }
-            
-            // Remove decimal point if it's the last character
-            if (len > 0 && buffer[len-1] == '.') {
-                buffer[--len] = '\0';
-            }
+
+    if (scientific) {
+        int count = decimals + 1 < DISPLAY_DIGITS ? decimals + 1 : DISPLAY_DIGITS;
+        shown = exponent + round_display_digits(value, count, digits);
+        return write_scientific(out, digits, count, shown);
+    }
+
+    int count = exponent + 1 + decimals;
+    if (count > DISPLAY_DIGITS) {
+        count = DISPLAY_DIGITS;
+    }
+    if (count > 0) {
+        shown = exponent + round_display_digits(value, count, digits);
+        if (shown != exponent) {
+            // The carry added an integer digit, the decimals stay
+            digits[count++] = '0';
         }
+        return write_normal(out, digits, count, shown, decimals);
     }
+    if (count == 0 && get_bcd_digit(value, 0) >= 5) {
+        // Rounds up to the first decimal place shown
+        digits[0] = '1';
+        return write_normal(out, digits, 1, exponent + 1, decimals);
+    }
+
+    // Rounds to zero, which is shown without its sign
+    return write_zero(start, decimals);
 }
 
-static real_t os_RealLog10(real_t* x) {
-    real_t log_x = os_RealLog(x);
-    return os_RealDiv(&log_x, &LOG10);
+/**
+ * Rounds the mantissa of a value to its first digits, half up, as text.
+ * 
+ * @param value Pointer to the value.
+ * @param count Digits to keep, from 1 to DISPLAY_DIGITS.
+ * @param digits Buffer the kept digits are written to, without a terminator.
+ * @return 1 if the rounding carried into a new first digit, 0 otherwise.
+ */
+static int round_display_digits(const real_t* value, int count, char* digits) {
+    bool carry = get_bcd_digit(value, count) >= 5;
+    for (int i = count - 1; i >= 0; i--) {
+        int digit = get_bcd_digit(value, i) + carry;
+        carry = digit == 10;
+        digits[i] = (char)('0' + (carry ? 0 : digit));
+    }
+    if (carry) {
+        digits[0] = '1';
+        return 1;
+    }
+    return 0;
 }
 
-static real_t os_RealAbs(real_t* x) {
-    if (x->sign == 0) {
-        return *x;
-    } else {
-        return os_RealNeg(x);
+/**
+ * Writes zero, with its decimal places in fix.
+ * 
+ * @param out Where to write.
+ * @param decimals Decimal places, or -1 for float.
+ * @return The end of what was written.
+ */
+static char* write_zero(char* out, int decimals) {
+    *out++ = '0';
+    if (decimals > 0) {
+        *out++ = '.';
+        memset(out, '0', decimals);
+        out += decimals;
     }
+    return out;
 }
 
-static real_t os_RealCeil(real_t* x) {
-    real_t ONE = os_Int24ToReal(1);
-    real_t int_part = os_RealInt(x);
-    if (os_RealCompare(x, &int_part) > 0) {
-        return os_RealAdd(&int_part, &ONE);
-    } else {
-        return int_part;
+/**
+ * Writes a number in scientific notation, like 1.25E-7.
+ * 
+ * @param out Where to write.
+ * @param digits The digits, the first one before the decimal point.
+ * @param count Number of digits.
+ * @param exponent The exponent, from -99 to 100.
+ * @return The end of what was written.
+ */
+static char* write_scientific(char* out, const char* digits, int count, int exponent) {
+    *out++ = digits[0];
+    if (count > 1) {
+        *out++ = '.';
+        memcpy(out, digits + 1, count - 1);
+        out += count - 1;
+    }
+    *out++ = CHAR_EXPONENT;
+    if (exponent < 0) {
+        *out++ = CHAR_NEGATIVE;
+        exponent = -exponent;
+    }
+    // Rounding in fix can carry 9.9E99 up to 1E100
+    if (exponent >= 100) {
+        *out++ = (char)('0' + exponent / 100);
+    }
+    if (exponent >= 10) {
+        *out++ = (char)('0' + exponent / 10 % 10);
+    }
+    *out++ = (char)('0' + exponent % 10);
+    return out;
+}
+
+/**
+ * Writes a number in normal notation, like 12.5 or .0031.
+ * 
+ * @param out Where to write.
+ * @param digits The digits, the first one at the place of the exponent.
+ * @param count Number of digits.
+ * @param exponent The exponent.
+ * @param decimals Decimal places to show, or -1 for those the digits have.
+ * @return The end of what was written.
+ */
+static char* write_normal(char* out, const char* digits, int count, int exponent, int decimals) {
+    for (int i = 0; i <= exponent; i++) {
+        *out++ = i < count ? digits[i] : '0';
+    }
+    if (count > exponent + 1 || decimals > 0) {
+        *out++ = '.';
+        for (int i = 0; i < -exponent - 1; i++) {
+            *out++ = '0';
+        }
+        for (int i = exponent >= 0 ? exponent + 1 : 0; i < count; i++) {
+            *out++ = digits[i];
+        }
     }
+    return out;
 }
@@ -0,0 +1,747 @@
+/**
+ * MathSolver for TI-84 CE - Bytecode Compiler and Virtual Machine
+ *
+ * Flattens an expression tree into a postfix program and runs it on a
+ * fixed value stack. Compiling once and executing many times avoids the
+ * recursion and pointer chasing of the tree walkers in evaluator.c, which
+ * matters when the same expression is evaluated over and over.
+ *
+ * A sum or product compiles to its bounds, a loop instruction, its body
+ * and a closing instruction that jumps back to the body until the range
+ * is done, so the body is compiled once and the loop never leaves the VM.
+ */
+
+#include <string.h>
+#include <tice.h>
+#include <ti/real.h>
+#include "headers/log.h"
+#include "headers/mathsolver.h"
+#include "headers/bytecode_private.h"
+
+/* ============================== Compiler ============================== */
+
+/** Slot value of a node that has no temporary */
+#define NO_SLOT 0xFF
+
+/** Number of references to each node from the expression being compiled */
+static uint8_t node_uses[MAX_NODES];
+
+/** Temporary holding the value of each shared node, once computed */
+static uint8_t node_slots[MAX_NODES];
+
+/** Sums and products open around the code being emitted */
+static uint8_t loop_depth;
+
+/** One, the identity of a product */
+static const real_t LOOP_ONE = REAL_LITERAL(0x00, 0x80, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+
+/**
+ * Parses, optimizes and compiles an expression string.
+ * This is the path for modes that evaluate an expression many times;
+ * step-by-step evaluation works on the unoptimized tree instead.
+ * Constants are folded with the formatting the program is to run with.
+ *
+ * @param input The input string to compile.
+ * @param program Pointer to the program to fill.
+ * @param format The formatting of the arithmetic mode the program runs in.
+ * @return True if the expression was parsed and fits in the program, false otherwise.
+ */
+bool compile_expression_string(const char* input, CompiledExpression* program, const ArithmeticFormat* format) {
+    ExpressionNode* root = parse_expression_string(input);
+    if (root == NULL) {
+        return false;
+    }
+
+    return compile_expression(optimize_expression(root, format), program);
+}
+
+/**
+ * Compiles an expression tree into a postfix program.
+ *
+ * @param root Pointer to the root node of the expression tree.
+ * @param program Pointer to the program to fill.
+ * @return True if the tree fits in the program, false otherwise.
+ */
+bool compile_expression(ExpressionNode* root, CompiledExpression* program) {
+    program->length = 0;
+    program->constant_count = 0;
+    program->temp_count = 0;
+    program->max_stack = 0;
+
+    if (root == NULL) {
+        LOG_ERROR("Null expression node");
+        return false;
+    }
+
+    // Nodes shared by an optimized expression are computed once
+    memset(node_uses, 0, sizeof(node_uses));
+    memset(node_slots, NO_SLOT, sizeof(node_slots));
+    loop_depth = 0;
+    count_uses(root);
+
+    if (!compile_node(root, program, 0)) {
+        LOG_ERROR("Expression does not fit in a program");
+        return false;
+    }
+
+    LOG_TRACE("Compiled %d instructions, %d constants, %d temporaries, stack depth %d",
+              program->length, program->constant_count, program->temp_count, program->max_stack);
+    return true;
+}
+
+/**
+ * Emits the code for a node and its children.
+ *
+ * @param node Pointer to the node to compile.
+ * @param program Pointer to the program being built.
+ * @param depth Stack depth before the code of this node runs.
+ * @return True on success, false if a program limit was exceeded.
+ */
+static bool compile_node(ExpressionNode* node, CompiledExpression* program, uint8_t depth) {
+    if (depth + 1 > VM_STACK_SIZE) {
+        return false;
+    }
+    if (depth + 1 > program->max_stack) {
+        program->max_stack = depth + 1;
+    }
+
+    if (node == NULL) {
+        // Same as the tree walkers: a missing node evaluates to zero
+        int index = add_constant(program, ZERO);
+        return index >= 0 && emit(program, OP_PUSH_CONST, index);
+    }
+
+    // A loop body runs with other values of its variable than the code
+    // around it, so values are neither kept nor reused inside one
+    NodeIndex index = (NodeIndex)(node - node_pool);
+    if (node_slots[index] != NO_SLOT && loop_depth == 0) {
+        return emit(program, OP_LOAD, node_slots[index]);
+    }
+
+    if (!compile_operation(node, program, depth)) {
+        return false;
+    }
+
+    // Keep the value of a shared operation for its other uses, while
+    // temporaries last; numbers and variables are as cheap to push again
+    if (node_uses[index] > 1 && node->type != NODE_NUMBER && node->type != NODE_VARIABLE &&
+        loop_depth == 0 && program->temp_count < VM_TEMP_COUNT) {
+        node_slots[index] = program->temp_count++;
+        return emit(program, OP_STORE, node_slots[index]);
+    }
+    return true;
+}
+
+/**
+ * Emits the code of the operation of a node, children included.
+ *
+ * @param node Pointer to the node to compile.
+ * @param program Pointer to the program being built.
+ * @param depth Stack depth before the code of this node runs.
+ * @return True on success, false if a program limit was exceeded.
+ */
+static bool compile_operation(ExpressionNode* node, CompiledExpression* program, uint8_t depth) {
+    switch (node->type) {
+        case NODE_NUMBER: {
+            int index = add_constant(program, node->number_value);
+            return index >= 0 && emit(program, OP_PUSH_CONST, index);
+        }
+
+        case NODE_VARIABLE: {
+            return emit(program, OP_PUSH_VAR, node->variable.symbol);
+        }
+
+        case NODE_ADDITION:
+        case NODE_SUBTRACTION:
+        case NODE_MULTIPLICATION:
+        case NODE_DIVISION:
+        case NODE_EXPONENT:
+            return compile_node(NODE_AT(node->binary_op.left), program, depth) &&
+                   compile_node(NODE_AT(node->binary_op.right), program, depth + 1) &&
+                   emit(program, get_binary_opcode(node->type), 0);
+
+        case NODE_FUNCTION:
+            return compile_node(NODE_AT(node->function.argument), program, depth) &&
+                   emit(program, OP_FUNC, node->function.func_type);
+
+        case NODE_FACTORIAL:
+            return compile_node(NODE_AT(node->factorial.expression), program, depth) &&
+                   emit(program, OP_FACTORIAL, 0);
+
+        case NODE_PARENTHESIS:
+            // Parentheses only matter to the shape of the tree
+            return compile_node(NODE_AT(node->parenthesis.expression), program, depth);
+
+        case NODE_SUMMATION:
+        case NODE_PRODUCT:
+            return compile_loop(node, program, depth);
+
+        default:
+            LOG_ERROR("Unknown node type");
+            return false;
+    }
+}
+
+/**
+ * Emits the code of a sum or product: the identity of the operation, the
+ * bounds, OP_LOOP_BEGIN, the body and the instruction that closes the loop.
+ *
+ * @param node Pointer to the sum or product node.
+ * @param program Pointer to the program being built.
+ * @param depth Stack depth before the code of this node runs.
+ * @return True on success, false if a program limit was exceeded.
+ */
+static bool compile_loop(ExpressionNode* node, CompiledExpression* program, uint8_t depth) {
+    if (loop_depth >= VM_LOOP_DEPTH) {
+        return false;
+    }
+
+    bool sum = node->type == NODE_SUMMATION;
+    int identity = add_constant(program, sum ? ZERO : LOOP_ONE);
+    if (identity < 0 || !emit(program, OP_PUSH_CONST, identity) ||
+        !compile_node(NODE_AT(node->iterator.start), program, depth + 1) ||
+        !compile_node(NODE_AT(node->iterator.end), program, depth + 2)) {
+        return false;
+    }
+
+    uint8_t begin = program->length;
+    if (!emit(program, OP_LOOP_BEGIN, node->iterator.symbol)) {
+        return false;
+    }
+
+    // The body runs over the accumulator
+    loop_depth++;
+    bool compiled = compile_node(NODE_AT(node->iterator.body), program, depth + 1);
+    loop_depth--;
+
+    return compiled && emit(program, sum ? OP_SUM_NEXT : OP_PRODUCT_NEXT, program->length - begin);
+}
+
+/**
+ * Counts the references to each node of an expression.
+ * The children of a shared node are only counted once, since its code is
+ * only emitted once.
+ *
+ * @param node Pointer to the node to count.
+ */
+static void count_uses(ExpressionNode* node) {
+    if (node == NULL) {
+        return;
+    }
+
+    if (node_uses[node - node_pool]++ > 0) {
+        return;
+    }
+
+    switch (node->type) {
+        case NODE_ADDITION:
+        case NODE_SUBTRACTION:
+        case NODE_MULTIPLICATION:
+        case NODE_DIVISION:
+        case NODE_EXPONENT:
+            count_uses(NODE_AT(node->binary_op.left));
+            count_uses(NODE_AT(node->binary_op.right));
+            break;
+
+        case NODE_FUNCTION:
+            count_uses(NODE_AT(node->function.argument));
+            break;
+
+        case NODE_FACTORIAL:
+            count_uses(NODE_AT(node->factorial.expression));
+            break;
+
+        case NODE_PARENTHESIS:
+            count_uses(NODE_AT(node->parenthesis.expression));
+            break;
+
+        case NODE_SUMMATION:
+        case NODE_PRODUCT:
+            count_uses(NODE_AT(node->iterator.body));
+            count_uses(NODE_AT(node->iterator.start));
+            count_uses(NODE_AT(node->iterator.end));
+            break;
+    }
+}
+
+/**
+ * Appends an instruction to a program.
+ *
+ * @param program Pointer to the program being built.
+ * @param opcode The operation to append.
+ * @param operand The operand of the operation.
+ * @return True on success, false if the program is full.
+ */
+static bool emit(CompiledExpression* program, OpCode opcode, int operand) {
+    if (program->length >= MAX_PROGRAM_LENGTH) {
+        return false;
+    }
+
+    Instruction* instruction = &program->code[program->length++];
+    instruction->opcode = (uint8_t)opcode;
+    instruction->operand = (uint8_t)operand;
+    return true;
+}
+
+/**
+ * Adds a value to the constant table of a program.
+ * Values already in the table reuse their entry.
+ *
+ * @param program Pointer to the program being built.
+ * @param value The constant value.
+ * @return Index of the constant, or -1 if the table is full.
+ */
+static int add_constant(CompiledExpression* program, real_t value) {
+    for (int i = 0; i < program->constant_count; i++) {
+        if (memcmp(&program->constants[i], &value, sizeof(real_t)) == 0) {
+            return i;
+        }
+    }
+
+    if (program->constant_count >= MAX_PROGRAM_LENGTH) {
+        return -1;
+    }
+
+    program->constants[program->constant_count] = value;
+    return program->constant_count++;
+}
+
+/**
+ * Finds the first variable a program reads that is not a constant, nor
+ * the variable of a sum or product it is read in.
+ *
+ * @param program Pointer to the program.
+ * @return The symbol of the variable, or -1 if the program reads none.
+ */
+int find_program_variable(const CompiledExpression* program) {
+    uint8_t symbols[MAX_VARIABLES];
+    return list_program_variables(program, symbols) > 0 ? symbols[0] : -1;
+}
+
+/**
+ * Lists the variables a program reads that are not constants, nor the
+ * variable of a sum or product they are read in, in the order they are
+ * first read.
+ *
+ * @param program Pointer to the program.
+ * @param symbols Array of MAX_VARIABLES symbols to fill.
+ * @return The number of variables.
+ */
+int list_program_variables(const CompiledExpression* program, uint8_t* symbols) {
+    uint8_t loop_symbols[VM_LOOP_DEPTH];
+    uint8_t loops = 0;
+    int count = 0;
+
+    for (int pc = 0; pc < program->length; pc++) {
+        const Instruction* instruction = &program->code[pc];
+
+        switch (instruction->opcode) {
+            case OP_LOOP_BEGIN:
+                loop_symbols[loops++] = instruction->operand;
+                break;
+
+            case OP_SUM_NEXT:
+            case OP_PRODUCT_NEXT:
+                loops--;
+                break;
+
+            case OP_PUSH_VAR:
+                if (!(instruction->operand & SYMBOL_CONSTANT) &&
+                    memchr(loop_symbols, instruction->operand, loops) == NULL &&
+                    memchr(symbols, instruction->operand, count) == NULL) {
+                    symbols[count++] = instruction->operand;
+                }
+                break;
+        }
+    }
+    return count;
+}
+
+/**
+ * Maps a binary operator node type to its opcode.
+ *
+ * @param type The node type.
+ * @return The matching opcode.
+ */
+static OpCode get_binary_opcode(NodeType type) {
+    switch (type) {
+        case NODE_ADDITION:       return OP_ADD;
+        case NODE_SUBTRACTION:    return OP_SUB;
+        case NODE_MULTIPLICATION: return OP_MUL;
+        case NODE_DIVISION:       return OP_DIV;
+        default:                  return OP_POW;
+    }
+}
+
+/* ============================== Virtual Machine ============================== */
+
+/**
+ * Sum or product being run by the VM.
+ */
+typedef struct {
+    Variable saved;     /**< Loop variable as it was before the loop */
+    int first;          /**< First value of the variable */
+    int index;          /**< Current value of the variable */
+    int last;           /**< Last value of the variable */
+    uint8_t symbol;     /**< Symbol of the loop variable */
+} ActiveLoop;
+
+/** Outcome of the loops of the last program run */
+static LoopStatus loop_status = LOOP_OK;
+
+/** Whether the last program run met a value that is not defined */
+static bool value_undefined = false;
+
+/** Function told how far long loops have got, or NULL */
+static LoopProgressHandler progress_handler = NULL;
+
+/*
+ * The loop of the VM is built twice from headers/bytecode_vm.h. In normal
+ * arithmetic the values are not formatted at all; in the other modes they
+ * go through the function run_program selected for the whole program.
+ */
+
+#define VM_RUN run_normal
+#define VM_FORMAT(format, value) ((void)(format))
+#include "headers/bytecode_vm.h"
+
+#define VM_RUN run_formatted
+#define VM_FORMAT(format, value) APPLY_FORMAT(format, value)
+#include "headers/bytecode_vm.h"
+
+/**
+ * Executes a compiled program with a formatting its caller selected once,
+ * not on every run. The mode is looked at once, to pick the loop to run.
+ * Follows the same rules as evaluate_expression: every intermediate value
+ * is formatted by the arithmetic mode, and a division by zero, a function
+ * outside its domain or an invalid or overflowing factorial gives zero;
+ * is_value_undefined tells whether that happened. A sum or product with
+ * bounds that are not integers gives zero too; get_loop_status tells
+ * whether that happened, or whether the progress handler stopped a loop.
+ *
+ * @param program Pointer to the program to execute.
+ * @param format The formatting of the arithmetic mode.
+ * @return The value of the expression, or zero if a loop was stopped.
+ */
+real_t run_program(const CompiledExpression* program, const ArithmeticFormat* format) {
+    if (format->function == NULL) {
+        return run_normal(program, format);
+    }
+    return run_formatted(program, format);
+}
+
+/**
+ * Gets the outcome of the loops of the last call to run_program.
+ *
+ * @return LOOP_OK, or what went wrong with a sum or product.
+ */
+LoopStatus get_loop_status(void) {
+    return loop_status;
+}
+
+/**
+ * Tells whether the last call to run_program met a division by zero, a
+ * function outside its domain or a factorial it could not compute, so
+ * its value is not defined.
+ *
+ * @return True if the value is not defined.
+ */
+bool is_value_undefined(void) {
+    return value_undefined;
+}
+
+/**
+ * Sets the function run_program tells how far its sums and products
+ * have got, every LOOP_PROGRESS_INTERVAL iterations.
+ *
+ * @param handler The function, or NULL for none.
+ */
+void set_loop_progress_handler(LoopProgressHandler handler) {
+    progress_handler = handler;
+}
+
+/**
+ * Converts a bound of a sum or product to an integer.
+ *
+ * @param value The bound.
+ * @param bound Pointer set to the integer.
+ * @return True if the bound is an integer no larger than LOOP_MAX_BOUND.
+ */
+static bool read_bound(real_t value, int* bound) {
+    real_t rounded = os_RealRoundInt(&value);
+    real_t limit = os_Int24ToReal(LOOP_MAX_BOUND);
+    real_t magnitude = os_RealCompare(&value, &ZERO) < 0 ? os_RealNeg(&value) : value;
+
+    if (os_RealCompare(&value, &rounded) != 0 || os_RealCompare(&magnitude, &limit) > 0) {
+        return false;
+    }
+    *bound = os_RealToInt24(&value);
+    return true;
+}
+
+/**
+ * Finds the instruction that closes a loop.
+ *
+ * @param program Pointer to the program.
+ * @param begin Position of the OP_LOOP_BEGIN of the loop.
+ * @return Position of the matching OP_SUM_NEXT or OP_PRODUCT_NEXT.
+ */
+static uint8_t find_loop_end(const CompiledExpression* program, uint8_t begin) {
+    uint8_t nested = 0;
+    uint8_t pc = begin + 1;
+    for (; pc < program->length; pc++) {
+        uint8_t opcode = program->code[pc].opcode;
+        if (opcode == OP_LOOP_BEGIN) {
+            nested++;
+        } else if (opcode == OP_SUM_NEXT || opcode == OP_PRODUCT_NEXT) {
+            if (nested == 0) {
+                break;
+            }
+            nested--;
+        }
+    }
+    return pc;
+}
+
+/* ============================== Dual Number Machine ============================== */
+
+/** Derivative of the chosen variable with respect to itself */
+static const real_t DUAL_ONE = REAL_LITERAL(0x00, 0x80, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+
+/**
+ * Executes a compiled program on dual numbers, yielding the value of the
+ * expression and its derivative with respect to one variable in a single
+ * pass (forward-mode automatic differentiation).
+ * Unlike run_program, values keep their full precision whatever the
+ * arithmetic mode, since this feeds the equation solver.
+ *
+ * @param program Pointer to the program to execute.
+ * @param symbol Symbol of the variable to differentiate by.
+ * @param value Pointer set to the value of the expression.
+ * @param derivative Pointer set to the derivative of the expression.
+ * @return True on success, false if the value or the derivative is undefined.
+ */
+bool execute_program_dual(const CompiledExpression* program, uint8_t symbol, real_t* value, real_t* derivative) {
+    DualValue stack[VM_STACK_SIZE];
+    DualValue temps[VM_TEMP_COUNT];
+    uint8_t top = 0;
+
+    for (uint8_t pc = 0; pc < program->length; pc++) {
+        const Instruction* instruction = &program->code[pc];
+        // Operand of a unary operation, or left operand of a binary one
+        DualValue* a = &stack[top > 0 ? top - 1 : 0];
+        DualValue* b;
+
+        switch (instruction->opcode) {
+            case OP_PUSH_CONST:
+                stack[top].value = program->constants[instruction->operand];
+                stack[top++].derivative = ZERO;
+                break;
+
+            case OP_PUSH_VAR: {
+                bool found;
+                stack[top].value = get_symbol_value(instruction->operand, &found);
+                stack[top++].derivative = instruction->operand == symbol ? DUAL_ONE : ZERO;
+                break;
+            }
+
+            case OP_STORE:
+                temps[instruction->operand] = *a;
+                break;
+
+            case OP_LOAD:
+                stack[top++] = temps[instruction->operand];
+                break;
+
+            case OP_ADD:
+                top--;
+                a = &stack[top - 1];
+                b = &stack[top];
+                // (u + v)' = u' + v'
+                a->value = real_add(a->value, b->value);
+                a->derivative = real_add(a->derivative, b->derivative);
+                break;
+
+            case OP_SUB:
+                top--;
+                a = &stack[top - 1];
+                b = &stack[top];
+                // (u - v)' = u' - v'
+                a->value = real_sub(a->value, b->value);
+                a->derivative = real_sub(a->derivative, b->derivative);
+                break;
+
+            case OP_MUL:
+                top--;
+                a = &stack[top - 1];
+                b = &stack[top];
+                // (uv)' = u'v + uv'
+                a->derivative = real_add(real_mul(a->derivative, b->value), real_mul(a->value, b->derivative));
+                a->value = real_mul(a->value, b->value);
+                break;
+
+            case OP_DIV:
+                top--;
+                a = &stack[top - 1];
+                b = &stack[top];
+                // (u / v)' = (u' - (u / v) v') / v
+                if (is_zero(b->value)) {
+                    return false;
+                }
+                a->value = real_div(a->value, b->value);
+                a->derivative = real_div(real_sub(a->derivative, real_mul(a->value, b->derivative)), b->value);
+                break;
+
+            case OP_POW:
+                top--;
+                a = &stack[top - 1];
+                b = &stack[top];
+                if (!differentiate_power(a, b)) {
+                    return false;
+                }
+                break;
+
+            case OP_FUNC:
+                if (!differentiate_function((FunctionType)instruction->operand, a)) {
+                    return false;
+                }
+                break;
+
+            case OP_FACTORIAL:
+                // Only defined on integers, so only a constant has a derivative
+                if (!is_zero(a->derivative) || evaluate_factorial(a->value, &a->value) != FACTORIAL_OK) {
+                    return false;
+                }
+                break;
+
+            default:
+                // Sums and products are left to the secant search
+                return false;
+        }
+    }
+
+    if (top == 0) {
+        *value = ZERO;
+        *derivative = ZERO;
+    } else {
+        *value = stack[top - 1].value;
+        *derivative = stack[top - 1].derivative;
+    }
+    return true;
+}
+
+/**
+ * Raises a dual number to a dual power, in place of the base.
+ *
+ * @param u Pointer to the base, replaced by the power.
+ * @param v Pointer to the exponent.
+ * @return True on success, false if the power or its derivative is undefined.
+ */
+static bool differentiate_power(DualValue* u, const DualValue* v) {
+    if (!in_power_domain(u->value, v->value)) {
+        return false;
+    }
+
+    if (is_zero(v->derivative)) {
+        // (u^n)' = n u^(n-1) u', for any sign of u
+        if (is_zero(u->value)) {
+            real_t one = DUAL_ONE;
+            if (!is_zero(u->derivative) && os_RealCompare(&v->value, &one) < 0) {
+                return false;
+            }
+            u->derivative = os_RealCompare(&v->value, &one) == 0 ? u->derivative : ZERO;
+            u->value = real_pow(u->value, v->value);
+            return true;
+        }
+
+        real_t power = real_pow(u->value, real_sub(v->value, DUAL_ONE));
+        u->derivative = real_mul(real_mul(v->value, power), u->derivative);
+        u->value = real_mul(power, u->value);
+        return true;
+    }
+
+    // (u^v)' = u^v (v' ln u + v u' / u), which needs u > 0
+    if (os_RealCompare(&u->value, &ZERO) <= 0) {
+        return false;
+    }
+    real_t log_u = os_RealLog(&u->value);
+    real_t power = real_pow(u->value, v->value);
+    real_t rate = real_add(real_mul(v->derivative, log_u), real_div(real_mul(v->value, u->derivative), u->value));
+    u->derivative = real_mul(power, rate);
+    u->value = power;
+    return true;
+}
+
+/**
+ * Applies a function to a dual number in place, by the chain rule.
+ *
+ * @param func_type The function.
+ * @param u Pointer to the argument, replaced by the result.
+ * @return True on success, false outside the domain of the function or its derivative.
+ */
+static bool differentiate_function(FunctionType func_type, DualValue* u) {
+    real_t rate;
+
+    switch (func_type) {
+        case FUNC_SIN:
+            rate = os_RealCosRad(&u->value);
+            break;
+
+        case FUNC_COS: {
+            real_t sine = os_RealSinRad(&u->value);
+            rate = os_RealNeg(&sine);
+            break;
+        }
+
+        case FUNC_TAN: {
+            // 1 / cos^2
+            real_t cosine = os_RealCosRad(&u->value);
+            if (is_zero(cosine)) {
+                return false;
+            }
+            rate = real_div(DUAL_ONE, real_mul(cosine, cosine));
+            break;
+        }
+
+        case FUNC_LN:
+            if (os_RealCompare(&u->value, &ZERO) <= 0) {
+                return false;
+            }
+            rate = real_div(DUAL_ONE, u->value);
+            break;
+
+        case FUNC_LOG:
+            if (os_RealCompare(&u->value, &ZERO) <= 0) {
+                return false;
+            }
+            rate = real_div(DUAL_ONE, real_mul(u->value, LOG10));
+            break;
+
+        case FUNC_SQRT: {
+            // 1 / (2 sqrt u), infinite at 0
+            if (os_RealCompare(&u->value, &ZERO) <= 0) {
+                return false;
+            }
+            real_t root = os_RealSqrt(&u->value);
+            rate = real_div(DUAL_ONE, real_add(root, root));
+            break;
+        }
+
+        default:
+            return false;
+    }
+
+    u->derivative = real_mul(rate, u->derivative);
+    u->value = evaluate_function(func_type, u->value);
+    return true;
+}
+
+/**
+ * Tells whether a value is zero.
+ *
+ * @param value The value.
+ * @return True if the value is zero.
+ */
+static bool is_zero(real_t value) {
+    return os_RealCompare(&value, &ZERO) == 0;
+}
@@ -0,0 +1,331 @@
+/**
+ * MathSolver for TI-84 CE - Result Cache
+ *
+ * Remembers the most recent results, so going back to an expression or
+ * to a combination of settings shows its result without tokenizing,
+ * parsing or evaluating it again. Results are packed one after the
+ * other in a byte pool, most recently used first; the oldest ones fall
+ * off the end when a new result does not fit.
+ *
+ * When built with PERSIST_CACHE the pool is saved to an AppVar on exit
+ * and restored on the next launch.
+ */
+
+#include <string.h>
+#include <fileioc.h>
+#include <ti/real.h>
+#include "headers/log.h"
+#include "headers/mathsolver.h"
+#include "headers/cache_private.h"
+
+/* ============================== Cache Records ============================== */
+
+/**
+ * Header of a cached result.
+ * It is followed in the pool by the normalized expression text and by
+ * the steps of the result, so each record only takes the room it needs.
+ */
+typedef struct {
+    uint32_t key;                   /**< Hash of the text, settings and variable values */
+    uint8_t text_length;            /**< Length of the normalized expression text */
+    uint8_t arithmetic_mode;        /**< Arithmetic mode used (ArithmeticType) */
+    uint8_t precision;              /**< Precision used */
+    uint8_t use_significant_digits; /**< Whether significant digits were used */
+    uint8_t step_count;             /**< Number of steps that follow the text */
+    real_t value;                   /**< Final value */
+    real_t normal_value;            /**< Normal arithmetic */
+} CacheRecord;
+
+/** Size of the largest record */
+#define MAX_RECORD_SIZE (sizeof(CacheRecord) + MAX_INPUT_LENGTH + MAX_STEPS * sizeof(CalculationStep))
+
+_Static_assert(MAX_RECORD_SIZE <= RESULT_CACHE_BYTES, "A result must fit in the cache");
+
+/** Name of the AppVar the cache is saved to */
+#define CACHE_APPVAR_NAME "MSCACHE"
+
+/** Layout version of the saved cache, bumped when records change */
+#define CACHE_VERSION 1
+
+/** Cached results, most recently used first */
+static uint8_t cache_pool[RESULT_CACHE_BYTES];
+
+/** Bytes of the pool in use */
+static uint16_t cache_used = 0;
+
+/** Record being moved or built */
+static uint8_t scratch[MAX_RECORD_SIZE];
+
+/* ============================== Lookup and Store ============================== */
+
+/**
+ * Looks up the result of an expression under the current settings.
+ * A hit becomes the most recently used result.
+ *
+ * @param input The expression string.
+ * @param result Pointer to the structure to fill on a hit.
+ * @return True if the result was cached, false otherwise.
+ */
+bool lookup_result(const char* input, CalculationResult* result) {
+    char text[MAX_INPUT_LENGTH];
+    uint8_t length = normalize_text(input, text);
+    uint32_t key = hash_key(input, text, length, current_arithmetic_type,
+                            current_precision, current_use_significant_digits);
+
+    uint16_t offset = 0;
+    while (offset < cache_used) {
+        CacheRecord record;
+        memcpy(&record, &cache_pool[offset], sizeof(CacheRecord));
+        uint16_t size = record_size(record.text_length, record.step_count);
+
+        if (record.key == key && record.text_length == length &&
+            record.arithmetic_mode == current_arithmetic_type &&
+            record.precision == current_precision &&
+            record.use_significant_digits == current_use_significant_digits &&
+            memcmp(&cache_pool[offset + sizeof(CacheRecord)], text, length) == 0) {
+            move_to_front(offset, size);
+            read_record(result);
+            LOG_DEBUG("Result cache hit");
+            return true;
+        }
+        offset += size;
+    }
+
+    LOG_DEBUG("Result cache miss");
+    return false;
+}
+
+/**
+ * Stores the result of an expression as the most recently used one.
+ * The oldest results are dropped to make room.
+ *
+ * @param input The expression string the result was computed from.
+ * @param result Pointer to the result.
+ */
+void store_result(const char* input, const CalculationResult* result) {
+    CacheRecord record;
+    char text[MAX_INPUT_LENGTH];
+
+    // The steps spilled to the AppVar would not come back with the record
+    if (result->step_count > MAX_STEPS) {
+        LOG_DEBUG("Result with %d steps not cached", result->step_count);
+        return;
+    }
+
+    record.text_length = normalize_text(input, text);
+    record.arithmetic_mode = (uint8_t)result->arithmetic_mode;
+    record.precision = (uint8_t)result->precision;
+    record.use_significant_digits = result->use_significant_digits;
+    record.step_count = (uint8_t)result->step_count;
+    record.value = result->value;
+    record.normal_value = result->normal_value;
+    record.key = hash_key(input, text, record.text_length, result->arithmetic_mode,
+                          result->precision, result->use_significant_digits);
+
+    uint16_t size = record_size(record.text_length, record.step_count);
+    memcpy(scratch, &record, sizeof(CacheRecord));
+    memcpy(&scratch[sizeof(CacheRecord)], text, record.text_length);
+    memcpy(&scratch[sizeof(CacheRecord) + record.text_length], result->steps,
+           record.step_count * sizeof(CalculationStep));
+
+    // Keep the most recent records that leave room for the new one
+    uint16_t kept = 0;
+    while (kept < cache_used) {
+        CacheRecord old;
+        memcpy(&old, &cache_pool[kept], sizeof(CacheRecord));
+        if (kept + record_size(old.text_length, old.step_count) + size > RESULT_CACHE_BYTES) {
+            break;
+        }
+        kept += record_size(old.text_length, old.step_count);
+    }
+
+    memmove(&cache_pool[size], cache_pool, kept);
+    memcpy(cache_pool, scratch, size);
+    cache_used = kept + size;
+    LOG_DEBUG("Result cached, %d bytes in use", cache_used);
+}
+
+/**
+ * Gets the size of a record, its text and steps included.
+ *
+ * @param text_length Length of the text of the record.
+ * @param step_count Number of steps of the record.
+ * @return Size of the record in bytes.
+ */
+static uint16_t record_size(uint8_t text_length, uint8_t step_count) {
+    return sizeof(CacheRecord) + text_length + step_count * sizeof(CalculationStep);
+}
+
+/**
+ * Moves a record to the front of the pool.
+ *
+ * @param offset Offset of the record.
+ * @param size Size of the record.
+ */
+static void move_to_front(uint16_t offset, uint16_t size) {
+    if (offset == 0) {
+        return;
+    }
+
+    memcpy(scratch, &cache_pool[offset], size);
+    memmove(&cache_pool[size], cache_pool, offset);
+    memcpy(cache_pool, scratch, size);
+}
+
+/**
+ * Rebuilds a result from the record at the front of the pool.
+ *
+ * @param result Pointer to the structure to fill.
+ */
+static void read_record(CalculationResult* result) {
+    CacheRecord record;
+    memcpy(&record, cache_pool, sizeof(CacheRecord));
+
+    memset(result, 0, sizeof(CalculationResult));
+    result->arithmetic_mode = (ArithmeticType)record.arithmetic_mode;
+    result->precision = record.precision;
+    result->use_significant_digits = record.use_significant_digits;
+    result->value = record.value;
+    result->normal_value = record.normal_value;
+    result->step_count = record.step_count;
+    memcpy(result->steps, &cache_pool[sizeof(CacheRecord) + record.text_length],
+           record.step_count * sizeof(CalculationStep));
+
+    // The record was made under the settings in effect now
+    format_real(result->value, result->formatted_result);
+}
+
+/* ============================== Keys ============================== */
+
+/**
+ * Normalizes an expression string for comparison.
+ * Letters are folded to lower case, as the tokenizer does with names;
+ * the length is kept, so step positions still match the typed text.
+ *
+ * @param input The expression string.
+ * @param text Buffer of MAX_INPUT_LENGTH characters for the normalized text.
+ * @return Length of the normalized text.
+ */
+static uint8_t normalize_text(const char* input, char* text) {
+    uint8_t length = 0;
+    while (input[length] != '\0' && length < MAX_INPUT_LENGTH) {
+        char c = input[length];
+        text[length++] = (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+    }
+    return length;
+}
+
+/**
+ * Hashes the text of an expression, the arithmetic settings and the
+ * values of the variables it refers to (FNV-1a).
+ *
+ * @param input The expression string, tokenized to find its variables.
+ * @param text The normalized text.
+ * @param length Length of the normalized text.
+ * @param mode The arithmetic mode.
+ * @param precision The precision.
+ * @param use_significant_digits Whether significant digits are used.
+ * @return The key of the result.
+ */
+static uint32_t hash_key(const char* input, const char* text, uint8_t length, ArithmeticType mode,
+                         int precision, bool use_significant_digits) {
+    uint32_t hash = hash_bytes(0x811C9DC5, text, length);
+
+    uint8_t settings[3] = { (uint8_t)mode, (uint8_t)precision, use_significant_digits };
+    hash = hash_bytes(hash, settings, sizeof(settings));
+
+    Tokenizer tokenizer;
+    tokenizer_init(&tokenizer, input);
+    while (tokenizer.current_token.type != TOKEN_END && tokenizer.current_token.type != TOKEN_NONE) {
+        if (tokenizer.current_token.type == TOKEN_VARIABLE) {
+            const Variable* variable = &variables[tokenizer.current_token.id];
+            hash = hash_bytes(hash, &variable->is_defined, sizeof(variable->is_defined));
+            hash = hash_bytes(hash, &variable->value, sizeof(real_t));
+        }
+        next_token(&tokenizer);
+    }
+    return hash;
+}
+
+/**
+ * Adds bytes to a running FNV-1a hash.
+ *
+ * @param hash The hash so far.
+ * @param data Pointer to the bytes.
+ * @param length Number of bytes.
+ * @return The updated hash.
+ */
+static uint32_t hash_bytes(uint32_t hash, const void* data, uint8_t length) {
+    const uint8_t* bytes = data;
+    while (length--) {
+        hash = (hash ^ *bytes++) * 0x01000193;
+    }
+    return hash;
+}
+
+/* ============================== Persistence ============================== */
+
+/**
+ * Restores the results saved by the last run, if any.
+ * A saved cache from another layout version is ignored.
+ */
+void load_result_cache(void) {
+#ifdef PERSIST_CACHE
+    cache_used = 0;
+
+    uint8_t handle = ti_Open(CACHE_APPVAR_NAME, "r");
+    if (!handle) {
+        return;
+    }
+
+    uint8_t version = 0;
+    uint16_t used = 0;
+    if (ti_Read(&version, sizeof(version), 1, handle) == 1 && version == CACHE_VERSION &&
+        ti_Read(&used, sizeof(used), 1, handle) == 1 && used <= RESULT_CACHE_BYTES &&
+        ti_Read(cache_pool, 1, used, handle) == used) {
+        cache_used = used;
+    }
+    ti_Close(handle);
+
+    // Drop anything that does not walk as a list of whole records
+    uint16_t offset = 0;
+    while (offset < cache_used) {
+        CacheRecord record;
+        if (offset + sizeof(CacheRecord) > cache_used) {
+            break;
+        }
+        memcpy(&record, &cache_pool[offset], sizeof(CacheRecord));
+        if (record.text_length > MAX_INPUT_LENGTH || record.step_count > MAX_STEPS ||
+            offset + record_size(record.text_length, record.step_count) > cache_used) {
+            break;
+        }
+        offset += record_size(record.text_length, record.step_count);
+    }
+    cache_used = offset;
+
+    LOG_DEBUG("Result cache restored, %d bytes", cache_used);
+#endif
+}
+
+/**
+ * Saves the cached results to an AppVar for the next run.
+ * The AppVar is archived so it survives a RAM reset.
+ */
+void save_result_cache(void) {
+#ifdef PERSIST_CACHE
+    uint8_t handle = ti_Open(CACHE_APPVAR_NAME, "w");
+    if (!handle) {
+        LOG_ERROR("Failed to save the result cache");
+        return;
+    }
+
+    uint8_t version = CACHE_VERSION;
+    ti_Write(&version, sizeof(version), 1, handle);
+    ti_Write(&cache_used, sizeof(cache_used), 1, handle);
+    ti_Write(cache_pool, 1, cache_used, handle);
+    ti_SetArchiveStatus(true, handle);
+    ti_Close(handle);
+
+    LOG_DEBUG("Result cache saved, %d bytes", cache_used);
+#endif
+}
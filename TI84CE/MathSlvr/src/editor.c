@@ -0,0 +1,455 @@
+/**
+ * MathSolver for TI-84 CE - Line Editor
+ *
+ * Edits a line of text on the home screen in place of the OS string
+ * input, whose text is only seen once ENTER is pressed. Keys come from the
+ * keyboard handler and are turned into text here, so every change can be
+ * handed on while the line is typed, and work can be done once typing
+ * pauses. The line scrolls sideways when it is wider than the screen; the
+ * cursor blinks and shows whether 2nd or alpha is active.
+ */
+
+#include <tice.h>
+#include <string.h>
+#include <ti/screen.h>
+#include "../../common/headers/kb_handler.h"
+#include "headers/ui.h"
+#include "headers/profile.h"
+#include "headers/editor_private.h"
+
+#define LOG_TAG "editor"
+#include "headers/log.h"
+
+/**
+ * Modes of the keys.
+ */
+typedef enum {
+    KEYS_NORMAL,        /**< Keys type their main function */
+    KEYS_SECOND,        /**< 2nd was pressed; the next key types its 2nd function */
+    KEYS_ALPHA,         /**< Alpha was pressed; the next key types its letter */
+    KEYS_ALPHA_LOCK     /**< Keys type their letters until alpha is pressed again */
+} KeyMode;
+
+/**
+ * Text typed by a key.
+ */
+typedef struct {
+    CombinedKey key;    /**< The key */
+    const char* text;   /**< Text typed, or NULL */
+    const char* second; /**< Text typed after 2nd, or NULL */
+    char letter;        /**< Character typed in alpha mode, or 0 */
+} KeyText;
+
+/**
+ * Text of the keys, with the letters where TI-OS has them.
+ */
+static const KeyText KEY_TEXTS[] = {
+    { KEY_0,        "0",    NULL,     ' ' },
+    { KEY_1,        "1",    NULL,     'Y' },
+    { KEY_2,        "2",    NULL,     'Z' },
+    { KEY_3,        "3",    NULL,     0   },
+    { KEY_4,        "4",    NULL,     'T' },
+    { KEY_5,        "5",    NULL,     'U' },
+    { KEY_6,        "6",    NULL,     'V' },
+    { KEY_7,        "7",    NULL,     'O' },
+    { KEY_8,        "8",    NULL,     'P' },
+    { KEY_9,        "9",    NULL,     'Q' },
+    { KEY_DECPNT,   ".",    NULL,     0   },
+    { KEY_CHS,      "-",    NULL,     0   },
+    { KEY_ADD,      "+",    NULL,     0   },
+    { KEY_SUB,      "-",    NULL,     'W' },
+    { KEY_MUL,      "*",    NULL,     'R' },
+    { KEY_DIV,      "/",    "e",      'M' },
+    { KEY_POWER,    "^",    "\xC4",   'H' },
+    { KEY_SQUARE,   "^2",   "sqrt(",  'I' },
+    { KEY_RECIP,    "^-1",  NULL,     'D' },
+    { KEY_LPAREN,   "(",    NULL,     'K' },
+    { KEY_RPAREN,   ")",    NULL,     'L' },
+    { KEY_COMMA,    ",",    "E",      'J' },
+    { KEY_SIN,      "sin(", NULL,     'E' },
+    { KEY_COS,      "cos(", NULL,     'F' },
+    { KEY_TAN,      "tan(", NULL,     'G' },
+    { KEY_LOG,      "log(", "10^(",   'N' },
+    { KEY_LN,       "ln(",  "e^(",    'S' },
+    { KEY_MATH,     "!",    "=",      'A' },
+    { KEY_APPS,     NULL,   NULL,     'B' },
+    { KEY_PRGM,     NULL,   NULL,     'C' },
+    { KEY_STO,      NULL,   NULL,     'X' },
+    { KEY_STAT,     NULL,   "sum(",   0   },
+    { KEY_GRAPHVAR, "X",    NULL,     0   },
+};
+
+/** Text being edited, and its capacity (without the terminator) */
+static char* text;
+static int capacity;
+
+/** Length of the text, and position of the cursor in it */
+static int length;
+static int cursor;
+
+/** Index of the first character shown */
+static int scroll;
+
+/** Screen row of the line, column where the text starts, and columns shown */
+static uint8_t line_row;
+static uint8_t text_column;
+static uint8_t text_width;
+
+/** KeyMode of the next key */
+static uint8_t key_mode;
+
+/** Whether the line is still being edited, and whether it was entered */
+static bool editing;
+static bool entered;
+
+/** Whether the cursor is shown, for the blinking */
+static bool cursor_shown;
+
+/** Number of changes made to the text */
+static unsigned int revision;
+
+/** Handlers told about the text, and the pause before the idle handler is called (in ms) */
+static EditorChangeHandler change_handler = NULL;
+static EditorIdleHandler idle_handler = NULL;
+static int idle_delay = 0;
+
+/** Handler giving the entries recalled with 2nd ENTER, and how far back the last one was */
+static EditorRecallHandler recall_handler = NULL;
+static int recall_depth = 0;
+
+/**
+ * Sets the handlers told about the text of the next line edited.
+ *
+ * @param on_changed Called after each change, or NULL.
+ * @param on_idle Called once typing pauses after a change, or NULL.
+ * @param idle_delay_ms The pause after which on_idle is called (in ms).
+ */
+void editor_set_handlers(EditorChangeHandler on_changed, EditorIdleHandler on_idle, int idle_delay_ms) {
+    change_handler = on_changed;
+    idle_handler = on_idle;
+    idle_delay = idle_delay_ms;
+}
+
+/**
+ * Sets the handler giving the entries 2nd ENTER recalls into the next line edited.
+ *
+ * @param on_recall Gives the entry that far back, or NULL to recall nothing.
+ */
+void editor_set_recall(EditorRecallHandler on_recall) {
+    recall_handler = on_recall;
+}
+
+/**
+ * Edits a line of text on the home screen until ENTER is pressed, or
+ * CLEAR is pressed on an empty line. The handlers set with
+ * editor_set_handlers are cleared when the line is done.
+ *
+ * @param row Screen row of the line.
+ * @param prompt Text shown at the start of the line.
+ * @param buffer Buffer holding the text to edit.
+ * @param buffer_size Size of the buffer.
+ * @return True if the line was entered, false if it was canceled.
+ */
+bool edit_line(uint8_t row, const char* prompt, char* buffer, int buffer_size) {
+    text = buffer;
+    capacity = buffer_size - 1;
+    length = strlen(buffer);
+    if (length > capacity) {
+        length = capacity;
+        text[length] = '\0';
+    }
+    cursor = length;
+    scroll = 0;
+    line_row = row;
+    text_column = strlen(prompt);
+    text_width = MAX_DISPLAY_COLS - text_column;
+    key_mode = KEYS_NORMAL;
+    editing = true;
+    entered = false;
+    cursor_shown = true;
+    recall_depth = 0;
+
+    os_SetCursorPos(line_row, 0);
+    os_PutStrFull(prompt);
+    draw_line();
+
+    kb_clear();
+    kb_register_any_press(on_key);
+    kb_register_hold(KEY_LEFT, repeat_left, EDITOR_REPEAT_DELAY_MS, true, EDITOR_REPEAT_MS);
+    kb_register_hold(KEY_RIGHT, repeat_right, EDITOR_REPEAT_DELAY_MS, true, EDITOR_REPEAT_MS);
+    kb_register_hold(KEY_DEL, repeat_delete, EDITOR_REPEAT_DELAY_MS, true, EDITOR_REPEAT_MS);
+
+    // The idle handler runs once per pause, after the text changed
+    bool idle_due = false;
+    while (editing) {
+        unsigned int seen = revision;
+        if (kb_wait_event_timeout(idle_due ? idle_delay : EDITOR_BLINK_MS)) {
+            kb_process();
+            if (revision != seen) {
+                idle_due = idle_handler != NULL;
+            }
+        } else if (idle_due) {
+            idle_due = false;
+            idle_handler(text);
+        } else {
+            cursor_shown = !cursor_shown;
+            draw_line();
+        }
+    }
+
+    // Wait for ENTER or CLEAR to be let go, then leave the line without a cursor
+    kb_clear();
+    cursor_shown = false;
+    draw_line();
+
+    editor_set_handlers(NULL, NULL, 0);
+    editor_set_recall(NULL);
+    LOG_DEBUG("Line %s: %s", entered ? "entered" : "canceled", text);
+    return entered;
+}
+
+/* ============================== Key Handlers ============================== */
+
+/**
+ * Handles a key pressed while the line is edited.
+ *
+ * @param key The key pressed.
+ */
+static void on_key(CombinedKey key) {
+    uint8_t mode = key_mode;
+    if (key_mode != KEYS_ALPHA_LOCK) {
+        key_mode = KEYS_NORMAL;
+    }
+    cursor_shown = true;
+
+    switch (key) {
+        case KEY_2ND:
+            key_mode = mode == KEYS_SECOND ? KEYS_NORMAL : KEYS_SECOND;
+            break;
+        case KEY_ALPHA:
+            if (mode == KEYS_SECOND) {
+                key_mode = KEYS_ALPHA_LOCK;
+            } else {
+                key_mode = mode == KEYS_NORMAL ? KEYS_ALPHA : KEYS_NORMAL;
+            }
+            break;
+        case KEY_ENTER:
+            if (mode == KEYS_SECOND) {
+                recall_entry();
+                break;
+            }
+            entered = true;
+            editing = false;
+            break;
+        case KEY_CLEAR:
+            if (length == 0) {
+                editing = false;
+            } else {
+                length = 0;
+                cursor = 0;
+                text[0] = '\0';
+                text_changed();
+            }
+            break;
+        case KEY_DEL:
+            delete_character();
+            break;
+        case KEY_LEFT:
+            move_cursor(mode == KEYS_SECOND ? 0 : cursor - 1);
+            break;
+        case KEY_RIGHT:
+            move_cursor(mode == KEYS_SECOND ? length : cursor + 1);
+            break;
+        case KEY_UP:
+            move_cursor(0);
+            break;
+        case KEY_DOWN:
+            move_cursor(length);
+            break;
+        default: {
+            const char* typed = key_text(key, mode);
+            if (typed != NULL) {
+                insert_text(typed);
+            }
+            break;
+        }
+    }
+
+    // The cursor follows the key mode
+    draw_line();
+}
+
+/**
+ * Moves the cursor left while LEFT is held.
+ *
+ * @param hold_time Time the key has been held (in ms).
+ */
+static void repeat_left(int hold_time) {
+    (void)hold_time;
+    move_cursor(cursor - 1);
+    draw_line();
+}
+
+/**
+ * Moves the cursor right while RIGHT is held.
+ *
+ * @param hold_time Time the key has been held (in ms).
+ */
+static void repeat_right(int hold_time) {
+    (void)hold_time;
+    move_cursor(cursor + 1);
+    draw_line();
+}
+
+/**
+ * Deletes characters while DEL is held.
+ *
+ * @param hold_time Time the key has been held (in ms).
+ */
+static void repeat_delete(int hold_time) {
+    (void)hold_time;
+    delete_character();
+    draw_line();
+}
+
+/**
+ * Gets the text a key types.
+ *
+ * @param key The key.
+ * @param mode The KeyMode the key was pressed in.
+ * @return The text, or NULL if the key types nothing in that mode.
+ */
+static const char* key_text(CombinedKey key, uint8_t mode) {
+    static char letter[2];
+
+    for (unsigned int i = 0; i < sizeof(KEY_TEXTS) / sizeof(KEY_TEXTS[0]); i++) {
+        if (KEY_TEXTS[i].key != key) continue;
+
+        if (mode == KEYS_SECOND) {
+            return KEY_TEXTS[i].second;
+        }
+        if ((mode == KEYS_ALPHA || mode == KEYS_ALPHA_LOCK) && KEY_TEXTS[i].letter != 0) {
+            letter[0] = KEY_TEXTS[i].letter;
+            letter[1] = '\0';
+            return letter;
+        }
+        return KEY_TEXTS[i].text;
+    }
+    return NULL;
+}
+
+/* ================================ Editing ================================ */
+
+/**
+ * Inserts text at the cursor, if it fits.
+ *
+ * @param typed The text to insert.
+ */
+static void insert_text(const char* typed) {
+    int size = strlen(typed);
+    if (length + size > capacity) {
+        return;
+    }
+
+    memmove(&text[cursor + size], &text[cursor], length - cursor + 1);
+    memcpy(&text[cursor], typed, size);
+    length += size;
+    cursor += size;
+    text_changed();
+}
+
+/**
+ * Deletes the character under the cursor, or the last one when the
+ * cursor is at the end.
+ */
+static void delete_character(void) {
+    if (cursor == length) {
+        if (length == 0) return;
+        cursor--;
+    }
+
+    memmove(&text[cursor], &text[cursor + 1], length - cursor);
+    length--;
+    text_changed();
+}
+
+/**
+ * Replaces the text with the entry before the one recalled last, like
+ * ENTRY on the home screen.
+ */
+static void recall_entry(void) {
+    if (recall_handler == NULL || !recall_handler(recall_depth, text, capacity + 1)) {
+        return;
+    }
+
+    recall_depth++;
+    length = strlen(text);
+    cursor = length;
+    text_changed();
+}
+
+/**
+ * Moves the cursor, within the text.
+ *
+ * @param position The new position of the cursor.
+ */
+static void move_cursor(int position) {
+    if (position < 0) position = 0;
+    if (position > length) position = length;
+    cursor = position;
+    cursor_shown = true;
+}
+
+/**
+ * Tells the change handler the text changed.
+ */
+static void text_changed(void) {
+    revision++;
+    if (change_handler != NULL) {
+        change_handler(text);
+    }
+}
+
+/* ================================ Display ================================ */
+
+/**
+ * Draws the visible part of the line, with the cursor.
+ */
+static void draw_line(void) {
+    PROFILE_START(PROFILE_DRAW);
+    char line[MAX_DISPLAY_COLS + 1];
+
+    // Keep the cursor in view
+    if (cursor < scroll) {
+        scroll = cursor;
+    } else if (cursor >= scroll + text_width) {
+        scroll = cursor - text_width + 1;
+    }
+
+    for (int column = 0; column < text_width; column++) {
+        int index = scroll + column;
+        line[column] = index < length ? text[index] : ' ';
+    }
+    if (cursor_shown) {
+        line[cursor - scroll] = cursor_character();
+    }
+    line[text_width] = '\0';
+
+    os_SetCursorPos(line_row, text_column);
+    os_PutStrFull(line);
+    PROFILE_STOP(PROFILE_DRAW);
+}
+
+/**
+ * Gets the character of the cursor for the key mode.
+ *
+ * @return The font character to show.
+ */
+static char cursor_character(void) {
+    switch (key_mode) {
+        case KEYS_SECOND:     return EDITOR_CURSOR_2ND;
+        case KEYS_ALPHA:
+        case KEYS_ALPHA_LOCK: return EDITOR_CURSOR_ALPHA;
+        default:              return EDITOR_CURSOR;
+    }
+}
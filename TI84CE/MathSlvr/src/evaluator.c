@@ -4,8 +4,22 @@
 #include <ti/real.h>
 #include "headers/log.h"
 #include "headers/mathsolver.h"
+#include "headers/profile.h"
 #include "headers/evaluator_private.h"
 
+/** Program a sum or product is compiled to before it runs */
+static CompiledExpression loop_program;
+
+/** Whether a sum or product run by evaluate_expression did not get to its end */
+static bool loop_failed = false;
+
+/**
+ * True value of an operation whose formatted result is result. In normal
+ * arithmetic both are the same, so normal_expression is not evaluated.
+ */
+#define NORMAL_RESULT(format, result, normal_expression) \
+    ((format)->function == NULL ? (result) : (normal_expression))
+
 /*
  *  ___                        _            ___          _           _   _          
  * | __|_ ___ __ _ _ ___ _____(_)___ _ _   | __|_ ____ _| |_  _ __ _| |_(_)___ _ _  
@@ -17,166 +31,174 @@
  */
 
 /**
- * Evaluates an expression node.
+ * Evaluates an expression node, with the current arithmetic settings.
  * 
  * @param node Pointer to the expression node to evaluate.
  * @return The result of the evaluation.
  */
 real_t evaluate_expression(ExpressionNode* node) {
+    ArithmeticFormat format = get_arithmetic_format(current_arithmetic_type, current_precision,
+                                                    current_use_significant_digits);
+    return evaluate_node(node, &format);
+}
+
+/**
+ * Evaluates an expression node. Each value goes through the formatting
+ * selected by the caller, so in normal arithmetic nothing is formatted
+ * at all.
+ * 
+ * @param node Pointer to the expression node to evaluate.
+ * @param format The formatting of the arithmetic mode.
+ * @return The result of the evaluation.
+ */
+real_t evaluate_node(ExpressionNode* node, const ArithmeticFormat* format) {
     if (node == NULL) {
-        log_error("Null expression node");
+        LOG_ERROR("Null expression node");
         real_t zero = os_Int24ToReal(0);
         return zero;
     }
     
     switch (node->type) {
         case NODE_NUMBER: {
-            real_t value = node->number_value;
-            real_t result = apply_arithmetic_format(value);
+            real_t result = node->number_value;
+            APPLY_FORMAT(format, result);
             
-            char value_str[MAX_TOKEN_LENGTH];
-            char rst_str[MAX_TOKEN_LENGTH];
-            format_real(value, value_str);
-            format_real(result, rst_str);
-            log_message("Evaluating number: %s -> %s", value_str, rst_str);
+            LOG_OPERATION("Number", result);
             
             return result;
         }
         
         case NODE_VARIABLE: {
             bool found;
-            real_t value = get_variable(node->variable.name, &found);
-            real_t result = apply_arithmetic_format(value);
+            real_t result = get_symbol_value(node->variable.symbol, &found);
+            APPLY_FORMAT(format, result);
             
             if (!found) {
-                log_error("Undefined variable");
+                LOG_ERROR("Undefined variable");
             } else {
-                char value_str[MAX_TOKEN_LENGTH];
-                char rst_str[MAX_TOKEN_LENGTH];
-                format_real(value, value_str);
-                format_real(result, rst_str);
-                log_message("Variable evaluated: %s = %s -> %s", node->variable.name, value_str, rst_str);
+                LOG_VARIABLE(get_symbol_name(node->variable.symbol), result);
             }
             
             return result;
         }
         
         case NODE_ADDITION: {
-            real_t left = evaluate_expression(node->binary_op.left);
-            real_t right = evaluate_expression(node->binary_op.right);
-            real_t result = apply_arithmetic_format(os_RealAdd(&left, &right));
+            real_t left = evaluate_node(NODE_AT(node->binary_op.left), format);
+            real_t right = evaluate_node(NODE_AT(node->binary_op.right), format);
+            real_t result = real_add(left, right);
+            APPLY_FORMAT(format, result);
             
-            char rst_str[MAX_TOKEN_LENGTH];
-            format_real(result, rst_str);
-            log_operation("Addition", rst_str);
+            LOG_OPERATION("Addition", result);
             
             return result;
         }
         
         case NODE_SUBTRACTION: {
-            real_t left = evaluate_expression(node->binary_op.left);
-            real_t right = evaluate_expression(node->binary_op.right);
-            real_t result = apply_arithmetic_format(os_RealSub(&left, &right));
+            real_t left = evaluate_node(NODE_AT(node->binary_op.left), format);
+            real_t right = evaluate_node(NODE_AT(node->binary_op.right), format);
+            real_t result = real_sub(left, right);
+            APPLY_FORMAT(format, result);
             
-            char rst_str[MAX_TOKEN_LENGTH];
-            format_real(result, rst_str);
-            log_operation("Subtraction", rst_str);
+            LOG_OPERATION("Subtraction", result);
             
             return result;
         }
         
         case NODE_MULTIPLICATION: {
-            real_t left = evaluate_expression(node->binary_op.left);
-            real_t right = evaluate_expression(node->binary_op.right);
-            real_t result = apply_arithmetic_format(os_RealMul(&left, &right));
+            real_t left = evaluate_node(NODE_AT(node->binary_op.left), format);
+            real_t right = evaluate_node(NODE_AT(node->binary_op.right), format);
+            real_t result = real_mul(left, right);
+            APPLY_FORMAT(format, result);
             
-            char rst_str[MAX_TOKEN_LENGTH];
-            format_real(result, rst_str);
-            log_operation("Multiplication", rst_str);
+            LOG_OPERATION("Multiplication", result);
             
             return result;
         }
         
         case NODE_DIVISION: {
-            real_t left = evaluate_expression(node->binary_op.left);
-            real_t right = evaluate_expression(node->binary_op.right);
+            real_t left = evaluate_node(NODE_AT(node->binary_op.left), format);
+            real_t right = evaluate_node(NODE_AT(node->binary_op.right), format);
             
             real_t zero = os_Int24ToReal(0);
             if (os_RealCompare(&right, &zero) == 0) {
-                log_error("Division by zero");
+                LOG_ERROR("Division by zero");
                 return zero;
             }
             
-            real_t result = apply_arithmetic_format(os_RealDiv(&left, &right));
+            real_t result = real_div(left, right);
+            APPLY_FORMAT(format, result);
             
-            char rst_str[MAX_TOKEN_LENGTH];
-            format_real(result, rst_str);
-            log_operation("Division", rst_str);
+            LOG_OPERATION("Division", result);
             
             return result;
         }
         
         case NODE_EXPONENT: {
-            real_t left = evaluate_expression(node->binary_op.left);
-            real_t right = evaluate_expression(node->binary_op.right);
-            real_t result = apply_arithmetic_format(os_RealPow(&left, &right));
+            real_t left = evaluate_node(NODE_AT(node->binary_op.left), format);
+            real_t right = evaluate_node(NODE_AT(node->binary_op.right), format);
+            
+            if (!in_power_domain(left, right)) {
+                LOG_ERROR("Power is not a real number");
+                return ZERO;
+            }
             
-            char rst_str[MAX_TOKEN_LENGTH];
-            format_real(result, rst_str);
-            log_operation("Exponentiation", rst_str);
+            real_t result = real_pow(left, right);
+            APPLY_FORMAT(format, result);
+            
+            LOG_OPERATION("Exponentiation", result);
             
             return result;
         }
         
         case NODE_FUNCTION: {
-            real_t argument = evaluate_expression(node->function.argument);
-            real_t result = apply_arithmetic_format(
-                evaluate_function(node->function.func_type, argument)
-            );
+            real_t argument = evaluate_node(NODE_AT(node->function.argument), format);
+            real_t result = evaluate_function(node->function.func_type, argument);
+            APPLY_FORMAT(format, result);
             
-            char rst_str[MAX_TOKEN_LENGTH];
-            format_real(result, rst_str);
-            log_operation(get_function_name(node->function.func_type), rst_str);
+            LOG_OPERATION(get_function_name(node->function.func_type), result);
             
             return result;
         }
         
         case NODE_FACTORIAL: {
-            real_t value = evaluate_expression(node->factorial.expression);
-            
-            // Check if value is a non-negative integer
-            real_t rounded = os_RealRoundInt(&value);
-            real_t zero = os_Int24ToReal(0);
+            real_t value = evaluate_node(NODE_AT(node->factorial.expression), format);
+            real_t result;
             
-            if (os_RealCompare(&value, &zero) < 0 || 
-                os_RealCompare(&value, &rounded) != 0) {
+            FactorialStatus status = evaluate_factorial(value, &result);
+            if (status == FACTORIAL_DOMAIN_ERROR) {
                 // Handle error: factorial is only defined for non-negative integers
-                log_error("Factorial is only defined for non-negative integers");
-                return zero;
+                LOG_ERROR("Factorial is only defined for non-negative integers");
+                return ZERO;
+            } else if (status == FACTORIAL_OVERFLOW) {
+                LOG_ERROR("Factorial overflow");
+                return ZERO;
             }
             
-            int24_t n = os_RealToInt24(&value);
-            real_t result = os_Int24ToReal(1);
+            APPLY_FORMAT(format, result);
             
-            for (int i = 2; i <= n; i++) {
-                real_t i_real = os_Int24ToReal(i);
-                result = os_RealMul(&result, &i_real);
-            }
-            
-            result = apply_arithmetic_format(result);
-            
-            char rst_str[MAX_TOKEN_LENGTH];
-            format_real(result, rst_str);
-            log_operation("Factorial", rst_str);
+            LOG_OPERATION("Factorial", result);
             
             return result;
         }
         
         case NODE_PARENTHESIS:
-            return evaluate_expression(node->parenthesis.expression);
+            return evaluate_node(NODE_AT(node->parenthesis.expression), format);
+        
+        case NODE_SUMMATION:
+        case NODE_PRODUCT: {
+            LoopStatus status;
+            real_t result = evaluate_loop(node, format, &status);
+            if (status != LOOP_OK) {
+                loop_failed = true;
+            }
+            
+            LOG_OPERATION(node->type == NODE_SUMMATION ? "Sum" : "Product", result);
+            
+            return result;
+        }
         
         default:
-            log_error("Unknown node type");
+            LOG_ERROR("Unknown node type");
             real_t zero = os_Int24ToReal(0);
             return zero;
     }
@@ -190,37 +212,55 @@ real_t evaluate_expression(ExpressionNode* node) {
  * @return True if the evaluation is successful, false otherwise.
  */
 bool evaluate_expression_string(const char* input, CalculationResult* result) {
-    log_message("Beginning expression evaluation.");
+    LOG_INFO("Beginning expression evaluation.");
     // Parse the expression
     ExpressionNode* root = parse_expression_string(input);
     if (root == NULL) return false;
 
+    evaluate_parsed_expression(root, result);
+    return true;
+}
+
+/**
+ * Evaluates the expression being typed, for a preview of its value.
+ * Nothing is recorded or cached; a sum or product stops when the loop
+ * progress handler tells it to.
+ * 
+ * @param root Pointer to the root node returned by the parser.
+ * @param value Pointer set to the value.
+ * @return True if every sum and product ran to its end, false otherwise.
+ */
+bool evaluate_preview(ExpressionNode* root, real_t* value) {
+    loop_failed = false;
+    PROFILE_START(PROFILE_EVALUATE);
+    *value = evaluate_expression(root);
+    PROFILE_STOP(PROFILE_EVALUATE);
+    return !loop_failed;
+}
+
+/**
+ * Evaluates an expression that was already parsed, with the current
+ * arithmetic settings. The tree stays valid until the next parse, so a
+ * result can be recomputed after the settings change without parsing
+ * the input again.
+ * 
+ * @param root Pointer to the root node returned by the parser.
+ * @param result Pointer to the structure to store the result.
+ */
+void evaluate_parsed_expression(ExpressionNode* root, CalculationResult* result) {
     // Initialize the result
     memset(result, 0, sizeof(CalculationResult));
     result->arithmetic_mode = current_arithmetic_type;
     result->precision = current_precision;
     result->use_significant_digits = current_use_significant_digits;
 
-    ArithmeticType cm = get_arithmetic_mode();
-    
-    if (cm != ARITHMETIC_NORMAL) {
-        /*
-         * We evaluate in normal mode only if the current mode is not normal.
-         */
-        int cp = get_precision();
-        bool cd = get_use_significant_digits();
-
-        set_arithmetic_mode(ARITHMETIC_NORMAL, 9, false);
-        result->normal_value = evaluate_expression(root);
-        set_arithmetic_mode(cm, cp, cd);
-    }
-
-    result->value = evaluate_with_steps(root, result);
+    // One traversal yields both the formatted value and the true value
+    PROFILE_START(PROFILE_EVALUATE);
+    result->value = evaluate_with_steps(root, result, &result->normal_value);
+    PROFILE_STOP(PROFILE_EVALUATE);
     
     // Format the final result
     format_real(result->value, result->formatted_result);
-    
-    return true;
 }
 
 char* node_to_string(ExpressionNode* node) {
@@ -233,31 +273,37 @@ char* node_to_string(ExpressionNode* node) {
             sprintf(buffer, "%s", temp);
             break;
         case NODE_VARIABLE:
-            sprintf(buffer, "%s", node->variable.name);
+            sprintf(buffer, "%s", get_symbol_name(node->variable.symbol));
             break;
         case NODE_ADDITION:
-            sprintf(buffer, "(%s + %s)", node_to_string(node->binary_op.left), node_to_string(node->binary_op.right));
+            sprintf(buffer, "(%s + %s)", node_to_string(NODE_AT(node->binary_op.left)), node_to_string(NODE_AT(node->binary_op.right)));
             break;
         case NODE_SUBTRACTION:
-            sprintf(buffer, "(%s - %s)", node_to_string(node->binary_op.left), node_to_string(node->binary_op.right));
+            sprintf(buffer, "(%s - %s)", node_to_string(NODE_AT(node->binary_op.left)), node_to_string(NODE_AT(node->binary_op.right)));
             break;
         case NODE_MULTIPLICATION:
-            sprintf(buffer, "(%s * %s)", node_to_string(node->binary_op.left), node_to_string(node->binary_op.right));
+            sprintf(buffer, "(%s * %s)", node_to_string(NODE_AT(node->binary_op.left)), node_to_string(NODE_AT(node->binary_op.right)));
             break;
         case NODE_DIVISION:
-            sprintf(buffer, "(%s / %s)", node_to_string(node->binary_op.left), node_to_string(node->binary_op.right));
+            sprintf(buffer, "(%s / %s)", node_to_string(NODE_AT(node->binary_op.left)), node_to_string(NODE_AT(node->binary_op.right)));
             break;
         case NODE_EXPONENT:
-            sprintf(buffer, "(%s ^ %s)", node_to_string(node->binary_op.left), node_to_string(node->binary_op.right));
+            sprintf(buffer, "(%s ^ %s)", node_to_string(NODE_AT(node->binary_op.left)), node_to_string(NODE_AT(node->binary_op.right)));
             break;
         case NODE_FUNCTION:
-            sprintf(buffer, "%s(%s)", get_function_name(node->function.func_type), node_to_string(node->function.argument));
+            sprintf(buffer, "%s(%s)", get_function_name(node->function.func_type), node_to_string(NODE_AT(node->function.argument)));
             break;
         case NODE_FACTORIAL:
-            sprintf(buffer, "%s!", node_to_string(node->factorial.expression));
+            sprintf(buffer, "%s!", node_to_string(NODE_AT(node->factorial.expression)));
             break;
         case NODE_PARENTHESIS:
-            sprintf(buffer, "(%s)", node_to_string(node->parenthesis.expression));
+            sprintf(buffer, "(%s)", node_to_string(NODE_AT(node->parenthesis.expression)));
+            break;
+        case NODE_SUMMATION:
+        case NODE_PRODUCT:
+            sprintf(buffer, "%s(%s, %s, %s, %s)", node->type == NODE_SUMMATION ? "sum" : "prod",
+                    node_to_string(NODE_AT(node->iterator.body)), get_symbol_name(node->iterator.symbol),
+                    node_to_string(NODE_AT(node->iterator.start)), node_to_string(NODE_AT(node->iterator.end)));
             break;
         default:
             sprintf(buffer, "Unknown node type");
@@ -276,288 +322,302 @@ char* result_to_string(CalculationResult* result) {
 
 /**
  * Evaluates an expression with step-by-step tracking.
+ * The value formatted by the current arithmetic mode and the true value
+ * of each node are carried up together, so a single traversal produces both.
+ * In normal arithmetic they are the same, and each operation runs once.
+ * Steps only keep raw operands; nothing is formatted until a step is shown.
  * 
  * @param node Pointer to the expression node to evaluate.
  * @param result Pointer to the structure to store the evaluation steps.
- * @return The result of the evaluation.
+ * @param normal_value Pointer to store the value computed in normal arithmetic.
+ * @return The result of the evaluation, formatted by the current arithmetic mode.
  */
-real_t evaluate_with_steps(ExpressionNode* node, CalculationResult* result) {
-    log_debug("Evaluating expression with steps.");
-    log_message("Node: %s", node_to_string(node));
-    log_message("Result: %s", result_to_string(result));    
+real_t evaluate_with_steps(ExpressionNode* node, CalculationResult* result, real_t* normal_value) {
+    ArithmeticFormat format = get_arithmetic_format(current_arithmetic_type, current_precision,
+                                                    current_use_significant_digits);
+    return evaluate_steps(node, &format, result, normal_value);
+}
 
+/**
+ * Evaluates an expression with step-by-step tracking, formatting each
+ * value with the formatting selected by evaluate_with_steps.
+ * 
+ * @param node Pointer to the expression node to evaluate.
+ * @param format The formatting of the arithmetic mode.
+ * @param result Pointer to the structure to store the evaluation steps.
+ * @param normal_value Pointer to store the value computed in normal arithmetic.
+ * @return The result of the evaluation, formatted by the arithmetic mode.
+ */
+static real_t evaluate_steps(ExpressionNode* node, const ArithmeticFormat* format,
+                             CalculationResult* result, real_t* normal_value) {
     if (node == NULL) {
-        real_t zero = os_Int24ToReal(0);
-        return zero;
+        *normal_value = ZERO;
+        return ZERO;
     }
     
     switch (node->type) {
         case NODE_NUMBER: {
             real_t value = node->number_value;
-            real_t rst = apply_arithmetic_format(value);
-            
-            char rst_str[MAX_TOKEN_LENGTH];
-            format_real(rst, rst_str);
-            log_operation("Number", rst_str);
+            *normal_value = value;
             
             // No step needed for a simple number
-            return rst;
+            APPLY_FORMAT(format, value);
+            return value;
         }
         
         case NODE_VARIABLE: {
             bool found;
-            real_t value = get_variable(node->variable.name, &found);
-            
-            if (found && result->step_count < MAX_STEPS) {
-                // Record the variable substitution step
-                CalculationStep* step = &result->steps[result->step_count++];
-                
-                sprintf(step->expression, "%s", node->variable.name);
-                sprintf(step->operation, "Substitute variable %s", node->variable.name);
-                format_real(value, step->result);
-            }
+            real_t value = get_symbol_value(node->variable.symbol, &found);
+            *normal_value = value;
             
             if (!found) {
                 // Handle undefined variable
-                real_t zero = os_Int24ToReal(0);
-                return zero;
+                return ZERO;
             }
             
+            // Record the variable substitution step
+            record_step(result, node, STEP_SUBSTITUTE, STEP_NO_OPERAND, 0, ZERO, ZERO, value);
             return value;
         }
         
         case NODE_ADDITION: {
-            real_t left = evaluate_with_steps(node->binary_op.left, result);
-            real_t right = evaluate_with_steps(node->binary_op.right, result);
-            real_t operation_result = os_RealAdd(&left, &right);
-            real_t formatted_result = apply_arithmetic_format(operation_result);
-
-            if (result->step_count < MAX_STEPS) {
-                CalculationStep* step = &result->steps[result->step_count++];
-                char left_str[MAX_TOKEN_LENGTH], right_str[MAX_TOKEN_LENGTH];
-                format_real(left, left_str);
-                format_real(right, right_str);
-
-                sprintf(step->expression, "%s + %s", left_str, right_str);
-                sprintf(step->operation, "Add");
-                format_real(formatted_result, step->result);
-                strcpy(step->left_operand, left_str);
-                strcpy(step->right_operand, right_str);
-                step->type = STEP_BINARY;
-            }
+            real_t left_normal, right_normal;
+            real_t left = evaluate_steps(NODE_AT(node->binary_op.left), format, result, &left_normal);
+            real_t right = evaluate_steps(NODE_AT(node->binary_op.right), format, result, &right_normal);
+            real_t formatted_result = real_add(left, right);
+            *normal_value = NORMAL_RESULT(format, formatted_result, real_add(left_normal, right_normal));
+            APPLY_FORMAT(format, formatted_result);
 
+            record_step(result, node, STEP_ADD, STEP_BINARY, 0, left, right, formatted_result);
             return formatted_result;
         }
         
         case NODE_SUBTRACTION: {
-            real_t left = evaluate_with_steps(node->binary_op.left, result);
-            real_t right = evaluate_with_steps(node->binary_op.right, result);
-            real_t operation_result = os_RealSub(&left, &right);
-            real_t formatted_result = apply_arithmetic_format(operation_result);
-
-            if (result->step_count < MAX_STEPS) {
-                CalculationStep* step = &result->steps[result->step_count++];
-                char left_str[MAX_TOKEN_LENGTH], right_str[MAX_TOKEN_LENGTH];
-                format_real(left, left_str);
-                format_real(right, right_str);
-
-                sprintf(step->expression, "%s - %s", left_str, right_str);
-                sprintf(step->operation, "Subtract");
-                format_real(formatted_result, step->result);
-                strcpy(step->left_operand, left_str);
-                strcpy(step->right_operand, right_str);
-                step->type = STEP_BINARY;
-            }
+            real_t left_normal, right_normal;
+            real_t left = evaluate_steps(NODE_AT(node->binary_op.left), format, result, &left_normal);
+            real_t right = evaluate_steps(NODE_AT(node->binary_op.right), format, result, &right_normal);
+            real_t formatted_result = real_sub(left, right);
+            *normal_value = NORMAL_RESULT(format, formatted_result, real_sub(left_normal, right_normal));
+            APPLY_FORMAT(format, formatted_result);
 
+            record_step(result, node, STEP_SUBTRACT, STEP_BINARY, 0, left, right, formatted_result);
             return formatted_result;
         }
         
         case NODE_MULTIPLICATION: {
-            real_t left = evaluate_with_steps(node->binary_op.left, result);
-            real_t right = evaluate_with_steps(node->binary_op.right, result);
-            real_t operation_result = os_RealMul(&left, &right);
-            real_t formatted_result = apply_arithmetic_format(operation_result);
-
-            if (result->step_count < MAX_STEPS) {
-                CalculationStep* step = &result->steps[result->step_count++];
-                char left_str[MAX_TOKEN_LENGTH], right_str[MAX_TOKEN_LENGTH];
-                format_real(left, left_str);
-                format_real(right, right_str);
-
-                sprintf(step->expression, "%s * %s", left_str, right_str);
-                sprintf(step->operation, "Multiply");
-                format_real(formatted_result, step->result);
-                strcpy(step->left_operand, left_str);
-                strcpy(step->right_operand, right_str);
-                step->type = STEP_BINARY;
-            }
+            real_t left_normal, right_normal;
+            real_t left = evaluate_steps(NODE_AT(node->binary_op.left), format, result, &left_normal);
+            real_t right = evaluate_steps(NODE_AT(node->binary_op.right), format, result, &right_normal);
+            real_t formatted_result = real_mul(left, right);
+            *normal_value = NORMAL_RESULT(format, formatted_result, real_mul(left_normal, right_normal));
+            APPLY_FORMAT(format, formatted_result);
 
+            record_step(result, node, STEP_MULTIPLY, STEP_BINARY, 0, left, right, formatted_result);
             return formatted_result;
         }
         
         case NODE_DIVISION: {
-            real_t left = evaluate_with_steps(node->binary_op.left, result);
-            real_t right = evaluate_with_steps(node->binary_op.right, result);
+            real_t left_normal, right_normal;
+            real_t left = evaluate_steps(NODE_AT(node->binary_op.left), format, result, &left_normal);
+            real_t right = evaluate_steps(NODE_AT(node->binary_op.right), format, result, &right_normal);
+            
+            // In normal arithmetic the true value is the formatted one, set below
+            *normal_value = ZERO;
+            if (format->function != NULL && os_RealCompare(&right_normal, &ZERO) != 0) {
+                *normal_value = real_div(left_normal, right_normal);
+            }
             
-            real_t zero = os_Int24ToReal(0);
-            if (os_RealCompare(&right, &zero) == 0) {
-                if (result->step_count < MAX_STEPS) {
-                    CalculationStep* step = &result->steps[result->step_count++];
-                    sprintf(step->expression, "Division by zero");
-                    sprintf(step->operation, "Error");
-                    sprintf(step->result, "Undefined");
-                    step->type = STEP_BINARY;
-                }
-                return zero;
+            if (os_RealCompare(&right, &ZERO) == 0) {
+                record_step(result, node, STEP_DIVISION_BY_ZERO, STEP_BINARY, 0, left, right, ZERO);
+                return ZERO;
             }
             
-            real_t operation_result = os_RealDiv(&left, &right);
-            real_t formatted_result = apply_arithmetic_format(operation_result);
-
-            if (result->step_count < MAX_STEPS) {
-                CalculationStep* step = &result->steps[result->step_count++];
-                char left_str[MAX_TOKEN_LENGTH], right_str[MAX_TOKEN_LENGTH];
-                format_real(left, left_str);
-                format_real(right, right_str);
-
-                sprintf(step->expression, "%s / %s", left_str, right_str);
-                sprintf(step->operation, "Divide");
-                format_real(formatted_result, step->result);
-                strcpy(step->left_operand, left_str);
-                strcpy(step->right_operand, right_str);
-                step->type = STEP_BINARY;
+            real_t formatted_result = real_div(left, right);
+            if (format->function == NULL) {
+                *normal_value = formatted_result;
             }
+            APPLY_FORMAT(format, formatted_result);
 
+            record_step(result, node, STEP_DIVIDE, STEP_BINARY, 0, left, right, formatted_result);
             return formatted_result;
         }
         
         case NODE_EXPONENT: {
-            real_t base = evaluate_with_steps(node->binary_op.left, result);
-            real_t exponent = evaluate_with_steps(node->binary_op.right, result);
-            real_t operation_result = os_RealPow(&base, &exponent);
-            real_t formatted_result = apply_arithmetic_format(operation_result);
-            
-            if (result->step_count < MAX_STEPS) {
-                // Record the exponentiation step
-                CalculationStep* step = &result->steps[result->step_count++];
-                
-                char base_str[MAX_TOKEN_LENGTH];
-                char exponent_str[MAX_TOKEN_LENGTH];
-                format_real(base, base_str);
-                format_real(exponent, exponent_str);
-                
-                sprintf(step->expression, "%s ^ %s", base_str, exponent_str);
-                sprintf(step->operation, "Raise %s to power %s", base_str, exponent_str);
-                format_real(formatted_result, step->result);
+            real_t base_normal, exponent_normal;
+            real_t base = evaluate_steps(NODE_AT(node->binary_op.left), format, result, &base_normal);
+            real_t exponent = evaluate_steps(NODE_AT(node->binary_op.right), format, result, &exponent_normal);
+            
+            // Handle domain errors
+            if (!in_power_domain(base, exponent)) {
+                *normal_value = ZERO;
+                record_step(result, node, STEP_POWER_ERROR, STEP_BINARY, 0, base, exponent, ZERO);
+                return ZERO;
             }
             
+            real_t formatted_result = real_pow(base, exponent);
+            *normal_value = NORMAL_RESULT(format, formatted_result,
+                                          in_power_domain(base_normal, exponent_normal) ?
+                                          real_pow(base_normal, exponent_normal) : ZERO);
+            APPLY_FORMAT(format, formatted_result);
+            
+            record_step(result, node, STEP_POWER, STEP_BINARY, 0, base, exponent, formatted_result);
             return formatted_result;
         }
         
         case NODE_FUNCTION: {
-            real_t argument = evaluate_with_steps(node->function.argument, result);
-            const char* func_name = get_function_name(node->function.func_type);
-            
-            // Handle domain errors
-            bool domain_error = false;
-            real_t zero = os_Int24ToReal(0);
-            
-            if ((node->function.func_type == FUNC_LOG || node->function.func_type == FUNC_LN) && 
-                os_RealCompare(&argument, &zero) <= 0) {
-                domain_error = true;
-            } else if (node->function.func_type == FUNC_SQRT && 
-                      os_RealCompare(&argument, &zero) < 0) {
-                domain_error = true;
+            FunctionType func_type = node->function.func_type;
+            real_t argument_normal;
+            real_t argument = evaluate_steps(NODE_AT(node->function.argument), format, result, &argument_normal);
+            // In normal arithmetic the true value is the formatted one, set below
+            *normal_value = ZERO;
+            if (format->function != NULL && in_function_domain(func_type, argument_normal)) {
+                *normal_value = evaluate_function(func_type, argument_normal);
             }
             
-            if (domain_error) {
-                if (result->step_count < MAX_STEPS) {
-                    CalculationStep* step = &result->steps[result->step_count++];
-                    
-                    sprintf(step->expression, "%s domain error", func_name);
-                    sprintf(step->operation, "Error");
-                    sprintf(step->result, "Undefined");
-                }
-                return zero;
+            // Handle domain errors
+            if (!in_function_domain(func_type, argument)) {
+                record_step(result, node, STEP_DOMAIN_ERROR, STEP_UNARY_RIGHT, func_type, ZERO, argument, ZERO);
+                return ZERO;
             }
             
-            real_t operation_result = evaluate_function(node->function.func_type, argument);
-            real_t formatted_result = apply_arithmetic_format(operation_result);
-            
-            if (result->step_count < MAX_STEPS) {
-                // Record the function evaluation step
-                CalculationStep* step = &result->steps[result->step_count++];
-                
-                char arg_str[MAX_TOKEN_LENGTH];
-                format_real(argument, arg_str);
-                
-                sprintf(step->expression, "%s(%s)", func_name, arg_str);
-                sprintf(step->operation, "Calculate %s of %s", func_name, arg_str);
-                format_real(formatted_result, step->result);
+            real_t formatted_result = evaluate_function(func_type, argument);
+            if (format->function == NULL) {
+                *normal_value = formatted_result;
             }
+            APPLY_FORMAT(format, formatted_result);
             
+            record_step(result, node, STEP_FUNCTION, STEP_UNARY_RIGHT, func_type, ZERO, argument, formatted_result);
             return formatted_result;
         }
         
         case NODE_FACTORIAL: {
-            real_t expression_value = evaluate_with_steps(node->factorial.expression, result);
-            
-            // Check if value is a non-negative integer
-            real_t rounded = os_RealRoundInt(&expression_value);
-            real_t zero = os_Int24ToReal(0);
-            
-            if (os_RealCompare(&expression_value, &zero) < 0 || 
-                os_RealCompare(&expression_value, &rounded) != 0) {
-                if (result->step_count < MAX_STEPS) {
-                    CalculationStep* step = &result->steps[result->step_count++];
-                    sprintf(step->expression, "Factorial domain error");
-                    sprintf(step->operation, "Error");
-                    sprintf(step->result, "Undefined");
-                    step->type = STEP_UNARY_LEFT;
-                }
-                return zero;
+            real_t expression_normal;
+            real_t expression_value = evaluate_steps(NODE_AT(node->factorial.expression), format, result, &expression_normal);
+            real_t operation_result;
+            
+            // In normal arithmetic the true value is the formatted one, set below
+            *normal_value = ZERO;
+            if (format->function != NULL) {
+                evaluate_factorial(expression_normal, normal_value);
             }
             
-            int24_t n = os_RealToInt24(&expression_value);
-            real_t operation_result = os_Int24ToReal(1);
-            
-            for (int i = 2; i <= n; i++) {
-                real_t i_real = os_Int24ToReal(i);
-                operation_result = os_RealMul(&operation_result, &i_real);
+            FactorialStatus status = evaluate_factorial(expression_value, &operation_result);
+            if (status != FACTORIAL_OK) {
+                StepOperation error = status == FACTORIAL_OVERFLOW ? STEP_FACTORIAL_OVERFLOW : STEP_FACTORIAL_ERROR;
+                record_step(result, node, error, STEP_UNARY_LEFT, 0, expression_value, ZERO, ZERO);
+                return ZERO;
             }
             
-            real_t formatted_result = apply_arithmetic_format(operation_result);
-
-            if (result->step_count < MAX_STEPS) {
-                CalculationStep* step = &result->steps[result->step_count++];
-                char expr_str[MAX_TOKEN_LENGTH];
-                format_real(expression_value, expr_str);
-
-                sprintf(step->expression, "%s!", expr_str);
-                sprintf(step->operation, "Factorial");
-                format_real(formatted_result, step->result);
-                strcpy(step->left_operand, expr_str);
-                step->right_operand[0] = '\0'; // No right operand
-                step->type = STEP_UNARY_LEFT;
+            real_t formatted_result = operation_result;
+            if (format->function == NULL) {
+                *normal_value = formatted_result;
             }
+            APPLY_FORMAT(format, formatted_result);
 
+            record_step(result, node, STEP_FACTORIAL, STEP_UNARY_LEFT, 0, expression_value, ZERO, formatted_result);
             return formatted_result;
         }
         
         case NODE_PARENTHESIS: {
             // Evaluate the expression inside the parentheses
-            real_t value = evaluate_with_steps(node->parenthesis.expression, result);
+            real_t value = evaluate_steps(NODE_AT(node->parenthesis.expression), format, result, normal_value);
             
             // We don't add a separate step for parentheses
             return value;
         }
         
+        case NODE_SUMMATION:
+        case NODE_PRODUCT: {
+            // Once ON was pressed, the loops left are not run
+            if (result->interrupted) {
+                *normal_value = ZERO;
+                return ZERO;
+            }
+            
+            // The bounds are shown with the step, the terms are not
+            real_t start = evaluate_node(NODE_AT(node->iterator.start), format);
+            real_t end = evaluate_node(NODE_AT(node->iterator.end), format);
+            
+            LoopStatus status;
+            real_t formatted_result = evaluate_loop(node, format, &status);
+            *normal_value = formatted_result;
+            if (status == LOOP_OK && format->function != NULL) {
+                // The true value takes a second run in normal arithmetic
+                ArithmeticFormat normal = { NULL, 0 };
+                *normal_value = evaluate_loop(node, &normal, &status);
+            }
+            
+            if (status != LOOP_OK) {
+                StepOperation error = status == LOOP_INTERRUPTED ? STEP_INTERRUPTED : STEP_BOUNDS_ERROR;
+                result->interrupted = status == LOOP_INTERRUPTED;
+                record_step(result, node, error, STEP_RANGE, node->type, start, end, ZERO);
+                *normal_value = ZERO;
+                return ZERO;
+            }
+            
+            StepOperation operation = node->type == NODE_SUMMATION ? STEP_SUMMATION : STEP_PRODUCT;
+            record_step(result, node, operation, STEP_RANGE, 0, start, end, formatted_result);
+            return formatted_result;
+        }
+        
         default:
             // Should never happen
+            *normal_value = ZERO;
             return ZERO;
     }
 }
 
+/**
+ * Appends a step to a calculation result, if it can still keep one.
+ * 
+ * @param result Pointer to the calculation result.
+ * @param node Pointer to the node the step is taken from.
+ * @param operation The operation performed.
+ * @param type The layout of the operands.
+ * @param detail Operation detail (e.g., the function type).
+ * @param left The left operand.
+ * @param right The right operand.
+ * @param value The result of the operation.
+ */
+static void record_step(CalculationResult* result, ExpressionNode* node, StepOperation operation,
+                        StepType type, uint8_t detail, real_t left, real_t right, real_t value) {
+    CalculationStep* step = next_step(result);
+    if (step == NULL) {
+        return;
+    }
+
+    step->operation = (uint8_t)operation;
+    step->type = (uint8_t)type;
+    step->detail = detail;
+    step->span_start = node->span_start;
+    step->span_length = node->span_length;
+    step->left = left;
+    step->right = right;
+    step->result = value;
+}
+
+/**
+ * Runs a sum or product. The node is compiled once, so its body is not
+ * walked again for every value of the variable: the whole loop runs in
+ * the bytecode VM.
+ * 
+ * @param node Pointer to the sum or product node.
+ * @param format The formatting of the arithmetic mode.
+ * @param status Pointer set to the outcome of the loop.
+ * @return The value of the sum or product, or zero if it did not run to its end.
+ */
+static real_t evaluate_loop(ExpressionNode* node, const ArithmeticFormat* format, LoopStatus* status) {
+    if (!compile_expression(node, &loop_program)) {
+        // Nested too deep for the VM; reported like bounds it cannot run
+        *status = LOOP_BOUNDS_ERROR;
+        return ZERO;
+    }
+    
+    real_t value = run_program(&loop_program, format);
+    *status = get_loop_status();
+    return value;
+}
+
 /*
  *  ___             _   _            ___          _           _   _          
  * | __|  _ _ _  __| |_(_)___ _ _   | __|_ ____ _| |_  _ __ _| |_(_)___ _ _  
@@ -573,7 +633,7 @@ real_t evaluate_with_steps(ExpressionNode* node, CalculationResult* result) {
  * @param func_type The type of the function.
  * @return The name of the function as a string.
  */
-static const char* get_function_name(FunctionType func_type) {
+const char* get_function_name(FunctionType func_type) {
     switch (func_type) {
         case FUNC_SIN:  return "sin";
         case FUNC_COS:  return "cos";
@@ -585,6 +645,47 @@ static const char* get_function_name(FunctionType func_type) {
     }
 }
 
+/**
+ * Tells whether a value is in the domain of a mathematical function.
+ * 
+ * @param func_type The type of the function.
+ * @param argument The argument to the function.
+ * @return True if the function is defined there, false otherwise.
+ */
+bool in_function_domain(FunctionType func_type, real_t argument) {
+    switch (func_type) {
+        case FUNC_LOG:
+        case FUNC_LN:
+            return os_RealCompare(&argument, &ZERO) > 0;
+        
+        case FUNC_SQRT:
+            return os_RealCompare(&argument, &ZERO) >= 0;
+        
+        default:
+            return true;
+    }
+}
+
+/**
+ * Tells whether a power is a real number: zero only has positive powers,
+ * and a negative number only has integer ones.
+ * 
+ * @param base The base of the power.
+ * @param exponent The exponent of the power.
+ * @return True if the power is defined, false otherwise.
+ */
+bool in_power_domain(real_t base, real_t exponent) {
+    int sign = os_RealCompare(&base, &ZERO);
+    if (sign == 0) {
+        return os_RealCompare(&exponent, &ZERO) > 0;
+    }
+    if (sign < 0) {
+        real_t whole = os_RealRoundInt(&exponent);
+        return os_RealCompare(&whole, &exponent) == 0;
+    }
+    return true;
+}
+
 /**
  * Evaluates a mathematical function.
  * 
@@ -592,7 +693,7 @@ static const char* get_function_name(FunctionType func_type) {
  * @param argument The argument to the function.
  * @return The result of the function evaluation.
  */
-static real_t evaluate_function(FunctionType func_type, real_t argument) {
+real_t evaluate_function(FunctionType func_type, real_t argument) {
     switch (func_type) {
         case FUNC_SIN:
             return os_RealSinRad(&argument);
@@ -612,10 +713,7 @@ static real_t evaluate_function(FunctionType func_type, real_t argument) {
             }
             
             // Convert ln(x) to log10(x) by dividing by ln(10)
-            real_t ln_result = os_RealLog(&argument);
-            real_t ten = os_Int24ToReal(10);
-            real_t ln_ten = os_RealLog(&ten);
-            return os_RealDiv(&ln_result, &ln_ten);
+            return real_div(os_RealLog(&argument), LOG10);
         }
         
         case FUNC_LN: {
@@ -642,3 +740,107 @@ static real_t evaluate_function(FunctionType func_type, real_t argument) {
             return ZERO;
     }
 }
+
+/**
+ * Factorials from 0! to MAX_FACTORIAL!, rounded to the 14 digits of a real_t.
+ * 70! is past 10^100 and does not fit.
+ */
+static const real_t FACTORIALS[MAX_FACTORIAL + 1] = {
+    REAL_LITERAL(0x00, 0x80, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00), /* 0! */
+    REAL_LITERAL(0x00, 0x80, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00), /* 1! */
+    REAL_LITERAL(0x00, 0x80, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00), /* 2! */
+    REAL_LITERAL(0x00, 0x80, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00), /* 3! */
+    REAL_LITERAL(0x00, 0x81, 0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00), /* 4! */
+    REAL_LITERAL(0x00, 0x82, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00), /* 5! */
+    REAL_LITERAL(0x00, 0x82, 0x72, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00), /* 6! */
+    REAL_LITERAL(0x00, 0x83, 0x50, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00), /* 7! */
+    REAL_LITERAL(0x00, 0x84, 0x40, 0x32, 0x00, 0x00, 0x00, 0x00, 0x00), /* 8! */
+    REAL_LITERAL(0x00, 0x85, 0x36, 0x28, 0x80, 0x00, 0x00, 0x00, 0x00), /* 9! */
+    REAL_LITERAL(0x00, 0x86, 0x36, 0x28, 0x80, 0x00, 0x00, 0x00, 0x00), /* 10! */
+    REAL_LITERAL(0x00, 0x87, 0x39, 0x91, 0x68, 0x00, 0x00, 0x00, 0x00), /* 11! */
+    REAL_LITERAL(0x00, 0x88, 0x47, 0x90, 0x01, 0x60, 0x00, 0x00, 0x00), /* 12! */
+    REAL_LITERAL(0x00, 0x89, 0x62, 0x27, 0x02, 0x08, 0x00, 0x00, 0x00), /* 13! */
+    REAL_LITERAL(0x00, 0x8A, 0x87, 0x17, 0x82, 0x91, 0x20, 0x00, 0x00), /* 14! */
+    REAL_LITERAL(0x00, 0x8C, 0x13, 0x07, 0x67, 0x43, 0x68, 0x00, 0x00), /* 15! */
+    REAL_LITERAL(0x00, 0x8D, 0x20, 0x92, 0x27, 0x89, 0x88, 0x80, 0x00), /* 16! */
+    REAL_LITERAL(0x00, 0x8E, 0x35, 0x56, 0x87, 0x42, 0x80, 0x96, 0x00), /* 17! */
+    REAL_LITERAL(0x00, 0x8F, 0x64, 0x02, 0x37, 0x37, 0x05, 0x72, 0x80), /* 18! */
+    REAL_LITERAL(0x00, 0x91, 0x12, 0x16, 0x45, 0x10, 0x04, 0x08, 0x83), /* 19! */
+    REAL_LITERAL(0x00, 0x92, 0x24, 0x32, 0x90, 0x20, 0x08, 0x17, 0x66), /* 20! */
+    REAL_LITERAL(0x00, 0x93, 0x51, 0x09, 0x09, 0x42, 0x17, 0x17, 0x09), /* 21! */
+    REAL_LITERAL(0x00, 0x95, 0x11, 0x24, 0x00, 0x07, 0x27, 0x77, 0x76), /* 22! */
+    REAL_LITERAL(0x00, 0x96, 0x25, 0x85, 0x20, 0x16, 0x73, 0x88, 0x85), /* 23! */
+    REAL_LITERAL(0x00, 0x97, 0x62, 0x04, 0x48, 0x40, 0x17, 0x33, 0x24), /* 24! */
+    REAL_LITERAL(0x00, 0x99, 0x15, 0x51, 0x12, 0x10, 0x04, 0x33, 0x31), /* 25! */
+    REAL_LITERAL(0x00, 0x9A, 0x40, 0x32, 0x91, 0x46, 0x11, 0x26, 0x61), /* 26! */
+    REAL_LITERAL(0x00, 0x9C, 0x10, 0x88, 0x88, 0x69, 0x45, 0x04, 0x18), /* 27! */
+    REAL_LITERAL(0x00, 0x9D, 0x30, 0x48, 0x88, 0x34, 0x46, 0x11, 0x71), /* 28! */
+    REAL_LITERAL(0x00, 0x9E, 0x88, 0x41, 0x76, 0x19, 0x93, 0x73, 0x97), /* 29! */
+    REAL_LITERAL(0x00, 0xA0, 0x26, 0x52, 0x52, 0x85, 0x98, 0x12, 0x19), /* 30! */
+    REAL_LITERAL(0x00, 0xA1, 0x82, 0x22, 0x83, 0x86, 0x54, 0x17, 0x79), /* 31! */
+    REAL_LITERAL(0x00, 0xA3, 0x26, 0x31, 0x30, 0x83, 0x69, 0x33, 0x69), /* 32! */
+    REAL_LITERAL(0x00, 0xA4, 0x86, 0x83, 0x31, 0x76, 0x18, 0x81, 0x19), /* 33! */
+    REAL_LITERAL(0x00, 0xA6, 0x29, 0x52, 0x32, 0x79, 0x90, 0x39, 0x60), /* 34! */
+    REAL_LITERAL(0x00, 0xA8, 0x10, 0x33, 0x31, 0x47, 0x96, 0x63, 0x86), /* 35! */
+    REAL_LITERAL(0x00, 0xA9, 0x37, 0x19, 0x93, 0x32, 0x67, 0x89, 0x90), /* 36! */
+    REAL_LITERAL(0x00, 0xAB, 0x13, 0x76, 0x37, 0x53, 0x09, 0x12, 0x26), /* 37! */
+    REAL_LITERAL(0x00, 0xAC, 0x52, 0x30, 0x22, 0x61, 0x74, 0x66, 0x60), /* 38! */
+    REAL_LITERAL(0x00, 0xAE, 0x20, 0x39, 0x78, 0x82, 0x08, 0x11, 0x97), /* 39! */
+    REAL_LITERAL(0x00, 0xAF, 0x81, 0x59, 0x15, 0x28, 0x32, 0x47, 0x90), /* 40! */
+    REAL_LITERAL(0x00, 0xB1, 0x33, 0x45, 0x25, 0x26, 0x61, 0x31, 0x64), /* 41! */
+    REAL_LITERAL(0x00, 0xB3, 0x14, 0x05, 0x00, 0x61, 0x17, 0x75, 0x29), /* 42! */
+    REAL_LITERAL(0x00, 0xB4, 0x60, 0x41, 0x52, 0x63, 0x06, 0x33, 0x74), /* 43! */
+    REAL_LITERAL(0x00, 0xB6, 0x26, 0x58, 0x27, 0x15, 0x74, 0x78, 0x84), /* 44! */
+    REAL_LITERAL(0x00, 0xB8, 0x11, 0x96, 0x22, 0x22, 0x08, 0x65, 0x48), /* 45! */
+    REAL_LITERAL(0x00, 0xB9, 0x55, 0x02, 0x62, 0x21, 0x59, 0x81, 0x21), /* 46! */
+    REAL_LITERAL(0x00, 0xBB, 0x25, 0x86, 0x23, 0x24, 0x15, 0x11, 0x17), /* 47! */
+    REAL_LITERAL(0x00, 0xBD, 0x12, 0x41, 0x39, 0x15, 0x59, 0x25, 0x36), /* 48! */
+    REAL_LITERAL(0x00, 0xBE, 0x60, 0x82, 0x81, 0x86, 0x40, 0x34, 0x27), /* 49! */
+    REAL_LITERAL(0x00, 0xC0, 0x30, 0x41, 0x40, 0x93, 0x20, 0x17, 0x13), /* 50! */
+    REAL_LITERAL(0x00, 0xC2, 0x15, 0x51, 0x11, 0x87, 0x53, 0x28, 0x74), /* 51! */
+    REAL_LITERAL(0x00, 0xC3, 0x80, 0x65, 0x81, 0x75, 0x17, 0x09, 0x44), /* 52! */
+    REAL_LITERAL(0x00, 0xC5, 0x42, 0x74, 0x88, 0x32, 0x84, 0x06, 0x00), /* 53! */
+    REAL_LITERAL(0x00, 0xC7, 0x23, 0x08, 0x43, 0x69, 0x73, 0x39, 0x24), /* 54! */
+    REAL_LITERAL(0x00, 0xC9, 0x12, 0x69, 0x64, 0x03, 0x35, 0x36, 0x58), /* 55! */
+    REAL_LITERAL(0x00, 0xCA, 0x71, 0x09, 0x98, 0x58, 0x78, 0x04, 0x86), /* 56! */
+    REAL_LITERAL(0x00, 0xCC, 0x40, 0x52, 0x69, 0x19, 0x50, 0x48, 0x77), /* 57! */
+    REAL_LITERAL(0x00, 0xCE, 0x23, 0x50, 0x56, 0x13, 0x31, 0x28, 0x29), /* 58! */
+    REAL_LITERAL(0x00, 0xD0, 0x13, 0x86, 0x83, 0x11, 0x85, 0x45, 0x69), /* 59! */
+    REAL_LITERAL(0x00, 0xD1, 0x83, 0x20, 0x98, 0x71, 0x12, 0x74, 0x14), /* 60! */
+    REAL_LITERAL(0x00, 0xD3, 0x50, 0x75, 0x80, 0x21, 0x38, 0x77, 0x22), /* 61! */
+    REAL_LITERAL(0x00, 0xD5, 0x31, 0x46, 0x99, 0x73, 0x26, 0x03, 0x88), /* 62! */
+    REAL_LITERAL(0x00, 0xD7, 0x19, 0x82, 0x60, 0x83, 0x15, 0x40, 0x44), /* 63! */
+    REAL_LITERAL(0x00, 0xD9, 0x12, 0x68, 0x86, 0x93, 0x21, 0x85, 0x88), /* 64! */
+    REAL_LITERAL(0x00, 0xDA, 0x82, 0x47, 0x65, 0x05, 0x92, 0x08, 0x25), /* 65! */
+    REAL_LITERAL(0x00, 0xDC, 0x54, 0x43, 0x44, 0x93, 0x90, 0x77, 0x44), /* 66! */
+    REAL_LITERAL(0x00, 0xDE, 0x36, 0x47, 0x11, 0x10, 0x91, 0x81, 0x89), /* 67! */
+    REAL_LITERAL(0x00, 0xE0, 0x24, 0x80, 0x03, 0x55, 0x42, 0x43, 0x68), /* 68! */
+    REAL_LITERAL(0x00, 0xE2, 0x17, 0x11, 0x22, 0x45, 0x24, 0x28, 0x14)  /* 69! */
+};
+
+/**
+ * Evaluates the factorial of a value.
+ * Results come straight from a table, so even huge operands are rejected
+ * without any multiplication.
+ * 
+ * @param value The value to compute the factorial of.
+ * @param result Pointer to store the factorial.
+ * @return FACTORIAL_OK on success, or the reason there is no result.
+ */
+FactorialStatus evaluate_factorial(real_t value, real_t* result) {
+    // Check if value is a non-negative integer
+    real_t rounded = os_RealRoundInt(&value);
+    
+    if (os_RealCompare(&value, &ZERO) < 0 || 
+        os_RealCompare(&value, &rounded) != 0) {
+        return FACTORIAL_DOMAIN_ERROR;
+    }
+    
+    real_t max_operand = os_Int24ToReal(MAX_FACTORIAL);
+    if (os_RealCompare(&value, &max_operand) > 0) {
+        return FACTORIAL_OVERFLOW;
+    }
+    
+    *result = FACTORIALS[os_RealToInt24(&value)];
+    return FACTORIAL_OK;
+}
@@ -0,0 +1,462 @@
+/**
+ * MathSolver for TI-84 CE - Graph View
+ *
+ * Plots y = f(x) with graphx, one evaluation of the compiled expression
+ * per pixel column. Where the curve moves by more than a pixel between
+ * two columns, or bends sharply, points in between are sampled to draw
+ * its shape and to find jumps, which are left unconnected.
+ *
+ * The value of every column is kept. Panning slides the picture already
+ * on the screen and only computes the columns it uncovers; zooming reuses
+ * the columns that land on the same x.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <graphx.h>
+#include <ti/real.h>
+#include "headers/log.h"
+#include "headers/mathsolver.h"
+#include "headers/graph_private.h"
+
+/* ============================== Graph State ============================== */
+
+/** Width of the plot, one column per pixel */
+#define GRAPH_WIDTH SCREEN_WIDTH
+
+/** Height of the plot */
+#define GRAPH_HEIGHT SCREEN_HEIGHT
+
+/** Times the interval between two columns can be halved to follow the curve */
+#define REFINE_DEPTH 3
+
+/** Points on the finest grid between two columns, both columns included */
+#define REFINE_POINTS ((1 << REFINE_DEPTH) + 1)
+
+/** Rise between two neighbouring samples taken as a jump rather than a slope */
+#define JUMP_PIXELS (GRAPH_HEIGHT / 2)
+
+/** Background color */
+#define BG_COLOR 0xFF
+
+/** Axis color */
+#define AXIS_COLOR 0x77
+
+/** Curve color */
+#define CURVE_COLOR 0x03
+
+/** Compiled form of the plotted expression */
+static CompiledExpression graph_program;
+
+/** Formatting of the arithmetic mode the graph was opened in */
+static ArithmeticFormat graph_format;
+
+/** Symbol of the variable the graph runs over */
+static uint8_t graph_symbol;
+
+/** Variable as it was before the graph wrote to it */
+static Variable saved_variable;
+
+/** Value of x on the first column */
+static real_t graph_xmin;
+
+/** Increment of x between columns */
+static real_t graph_dx;
+
+/** Increment of x on the finest grid between two columns */
+static real_t graph_sub_dx;
+
+/** Value of y on the top row */
+static float graph_ytop;
+
+/** Decrement of y between rows */
+static float graph_dy;
+
+/** Column of the y axis, or -1 if it is not visible */
+static int axis_column;
+
+/** Value of the expression on each column */
+static float column_values[GRAPH_WIDTH];
+
+/** Lowest value drawn on each column */
+static float column_low[GRAPH_WIDTH];
+
+/** Highest value drawn on each column */
+static float column_high[GRAPH_WIDTH];
+
+/** Whether the value of each column is known, while the window changes */
+static bool column_known[GRAPH_WIDTH];
+
+/** Values of the columns being moved by a zoom */
+static float zoom_values[GRAPH_WIDTH];
+
+/* ============================== Graph Lifecycle ============================== */
+
+/**
+ * Opens the graph of an expression over the standard window.
+ * The graph runs over the first variable the expression refers to; its
+ * value is restored by graph_close. The screen is handed over to graphx
+ * until then.
+ *
+ * @param input The expression string.
+ * @return A PlotStatus telling whether the graph is shown.
+ */
+PlotStatus graph_open(const char* input) {
+    graph_format = get_arithmetic_format(current_arithmetic_type, current_precision,
+                                         current_use_significant_digits);
+    if (!compile_expression_string(input, &graph_program, &graph_format)) {
+        return PLOT_INVALID;
+    }
+
+    int symbol = find_program_variable(&graph_program);
+    if (symbol < 0) {
+        LOG_ERROR("Graph expression has no variable");
+        return PLOT_NO_VARIABLE;
+    }
+    graph_symbol = (uint8_t)symbol;
+    saved_variable = variables[graph_symbol];
+
+    // Standard window: x and y from -10 to 10
+    real_t ten = os_Int24ToReal(10);
+    real_t width = os_Int24ToReal(GRAPH_WIDTH / 20);
+    graph_xmin = os_RealNeg(&ten);
+    graph_dx = os_RealInv(&width);
+    graph_ytop = 10.0f;
+    graph_dy = 20.0f / GRAPH_HEIGHT;
+    update_window();
+
+    LOG_INFO("Graph of %s over %s", input, get_symbol_name(graph_symbol));
+
+    gfx_Begin();
+    memset(column_known, false, sizeof(column_known));
+    render(0, GRAPH_WIDTH - 1);
+    return PLOT_OK;
+}
+
+/**
+ * Closes the graph, giving the screen back to the OS and restoring the
+ * variable the graph wrote to.
+ */
+void graph_close(void) {
+    gfx_End();
+    variables[graph_symbol] = saved_variable;
+}
+
+/* ============================== Pan and Zoom ============================== */
+
+/**
+ * Moves the window of the graph.
+ * The picture on the screen is shifted; only the columns or rows that
+ * come into view are drawn, and only new columns are evaluated.
+ *
+ * @param columns Columns to move right by, negative to move left.
+ * @param rows Rows to move up by, negative to move down.
+ */
+void graph_pan(int columns, int rows) {
+    if (columns > 0 && columns < GRAPH_WIDTH) {
+        graph_xmin = column_x(columns);
+        shift_columns(columns, 0, GRAPH_WIDTH - columns);
+        update_window();
+        gfx_ShiftLeft(columns);
+        render(GRAPH_WIDTH - columns, GRAPH_WIDTH - 1);
+    } else if (columns < 0 && -columns < GRAPH_WIDTH) {
+        graph_xmin = column_x(columns);
+        shift_columns(0, -columns, GRAPH_WIDTH + columns);
+        update_window();
+        gfx_ShiftRight(-columns);
+        // The first kept column has a new neighbour to join
+        render(0, -columns);
+    }
+
+    if (rows > 0 && rows < GRAPH_HEIGHT) {
+        graph_ytop += rows * graph_dy;
+        gfx_ShiftDown(rows);
+        draw_rows(0, rows);
+    } else if (rows < 0 && -rows < GRAPH_HEIGHT) {
+        graph_ytop += rows * graph_dy;
+        gfx_ShiftUp(-rows);
+        draw_rows(GRAPH_HEIGHT + rows, GRAPH_HEIGHT);
+    }
+}
+
+/**
+ * Zooms the graph in or out by a factor of two around its center.
+ * Columns that land on an x already computed keep their value: every
+ * other column when zooming in, the middle half when zooming out.
+ *
+ * @param in True to zoom in, false to zoom out.
+ */
+void graph_zoom(bool in) {
+    real_t two = os_Int24ToReal(2);
+    float center = graph_ytop - (GRAPH_HEIGHT / 2) * graph_dy;
+
+    memset(column_known, false, sizeof(column_known));
+    for (int column = 0; column < GRAPH_WIDTH; column++) {
+        int source;
+        if (in) {
+            source = (column % 2 == 0) ? GRAPH_WIDTH / 4 + column / 2 : -1;
+        } else {
+            source = 2 * column - GRAPH_WIDTH / 2;
+        }
+
+        if (source >= 0 && source < GRAPH_WIDTH) {
+            zoom_values[column] = column_values[source];
+            column_known[column] = true;
+        }
+    }
+    memcpy(column_values, zoom_values, sizeof(column_values));
+
+    if (in) {
+        graph_xmin = column_x(GRAPH_WIDTH / 4);
+        graph_dx = os_RealDiv(&graph_dx, &two);
+        graph_dy /= 2;
+    } else {
+        graph_xmin = column_x(-GRAPH_WIDTH / 2);
+        graph_dx = os_RealMul(&graph_dx, &two);
+        graph_dy *= 2;
+    }
+    graph_ytop = center + (GRAPH_HEIGHT / 2) * graph_dy;
+    update_window();
+
+    render(0, GRAPH_WIDTH - 1);
+}
+
+/**
+ * Moves the values of columns that stay in view after a pan.
+ * The columns left uncovered are marked as unknown.
+ *
+ * @param from First column to move.
+ * @param to Column the first one moves to.
+ * @param count Number of columns to move.
+ */
+static void shift_columns(int from, int to, int count) {
+    memmove(&column_values[to], &column_values[from], count * sizeof(float));
+    memmove(&column_low[to], &column_low[from], count * sizeof(float));
+    memmove(&column_high[to], &column_high[from], count * sizeof(float));
+
+    memset(column_known, false, sizeof(column_known));
+    memset(&column_known[to], true, count);
+}
+
+/**
+ * Updates what depends on the horizontal window.
+ */
+static void update_window(void) {
+    real_t steps = os_Int24ToReal(REFINE_POINTS - 1);
+    graph_sub_dx = os_RealDiv(&graph_dx, &steps);
+
+    // Column whose interval holds x = 0
+    real_t position = os_RealDiv(&graph_xmin, &graph_dx);
+    float column = -os_RealToFloat(&position);
+    axis_column = (column >= 0 && column < GRAPH_WIDTH) ? (int)column : -1;
+}
+
+/* ============================== Sampling ============================== */
+
+/**
+ * Evaluates, refines and draws a range of columns.
+ * Only columns whose value is unknown are evaluated.
+ *
+ * @param first First column.
+ * @param last Last column.
+ */
+static void render(int first, int last) {
+    for (int column = first; column <= last; column++) {
+        if (!column_known[column]) {
+            column_values[column] = sample(column_x(column));
+            column_known[column] = true;
+        }
+    }
+
+    for (int column = first; column <= last; column++) {
+        refine_column(column);
+        draw_column(column);
+    }
+}
+
+/**
+ * Gets the value of x on a column.
+ *
+ * @param column The column, which may lie outside the screen.
+ * @return The value of x.
+ */
+static real_t column_x(int column) {
+    real_t index = os_Int24ToReal(column);
+    real_t offset = os_RealMul(&index, &graph_dx);
+    return os_RealAdd(&graph_xmin, &offset);
+}
+
+/**
+ * Evaluates the expression.
+ *
+ * @param x The value of the variable.
+ * @return The value of the expression, or NAN where it is not defined.
+ */
+static float sample(real_t x) {
+    set_symbol_value(graph_symbol, x);
+    real_t value = run_program(&graph_program, &graph_format);
+    if (is_value_undefined() || get_loop_status() != LOOP_OK) {
+        return NAN;
+    }
+    return os_RealToFloat(&value);
+}
+
+/**
+ * Works out what to draw on a column, from the previous column to this one.
+ * The curve is sampled between them where it rises more than a pixel or
+ * bends sharply. Going back from this column, the drawing stops at the
+ * first jump or undefined point, so the sides of a discontinuity are not
+ * joined. A column where the curve is not defined is left blank.
+ *
+ * @param column The column, whose value and the previous one's are known.
+ */
+static void refine_column(int column) {
+    float value = column_values[column];
+    column_low[column] = value;
+    column_high[column] = value;
+    if (column == 0 || isnan(value)) {
+        return;
+    }
+
+    float points[REFINE_POINTS];
+    bool sampled[REFINE_POINTS];
+    memset(sampled, false, sizeof(sampled));
+    points[0] = column_values[column - 1];
+    points[REFINE_POINTS - 1] = value;
+    sampled[0] = true;
+    sampled[REFINE_POINTS - 1] = true;
+
+    bool bends = column >= 2 &&
+                 pixels(value - 2 * column_values[column - 1] + column_values[column - 2]) > 1;
+    if (bends || pixels(value - points[0]) > 1) {
+        subdivide(column_x(column - 1), points, sampled, 0, REFINE_POINTS - 1);
+    }
+
+    int next = REFINE_POINTS - 1;
+    for (int point = REFINE_POINTS - 2; point >= 0; point--) {
+        if (!sampled[point]) {
+            continue;
+        }
+        if (isnan(points[point]) || pixels(points[next] - points[point]) > JUMP_PIXELS) {
+            break;
+        }
+
+        if (points[point] < column_low[column]) {
+            column_low[column] = points[point];
+        }
+        if (points[point] > column_high[column]) {
+            column_high[column] = points[point];
+        }
+        next = point;
+    }
+}
+
+/**
+ * Samples the middle of an interval between two columns, then the halves
+ * where the curve still rises more than a pixel.
+ *
+ * @param x0 Value of x on the previous column.
+ * @param points Values on the finest grid between the columns.
+ * @param sampled Which points have been sampled.
+ * @param first Grid index of the start of the interval, already sampled.
+ * @param last Grid index of the end of the interval, already sampled.
+ */
+static void subdivide(real_t x0, float* points, bool* sampled, int first, int last) {
+    if (last - first < 2) {
+        return;
+    }
+
+    int middle = (first + last) / 2;
+    real_t index = os_Int24ToReal(middle);
+    real_t offset = os_RealMul(&index, &graph_sub_dx);
+    points[middle] = sample(os_RealAdd(&x0, &offset));
+    sampled[middle] = true;
+
+    if (pixels(points[middle] - points[first]) > 1) {
+        subdivide(x0, points, sampled, first, middle);
+    }
+    if (pixels(points[last] - points[middle]) > 1) {
+        subdivide(x0, points, sampled, middle, last);
+    }
+}
+
+/**
+ * Converts a difference of y to a number of rows.
+ *
+ * @param difference The difference of y.
+ * @return The size of the difference in rows, always positive.
+ */
+static float pixels(float difference) {
+    float rows = difference / graph_dy;
+    return rows < 0 ? -rows : rows;
+}
+
+/* ============================== Drawing ============================== */
+
+/**
+ * Draws every column, limited to a band of rows.
+ *
+ * @param top First row of the band.
+ * @param bottom Row after the band.
+ */
+static void draw_rows(int top, int bottom) {
+    gfx_SetClipRegion(0, top, GRAPH_WIDTH, bottom);
+    for (int column = 0; column < GRAPH_WIDTH; column++) {
+        draw_column(column);
+    }
+    gfx_SetClipRegion(0, 0, GRAPH_WIDTH, GRAPH_HEIGHT);
+}
+
+/**
+ * Draws a column: background, axes and curve.
+ *
+ * @param column The column.
+ */
+static void draw_column(int column) {
+    gfx_SetColor(BG_COLOR);
+    gfx_VertLine(column, 0, GRAPH_HEIGHT);
+
+    gfx_SetColor(AXIS_COLOR);
+    if (column == axis_column) {
+        gfx_VertLine(column, 0, GRAPH_HEIGHT);
+    }
+    int axis_row = row_of(0);
+    if (axis_row >= 0 && axis_row < GRAPH_HEIGHT) {
+        gfx_SetPixel(column, axis_row);
+    }
+
+    if (isnan(column_low[column])) {
+        return;
+    }
+    int top = row_of(column_high[column]);
+    int bottom = row_of(column_low[column]);
+    if (bottom < 0 || top >= GRAPH_HEIGHT) {
+        return;
+    }
+    if (top < 0) {
+        top = 0;
+    }
+    if (bottom >= GRAPH_HEIGHT) {
+        bottom = GRAPH_HEIGHT - 1;
+    }
+
+    gfx_SetColor(CURVE_COLOR);
+    gfx_VertLine(column, top, bottom - top + 1);
+}
+
+/**
+ * Gets the row of a value of y.
+ *
+ * @param y The value of y.
+ * @return The row, clamped to just outside the screen.
+ */
+static int row_of(float y) {
+    float row = (graph_ytop - y) / graph_dy + 0.5f;
+    if (row < 0) {
+        return -1;
+    }
+    if (row > GRAPH_HEIGHT) {
+        return GRAPH_HEIGHT;
+    }
+    return (int)row;
+}
@@ -0,0 +1,189 @@
+/**
+ * MathSolver for TI-84 CE - Virtual Machine Loop
+ *
+ * Body of the VM, included by bytecode.c once for each formatting of the
+ * values: it defines VM_RUN as the name of the function and
+ * VM_FORMAT(format, value) as what is done to each value computed.
+ * Both are undefined again at the end, so the file can be included anew.
+ */
+
+#ifndef VM_RUN
+#error "Define VM_RUN and VM_FORMAT before including bytecode_vm.h"
+#endif
+
+/**
+ * Executes a compiled program, formatting each value with VM_FORMAT.
+ *
+ * @param program Pointer to the program to execute.
+ * @param format The formatting of the arithmetic mode.
+ * @return The value of the expression, or zero if a loop was stopped.
+ */
+static real_t VM_RUN(const CompiledExpression* program, const ArithmeticFormat* format) {
+    real_t stack[VM_STACK_SIZE];
+    real_t temps[VM_TEMP_COUNT];
+    uint8_t top = 0;
+    ActiveLoop loops[VM_LOOP_DEPTH];
+    uint8_t loop_count = 0;
+    unsigned int iterations = 0;
+
+    loop_status = LOOP_OK;
+    value_undefined = false;
+
+    for (uint8_t pc = 0; pc < program->length; pc++) {
+        const Instruction* instruction = &program->code[pc];
+
+        switch (instruction->opcode) {
+            case OP_PUSH_CONST:
+                stack[top] = program->constants[instruction->operand];
+                VM_FORMAT(format, stack[top]);
+                top++;
+                break;
+
+            case OP_PUSH_VAR: {
+                bool found;
+                stack[top] = get_symbol_value(instruction->operand, &found);
+                VM_FORMAT(format, stack[top]);
+                top++;
+                break;
+            }
+
+            case OP_STORE:
+                temps[instruction->operand] = stack[top - 1];
+                break;
+
+            case OP_LOAD:
+                stack[top++] = temps[instruction->operand];
+                break;
+
+            case OP_ADD:
+                top--;
+                stack[top - 1] = real_add(stack[top - 1], stack[top]);
+                VM_FORMAT(format, stack[top - 1]);
+                break;
+
+            case OP_SUB:
+                top--;
+                stack[top - 1] = real_sub(stack[top - 1], stack[top]);
+                VM_FORMAT(format, stack[top - 1]);
+                break;
+
+            case OP_MUL:
+                top--;
+                stack[top - 1] = real_mul(stack[top - 1], stack[top]);
+                VM_FORMAT(format, stack[top - 1]);
+                break;
+
+            case OP_DIV:
+                top--;
+                if (os_RealCompare(&stack[top], &ZERO) == 0) {
+                    value_undefined = true;
+                    stack[top - 1] = ZERO;
+                } else {
+                    stack[top - 1] = real_div(stack[top - 1], stack[top]);
+                    VM_FORMAT(format, stack[top - 1]);
+                }
+                break;
+
+            case OP_POW:
+                top--;
+                if (!in_power_domain(stack[top - 1], stack[top])) {
+                    value_undefined = true;
+                    stack[top - 1] = ZERO;
+                    break;
+                }
+                stack[top - 1] = real_pow(stack[top - 1], stack[top]);
+                VM_FORMAT(format, stack[top - 1]);
+                break;
+
+            case OP_FUNC:
+                if (!in_function_domain((FunctionType)instruction->operand, stack[top - 1])) {
+                    value_undefined = true;
+                    stack[top - 1] = ZERO;
+                    break;
+                }
+                stack[top - 1] = evaluate_function((FunctionType)instruction->operand, stack[top - 1]);
+                VM_FORMAT(format, stack[top - 1]);
+                break;
+
+            case OP_FACTORIAL: {
+                real_t factorial;
+                if (evaluate_factorial(stack[top - 1], &factorial) == FACTORIAL_OK) {
+                    stack[top - 1] = factorial;
+                    VM_FORMAT(format, stack[top - 1]);
+                } else {
+                    value_undefined = true;
+                    stack[top - 1] = ZERO;
+                }
+                break;
+            }
+
+            case OP_LOOP_BEGIN: {
+                // The bounds sit over the accumulator
+                int first, last;
+                top -= 2;
+                if (!read_bound(stack[top], &first) || !read_bound(stack[top + 1], &last)) {
+                    LOG_ERROR("Sum or product bounds must be integers");
+                    loop_status = LOOP_BOUNDS_ERROR;
+                    stack[top - 1] = ZERO;
+                    pc = find_loop_end(program, pc);
+                    break;
+                }
+                if (first > last) {
+                    // An empty range leaves the identity
+                    pc = find_loop_end(program, pc);
+                    break;
+                }
+
+                ActiveLoop* loop = &loops[loop_count++];
+                loop->symbol = instruction->operand;
+                loop->saved = variables[loop->symbol];
+                loop->first = first;
+                loop->index = first;
+                loop->last = last;
+                set_symbol_value(loop->symbol, os_Int24ToReal(first));
+                break;
+            }
+
+            case OP_SUM_NEXT:
+            case OP_PRODUCT_NEXT: {
+                top--;
+                if (instruction->opcode == OP_SUM_NEXT) {
+                    stack[top - 1] = real_add(stack[top - 1], stack[top]);
+                    VM_FORMAT(format, stack[top - 1]);
+                } else {
+                    stack[top - 1] = real_mul(stack[top - 1], stack[top]);
+                    VM_FORMAT(format, stack[top - 1]);
+                }
+
+                ActiveLoop* loop = &loops[loop_count - 1];
+                if (loop->index >= loop->last) {
+                    variables[loop->symbol] = loop->saved;
+                    loop_count--;
+                    break;
+                }
+
+                loop->index++;
+                set_symbol_value(loop->symbol, os_Int24ToReal(loop->index));
+                pc -= instruction->operand;
+
+                // Progress is that of the outermost loop
+                if (++iterations % LOOP_PROGRESS_INTERVAL == 0 && progress_handler != NULL &&
+                    !progress_handler(loops[0].index - loops[0].first, loops[0].last - loops[0].first + 1)) {
+                    LOG_INFO("Loop interrupted");
+                    while (loop_count > 0) {
+                        loop_count--;
+                        variables[loops[loop_count].symbol] = loops[loop_count].saved;
+                    }
+                    loop_status = LOOP_INTERRUPTED;
+                    return ZERO;
+                }
+                break;
+            }
+        }
+    }
+
+    return top > 0 ? stack[top - 1] : ZERO;
+}
+
+#undef VM_RUN
+#undef VM_FORMAT
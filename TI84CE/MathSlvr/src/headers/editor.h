@@ -0,0 +1,61 @@
+/**
+ * MathSolver for TI-84 CE - Line Editor Definitions
+ *
+ * Types and constants of the home screen line editor, which reads the
+ * input key by key so the program can follow the text as it is typed.
+ */
+
+#ifndef EDITOR_H
+#define EDITOR_H
+
+#include <stdbool.h>
+
+/* ============================ Editor Constants ============================ */
+
+/** Time the cursor stays on or off when no key is pressed (in ms). */
+#define EDITOR_BLINK_MS        500
+
+/** Time an arrow or DEL is held before it repeats (in ms). */
+#define EDITOR_REPEAT_DELAY_MS 400
+
+/** Time between two repeats of a held arrow or DEL (in ms). */
+#define EDITOR_REPEAT_MS       80
+
+/** Home screen font character of the cursor. */
+#define EDITOR_CURSOR          '\xE0'
+
+/** Home screen font character of the cursor after 2nd. */
+#define EDITOR_CURSOR_2ND      '\xE1'
+
+/** Home screen font character of the cursor in alpha mode. */
+#define EDITOR_CURSOR_ALPHA    '\xE2'
+
+/* ============================== Editor Types ============================== */
+
+/**
+ * Called after each change of the text.
+ *
+ * @param text The text being edited.
+ */
+typedef void (*EditorChangeHandler)(const char* text);
+
+/**
+ * Called once when the text has been left unchanged for the idle delay.
+ *
+ * @param text The text being edited.
+ */
+typedef void (*EditorIdleHandler)(const char* text);
+
+/**
+ * Called when 2nd ENTER asks for an earlier entry, going further back each time.
+ *
+ * @param back How far back the entry is, 0 being the newest.
+ * @param buffer Buffer to copy the entry to.
+ * @param buffer_size Size of the buffer.
+ * @return True if the entry was copied, false if there is none that far back.
+ */
+typedef bool (*EditorRecallHandler)(int back, char* buffer, int buffer_size);
+
+#include "editor_public.h"
+
+#endif /* EDITOR_H */
@@ -0,0 +1,47 @@
+/**
+ * MathSolver for TI-84 CE - Calculation History Layout
+ *
+ * Layout of the AppVar the history is kept in.
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdint.h>
+#include <ti/real.h>
+#include "mathsolver.h"
+
+/** Name of the AppVar the history is kept in */
+#define HISTORY_APPVAR_NAME "MSHIST"
+
+/** Layout version of the AppVar, bumped when the layout changes */
+#define HISTORY_VERSION 1
+
+/** Settings of an entry packed in a byte: mode in bits 0-1, significant digits in bit 2, precision above */
+#define PACK_SETTINGS(mode, precision, sig) \
+    ((uint8_t)((mode) | ((sig) ? 0x04 : 0) | ((precision) << 4)))
+
+/**
+ * Variable saved with the history.
+ */
+typedef struct {
+    char name[MAX_TOKEN_LENGTH];  /**< Variable name */
+    real_t value;                 /**< Variable value */
+} SavedVariable;
+
+/**
+ * Start of the AppVar.
+ * It is followed by the entries, each one a length byte, the expression
+ * text, a byte of packed settings and the real_t result.
+ */
+typedef struct {
+    uint8_t version;                         /**< Layout version (HISTORY_VERSION) */
+    uint8_t entry_count;                     /**< Entries in the index */
+    uint8_t newest;                          /**< Slot of the index holding the newest entry */
+    uint8_t variable_count;                  /**< Variables in the variable block */
+    uint16_t end;                            /**< Offset of the end of the entries */
+    uint16_t index[HISTORY_ENTRIES];         /**< Offsets of the last entries, a ring */
+    SavedVariable variables[MAX_VARIABLES];  /**< Variables defined when the history was last saved */
+} HistoryHeader;
+
+#endif // HISTORY_H
@@ -14,5 +14,17 @@
 
 #include <ti/real.h>
 #include "log_public.h"
+#include "../../../common/log_macros.h"
+
+/* Trace helpers that format a real_t, compiled out with the trace level */
+#if LOG_ENABLED(LOG_LEVEL_TRACE)
+#define LOG_VARIABLE(name, value)             log_variable(name, value)
+#define LOG_OPERATION(operation, value)       log_operation(operation, value)
+#define LOG_TOKEN(source, type, text, length) log_token(source, type, text, length)
+#else
+#define LOG_VARIABLE(name, value)             ((void)0)
+#define LOG_OPERATION(operation, value)       ((void)0)
+#define LOG_TOKEN(source, type, text, length) ((void)0)
+#endif
 
 #endif // LOG_H
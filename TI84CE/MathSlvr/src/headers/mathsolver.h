@@ -9,24 +9,91 @@
 
 #include <ti/real.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /* ============================== Constants ============================== */
 
 /** Maximum input expression length */
 #define MAX_INPUT_LENGTH     100
 
-/** Maximum nodes in the expression tree */
-#define MAX_NODES            50
+/** Bytes reserved for the expression node arena */
+#define NODE_POOL_BYTES      2048
+
+/** Maximum nodes in the expression tree, as many as fit in NODE_POOL_BYTES */
+#define MAX_NODES            ((int)(NODE_POOL_BYTES / sizeof(ExpressionNode)))
+
+/** Node index meaning "no node"; the arena can never hold this many nodes */
+#define NODE_NONE            0xFF
 
 /** Maximum token length */
 #define MAX_TOKEN_LENGTH     20
 
-/** Maximum number of variables */
-#define MAX_VARIABLES        10
+/** Maximum number of variables (size of the hashed symbol table, a power of two) */
+#define MAX_VARIABLES        16
+
+/** Symbol flag marking a built-in constant; the low bits hold its ConstantId */
+#define SYMBOL_CONSTANT      0x80
+
+/** Symbol of a name that has no slot in the symbol table */
+#define SYMBOL_NONE          0xFF
 
-/** Maximum calculation steps to display */
+/** Calculation steps kept in a result; later ones are spilled to an AppVar */
 #define MAX_STEPS            20
 
+/** Bytes reserved for the cache of recent results */
+#define RESULT_CACHE_BYTES   2048
+
+/** Entries of the history that can be recalled */
+#define HISTORY_ENTRIES      16
+
+/** Size the history AppVar grows to before its old entries are dropped */
+#define HISTORY_BYTES        4096
+
+/** Maximum rows in a function table */
+#define TABLE_MAX_ROWS       9999
+
+/** Maximum iterations of each method of the equation solver */
+#define SOLVE_MAX_ITERATIONS 100
+
+/** Times the equation solver doubles its search around the guess for a sign change */
+#define SOLVE_BRACKET_STEPS  24
+
+/** Times the equation solver halves the way to the edge of where the equation is defined */
+#define SOLVE_EDGE_STEPS     48
+
+/** Rows of a function table kept once computed (a power of two) */
+#define TABLE_CACHE_ROWS     64
+
+/** Maximum instructions in a compiled expression program */
+#define MAX_PROGRAM_LENGTH   MAX_NODES
+
+/** Largest n whose factorial fits in a real_t */
+#define MAX_FACTORIAL        69
+
+/** Depth of the value stack used by the bytecode VM */
+#define VM_STACK_SIZE        16
+
+/** Temporaries the bytecode VM keeps for values shared by an optimized expression */
+#define VM_TEMP_COUNT        8
+
+/** Sums and products the bytecode VM runs one inside another at most */
+#define VM_LOOP_DEPTH        4
+
+/** Largest magnitude of a bound of a sum or product */
+#define LOOP_MAX_BOUND       999999
+
+/** Iterations of a sum or product between two progress reports */
+#define LOOP_PROGRESS_INTERVAL 128
+
+/** Depth of the operator stack used by the parser (pending operators and open parentheses) */
+#define PARSER_STACK_SIZE    32
+
+/** Parser states kept to resume the parse of an expression being typed */
+#define PARSER_CHECKPOINTS   4
+
+/** Operands and operators read between two kept parser states */
+#define PARSER_CHECKPOINT_SPACING 8
+
 /** Calculator screen width */
 #define SCREEN_WIDTH         320
 
@@ -52,21 +119,34 @@
 /** Gridline color (light gray) */
 #define COLOR_GRIDLINE       0xB5
 
+/** Builds a real_t initializer from its sign, biased exponent and BCD mantissa bytes */
+#define REAL_LITERAL(sign, exp, m0, m1, m2, m3, m4, m5, m6) \
+    { (int8_t)(uint8_t)(sign), (int8_t)(uint8_t)(exp), { m0, m1, m2, m3, m4, m5, m6 } }
+
 /* Mathematical constants */
 /** Value of Pi  = 3.14159265358979323846*/
-extern real_t PI;
+extern const real_t PI;
 
 /** Base of natural logarithm (e) = 2.71828182845904523536*/
-extern real_t E;
+extern const real_t E;
 
 /** Golden ratio (phi) = 1.61803398874989484820 */
-extern real_t PHI;
+extern const real_t PHI;
 
 /** Zero value */
-extern real_t ZERO;
+extern const real_t ZERO;
+
+/** The value of the natural logarithm of 10 = 2.30258509299404568402 */
+extern const real_t LOG10;
+
+/** Smallest power of ten a real_t can hold */
+#define POW10_MIN_EXPONENT   (-99)
 
-/** The value of the natural logarithm of 10 */
-extern real_t LOG10;
+/** Largest power of ten a real_t can hold */
+#define POW10_MAX_EXPONENT   99
+
+/** Powers of ten from 10^POW10_MIN_EXPONENT to 10^POW10_MAX_EXPONENT */
+extern const real_t POWERS_OF_TEN[POW10_MAX_EXPONENT - POW10_MIN_EXPONENT + 1];
 
 /* ============================== Types ============================== */
 
@@ -88,8 +168,8 @@ typedef enum {
     TOKEN_FACTORIAL,    /**< Factorial operator */
     TOKEN_FUNCTION,     /**< Function token */
     TOKEN_END,          /**< End of input */
-    TOKEN_PI,           /**< Pi constant */
-    TOKEN_PHI           /**< Phi constant */
+    TOKEN_CONSTANT,     /**< Built-in constant */
+    TOKEN_ITERATOR      /**< Sum or product keyword */
 } TokenType;
 
 /**
@@ -105,9 +185,20 @@ typedef enum {
     NODE_EXPONENT,      /**< Exponentiation node */
     NODE_FUNCTION,      /**< Function node */
     NODE_FACTORIAL,     /**< Factorial node */
-    NODE_PARENTHESIS    /**< Parenthesis node */
+    NODE_PARENTHESIS,   /**< Parenthesis node */
+    NODE_SUMMATION,     /**< Sum of a body over an integer range of a variable */
+    NODE_PRODUCT        /**< Product of a body over an integer range of a variable */
 } NodeType;
 
+/**
+ * Enumeration of built-in constants, resolved when an expression is parsed
+ */
+typedef enum {
+    CONST_PI,           /**< Pi */
+    CONST_E,            /**< Base of natural logarithm */
+    CONST_PHI           /**< Golden ratio */
+} ConstantId;
+
 /**
  * Enumeration of supported mathematical functions
  */
@@ -121,6 +212,56 @@ typedef enum {
     FUNC_NONE           /**< No function */
 } FunctionType;
 
+/**
+ * Enumeration of factorial evaluation outcomes
+ */
+typedef enum {
+    FACTORIAL_OK,           /**< Factorial computed */
+    FACTORIAL_DOMAIN_ERROR, /**< Operand is not a non-negative integer */
+    FACTORIAL_OVERFLOW      /**< Factorial is too large for a real_t */
+} FactorialStatus;
+
+/**
+ * Enumeration of expression parsing outcomes
+ */
+typedef enum {
+    PARSE_OK,                 /**< Expression parsed */
+    PARSE_TOO_COMPLEX,        /**< Too many pending operators or open parentheses */
+    PARSE_TOO_LONG,           /**< The node arena is full */
+    PARSE_INVALID,            /**< A sum or product is not of the form sum(body, variable, start, end) */
+    PARSE_UNEXPECTED,         /**< A token where it cannot go, or a character that is not part of an expression */
+    PARSE_TOO_MANY_VARIABLES  /**< A name did not fit in the symbol table */
+} ParseStatus;
+
+/**
+ * Enumeration of outcomes of running a sum or product
+ */
+typedef enum {
+    LOOP_OK,            /**< Every loop ran to its end */
+    LOOP_BOUNDS_ERROR,  /**< A bound is not an integer, or is too large */
+    LOOP_INTERRUPTED    /**< The progress handler asked to stop */
+} LoopStatus;
+
+/**
+ * Enumeration of outcomes when preparing an expression to run over its
+ * variable, for a table or a graph
+ */
+typedef enum {
+    PLOT_OK,            /**< Ready */
+    PLOT_INVALID,       /**< The expression could not be compiled */
+    PLOT_NO_VARIABLE    /**< The expression has no variable to run over */
+} PlotStatus;
+
+/**
+ * Enumeration of equation solver outcomes
+ */
+typedef enum {
+    SOLVE_OK,           /**< Root found */
+    SOLVE_INVALID,      /**< The equation could not be compiled */
+    SOLVE_NO_VARIABLE,  /**< The equation has no variable to solve for */
+    SOLVE_NO_ROOT       /**< No root found near the guess */
+} SolveStatus;
+
 /**
  * Enumeration of arithmetic formatting modes
  */
@@ -130,6 +271,45 @@ typedef enum {
     ARITHMETIC_ROUND    /**< Round decimals */
 } ArithmeticType;
 
+/**
+ * Function a value is formatted with in a mode other than normal
+ * arithmetic. The precision is passed in rather than read from the settings.
+ */
+typedef real_t (*FormatFunction)(real_t value, int precision);
+
+/**
+ * Formatting of an arithmetic mode, selected once per evaluation by
+ * get_arithmetic_format so the mode is not looked at again for each value.
+ */
+typedef struct {
+    FormatFunction function;    /**< Function values go through, or NULL in normal arithmetic */
+    int precision;              /**< Decimal places or significant digits */
+} ArithmeticFormat;
+
+/** Formats a real_t variable in place; in normal arithmetic it is left as it is */
+#define APPLY_FORMAT(format, value) \
+    do { if ((format)->function != NULL) (value) = (format)->function((value), (format)->precision); } while (0)
+
+/**
+ * Enumeration of bytecode operations executed by the expression VM
+ */
+typedef enum {
+    OP_PUSH_CONST,      /**< Push a constant from the program's constant table */
+    OP_PUSH_VAR,        /**< Push the value of the symbol in the operand */
+    OP_ADD,             /**< Pop two values and push their sum */
+    OP_SUB,             /**< Pop two values and push their difference */
+    OP_MUL,             /**< Pop two values and push their product */
+    OP_DIV,             /**< Pop two values and push their quotient */
+    OP_POW,             /**< Pop two values and push the power */
+    OP_FUNC,            /**< Apply the function in the operand to the top value */
+    OP_FACTORIAL,       /**< Replace the top value by its factorial */
+    OP_STORE,           /**< Copy the top value to the temporary in the operand */
+    OP_LOAD,            /**< Push the value of the temporary in the operand */
+    OP_LOOP_BEGIN,      /**< Pop the bounds and run the loop body over the symbol in the operand */
+    OP_SUM_NEXT,        /**< Add the body value; loop back by the operand until the end */
+    OP_PRODUCT_NEXT     /**< Multiply by the body value; loop back by the operand until the end */
+} OpCode;
+
 /* ============================== Structures ============================== */
 
 /**
@@ -143,11 +323,13 @@ typedef struct {
 } SourcePosition;
 
 /**
- * Token structure representing a parsed token
+ * Token structure representing a parsed token.
+ * The text of a token is not copied: it is the span given by its
+ * position in the tokenizer input.
  */
 typedef struct {
     TokenType type;              /**< Type of token */
-    char value[MAX_TOKEN_LENGTH];/**< Token value as string */
+    uint8_t id;                  /**< FunctionType, ConstantId or variable symbol of the token */
     SourcePosition position;     /**< Position in the input */
     real_t real_value;           /**< Real value for number tokens */
 } Token;
@@ -158,35 +340,95 @@ typedef struct {
 typedef struct ExpressionNode ExpressionNode;
 
 /**
- * Expression node structure (the building block of the AST)
+ * Index of a node in the node arena, or NODE_NONE
+ */
+typedef uint8_t NodeIndex;
+
+/**
+ * Expression node structure (the building block of the AST).
+ * Nodes are packed: children are arena indices and the source span is
+ * the start and length of the token that created the node.
  */
 struct ExpressionNode {
-    NodeType type;               /**< Type of node */
-    SourcePosition position;     /**< Position in source */
-    real_t normal_value;         /**< Normal arithmetic value */
+    uint8_t type;                /**< Type of node (NodeType) */
+    uint8_t span_start;          /**< Start index of the node in the input string */
+    uint8_t span_length;         /**< Length of the node in the input string */
     
     union {
         real_t number_value;     /**< Value for number nodes */
         struct {
-            char name[MAX_TOKEN_LENGTH]; /**< Variable name */
+            uint8_t symbol;      /**< Symbol table slot, or SYMBOL_CONSTANT plus a ConstantId */
         } variable;
         struct {
-            ExpressionNode* left; /**< Left operand */
-            ExpressionNode* right;/**< Right operand */
+            NodeIndex left;      /**< Left operand */
+            NodeIndex right;     /**< Right operand */
         } binary_op;
         struct {
-            FunctionType func_type; /**< Function type */
-            ExpressionNode* argument; /**< Function argument */
+            uint8_t func_type;   /**< Function type (FunctionType) */
+            NodeIndex argument;  /**< Function argument */
         } function;
         struct {
-            ExpressionNode* expression; /**< Expression for factorial */
+            NodeIndex expression; /**< Expression for factorial */
         } factorial;
         struct {
-            ExpressionNode* expression; /**< Expression in parentheses */
+            NodeIndex expression; /**< Expression in parentheses */
         } parenthesis;
+        struct {
+            uint8_t symbol;      /**< Symbol of the loop variable */
+            NodeIndex body;      /**< Expression summed or multiplied */
+            NodeIndex start;     /**< First value of the variable */
+            NodeIndex end;       /**< Last value of the variable */
+        } iterator;
     };
 };
 
+/**
+ * Gets the node at an arena index, or NULL for NODE_NONE.
+ * The index is evaluated twice.
+ */
+#define NODE_AT(index)       ((index) == NODE_NONE ? NULL : &node_pool[(index)])
+
+/**
+ * Single bytecode instruction
+ */
+typedef struct {
+    uint8_t opcode;  /**< Operation to perform (OpCode) */
+    uint8_t operand; /**< Constant index, symbol, function type or temporary */
+} Instruction;
+
+/**
+ * Expression compiled to a postfix program for the bytecode VM.
+ * Variables are referenced by symbol, so a program stays valid as long
+ * as the symbol table is not reset. Nodes shared by an optimized
+ * expression are computed once and kept in a temporary.
+ */
+typedef struct {
+    Instruction code[MAX_PROGRAM_LENGTH];    /**< Program instructions */
+    real_t constants[MAX_PROGRAM_LENGTH];    /**< Constant table */
+    uint8_t length;                          /**< Number of instructions */
+    uint8_t constant_count;                  /**< Number of constants */
+    uint8_t temp_count;                      /**< Number of temporaries used */
+    uint8_t max_stack;                       /**< Deepest stack use of the program */
+} CompiledExpression;
+
+/**
+ * Value of an expression together with its derivative, for the dual
+ * number machine
+ */
+typedef struct {
+    real_t value;       /**< Value */
+    real_t derivative;  /**< Derivative with respect to the chosen variable */
+} DualValue;
+
+/**
+ * Function told how far the outermost running sum or product has got.
+ *
+ * @param done Iterations done.
+ * @param total Iterations in all.
+ * @return True to go on, false to stop.
+ */
+typedef bool (*LoopProgressHandler)(int done, int total);
+
 /**
  * Tokenizer structure for parsing input
  */
@@ -208,19 +450,56 @@ typedef struct {
 } Variable;
 
 /**
- * Calculation step structure for step-by-step output
+ * Layout of the operands shown for a calculation step
+ */
+typedef enum {
+    STEP_BINARY,        /**< Binary operation (e.g., addition, subtraction) */
+    STEP_UNARY_LEFT,    /**< Unary operation with left operand (e.g., factorial) */
+    STEP_UNARY_RIGHT,   /**< Unary operation with right operand (e.g., sqrt, negate) */
+    STEP_NO_OPERAND,    /**< Result only (e.g., variable substitution) */
+    STEP_ITERATION,     /**< Solver iteration: estimate, value there and next estimate */
+    STEP_RANGE          /**< Sum or product: first and last value of the variable */
+} StepType;
+
+/**
+ * Operation recorded by a calculation step
+ */
+typedef enum {
+    STEP_SUBSTITUTE,        /**< Substitute a variable by its value */
+    STEP_ADD,               /**< Addition */
+    STEP_SUBTRACT,          /**< Subtraction */
+    STEP_MULTIPLY,          /**< Multiplication */
+    STEP_DIVIDE,            /**< Division */
+    STEP_POWER,             /**< Exponentiation */
+    STEP_FUNCTION,          /**< Function call, the function type is in detail */
+    STEP_FACTORIAL,         /**< Factorial */
+    STEP_DIVISION_BY_ZERO,  /**< Division by zero error */
+    STEP_DOMAIN_ERROR,      /**< Function domain error, the function type is in detail */
+    STEP_POWER_ERROR,       /**< Power that is not a real number */
+    STEP_FACTORIAL_ERROR,   /**< Factorial domain error */
+    STEP_FACTORIAL_OVERFLOW,/**< Factorial too large for a real_t */
+    STEP_NEWTON,            /**< Newton iteration of the equation solver */
+    STEP_SECANT,            /**< Bracketed secant iteration of the equation solver */
+    STEP_SUMMATION,         /**< Sum over a range */
+    STEP_PRODUCT,           /**< Product over a range */
+    STEP_BOUNDS_ERROR,      /**< Sum or product bounds error, the node type is in detail */
+    STEP_INTERRUPTED        /**< Sum or product stopped with ON, the node type is in detail */
+} StepOperation;
+
+/**
+ * Calculation step structure for step-by-step output.
+ * Only raw operands are recorded; the text shown to the user is built
+ * when the step is displayed.
  */
 typedef struct {
-    char expression[MAX_INPUT_LENGTH]; /**< Expression at this step */
-    char operation[MAX_INPUT_LENGTH];  /**< Operation performed */
-    char result[MAX_INPUT_LENGTH];     /**< Result of the operation */
-    char left_operand[MAX_TOKEN_LENGTH]; /**< Left operand (if applicable) */
-    char right_operand[MAX_TOKEN_LENGTH]; /**< Right operand (if applicable) */
-    enum {
-        STEP_BINARY, /**< Binary operation (e.g., addition, subtraction) */
-        STEP_UNARY_LEFT, /**< Unary operation with left operand (e.g., factorial) */
-        STEP_UNARY_RIGHT /**< Unary operation with right operand (e.g., sqrt, negate) */
-    } type; /**< Type of operation */
+    uint8_t operation;   /**< Operation performed (StepOperation) */
+    uint8_t type;        /**< Layout of the operands (StepType) */
+    uint8_t detail;      /**< Operation detail (e.g., FunctionType) */
+    uint8_t span_start;  /**< Start of the source text of the step */
+    uint8_t span_length; /**< Length of the source text of the step */
+    real_t left;         /**< Left operand (if applicable) */
+    real_t right;        /**< Right operand (if applicable) */
+    real_t result;       /**< Result of the operation */
 } CalculationStep;
 
 /**
@@ -233,10 +512,23 @@ typedef struct {
     real_t value;                    /**< Final value */
     real_t normal_value;             /**< Normal arithmetic */
     int step_count;                  /**< Number of steps */
+    bool interrupted;                /**< Whether a sum or product was stopped before its end */
     char formatted_result[MAX_TOKEN_LENGTH]; /**< Formatted result string */
-    CalculationStep steps[MAX_STEPS];/**< Step-by-step calculation */
+    CalculationStep steps[MAX_STEPS];/**< First steps of the calculation; read them all with get_step */
 } CalculationResult;
 
+/**
+ * Entry of the calculation history, read in place from its AppVar
+ */
+typedef struct {
+    const char* text;               /**< Expression text, not terminated */
+    uint8_t length;                 /**< Length of the text */
+    ArithmeticType arithmetic_mode; /**< Arithmetic mode used */
+    int precision;                  /**< Precision used */
+    bool use_significant_digits;    /**< Whether significant digits were used */
+    real_t value;                   /**< Result */
+} HistoryEntry;
+
 extern ArithmeticType current_arithmetic_type;
 extern int current_precision;
 extern bool current_use_significant_digits;
@@ -253,10 +545,21 @@ extern int variable_count;
 /** Index of the next available node in the node pool. */
 extern int node_pool_index;
 
+/** Arena the expression nodes are allocated from. */
+extern ExpressionNode node_pool[MAX_NODES];
+
 #include "mathsolver_public.h"
 #include "arithmetic_public.h"
+#include "bytecode_public.h"
+#include "cache_public.h"
 #include "evaluator_public.h"
+#include "graph_public.h"
+#include "history_public.h"
+#include "optimizer_public.h"
 #include "parser_public.h"
+#include "solver_public.h"
+#include "steps_public.h"
+#include "table_public.h"
 #include "tokenizer_public.h"
 #include "variables_public.h"
 
@@ -0,0 +1,56 @@
+/**
+ * MathSolver for TI-84 CE - Profiler
+ *
+ * Zones of the profiler and the macros that time them. The macros compile
+ * to nothing unless the program is built with PROFILE=1.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+/**
+ * Parts of the program the profiler times. A zone holds the time spent
+ * in the zones it calls: parse holds tokenize, and draw holds format_real.
+ */
+typedef enum {
+    PROFILE_TOKENIZE,           /**< next_token */
+    PROFILE_PARSE,              /**< Full and incremental parses */
+    PROFILE_EVALUATE,           /**< Evaluation of a parsed expression, with its steps */
+    PROFILE_ARITHMETIC_FORMAT,  /**< apply_arithmetic_format; the evaluators select a formatting instead */
+    PROFILE_FORMAT_REAL,        /**< format_real */
+    PROFILE_DRAW,               /**< Drawing of the result view and the input line */
+    PROFILE_ZONE_COUNT          /**< Number of zones */
+} ProfileZone;
+
+#ifdef PROFILE
+
+#include <sys/timers.h>
+#include "profile_public.h"
+
+/** Hardware timer the profiler counts CPU cycles with; timer 1 is the keyboard handler's */
+#define PROFILE_TIMER 3
+
+/** Starts timing a zone, until PROFILE_STOP with the same zone in the same block */
+#define PROFILE_START(zone) uint32_t profile_start_##zone = timer_Get(PROFILE_TIMER)
+
+/** Stops timing a zone and adds the cycles to it */
+#define PROFILE_STOP(zone)  profile_add(zone, profile_start_##zone)
+
+/** Starts the profiler timer and clears the zones */
+#define PROFILE_INIT()      profile_init()
+
+/** Writes the zones to the debug console and to the profile AppVar */
+#define PROFILE_DUMP()      profile_dump()
+
+#else
+
+#define PROFILE_START(zone) ((void)0)
+#define PROFILE_STOP(zone)  ((void)0)
+#define PROFILE_INIT()      ((void)0)
+#define PROFILE_DUMP()      ((void)0)
+
+#endif // PROFILE
+
+#endif // PROFILE_H
@@ -0,0 +1,224 @@
+/**
+ * MathSolver for TI-84 CE - Calculation History
+ *
+ * Keeps the expressions entered and their results, and the variables,
+ * from one run to the next in an AppVar. Entries are appended to the end
+ * of the AppVar and never rewritten; an index at its start holds where
+ * the last HISTORY_ENTRIES of them are, so any of them is found without
+ * walking the others. Entries are read where they lie, through the data
+ * pointer of the AppVar, without copying them to RAM.
+ *
+ * The AppVar is archived on exit, so it survives a RAM reset, and moved
+ * back to RAM the first time an entry is added in a run.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fileioc.h>
+#include <ti/real.h>
+#include "headers/log.h"
+#include "headers/mathsolver.h"
+#include "headers/history_private.h"
+
+/* ============================== Restore and Save ============================== */
+
+/**
+ * Restores the variables saved by the last run, if any.
+ * A history from another layout version is ignored.
+ */
+void load_history(void) {
+    uint8_t handle = ti_Open(HISTORY_APPVAR_NAME, "r");
+    if (!handle) {
+        return;
+    }
+
+    const HistoryHeader* header = ti_GetDataPtr(handle);
+    if (ti_GetSize(handle) >= sizeof(HistoryHeader) && header->version == HISTORY_VERSION) {
+        for (int i = 0; i < header->variable_count && i < MAX_VARIABLES; i++) {
+            set_variable(header->variables[i].name, header->variables[i].value);
+        }
+        LOG_DEBUG("History restored, %d entries", header->entry_count);
+    }
+    ti_Close(handle);
+}
+
+/**
+ * Saves the variables with the history and archives its AppVar for the next run.
+ */
+void save_history(void) {
+    uint8_t handle = open_history();
+    if (!handle) {
+        LOG_ERROR("Failed to save the history");
+        return;
+    }
+
+    HistoryHeader* header = history_header(handle);
+    int count = 0;
+    for (int i = 0; i < MAX_VARIABLES; i++) {
+        if (variables[i].is_defined && variables[i].name[0] != '\0') {
+            memcpy(header->variables[count].name, variables[i].name, MAX_TOKEN_LENGTH);
+            header->variables[count].value = variables[i].value;
+            count++;
+        }
+    }
+    header->variable_count = (uint8_t)count;
+
+    ti_SetArchiveStatus(true, handle);
+    ti_Close(handle);
+    LOG_DEBUG("History saved, %d variables", count);
+}
+
+/* ============================== Entries ============================== */
+
+/**
+ * Appends an expression and its result to the history.
+ *
+ * @param expression The expression text.
+ * @param result Pointer to the result of the expression.
+ */
+void add_history(const char* expression, const CalculationResult* result) {
+    uint8_t length = (uint8_t)strlen(expression);
+    uint8_t settings = PACK_SETTINGS(result->arithmetic_mode, result->precision,
+                                     result->use_significant_digits);
+    uint16_t size = 1 + length + 1 + sizeof(real_t);
+
+    uint8_t handle = open_history();
+    if (!handle) {
+        LOG_ERROR("Failed to open the history");
+        return;
+    }
+
+    // Drop the entries that fell off the index once the AppVar is full
+    if (history_header(handle)->end + size > HISTORY_BYTES) {
+        compact_history(handle);
+    }
+
+    uint16_t end = history_header(handle)->end;
+    bool written = ti_Seek(end, SEEK_SET, handle) != EOF &&
+                   ti_Write(&length, 1, 1, handle) == 1 &&
+                   ti_Write(expression, 1, length, handle) == length &&
+                   ti_Write(&settings, 1, 1, handle) == 1 &&
+                   ti_Write(&result->value, sizeof(real_t), 1, handle) == 1;
+    if (!written) {
+        LOG_ERROR("Failed to add to the history");
+        ti_Close(handle);
+        return;
+    }
+
+    // Writing may have moved the AppVar, so the header is looked up again
+    HistoryHeader* header = history_header(handle);
+    header->newest = header->entry_count > 0 ? (header->newest + 1) % HISTORY_ENTRIES : 0;
+    header->index[header->newest] = end;
+    if (header->entry_count < HISTORY_ENTRIES) {
+        header->entry_count++;
+    }
+    header->end = end + size;
+    ti_Close(handle);
+}
+
+/**
+ * Gets an entry of the history. The text is not copied: it points into
+ * the AppVar and stays valid until an AppVar is next written.
+ *
+ * @param back How far back the entry is, 0 being the newest.
+ * @param entry Pointer to the structure to fill.
+ * @return True if the entry exists, false otherwise.
+ */
+bool get_history(int back, HistoryEntry* entry) {
+    uint8_t handle = ti_Open(HISTORY_APPVAR_NAME, "r");
+    if (!handle) {
+        return false;
+    }
+
+    const HistoryHeader* header = ti_GetDataPtr(handle);
+    bool found = ti_GetSize(handle) >= sizeof(HistoryHeader) &&
+                 header->version == HISTORY_VERSION &&
+                 back >= 0 && back < header->entry_count;
+    if (found) {
+        const uint8_t* record = (const uint8_t*)header +
+                                header->index[(header->newest + HISTORY_ENTRIES - back) % HISTORY_ENTRIES];
+        uint8_t settings = record[1 + record[0]];
+        entry->length = record[0];
+        entry->text = (const char*)&record[1];
+        entry->arithmetic_mode = (ArithmeticType)(settings & 0x03);
+        entry->use_significant_digits = (settings & 0x04) != 0;
+        entry->precision = settings >> 4;
+        memcpy(&entry->value, &record[2 + record[0]], sizeof(real_t));
+    }
+    ti_Close(handle);
+    return found;
+}
+
+/**
+ * Opens the history for writing, in RAM, creating it if it does not
+ * exist or has another layout.
+ *
+ * @return The handle of the AppVar, or 0 if it could not be opened.
+ */
+static uint8_t open_history(void) {
+    uint8_t handle = ti_Open(HISTORY_APPVAR_NAME, "r+");
+    if (handle) {
+        if (ti_GetSize(handle) >= sizeof(HistoryHeader) &&
+            history_header(handle)->version == HISTORY_VERSION) {
+            // An archived AppVar cannot be written to
+            if (ti_IsArchived(handle)) {
+                ti_SetArchiveStatus(false, handle);
+            }
+            return handle;
+        }
+        ti_Close(handle);
+    }
+
+    handle = ti_Open(HISTORY_APPVAR_NAME, "w");
+    if (!handle) {
+        return 0;
+    }
+
+    if (ti_Resize(sizeof(HistoryHeader), handle) != sizeof(HistoryHeader)) {
+        ti_Close(handle);
+        return 0;
+    }
+    HistoryHeader* header = history_header(handle);
+    memset(header, 0, sizeof(HistoryHeader));
+    header->version = HISTORY_VERSION;
+    header->end = sizeof(HistoryHeader);
+    return handle;
+}
+
+/**
+ * Gets the header of an open history.
+ *
+ * @param handle The handle of the AppVar.
+ * @return Pointer to the header, in the AppVar itself.
+ */
+static HistoryHeader* history_header(uint8_t handle) {
+    ti_Rewind(handle);
+    return ti_GetDataPtr(handle);
+}
+
+/**
+ * Moves the entries still in the index to just after the header, and
+ * shrinks the AppVar to them. They are the newest ones, so they already
+ * lie together at the end.
+ *
+ * @param handle The handle of the AppVar, in RAM.
+ */
+static void compact_history(uint8_t handle) {
+    HistoryHeader* header = history_header(handle);
+    uint16_t start = sizeof(HistoryHeader);
+    if (header->entry_count > 0) {
+        int oldest = (header->newest + HISTORY_ENTRIES - header->entry_count + 1) % HISTORY_ENTRIES;
+        start = header->index[oldest];
+    }
+
+    uint16_t shift = start - sizeof(HistoryHeader);
+    memmove((uint8_t*)header + sizeof(HistoryHeader), (uint8_t*)header + start, header->end - start);
+    for (int i = 0; i < HISTORY_ENTRIES; i++) {
+        header->index[i] -= shift;
+    }
+    header->end -= shift;
+
+    uint16_t end = header->end;
+    ti_Resize(end, handle);
+    LOG_DEBUG("History compacted, %d bytes in use", end);
+}
@@ -12,7 +12,7 @@
 #include <stdbool.h>
 #include <fileioc.h>
 #include "headers/ui.h"
-#include "headers/kb_handler.h"
+#include "../../common/headers/kb_handler.h"
 #include "headers/log.h"
 #include "headers/log_private.h"
 
@@ -21,15 +21,41 @@
 /** Maximum length of a single log message */
 #define MAX_LOG_MSG_LENGTH 100
 
+/** Buffer length for a real_t written by os_RealToStr */
+#define MAX_REAL_STR_LENGTH 20
+
 /** Debug AppVar name */
 #define DEBUG_APPVAR_NAME "DBGLOG"
 
+/** Size of the in-RAM log ring buffer */
+#define LOG_BUFFER_SIZE 1024
+
+/** Buffered bytes that trigger a flush to the AppVar */
+#define LOG_FLUSH_THRESHOLD (LOG_BUFFER_SIZE - 2 * MAX_LOG_MSG_LENGTH)
+
 /** Debug buffer to prepare log messages */
 static char debug_buffer[MAX_LOG_MSG_LENGTH];
 
+/** Ring buffer holding messages not yet written to the AppVar */
+static char log_buffer[LOG_BUFFER_SIZE];
+
+/** Index of the oldest buffered byte */
+static uint16_t log_head = 0;
+
+/** Number of buffered bytes */
+static uint16_t log_count = 0;
+
+/** Number of messages dropped because the buffer was full */
+static unsigned int log_dropped = 0;
+
+/** Handle to the debug AppVar, kept open while the logger runs */
+static uint8_t log_handle = 0;
+
+/* ============================== Logger Lifecycle ============================== */
+
 /**
  * Initializes the debug logger.
- * Creates the debug AppVar if it doesn't exist.
+ * Creates the debug AppVar and keeps it open until the logger is closed.
  */
 void logger_init(void) {
     #ifndef DEBUG
@@ -40,13 +66,14 @@ void logger_init(void) {
    println("Initializing logger");
 
     // Clear the log
-    uint8_t handle = logger_get_handle("w");
-    if (handle) {
+    log_handle = logger_get_handle("w");
+    if (log_handle) {
        // Write initial message
        const char *init_msg = "\nMathSolver Debug Log\n";
-       ti_Write(init_msg, 1, strlen(init_msg), handle);
-       ti_Close(handle);
-       ti_SetArchiveStatus(true, handle);
+       ti_Write(init_msg, 1, strlen(init_msg), log_handle);
+
+       // Messages logged before the AppVar was open
+       log_flush();
    }
 
    println("Logger initialized");
@@ -54,28 +81,31 @@ void logger_init(void) {
 
 /**
  * Closes the debug logger.
- * Appends a closing message to the log.
+ * Appends a closing message, flushes the buffer and archives the log.
  */
 void logger_close(void) {
     #ifndef DEBUG
     return;
     #endif
 
-    // Append the log
-    uint8_t handle = logger_get_handle("a");
-    if (!handle) {
+    if (!log_handle) {
         return;
     }
     
     // Append log message
-    const char *close_msg = "\nMathSolver Debug Log Closed\n";
-    ti_Write(close_msg, 1, strlen(close_msg), handle);
-    ti_Close(handle);
-    ti_SetArchiveStatus(true, handle);
+    log_buffer_append("\nMathSolver Debug Log Closed\n");
+    log_flush();
+
+    ti_SetArchiveStatus(true, log_handle);
+    ti_Close(log_handle);
+    log_handle = 0;
 }
 
+/* ============================== Log Buffer ============================== */
+
 /**
  * Adds a message to the debug log.
+ * The message is buffered in RAM and written to the AppVar in batches.
  * 
  * @param format Format string similar to printf.
  * @param ... Variable arguments for the format string.
@@ -96,17 +126,67 @@ void log_message(const char* format, ...) {
 
     dbg_printf("%s", debug_buffer);
     
-    // Append the log
-    uint8_t handle = logger_get_handle("a");
-    if (!handle) {
+    log_buffer_append(debug_buffer);
+    if (log_count >= LOG_FLUSH_THRESHOLD) {
+        log_flush();
+    }
+}
+
+/**
+ * Writes the buffered messages to the debug AppVar.
+ * If messages were dropped since the last flush, a note with their
+ * count is written after them.
+ */
+void log_flush(void) {
+    #ifndef DEBUG
+    return;
+    #endif
+
+    if (!log_handle) {
+        // Nowhere to write yet, keep the messages buffered
         return;
     }
-    
-    // Append log message
-    ti_Write(debug_buffer, 1, strlen(debug_buffer), handle);
-    
-    // Close AppVar
-    ti_Close(handle);
+
+    // The buffered bytes wrap around at most once
+    uint16_t first = LOG_BUFFER_SIZE - log_head;
+    if (first > log_count) {
+        first = log_count;
+    }
+    ti_Write(&log_buffer[log_head], 1, first, log_handle);
+    if (log_count > first) {
+        ti_Write(log_buffer, 1, log_count - first, log_handle);
+    }
+
+    log_head = 0;
+    log_count = 0;
+
+    if (log_dropped > 0) {
+        char note[32];
+        int length = snprintf(note, sizeof(note), "[%u messages dropped]\n", log_dropped);
+        ti_Write(note, 1, length, log_handle);
+        log_dropped = 0;
+    }
+}
+
+/**
+ * Appends a message to the ring buffer.
+ * A message that does not fit is dropped and counted.
+ * 
+ * @param message The message to append.
+ */
+static void log_buffer_append(const char* message) {
+    uint16_t length = strlen(message);
+    if (length > LOG_BUFFER_SIZE - log_count) {
+        log_dropped++;
+        return;
+    }
+
+    uint16_t tail = (log_head + log_count) % LOG_BUFFER_SIZE;
+    for (uint16_t i = 0; i < length; i++) {
+        log_buffer[tail] = message[i];
+        tail = (tail + 1) % LOG_BUFFER_SIZE;
+    }
+    log_count += length;
 }
 
 /**
@@ -128,14 +208,7 @@ static uint8_t logger_get_handle(char* mode) {
     return handle;
 }
 
-/**
- * Logs a debug message.
- * 
- * @param message The debug message to log.
- */
-void log_debug(const char* message) {
-    log_message("DEBUG: %s", message);
-}
+/* ============================== Log Helpers ============================== */
 
 /**
  * Logs a variable value.
@@ -144,7 +217,9 @@ void log_debug(const char* message) {
  * @param value Variable value.
  */
 void log_variable(const char* name, real_t value) {
-    log_message("VAR: %s = %.6f", name, value);
+    char value_str[MAX_REAL_STR_LENGTH];
+    os_RealToStr(value_str, &value, MAX_REAL_STR_LENGTH, 0, -1);
+    log_message("VAR: %s = %s", name, value_str);
 }
 
 /**
@@ -153,47 +228,26 @@ void log_variable(const char* name, real_t value) {
  * @param operation The operation description.
  * @param result The result of the operation.
  */
-void log_operation(const char* operation, char* result) {
-    log_message("OP: %s = %.6f", operation, result);
-}
-
-/**
- * Logs an error message.
- * 
- * @param error The error message.
- */
-void log_error(const char* error) {
-    log_message("ERROR: %s", error);
-}
-
-/**
- * Logs a token with its type and value.
- * 
- * @param source The source of the token.
- * @param type The type of the token.
- * @param value The value of the token.
- */
-void log_token(const char* source, int type, const char* value) {
-   if (type == TOKEN_NONE) {
-       log_message("(%s) Token not identified: '%s' (0x%x)", source, value, value);
-   }
-   else
-       log_message("(%s) Token identified: Type=%s, Value=%s", source, get_token_type(type), value);
+void log_operation(const char* operation, real_t result) {
+    char result_str[MAX_REAL_STR_LENGTH];
+    os_RealToStr(result_str, &result, MAX_REAL_STR_LENGTH, 0, -1);
+    log_message("OP: %s = %s", operation, result_str);
 }
 
 /**
- * Logs a char token with its type and value.
+ * Logs a token with its type and text.
  * 
  * @param source The source of the token.
  * @param type The type of the token.
- * @param value The value of the token.
+ * @param text The text of the token in the input.
+ * @param length The length of the text.
  */
-void log_token_char(const char* source, int type, const char value) {
+void log_token(const char* source, int type, const char* text, int length) {
    if (type == TOKEN_NONE) {
-       log_message("(%s) Token not identified: '%s' (0x%x)", source, value, value);
+       log_message("(%s) Token not identified: '%.*s' (0x%x)", source, length, text, (uint8_t)text[0]);
    }
    else
-       log_message("(%s) Token identified: Type=%s, Value=%s", source, get_token_type(type), value);
+       log_message("(%s) Token identified: Type=%s, Value=%.*s", source, get_token_type(type), length, text);
 }
 
 /**
@@ -219,8 +273,7 @@ static char* get_token_type(int type) {
    case TOKEN_POWER:       return "POWER";
    case TOKEN_RIGHT_PAREN: return "RIGHT_PAREN";
    case TOKEN_VARIABLE:    return "VARIABLE";
-   case TOKEN_PI:          return "PI";
-   case TOKEN_PHI:         return "PHI";
+   case TOKEN_CONSTANT:    return "CONSTANT";
    default:
        return "-";
    }
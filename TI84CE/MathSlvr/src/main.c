@@ -14,6 +14,7 @@
 #include "headers/mathsolver.h"
 #include "headers/ui.h"
 #include "headers/log.h"
+#include "headers/profile.h"
 #include "headers/main_private.h"
 
 /**
@@ -28,12 +29,17 @@
 int main(void) {
 
     logger_init();
+    PROFILE_INIT();
     screen_init();
     mathsolver_init();
+    load_result_cache();
     
     // Set up some default variables for convenience
     set_variable("x", ZERO); // Initializes variable 'x' with a default value of 0.
     set_variable("y", ZERO); // Initializes variable 'y' with a default value of 0.
+
+    // The variables of the last run replace the defaults
+    load_history();
     
     // Set arithmetic mode to normal.
     // Note: Setting up normal arithmetic the number of decimal places is ignored, as is the use of significant digits.
@@ -43,6 +49,9 @@ int main(void) {
     run_calculator_ui();
     
     // Clean up
+    save_result_cache();
+    save_history();
+    PROFILE_DUMP();
     mathsolver_cleanup(); 
     logger_close();
     
@@ -50,12 +59,14 @@ int main(void) {
 }
 
 static void screen_init(void){
-    log_debug("Initializing screen");
+    LOG_DEBUG("Initializing screen");
     os_ClrHome();
     kb_Reset();
     os_FontSelect(os_SmallFont);
-    log_message("Font ID: %d", (int)os_FontGetID());
+#if LOG_ENABLED(LOG_LEVEL_INFO)
+    LOG_INFO("Font ID: %d", (int)os_FontGetID());
     uint24_t width = os_FontGetWidth("W");
     uint24_t height = os_FontGetHeight();
-    log_message("Font size: (%d x %d)", width, height);
+    LOG_INFO("Font size: (%d x %d)", width, height);
+#endif
 }
@@ -15,48 +15,23 @@ ArithmeticType current_arithmetic_type = ARITHMETIC_NORMAL;
 int current_precision = 4;
 bool current_use_significant_digits = false;
 
-/**
- * Static memory pool for expression nodes.
- * Used to allocate nodes for the expression tree.
- */
-static ExpressionNode node_pool[MAX_NODES];
-
-real_t PI;
-real_t E;
-real_t PHI;
-real_t ZERO;
-real_t LOG10;
+/* Constants as real_t literals, rounded to the 14 digits a real_t holds */
+const real_t PI = REAL_LITERAL(0x00, 0x80, 0x31, 0x41, 0x59, 0x26, 0x53, 0x58, 0x98);
+const real_t E = REAL_LITERAL(0x00, 0x80, 0x27, 0x18, 0x28, 0x18, 0x28, 0x45, 0x90);
+const real_t PHI = REAL_LITERAL(0x00, 0x80, 0x16, 0x18, 0x03, 0x39, 0x88, 0x74, 0x99);
+const real_t ZERO = REAL_LITERAL(0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+const real_t LOG10 = REAL_LITERAL(0x00, 0x80, 0x23, 0x02, 0x58, 0x50, 0x92, 0x99, 0x40);
 
 /**
  * Initializes the math solver.
- * Resets the node pool and variable list to their initial states.
+ * The constants are built by the compiler, and the node pool and variable
+ * list start zeroed like all static data, so only the counters are reset.
  */
 void mathsolver_init(void) {
-    init_constants();
-
-    // Reset node pool
     node_pool_index = 0;
-    memset(node_pool, 0, sizeof(node_pool));
-    
-    // Reset variables
     variable_count = 0;
-    memset(variables, 0, sizeof(variables));
 
-    log_debug("MathSolver initialized");
-}
-
-/**
- * Initializes the math solver constants.
- * Sets up the values for PI, E, PHI, ZERO, and LOG10.
- */
-static void init_constants(void)
-{
-    real_t x = os_FloatToReal(10.0);
-    E = os_FloatToReal(2.71828182845904523536);
-    PI = os_FloatToReal(3.14159265358979323846);
-    PHI = os_FloatToReal(1.61803398874989484820);
-    ZERO = os_Int24ToReal(0);
-    LOG10 = os_RealLog(&x);
+    LOG_DEBUG("MathSolver initialized");
 }
 
 /**
@@ -67,8 +42,12 @@ void mathsolver_cleanup(void) {
     // Reset node pool
     node_pool_index = 0;
     
-    // Reset variables
+    // Reset variables; the symbol table finds free slots by their empty name
+    memset(variables, 0, sizeof(variables));
     variable_count = 0;
 
-    log_debug("MathSolver cleaned up");
+    // The spilled steps only lived for the result they belong to
+    discard_steps();
+
+    LOG_DEBUG("MathSolver cleaned up");
 }
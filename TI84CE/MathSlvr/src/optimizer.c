@@ -0,0 +1,280 @@
+/**
+ * MathSolver for TI-84 CE - Expression Optimizer
+ *
+ * Folds constant subtrees into numbers and merges identical subtrees, so
+ * the tree becomes a DAG that the bytecode compiler evaluates once per
+ * shared node. Meant for expressions that are evaluated many times; the
+ * step-by-step display works on the unoptimized tree to keep every step.
+ */
+
+#include <string.h>
+#include <ti/real.h>
+#include "headers/log.h"
+#include "headers/mathsolver.h"
+#include "headers/optimizer_private.h"
+
+/** Slots in the table of distinct nodes (a power of two above MAX_NODES) */
+#define NODE_TABLE_SIZE 256
+
+/** Distinct nodes found so far, by hash */
+static NodeIndex node_table[NODE_TABLE_SIZE];
+
+/** Node each arena index was replaced by */
+static NodeIndex replacement[MAX_NODES];
+
+/**
+ * Optimizes a parsed expression in place.
+ * Constant subtrees are evaluated once with the formatting given, so they
+ * follow that arithmetic mode: optimize again for another mode. Nodes are
+ * visited in arena order, which is bottom-up since the parser allocates
+ * every node after its children.
+ *
+ * @param root Pointer to the root node returned by the parser.
+ * @param format The formatting of the arithmetic mode the expression runs in.
+ * @return Pointer to the root of the optimized expression.
+ */
+ExpressionNode* optimize_expression(ExpressionNode* root, const ArithmeticFormat* format) {
+    if (root == NULL) {
+        return NULL;
+    }
+
+    memset(node_table, NODE_NONE, sizeof(node_table));
+    int folded = 0;
+    int shared = 0;
+
+    for (int index = 0; index < node_pool_index; index++) {
+        ExpressionNode* node = &node_pool[index];
+        replace_children(node);
+
+        if (node->type == NODE_PARENTHESIS) {
+            // Parentheses only shape the tree, the parser already did that
+            replacement[index] = node->parenthesis.expression;
+            continue;
+        }
+
+        if (node->type != NODE_NUMBER && has_constant_operands(node) && is_defined(node)) {
+            node->number_value = evaluate_node(node, format);
+            node->type = NODE_NUMBER;
+            folded++;
+        }
+
+        replacement[index] = find_or_add_node((NodeIndex)index);
+        if (replacement[index] != index) {
+            shared++;
+        }
+    }
+
+    LOG_DEBUG("Optimizer folded %d nodes and shared %d", folded, shared);
+    return NODE_AT(replacement[root - node_pool]);
+}
+
+/**
+ * Points the children of a node to their replacements.
+ *
+ * @param node Pointer to the node.
+ */
+static void replace_children(ExpressionNode* node) {
+    switch (node->type) {
+        case NODE_ADDITION:
+        case NODE_SUBTRACTION:
+        case NODE_MULTIPLICATION:
+        case NODE_DIVISION:
+        case NODE_EXPONENT:
+            node->binary_op.left = replace(node->binary_op.left);
+            node->binary_op.right = replace(node->binary_op.right);
+            break;
+
+        case NODE_FUNCTION:
+            node->function.argument = replace(node->function.argument);
+            break;
+
+        case NODE_FACTORIAL:
+            node->factorial.expression = replace(node->factorial.expression);
+            break;
+
+        case NODE_PARENTHESIS:
+            node->parenthesis.expression = replace(node->parenthesis.expression);
+            break;
+
+        case NODE_SUMMATION:
+        case NODE_PRODUCT:
+            node->iterator.body = replace(node->iterator.body);
+            node->iterator.start = replace(node->iterator.start);
+            node->iterator.end = replace(node->iterator.end);
+            break;
+    }
+}
+
+/**
+ * Gets the replacement of a node that was already visited.
+ *
+ * @param index Index of the node, or NODE_NONE.
+ * @return Index of the replacement.
+ */
+static NodeIndex replace(NodeIndex index) {
+    return index == NODE_NONE ? NODE_NONE : replacement[index];
+}
+
+/**
+ * Tells whether every operand of an operation is a number.
+ * A missing operand evaluates to zero, so it counts as a number.
+ *
+ * @param node Pointer to the node, with its children already replaced.
+ * @return True if the node can be folded.
+ */
+static bool has_constant_operands(const ExpressionNode* node) {
+    switch (node->type) {
+        case NODE_ADDITION:
+        case NODE_SUBTRACTION:
+        case NODE_MULTIPLICATION:
+        case NODE_DIVISION:
+        case NODE_EXPONENT:
+            return is_number(node->binary_op.left) && is_number(node->binary_op.right);
+
+        case NODE_FUNCTION:
+            return is_number(node->function.argument);
+
+        case NODE_FACTORIAL:
+            return is_number(node->factorial.expression);
+
+        default:
+            return false;
+    }
+}
+
+/**
+ * Tells whether an operation on numbers is defined. An undefined one is
+ * left for the VM, which flags the value as undefined when it runs.
+ *
+ * @param node Pointer to the node, with constant operands.
+ * @return True if the node can be folded to its value.
+ */
+static bool is_defined(const ExpressionNode* node) {
+    switch (node->type) {
+        case NODE_DIVISION: {
+            real_t divisor = number_value(node->binary_op.right);
+            return os_RealCompare(&divisor, &ZERO) != 0;
+        }
+
+        case NODE_EXPONENT:
+            return in_power_domain(number_value(node->binary_op.left), number_value(node->binary_op.right));
+
+        case NODE_FUNCTION:
+            return in_function_domain(node->function.func_type, number_value(node->function.argument));
+
+        case NODE_FACTORIAL: {
+            real_t factorial;
+            return evaluate_factorial(number_value(node->factorial.expression), &factorial) == FACTORIAL_OK;
+        }
+
+        default:
+            return true;
+    }
+}
+
+/**
+ * Gets the value of a number node; a missing operand evaluates to zero.
+ *
+ * @param index Index of the node, or NODE_NONE.
+ * @return The value of the number.
+ */
+static real_t number_value(NodeIndex index) {
+    return index == NODE_NONE ? ZERO : node_pool[index].number_value;
+}
+
+/**
+ * Tells whether a node is a number, or missing.
+ *
+ * @param index Index of the node, or NODE_NONE.
+ * @return True if the node is constant.
+ */
+static bool is_number(NodeIndex index) {
+    return index == NODE_NONE || node_pool[index].type == NODE_NUMBER;
+}
+
+/**
+ * Finds a node identical to a given one, or records the node as new.
+ *
+ * @param index Index of the node, with its children already replaced.
+ * @return Index of the identical node seen first.
+ */
+static NodeIndex find_or_add_node(NodeIndex index) {
+    const ExpressionNode* node = &node_pool[index];
+    uint8_t slot = hash_node(node);
+
+    while (node_table[slot] != NODE_NONE) {
+        if (same_node(&node_pool[node_table[slot]], node)) {
+            return node_table[slot];
+        }
+        slot = (uint8_t)((slot + 1) & (NODE_TABLE_SIZE - 1));
+    }
+
+    node_table[slot] = index;
+    return index;
+}
+
+/**
+ * Hashes the type and contents of a node (FNV-1a over its bytes).
+ *
+ * @param node Pointer to the node.
+ * @return Home slot of the node in the table.
+ */
+static uint8_t hash_node(const ExpressionNode* node) {
+    const uint8_t* bytes;
+    uint8_t length;
+
+    if (node->type == NODE_NUMBER) {
+        bytes = (const uint8_t*)&node->number_value;
+        length = sizeof(real_t);
+    } else {
+        // Every other kind of node fits in its first two payload bytes,
+        // or is told apart by them often enough
+        bytes = (const uint8_t*)&node->binary_op;
+        length = 2;
+    }
+
+    uint8_t hash = (uint8_t)(0x81 ^ node->type);
+    while (length--) {
+        hash = (uint8_t)((hash ^ *bytes++) * 0x93);
+    }
+    return hash;
+}
+
+/**
+ * Tells whether two nodes compute the same value.
+ *
+ * @param a Pointer to the first node.
+ * @param b Pointer to the second node.
+ * @return True if the nodes have the same type and contents.
+ */
+static bool same_node(const ExpressionNode* a, const ExpressionNode* b) {
+    if (a->type != b->type) {
+        return false;
+    }
+
+    switch (a->type) {
+        case NODE_NUMBER:
+            return memcmp(&a->number_value, &b->number_value, sizeof(real_t)) == 0;
+
+        case NODE_VARIABLE:
+            return a->variable.symbol == b->variable.symbol;
+
+        case NODE_FUNCTION:
+            return a->function.func_type == b->function.func_type &&
+                   a->function.argument == b->function.argument;
+
+        case NODE_FACTORIAL:
+            return a->factorial.expression == b->factorial.expression;
+
+        case NODE_SUMMATION:
+        case NODE_PRODUCT:
+            return a->iterator.symbol == b->iterator.symbol &&
+                   a->iterator.body == b->iterator.body &&
+                   a->iterator.start == b->iterator.start &&
+                   a->iterator.end == b->iterator.end;
+
+        default:
+            return a->binary_op.left == b->binary_op.left &&
+                   a->binary_op.right == b->binary_op.right;
+    }
+}
@@ -1,28 +1,140 @@
 #include <stdlib.h>
+#include <string.h>
 #include "headers/log.h"
 #include "headers/mathsolver.h"
+#include "headers/profile.h"
 #include "headers/parser_private.h"
 
 /**
- * Static memory pool for expression nodes.
+ * Memory pool for expression nodes.
  * Used to allocate nodes for the expression tree.
  */
-static ExpressionNode node_pool[MAX_NODES];
+ExpressionNode node_pool[MAX_NODES];
+
+_Static_assert(NODE_POOL_BYTES / sizeof(ExpressionNode) < NODE_NONE,
+               "Node indices must fit in a NodeIndex");
 
 /**
- * Expects a specific token type and advances, or reports an error.
- * 
- * @param tokenizer Pointer to the tokenizer.
- * @param type The expected token type.
- * @return True if the current token matches the expected type, false otherwise.
+ * Outcome of the last call to parse_expression_string.
  */
-static bool expect(Tokenizer* tokenizer, TokenType type) {
-    if (tokenizer->current_token.type == type) {
-        tokenizer->current_token = get_next_token(tokenizer);
-        return true;
-    }
-    return false;
-}
+static ParseStatus parse_status = PARSE_OK;
+
+/*
+ * The parser is an iterative precedence climber: operators wait on an
+ * explicit stack until an operator of lower precedence, a closing
+ * parenthesis or the end of the input reduces them into nodes. Nothing
+ * recurses, so nesting costs stack slots instead of hardware stack, and
+ * running out of slots is reported instead of crashing.
+ *
+ * Precedence, from loosest to tightest:
+ *   + -   left associative
+ *   * /   left associative
+ *   -x    prefix, so -2^2 is -(2^2) and -2*3 is (-2)*3
+ *   ^     right associative
+ *   !     postfix, applied to the operand right before it
+ *
+ * A sum or product, sum(body, variable, start, end), waits on the stack
+ * like a function; each comma closes one of its arguments.
+ */
+
+/** Precedence of unary minus */
+#define PRECEDENCE_NEGATE 3
+
+/**
+ * Kinds of entries on the operator stack.
+ */
+typedef enum {
+    PENDING_BINARY,     /**< Binary operator waiting for its right operand */
+    PENDING_NEGATE,     /**< Unary minus waiting for its operand */
+    PENDING_GROUP,      /**< Open parenthesis */
+    PENDING_FUNCTION,   /**< Function waiting for its closing parenthesis */
+    PENDING_ITERATOR    /**< Sum or product waiting for its arguments */
+} PendingKind;
+
+/**
+ * Entry of the operator stack.
+ */
+typedef struct {
+    uint8_t kind;               /**< PendingKind */
+    uint8_t id;                 /**< NodeType of a binary operator or iterator, FunctionType of a function */
+    uint8_t precedence;         /**< Precedence of an operator */
+    uint8_t arguments;          /**< Commas read so far by an iterator */
+    SourcePosition position;    /**< Position of the token that pushed the entry */
+} PendingOperator;
+
+/**
+ * Binary operator table entry.
+ */
+typedef struct {
+    uint8_t node_type;          /**< NodeType built by the operator */
+    uint8_t precedence;         /**< Precedence, 0 for tokens that are not binary operators */
+    bool right_associative;     /**< Whether a chain groups from the right */
+} BinaryOperator;
+
+/**
+ * Binary operators, indexed by TokenType.
+ */
+static const BinaryOperator BINARY_OPERATORS[TOKEN_CONSTANT + 1] = {
+    [TOKEN_PLUS]     = { NODE_ADDITION,       1, false },
+    [TOKEN_MINUS]    = { NODE_SUBTRACTION,    1, false },
+    [TOKEN_MULTIPLY] = { NODE_MULTIPLICATION, 2, false },
+    [TOKEN_DIVIDE]   = { NODE_DIVISION,       2, false },
+    [TOKEN_POWER]    = { NODE_EXPONENT,       4, true },
+};
+
+/**
+ * States of the parser.
+ */
+typedef enum {
+    PARSER_OPERAND,     /**< An operand or a prefix comes next */
+    PARSER_OPERATOR,    /**< An operator, a postfix or a closing parenthesis comes next */
+    PARSER_DONE         /**< The expression has ended */
+} ParserState;
+
+/** Operators waiting to be reduced */
+static PendingOperator operators[PARSER_STACK_SIZE];
+static uint8_t operator_count;
+
+/** Operands waiting for their operator; there is at most one more than there are operators */
+static NodeIndex operands[PARSER_STACK_SIZE + 1];
+static uint8_t operand_count;
+
+/*
+ * An expression being typed changes mostly at its end. Every few steps an
+ * incremental parse saves the whole parser state; the next one resumes
+ * from the last state saved before the first character that changed, so
+ * the nodes of the unchanged prefix stay where they are in the pool and
+ * only the edited suffix is read again.
+ */
+
+/**
+ * Characters the tokenizer may read past the token it stops on: a number
+ * looks at an exponent marker, its sign and a digit after its last digit.
+ */
+#define TOKEN_LOOKAHEAD 3
+
+/**
+ * Parser state saved between two tokens.
+ */
+typedef struct {
+    Tokenizer tokenizer;                             /**< Tokenizer, with the next token read */
+    uint8_t state;                                   /**< ParserState */
+    uint8_t operator_count;                          /**< Operators waiting */
+    uint8_t operand_count;                           /**< Operands waiting */
+    NodeIndex node_count;                            /**< Nodes allocated so far */
+    PendingOperator operators[PARSER_STACK_SIZE];    /**< Operator stack */
+    NodeIndex operands[PARSER_STACK_SIZE + 1];       /**< Operand stack */
+} ParserCheckpoint;
+
+/** Input of the last incremental parse */
+static char resume_input[MAX_INPUT_LENGTH + 1];
+
+/** States saved by the last incremental parse, oldest first */
+static ParserCheckpoint checkpoints[PARSER_CHECKPOINTS];
+static uint8_t checkpoint_count = 0;
+
+/** Nodes allocated when the last incremental parse ended */
+static int resume_node_count = -1;
 
 /**
  * Parses an input string into an expression tree.
@@ -31,249 +143,448 @@ static bool expect(Tokenizer* tokenizer, TokenType type) {
  * @return Pointer to the root of the parsed expression tree, or NULL on error.
  */
 ExpressionNode* parse_expression_string(const char* input) {
-    // Reset node pool
+    // Reset node pool; the nodes kept for an incremental parse are lost
     node_pool_index = 0;
+    parse_status = PARSE_OK;
+    checkpoint_count = 0;
 
-    log_debug("Parsing expression string");
-    log_message("Expression input: %s", input);
+    // No tree refers to the names of the last expression any more
+    release_undefined_symbols();
+
+    LOG_DEBUG("Parsing expression string");
+    LOG_DEBUG("Expression input: %s", input);
     
     // Initialize tokenizer
     Tokenizer tokenizer;
     tokenizer_init(&tokenizer, input);
     
     // Parse the expression
+    PROFILE_START(PROFILE_PARSE);
     ExpressionNode* root = parse_expression(&tokenizer);
+    PROFILE_STOP(PROFILE_PARSE);
     if (root == NULL) {
-        log_error("Failed to parse expression");
+        LOG_ERROR("Failed to parse expression");
     } else {
-        log_debug("Expression parsed successfully");
+        LOG_DEBUG("Expression parsed successfully");
     }
     return root;
 }
 
 /**
- * Parses an expression (addition/subtraction).
+ * Parses an input string into an expression tree, resuming from the state
+ * the last incremental parse was in before the first character that
+ * changed. Meant for an expression that is being typed: adding to its end
+ * reads only the last few tokens again.
+ * The tree is built in the node pool, like parse_expression_string; a full
+ * parse in between makes the next incremental parse start over.
+ * 
+ * @param input The input string to parse.
+ * @return Pointer to the root of the parsed expression tree, or NULL on error.
+ */
+ExpressionNode* parse_expression_incremental(const char* input) {
+    parse_status = PARSE_OK;
+
+    // Something else has used the node pool since the last incremental parse
+    if (node_pool_index != resume_node_count) {
+        checkpoint_count = 0;
+    }
+
+    // Drop the states that depend on a character that changed
+    int unchanged = 0;
+    while (unchanged < MAX_INPUT_LENGTH && input[unchanged] != '\0' && input[unchanged] == resume_input[unchanged]) {
+        unchanged++;
+    }
+    while (checkpoint_count > 0 &&
+           checkpoints[checkpoint_count - 1].tokenizer.position + TOKEN_LOOKAHEAD > unchanged) {
+        checkpoint_count--;
+    }
+    strncpy(resume_input, input, MAX_INPUT_LENGTH);
+    resume_input[MAX_INPUT_LENGTH] = '\0';
+
+    Tokenizer tokenizer;
+    uint8_t state;
+    if (checkpoint_count > 0) {
+        state = restore_checkpoint(&tokenizer);
+        tokenizer.input = input;
+        LOG_DEBUG("Resuming parse at position %d", tokenizer.position);
+    } else {
+        node_pool_index = 0;
+        operator_count = 0;
+        operand_count = 0;
+        state = PARSER_OPERAND;
+        release_undefined_symbols();
+        tokenizer_init(&tokenizer, input);
+        LOG_DEBUG("Parsing expression string from the start");
+    }
+
+    PROFILE_START(PROFILE_PARSE);
+    ExpressionNode* root = parse_from(&tokenizer, state, true);
+    PROFILE_STOP(PROFILE_PARSE);
+    resume_node_count = node_pool_index;
+    return root;
+}
+
+/**
+ * Gets the outcome of the last call to parse_expression_string.
+ * 
+ * @return PARSE_OK, or the reason the expression could not be parsed.
+ */
+ParseStatus get_parse_status(void) {
+    return parse_status;
+}
+
+/**
+ * Parses an expression up to the end of the input.
  * 
  * @param tokenizer Pointer to the tokenizer.
- * @return Pointer to the parsed expression node.
+ * @return Pointer to the root node, or NULL if the expression is invalid or does not fit.
  */
 static ExpressionNode* parse_expression(Tokenizer* tokenizer) {
-    ExpressionNode* left = parse_term(tokenizer);
-    
-    while (tokenizer->current_token.type == TOKEN_PLUS || 
-           tokenizer->current_token.type == TOKEN_MINUS) {
-        
-        TokenType operator_type = tokenizer->current_token.type;
-        SourcePosition operator_position = tokenizer->current_token.position;
-        
-        // Consume the operator
-        tokenizer->current_token = get_next_token(tokenizer);
-        
-        ExpressionNode* right = parse_term(tokenizer);
-        
-        if (operator_type == TOKEN_PLUS) {
-            left = create_binary_op_node(NODE_ADDITION, left, right, operator_position);
-        } else {
-            left = create_binary_op_node(NODE_SUBTRACTION, left, right, operator_position);
-        }
-    }
-    
-    return left;
+    operator_count = 0;
+    operand_count = 0;
+    return parse_from(tokenizer, PARSER_OPERAND, false);
 }
 
 /**
- * Parses a term (multiplication/division).
+ * Runs the parser from a state up to the end of the expression.
  * 
  * @param tokenizer Pointer to the tokenizer.
- * @return Pointer to the parsed term node.
+ * @param state The ParserState to start in.
+ * @param save Whether to save the parser state every PARSER_CHECKPOINT_SPACING steps.
+ * @return Pointer to the root node, or NULL if the expression is invalid or does not fit.
  */
-static ExpressionNode* parse_term(Tokenizer* tokenizer) {
-    ExpressionNode* left = parse_factor(tokenizer);
-    
-    while (tokenizer->current_token.type == TOKEN_MULTIPLY || 
-           tokenizer->current_token.type == TOKEN_DIVIDE) {
-        
-        TokenType operator_type = tokenizer->current_token.type;
-        SourcePosition operator_position = tokenizer->current_token.position;
-        
-        // Consume the operator
-        tokenizer->current_token = get_next_token(tokenizer);
-        
-        ExpressionNode* right = parse_factor(tokenizer);
-        
-        if (operator_type == TOKEN_MULTIPLY) {
-            left = create_binary_op_node(NODE_MULTIPLICATION, left, right, operator_position);
+static ExpressionNode* parse_from(Tokenizer* tokenizer, uint8_t state, bool save) {
+    uint8_t steps = 0;
+    while (state != PARSER_DONE && parse_status == PARSE_OK) {
+        state = (state == PARSER_OPERAND) ? parse_operand(tokenizer) : parse_operator(tokenizer);
+        if (save && ++steps == PARSER_CHECKPOINT_SPACING) {
+            steps = 0;
+            if (state != PARSER_DONE && parse_status == PARSE_OK) {
+                save_checkpoint(tokenizer, state);
+            }
+        }
+    }
+
+    // Close what is still open; a missing ')' is tolerated
+    while (operator_count > 0 && parse_status == PARSE_OK) {
+        reduce_operator();
+    }
+
+    if (parse_status != PARSE_OK) {
+        if (parse_status == PARSE_TOO_COMPLEX) {
+            LOG_ERROR("Expression too complex");
+        } else if (parse_status == PARSE_TOO_LONG) {
+            LOG_ERROR("Expression too long");
+        } else if (parse_status == PARSE_INVALID) {
+            LOG_ERROR("Malformed sum or product");
+        } else if (parse_status == PARSE_TOO_MANY_VARIABLES) {
+            LOG_ERROR("Too many variables");
         } else {
-            left = create_binary_op_node(NODE_DIVISION, left, right, operator_position);
+            LOG_ERROR("Unexpected token at position %d", tokenizer->current_token.position.start);
         }
+        return NULL;
     }
-    
-    return left;
+    return pop_operand();
 }
 
 /**
- * Parses a factor (exponentiation).
+ * Saves the parser state, dropping the oldest saved state when all are in use.
  * 
  * @param tokenizer Pointer to the tokenizer.
- * @return Pointer to the parsed factor node.
+ * @param state The ParserState the parser is in.
  */
-static ExpressionNode* parse_factor(Tokenizer* tokenizer) {
-    ExpressionNode* left = parse_primary(tokenizer);
-    
-    if (tokenizer->current_token.type == TOKEN_POWER) {
-        SourcePosition operator_position = tokenizer->current_token.position;
-        
-        // Consume the operator
-        tokenizer->current_token = get_next_token(tokenizer);
-        
-        ExpressionNode* right = parse_factor(tokenizer); // Note: right-associative
-        
-        left = create_binary_op_node(NODE_EXPONENT, left, right, operator_position);
+static void save_checkpoint(const Tokenizer* tokenizer, uint8_t state) {
+    if (checkpoint_count == PARSER_CHECKPOINTS) {
+        memmove(&checkpoints[0], &checkpoints[1], (PARSER_CHECKPOINTS - 1) * sizeof(ParserCheckpoint));
+        checkpoint_count--;
     }
-    
-    if (tokenizer->current_token.type == TOKEN_FACTORIAL) {
-        SourcePosition operator_position = tokenizer->current_token.position;
-        
-        // Consume the operator
-        tokenizer->current_token = get_next_token(tokenizer);
-        
-        left = create_factorial_node(left, operator_position);
-    }
-    
-    return left;
+
+    ParserCheckpoint* checkpoint = &checkpoints[checkpoint_count++];
+    checkpoint->tokenizer = *tokenizer;
+    checkpoint->state = state;
+    checkpoint->operator_count = operator_count;
+    checkpoint->operand_count = operand_count;
+    checkpoint->node_count = (NodeIndex)node_pool_index;
+    memcpy(checkpoint->operators, operators, operator_count * sizeof(PendingOperator));
+    memcpy(checkpoint->operands, operands, operand_count * sizeof(NodeIndex));
+}
+
+/**
+ * Puts the parser back in the last saved state. The nodes allocated after
+ * that state was saved are freed.
+ * 
+ * @param tokenizer Pointer to the tokenizer to restore.
+ * @return The ParserState to resume in.
+ */
+static uint8_t restore_checkpoint(Tokenizer* tokenizer) {
+    const ParserCheckpoint* checkpoint = &checkpoints[checkpoint_count - 1];
+    *tokenizer = checkpoint->tokenizer;
+    operator_count = checkpoint->operator_count;
+    operand_count = checkpoint->operand_count;
+    node_pool_index = checkpoint->node_count;
+    memcpy(operators, checkpoint->operators, operator_count * sizeof(PendingOperator));
+    memcpy(operands, checkpoint->operands, operand_count * sizeof(NodeIndex));
+    return checkpoint->state;
 }
 
 /**
- * Parses a primary expression (numbers, variables, functions, parenthesized expressions).
+ * Reads an operand, or a prefix that waits for one.
+ * A token that cannot start an operand ends the parse with an error.
  * 
  * @param tokenizer Pointer to the tokenizer.
- * @return Pointer to the parsed primary expression node.
+ * @return The next state of the parser (ParserState).
  */
-static ExpressionNode* parse_primary(Tokenizer* tokenizer) {
-    Token token = tokenizer->current_token;
-    
-    switch ((int)token.type) {
+static uint8_t parse_operand(Tokenizer* tokenizer) {
+    const Token* token = &tokenizer->current_token;
+    uint8_t id = token->id;
+    SourcePosition position = token->position;
+
+    switch ((int)token->type) {
         case TOKEN_NUMBER: {
-            // Consume the token
-            tokenizer->current_token = get_next_token(tokenizer);
-            
-            // Convert string to real_t
-            real_t value = os_StrToReal(token.value, NULL);
-            
-            return create_number_node(value, token.position);
+            // The tokenizer already converted the literal
+            real_t value = token->real_value;
+            next_token(tokenizer);
+            push_operand(create_number_node(value, position));
+            return PARSER_OPERATOR;
         }
 
-        case TOKEN_PI: {
-            // Consume the token
-            tokenizer->current_token = get_next_token(tokenizer);
-            
-            return create_number_node(PI, token.position);
+        case TOKEN_CONSTANT: {
+            bool found;
+            next_token(tokenizer);
+            push_operand(create_number_node(get_symbol_value(SYMBOL_CONSTANT | id, &found), position));
+            return PARSER_OPERATOR;
         }
 
-        case TOKEN_PHI: {
-            // Consume the token
-            tokenizer->current_token = get_next_token(tokenizer);
-            
-            return create_number_node(PHI, token.position);
-        }
-        
-        case TOKEN_VARIABLE: {
-            // Consume the token
-            tokenizer->current_token = get_next_token(tokenizer);
-            
-            return create_variable_node(token.value, token.position);
+        case TOKEN_VARIABLE:
+            next_token(tokenizer);
+            push_operand(create_variable_node(id, position));
+            return PARSER_OPERATOR;
+
+        case TOKEN_FUNCTION:
+            // The function node sits at the '(' after the name; like a
+            // missing ')', a missing '(' is tolerated
+            next_token(tokenizer);
+            position = tokenizer->current_token.position;
+            if (tokenizer->current_token.type == TOKEN_LEFT_PAREN) {
+                next_token(tokenizer);
+            }
+            push_operator(PENDING_FUNCTION, id, 0, position);
+            return PARSER_OPERAND;
+
+        case TOKEN_ITERATOR:
+            // The node sits at the name, which is what its step shows
+            next_token(tokenizer);
+            if (tokenizer->current_token.type == TOKEN_LEFT_PAREN) {
+                next_token(tokenizer);
+            }
+            push_operator(PENDING_ITERATOR, id, 0, position);
+            return PARSER_OPERAND;
+
+        case TOKEN_LEFT_PAREN:
+            next_token(tokenizer);
+            push_operator(PENDING_GROUP, 0, 0, position);
+            return PARSER_OPERAND;
+
+        case TOKEN_MINUS:
+            next_token(tokenizer);
+            push_operator(PENDING_NEGATE, NODE_SUBTRACTION, PRECEDENCE_NEGATE, position);
+            return PARSER_OPERAND;
+
+        default:
+            // An operator, a ')' or the end where an operand belongs, an
+            // unknown character, or a name the symbol table had no room for
+            parse_status = (token->type == TOKEN_NONE && id == SYMBOL_NONE) ? PARSE_TOO_MANY_VARIABLES
+                                                                           : PARSE_UNEXPECTED;
+            return PARSER_DONE;
+    }
+}
+
+/**
+ * Reads a binary operator, a factorial, a comma or a closing parenthesis.
+ * Anything else but the end of the input ends the parse with an error.
+ * 
+ * @param tokenizer Pointer to the tokenizer.
+ * @return The next state of the parser (ParserState).
+ */
+static uint8_t parse_operator(Tokenizer* tokenizer) {
+    const Token* token = &tokenizer->current_token;
+    TokenType type = token->type;
+    SourcePosition position = token->position;
+
+    if (type <= TOKEN_CONSTANT && BINARY_OPERATORS[type].precedence != 0) {
+        const BinaryOperator* binary = &BINARY_OPERATORS[type];
+
+        // Reduce the operators that bind at least as tightly as this one
+        while (operator_count > 0) {
+            const PendingOperator* top = &operators[operator_count - 1];
+            if (top->kind == PENDING_GROUP || top->kind == PENDING_FUNCTION ||
+                top->kind == PENDING_ITERATOR || top->precedence < binary->precedence ||
+                (top->precedence == binary->precedence && binary->right_associative)) {
+                break;
+            }
+            reduce_operator();
         }
-        
-        case TOKEN_FUNCTION: {
-            FunctionType func_type;
-            
-            // Determine which function
-            if (strcmp(token.value, "sin") == 0) {
-                func_type = FUNC_SIN;
-            } else if (strcmp(token.value, "cos") == 0) {
-                func_type = FUNC_COS;
-            } else if (strcmp(token.value, "tan") == 0) {
-                func_type = FUNC_TAN;
-            } else if (strcmp(token.value, "log") == 0) {
-                func_type = FUNC_LOG;
-            } else if (strcmp(token.value, "ln") == 0) {
-                func_type = FUNC_LN;
-            } else if (strcmp(token.value, "sqrt") == 0) {
-                func_type = FUNC_SQRT;
-            } else {
-                func_type = FUNC_NONE;
+
+        next_token(tokenizer);
+        push_operator(PENDING_BINARY, binary->node_type, binary->precedence, position);
+        return PARSER_OPERAND;
+    }
+
+    switch ((int)type) {
+        case TOKEN_FACTORIAL:
+            next_token(tokenizer);
+            push_operand(create_factorial_node(pop_operand(), position));
+            return PARSER_OPERATOR;
+
+        case TOKEN_COMMA: {
+            close_argument();
+            PendingOperator* top = operator_count > 0 ? &operators[operator_count - 1] : NULL;
+            if (top == NULL || top->kind != PENDING_ITERATOR) {
+                parse_status = PARSE_UNEXPECTED;
+                return PARSER_DONE;
+            }
+            if (top->arguments >= 3) {
+                parse_status = PARSE_INVALID;
+                return PARSER_DONE;
             }
-            
-            // Consume the function name
-            tokenizer->current_token = get_next_token(tokenizer);
-            
-            return parse_function(tokenizer, func_type);
+
+            top->arguments++;
+            next_token(tokenizer);
+            return PARSER_OPERAND;
         }
-        
-        case TOKEN_LEFT_PAREN: {
-            // Consume the '('
-            tokenizer->current_token = get_next_token(tokenizer);
-            
-            ExpressionNode* expr = parse_expression(tokenizer);
-            
-            // Expect a ')'
-            if (!expect(tokenizer, TOKEN_RIGHT_PAREN)) {
-                // Handle error: missing closing parenthesis
-                // In a real implementation, we would report an error
+
+        case TOKEN_RIGHT_PAREN:
+            close_argument();
+            if (operator_count == 0) {
+                // Unmatched ')'
+                parse_status = PARSE_UNEXPECTED;
+                return PARSER_DONE;
             }
-            
-            return create_parenthesis_node(expr, token.position);
+
+            next_token(tokenizer);
+            reduce_operator();
+            return PARSER_OPERATOR;
+
+        case TOKEN_END:
+            return PARSER_DONE;
+
+        default:
+            // An operand right after an operand, or an unknown character
+            parse_status = (type == TOKEN_NONE && token->id == SYMBOL_NONE) ? PARSE_TOO_MANY_VARIABLES
+                                                                            : PARSE_UNEXPECTED;
+            return PARSER_DONE;
+    }
+}
+
+/**
+ * Reduces the operators of the innermost open group, function or
+ * iterator argument.
+ */
+static void close_argument(void) {
+    while (operator_count > 0 &&
+           operators[operator_count - 1].kind != PENDING_GROUP &&
+           operators[operator_count - 1].kind != PENDING_FUNCTION &&
+           operators[operator_count - 1].kind != PENDING_ITERATOR) {
+        reduce_operator();
+    }
+}
+
+/**
+ * Pops the top of the operator stack and builds its node from the operands.
+ */
+static void reduce_operator(void) {
+    PendingOperator pending = operators[--operator_count];
+
+    switch (pending.kind) {
+        case PENDING_BINARY: {
+            ExpressionNode* right = pop_operand();
+            ExpressionNode* left = pop_operand();
+            push_operand(create_binary_op_node((NodeType)pending.id, left, right, pending.position));
+            break;
         }
-        
-        case TOKEN_MINUS: {
-            // Handle unary minus
-            SourcePosition operator_position = token.position;
-            
-            // Consume the '-'
-            tokenizer->current_token = get_next_token(tokenizer);
-            
-            ExpressionNode* expr = parse_factor(tokenizer);
-            
+
+        case PENDING_NEGATE: {
             // Create a subtraction with 0 as the left operand
-            ExpressionNode* zero = create_number_node(ZERO, operator_position);
-            
-            return create_binary_op_node(NODE_SUBTRACTION, zero, expr, operator_position);
+            ExpressionNode* expr = pop_operand();
+            ExpressionNode* zero = create_number_node(ZERO, pending.position);
+            push_operand(create_binary_op_node(NODE_SUBTRACTION, zero, expr, pending.position));
+            break;
+        }
+
+        case PENDING_GROUP:
+            push_operand(create_parenthesis_node(pop_operand(), pending.position));
+            break;
+
+        case PENDING_ITERATOR: {
+            if (pending.arguments != 3) {
+                parse_status = PARSE_INVALID;
+                break;
+            }
+            ExpressionNode* end = pop_operand();
+            ExpressionNode* start = pop_operand();
+            ExpressionNode* variable = pop_operand();
+            ExpressionNode* body = pop_operand();
+            if (variable == NULL || variable->type != NODE_VARIABLE) {
+                parse_status = PARSE_INVALID;
+                break;
+            }
+            push_operand(create_iterator_node((NodeType)pending.id, variable->variable.symbol,
+                                              body, start, end, pending.position));
+            break;
         }
-        
+
         default:
-            // Handle error: unexpected token
-            // In a real implementation, we would report an error
-            // For now, return a default value
-            return create_number_node(ZERO, token.position);
+            push_operand(create_function_node((FunctionType)pending.id, pop_operand(), pending.position));
+            break;
     }
 }
 
 /**
- * Parses a function call.
+ * Pushes an entry on the operator stack.
  * 
- * @param tokenizer Pointer to the tokenizer.
- * @param func_type The type of the function being parsed.
- * @return Pointer to the parsed function node.
+ * @param kind The kind of entry (PendingKind).
+ * @param id The NodeType or FunctionType of the entry.
+ * @param precedence The precedence of the entry.
+ * @param position The position of the token that pushed the entry.
  */
-static ExpressionNode* parse_function(Tokenizer* tokenizer, FunctionType func_type) {
-    SourcePosition position = tokenizer->current_token.position;
-    
-    // Expect a '('
-    if (!expect(tokenizer, TOKEN_LEFT_PAREN)) {
-        // Handle error: missing opening parenthesis after function name
-        // In a real implementation, we would report an error
+static void push_operator(uint8_t kind, uint8_t id, uint8_t precedence, SourcePosition position) {
+    if (operator_count >= PARSER_STACK_SIZE) {
+        parse_status = PARSE_TOO_COMPLEX;
+        return;
     }
-    
-    // Parse the argument expression
-    ExpressionNode* argument = parse_expression(tokenizer);
-    
-    // Expect a ')'
-    if (!expect(tokenizer, TOKEN_RIGHT_PAREN)) {
-        // Handle error: missing closing parenthesis
-        // In a real implementation, we would report an error
+
+    PendingOperator* pending = &operators[operator_count++];
+    pending->kind = kind;
+    pending->id = id;
+    pending->precedence = precedence;
+    pending->arguments = 0;
+    pending->position = position;
+}
+
+/**
+ * Pushes a node on the operand stack.
+ * 
+ * @param node Pointer to the node, or NULL if it could not be allocated.
+ */
+static void push_operand(ExpressionNode* node) {
+    if (operand_count > PARSER_STACK_SIZE) {
+        parse_status = PARSE_TOO_COMPLEX;
+        return;
     }
-    
-    return create_function_node(func_type, argument, position);
+    operands[operand_count++] = index_of(node);
+}
+
+/**
+ * Pops a node from the operand stack.
+ * 
+ * @return Pointer to the node, or NULL if the stack is empty.
+ */
+static ExpressionNode* pop_operand(void) {
+    if (operand_count == 0) {
+        return NULL;
+    }
+    NodeIndex index = operands[--operand_count];
+    return NODE_AT(index);
 }
 
 /**
@@ -290,20 +601,22 @@ static ExpressionNode* create_function_node(FunctionType func_type, ExpressionNo
     
     node->type = NODE_FUNCTION;
     node->function.func_type = func_type;
-    node->function.argument = argument;
-    node->position = position;
+    node->function.argument = index_of(argument);
+    set_span(node, position);
     
     return node;
 }
 
 /**
  * Allocates a node from the node pool.
- * Returns NULL if the node pool is full.
+ * Returns NULL if the node pool is full. Nodes are always allocated after
+ * their children, which the optimizer relies on.
  * 
  * @return Pointer to the allocated node, or NULL if the pool is full.
  */
 static ExpressionNode* allocate_node(void) {
     if (node_pool_index >= MAX_NODES) {
+        parse_status = PARSE_TOO_LONG;
         return NULL; // Node pool is full
     }
     
@@ -312,6 +625,28 @@ static ExpressionNode* allocate_node(void) {
     return node;
 }
 
+/**
+ * Gets the arena index of a node.
+ * 
+ * @param node Pointer to a node of the pool, or NULL.
+ * @return Index of the node, or NODE_NONE for NULL.
+ */
+static NodeIndex index_of(ExpressionNode* node) {
+    return node == NULL ? NODE_NONE : (NodeIndex)(node - node_pool);
+}
+
+/**
+ * Sets the source span of a node from the position of its token.
+ * 
+ * @param node Pointer to the node.
+ * @param position The source position of the token.
+ */
+static void set_span(ExpressionNode* node, SourcePosition position) {
+    int length = position.end - position.start + 1;
+    node->span_start = (uint8_t)position.start;
+    node->span_length = (uint8_t)(length > 0 ? length : 1);
+}
+
 /**
  * Creates a number node with the given value and position.
  * 
@@ -325,8 +660,7 @@ static ExpressionNode* create_number_node(real_t value, SourcePosition position)
     
     node->type = NODE_NUMBER;
     node->number_value = value;
-    node->normal_value = value;
-    node->position = position;
+    set_span(node, position);
     
     return node;
 }
@@ -345,9 +679,9 @@ static ExpressionNode* create_binary_op_node(NodeType type, ExpressionNode* left
     if (node == NULL) return NULL;
     
     node->type = type;
-    node->binary_op.left = left;
-    node->binary_op.right = right;
-    node->position = position;
+    node->binary_op.left = index_of(left);
+    node->binary_op.right = index_of(right);
+    set_span(node, position);
     
     return node;
 }
@@ -364,27 +698,26 @@ static ExpressionNode* create_parenthesis_node(ExpressionNode* expression, Sourc
     if (node == NULL) return NULL;
     
     node->type = NODE_PARENTHESIS;
-    node->parenthesis.expression = expression;
-    node->position = position;
+    node->parenthesis.expression = index_of(expression);
+    set_span(node, position);
     
     return node;
 }
 
 /**
- * Creates a variable node with the given name and position.
+ * Creates a variable node for a symbol and position.
  * 
- * @param name The name of the variable.
+ * @param symbol The symbol of the variable, as resolved by the tokenizer.
  * @param position The source position of the node.
  * @return Pointer to the created node, or NULL if allocation fails.
  */
-static ExpressionNode* create_variable_node(const char* name, SourcePosition position) {
+static ExpressionNode* create_variable_node(uint8_t symbol, SourcePosition position) {
     ExpressionNode* node = allocate_node();
     if (node == NULL) return NULL;
     
     node->type = NODE_VARIABLE;
-    strncpy(node->variable.name, name, MAX_TOKEN_LENGTH - 1);
-    node->variable.name[MAX_TOKEN_LENGTH - 1] = '\0';
-    node->position = position;
+    node->variable.symbol = symbol;
+    set_span(node, position);
     
     return node;
 }
@@ -401,9 +734,35 @@ static ExpressionNode* create_factorial_node(ExpressionNode* expression, SourceP
     if (node == NULL) return NULL;
     
     node->type = NODE_FACTORIAL;
-    node->factorial.expression = expression;
-    node->position = position;
+    node->factorial.expression = index_of(expression);
+    set_span(node, position);
     
     return node;
 }
 
+
+/**
+ * Creates a sum or product node.
+ * 
+ * @param type NODE_SUMMATION or NODE_PRODUCT.
+ * @param symbol The symbol of the loop variable.
+ * @param body Pointer to the expression summed or multiplied.
+ * @param start Pointer to the first value of the variable.
+ * @param end Pointer to the last value of the variable.
+ * @param position The source position of the node.
+ * @return Pointer to the created node, or NULL if allocation fails.
+ */
+static ExpressionNode* create_iterator_node(NodeType type, uint8_t symbol, ExpressionNode* body,
+                                            ExpressionNode* start, ExpressionNode* end, SourcePosition position) {
+    ExpressionNode* node = allocate_node();
+    if (node == NULL) return NULL;
+    
+    node->type = type;
+    node->iterator.symbol = symbol;
+    node->iterator.body = index_of(body);
+    node->iterator.start = index_of(start);
+    node->iterator.end = index_of(end);
+    set_span(node, position);
+    
+    return node;
+}
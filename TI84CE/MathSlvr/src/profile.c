@@ -0,0 +1,107 @@
+/**
+ * MathSolver for TI-84 CE - Profiler
+ *
+ * Counts the calls and the CPU cycles of the zones of headers/profile.h,
+ * with a hardware timer counting up at the CPU clock. The counts are kept
+ * in RAM and written out on exit, to the debug console of CEmu and to an
+ * AppVar that can be copied from a calculator.
+ *
+ * Built only with PROFILE=1; otherwise this file is empty and the macros
+ * that call it compile to nothing.
+ */
+
+#include <stdint.h>
+#include "headers/profile.h"
+
+#ifdef PROFILE
+
+// The report goes to the debug console in release builds too
+#undef NDEBUG
+#include <debug.h>
+#include <tice.h>
+#include <stdio.h>
+#include <string.h>
+#include <fileioc.h>
+#include "headers/profile_private.h"
+
+/** Name of the AppVar the report is written to */
+#define PROFILE_APPVAR_NAME "MSPROF"
+
+/** CPU cycles in a microsecond, at the 48 MHz of the CE */
+#define CYCLES_PER_US 48
+
+/** Longest line of the report */
+#define MAX_PROFILE_LINE 64
+
+/**
+ * Calls and cycles of a zone.
+ */
+typedef struct {
+    uint24_t calls;     /**< Number of times the zone was timed */
+    uint32_t cycles;    /**< CPU cycles spent in the zone, wrapping after about 89 s */
+} ProfileCounter;
+
+/** Counters of the zones */
+static ProfileCounter counters[PROFILE_ZONE_COUNT];
+
+/** Names of the zones, as the report writes them for autotester/profile.ps1 */
+static const char* const zone_names[PROFILE_ZONE_COUNT] = {
+    "tokenize",
+    "parse",
+    "evaluate",
+    "arithmetic_format",
+    "format_real",
+    "draw"
+};
+
+/**
+ * Starts the timer of the profiler, counting up at the CPU clock, and
+ * clears the zones.
+ */
+void profile_init(void) {
+    memset(counters, 0, sizeof(counters));
+    timer_Disable(PROFILE_TIMER);
+    timer_Set(PROFILE_TIMER, 0);
+    timer_Enable(PROFILE_TIMER, TIMER_CPU, TIMER_NOINT, TIMER_UP);
+}
+
+/**
+ * Adds a call to a zone. The difference is taken without a sign, so it
+ * holds when the timer wraps.
+ *
+ * @param zone The zone.
+ * @param start Timer count when the zone was entered.
+ */
+void profile_add(ProfileZone zone, uint32_t start) {
+    counters[zone].calls++;
+    counters[zone].cycles += timer_Get(PROFILE_TIMER) - start;
+}
+
+/**
+ * Writes one line per zone, with its calls, its cycles, and the mean
+ * cycles and microseconds of a call, to the debug console and to the
+ * profile AppVar.
+ */
+void profile_dump(void) {
+    uint8_t handle = ti_Open(PROFILE_APPVAR_NAME, "w");
+    char line[MAX_PROFILE_LINE];
+
+    for (int i = 0; i < PROFILE_ZONE_COUNT; i++) {
+        uint32_t calls = counters[i].calls;
+        uint32_t mean = calls > 0 ? counters[i].cycles / calls : 0;
+        int length = sprintf(line, "PROFILE %s calls=%lu cycles=%lu mean=%lu us=%lu\n", zone_names[i],
+                             (unsigned long)calls, (unsigned long)counters[i].cycles,
+                             (unsigned long)mean, (unsigned long)(mean / CYCLES_PER_US));
+        dbg_printf("%s", line);
+        if (handle) {
+            ti_Write(line, 1, length, handle);
+        }
+    }
+
+    if (handle) {
+        ti_Close(handle);
+    }
+    timer_Disable(PROFILE_TIMER);
+}
+
+#endif // PROFILE
@@ -0,0 +1,461 @@
+/**
+ * MathSolver for TI-84 CE - Equation Solver
+ *
+ * Finds a root of lhs = rhs near a guess. The equation is compiled once,
+ * as lhs - rhs. Newton's method gets the value and the slope from a
+ * single run of the dual number machine; when the slope vanishes or is
+ * undefined, or Newton's method does not settle, a bracketed secant
+ * search (the Illinois method) takes over. A point where the equation is
+ * undefined is never taken as a root. Every iteration is recorded as a
+ * calculation step.
+ */
+
+#include <string.h>
+#include <ti/real.h>
+#include "headers/log.h"
+#include "headers/mathsolver.h"
+#include "headers/solver_private.h"
+
+/** Relative distance between two estimates taken as convergence (1E-12) */
+static const real_t SOLVE_TOLERANCE = REAL_LITERAL(0x00, 0x74, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+
+/** One, the smallest scale of the tolerance */
+static const real_t SOLVE_ONE = REAL_LITERAL(0x00, 0x80, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+
+/** Compiled form of lhs - rhs */
+static CompiledExpression solve_program;
+
+/** Normal arithmetic, which the equation is evaluated in whatever the mode */
+static const ArithmeticFormat SOLVE_FORMAT = { NULL, 0 };
+
+/** Symbol of the variable solved for */
+static uint8_t solve_symbol;
+
+/** Whether the root replaced a value the variable solved for already had */
+static bool solve_replaced;
+
+/**
+ * Solves an equation for its variable: the first one that has no value,
+ * else x, else the first one it reads.
+ * The solver works at full precision whatever the arithmetic mode; only
+ * the root is formatted. On success the root is stored in the variable;
+ * solve_replaced_value tells whether that replaced a value.
+ *
+ * @param input The equation, lhs = rhs; without '=' the right side is 0.
+ * @param guess The value to start the search from.
+ * @param result Pointer to the structure to store the root and the iterations in.
+ * @return A SolveStatus telling whether a root was found.
+ */
+SolveStatus solve_equation(const char* input, real_t guess, CalculationResult* result) {
+    char difference[MAX_INPUT_LENGTH + 5];
+    if (!build_difference(input, difference)) {
+        return SOLVE_INVALID;
+    }
+
+    SolveStatus status = find_root(difference, guess, result);
+
+    if (status == SOLVE_OK) {
+        result->arithmetic_mode = current_arithmetic_type;
+        result->precision = current_precision;
+        result->use_significant_digits = current_use_significant_digits;
+        ArithmeticFormat format = get_arithmetic_format(current_arithmetic_type, current_precision,
+                                                        current_use_significant_digits);
+        result->value = apply_arithmetic_format(result->normal_value, &format);
+        format_real(result->value, result->formatted_result);
+    }
+    return status;
+}
+
+/**
+ * Rewrites lhs = rhs as (lhs)-(rhs).
+ *
+ * @param input The equation.
+ * @param difference Buffer of MAX_INPUT_LENGTH + 5 characters for the expression.
+ * @return True on success, false if the equation has more than one '='.
+ */
+static bool build_difference(const char* input, char* difference) {
+    const char* equals = strchr(input, '=');
+    if (equals == NULL) {
+        strcpy(difference, input);
+        return true;
+    }
+    if (strchr(equals + 1, '=') != NULL) {
+        LOG_ERROR("More than one '=' in the equation");
+        return false;
+    }
+
+    int left = equals - input;
+    difference[0] = '(';
+    memcpy(&difference[1], input, left);
+    strcpy(&difference[1 + left], ")-(");
+    strcat(difference, equals + 1);
+    strcat(difference, ")");
+    return true;
+}
+
+/**
+ * Compiles an expression and finds a root of it.
+ *
+ * @param expression The expression to find a root of.
+ * @param guess The value to start the search from.
+ * @param result Pointer to the structure to store the root and the iterations in.
+ * @return A SolveStatus telling whether a root was found.
+ */
+static SolveStatus find_root(const char* expression, real_t guess, CalculationResult* result) {
+    memset(result, 0, sizeof(CalculationResult));
+
+    if (!compile_expression_string(expression, &solve_program, &SOLVE_FORMAT)) {
+        return SOLVE_INVALID;
+    }
+
+    int symbol = find_unknown();
+    if (symbol < 0) {
+        LOG_ERROR("Equation has no variable");
+        return SOLVE_NO_VARIABLE;
+    }
+    solve_symbol = (uint8_t)symbol;
+    Variable saved_variable = variables[solve_symbol];
+
+    real_t root;
+    if (!newton(guess, result, &root) && !secant(guess, result, &root)) {
+        variables[solve_symbol] = saved_variable;
+        LOG_INFO("No root found");
+        return SOLVE_NO_ROOT;
+    }
+
+    set_symbol_value(solve_symbol, root);
+    solve_replaced = saved_variable.is_defined;
+    result->normal_value = root;
+    LOG_INFO("Root found after %d iterations", result->step_count);
+    return SOLVE_OK;
+}
+
+/**
+ * Chooses the variable to solve for: the first one read that has no
+ * value, else x, else the first one read, whose value the root replaces.
+ *
+ * @return The symbol of the variable, or -1 if the equation reads none.
+ */
+static int find_unknown(void) {
+    uint8_t symbols[MAX_VARIABLES];
+    int count = list_program_variables(&solve_program, symbols);
+    if (count == 0) {
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (!variables[symbols[i]].is_defined) {
+            return symbols[i];
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        if (strcmp(variables[symbols[i]].name, "x") == 0) {
+            return symbols[i];
+        }
+    }
+    return symbols[0];
+}
+
+/**
+ * Gets the name of the variable the last equation was solved for.
+ *
+ * @return The name of the variable.
+ */
+const char* solve_variable_name(void) {
+    return get_symbol_name(solve_symbol);
+}
+
+/**
+ * Tells whether the last root found replaced a value its variable had.
+ *
+ * @return True if the variable had a value before.
+ */
+bool solve_replaced_value(void) {
+    return solve_replaced;
+}
+
+/* ============================== Methods ============================== */
+
+/**
+ * Newton's method: x - f(x) / f'(x), with the slope from the dual number
+ * machine.
+ *
+ * @param x The value to start from.
+ * @param result Pointer to the structure to record the iterations in.
+ * @param root Pointer set to the root on success.
+ * @return True if the method converged, false otherwise.
+ */
+static bool newton(real_t x, CalculationResult* result, real_t* root) {
+    for (int iteration = 0; iteration < SOLVE_MAX_ITERATIONS; iteration++) {
+        real_t value, slope;
+        set_symbol_value(solve_symbol, x);
+        if (!execute_program_dual(&solve_program, solve_symbol, &value, &slope)) {
+            LOG_DEBUG("Newton: undefined at the estimate");
+            return false;
+        }
+        if (is_zero(value)) {
+            *root = x;
+            return true;
+        }
+        if (is_zero(slope)) {
+            LOG_DEBUG("Newton: flat at the estimate");
+            return false;
+        }
+
+        real_t next = real_sub(x, real_div(value, slope));
+        record_iteration(result, STEP_NEWTON, x, value, next);
+        if (converged(x, next)) {
+            if (!value_at(next, &value)) {
+                LOG_DEBUG("Newton: undefined at the root");
+                return false;
+            }
+            *root = next;
+            return true;
+        }
+        x = next;
+    }
+
+    LOG_DEBUG("Newton: no convergence");
+    return false;
+}
+
+/**
+ * Bracketed secant method (Illinois): keeps a sign change between two
+ * estimates and moves one of them to where the chord crosses zero.
+ * A sign change around a pole also closes in, so the value at the end
+ * must be no larger than at the ends of the first bracket. Where the
+ * chord crosses at a point the expression is undefined, the middle of
+ * the bracket is tried instead.
+ *
+ * @param guess The value to search for a sign change around.
+ * @param result Pointer to the structure to record the iterations in.
+ * @param root Pointer set to the root on success.
+ * @return True if a root was found, false otherwise.
+ */
+static bool secant(real_t guess, CalculationResult* result, real_t* root) {
+    real_t a, b, fa, fb;
+    if (!find_bracket(guess, &a, &fa, &b, &fb)) {
+        LOG_DEBUG("Secant: no sign change found");
+        return false;
+    }
+
+    real_t bound = real_abs(fa);
+    real_t size = real_abs(fb);
+    if (os_RealCompare(&size, &bound) < 0) {
+        bound = size;
+    }
+    real_t two = os_Int24ToReal(2);
+
+    for (int iteration = 0; iteration < SOLVE_MAX_ITERATIONS; iteration++) {
+        // x = b - fb (b - a) / (fb - fa); the signs differ, so fb - fa is not zero
+        real_t x = real_sub(b, real_div(real_mul(fb, real_sub(b, a)), real_sub(fb, fa)));
+        real_t fx;
+        if (!value_at(x, &fx)) {
+            x = real_div(real_add(a, b), two);
+            if (!value_at(x, &fx)) {
+                LOG_DEBUG("Secant: undefined inside the bracket");
+                return false;
+            }
+        }
+        record_iteration(result, STEP_SECANT, b, fb, x);
+
+        if (sign_of(fx) != sign_of(fb)) {
+            a = b;
+            fa = fb;
+        } else {
+            // The same end would move again; halving its value speeds it up
+            fa = real_div(fa, two);
+        }
+        bool settled = is_zero(fx) || converged(b, x) || converged(a, x);
+        b = x;
+        fb = fx;
+
+        if (settled) {
+            size = real_abs(fb);
+            if (os_RealCompare(&size, &bound) > 0) {
+                LOG_DEBUG("Secant: closed in on a pole");
+                return false;
+            }
+            *root = b;
+            return true;
+        }
+    }
+
+    LOG_DEBUG("Secant: no convergence");
+    return false;
+}
+
+/**
+ * Searches for a sign change of the expression on both sides of a guess,
+ * doubling the distance at each step. Points where the expression is
+ * undefined are skipped; when a side crosses the edge of where it is
+ * defined, the edge is searched too, since a root can lie close to it.
+ *
+ * @param guess The value to search around.
+ * @param a Pointer set to one end of the bracket.
+ * @param fa Pointer set to the value at a.
+ * @param b Pointer set to the other end of the bracket.
+ * @param fb Pointer set to the value at b.
+ * @return True if a sign change was found, false otherwise.
+ */
+static bool find_bracket(real_t guess, real_t* a, real_t* fa, real_t* b, real_t* fb) {
+    // The last point of the right side, then of the left side
+    real_t ends[2], values[2];
+    bool defined[2];
+    ends[0] = ends[1] = guess;
+    defined[0] = defined[1] = value_at(guess, &values[0]);
+    values[1] = values[0];
+
+    // Start at a tenth of the size of the guess, or 0.1
+    real_t ten = os_Int24ToReal(10);
+    real_t scale = real_abs(guess);
+    if (os_RealCompare(&scale, &SOLVE_ONE) < 0) {
+        scale = SOLVE_ONE;
+    }
+    real_t distance = real_div(scale, ten);
+
+    for (int step = 0; step < SOLVE_BRACKET_STEPS; step++) {
+        for (int side = 0; side < 2; side++) {
+            real_t x = side == 0 ? real_add(guess, distance) : real_sub(guess, distance);
+            real_t fx;
+            bool x_defined = value_at(x, &fx);
+            if (x_defined && defined[side] && sign_of(fx) != sign_of(values[side])) {
+                *a = ends[side]; *fa = values[side];
+                *b = x; *fb = fx;
+                return true;
+            }
+            if (x_defined && !defined[side] && search_edge(x, fx, ends[side], a, fa, b, fb)) {
+                return true;
+            }
+            if (!x_defined && defined[side] && search_edge(ends[side], values[side], x, a, fa, b, fb)) {
+                return true;
+            }
+            ends[side] = x;
+            values[side] = fx;
+            defined[side] = x_defined;
+        }
+
+        distance = real_add(distance, distance);
+    }
+    return false;
+}
+
+/**
+ * Searches for a sign change between a point where the expression is
+ * defined and the edge of where it is, halving the way to a point where
+ * it is not.
+ *
+ * @param inside A point where the expression is defined.
+ * @param inside_value The value at inside.
+ * @param outside A point where the expression is undefined.
+ * @param a Pointer set to one end of the bracket.
+ * @param fa Pointer set to the value at a.
+ * @param b Pointer set to the other end of the bracket.
+ * @param fb Pointer set to the value at b.
+ * @return True if a sign change was found, false otherwise.
+ */
+static bool search_edge(real_t inside, real_t inside_value, real_t outside,
+                        real_t* a, real_t* fa, real_t* b, real_t* fb) {
+    real_t two = os_Int24ToReal(2);
+    for (int step = 0; step < SOLVE_EDGE_STEPS && !converged(inside, outside); step++) {
+        real_t x = real_div(real_add(inside, outside), two);
+        real_t fx;
+        if (!value_at(x, &fx)) {
+            outside = x;
+            continue;
+        }
+        if (sign_of(fx) != sign_of(inside_value)) {
+            *a = inside; *fa = inside_value;
+            *b = x; *fb = fx;
+            return true;
+        }
+        inside = x;
+        inside_value = fx;
+    }
+    return false;
+}
+
+/* ============================== Helpers ============================== */
+
+/**
+ * Evaluates the expression.
+ *
+ * @param x The value of the variable.
+ * @param value Pointer set to the value of the expression.
+ * @return True if the expression is defined at x, false otherwise.
+ */
+static bool value_at(real_t x, real_t* value) {
+    set_symbol_value(solve_symbol, x);
+    *value = run_program(&solve_program, &SOLVE_FORMAT);
+    return !is_value_undefined();
+}
+
+/**
+ * Tells whether two successive estimates agree to SOLVE_TOLERANCE.
+ *
+ * @param previous The previous estimate.
+ * @param next The next estimate.
+ * @return True if the estimates are close enough.
+ */
+static bool converged(real_t previous, real_t next) {
+    real_t scale = real_abs(next);
+    if (os_RealCompare(&scale, &SOLVE_ONE) < 0) {
+        scale = SOLVE_ONE;
+    }
+    real_t distance = real_abs(real_sub(next, previous));
+    real_t limit = real_mul(scale, SOLVE_TOLERANCE);
+    return os_RealCompare(&distance, &limit) <= 0;
+}
+
+/**
+ * Records a solver iteration as a calculation step.
+ *
+ * @param result Pointer to the result to record the step in.
+ * @param operation STEP_NEWTON or STEP_SECANT.
+ * @param x The estimate.
+ * @param value The value of the expression at the estimate.
+ * @param next The next estimate.
+ */
+static void record_iteration(CalculationResult* result, StepOperation operation, real_t x, real_t value, real_t next) {
+    CalculationStep* step = next_step(result);
+    if (step == NULL) {
+        return;
+    }
+
+    memset(step, 0, sizeof(CalculationStep));
+    step->operation = (uint8_t)operation;
+    step->type = STEP_ITERATION;
+    step->left = x;
+    step->right = value;
+    step->result = next;
+}
+
+/**
+ * Gets the absolute value of a value.
+ *
+ * @param value The value.
+ * @return The absolute value.
+ */
+static real_t real_abs(real_t value) {
+    return os_RealCompare(&value, &ZERO) < 0 ? os_RealNeg(&value) : value;
+}
+
+/**
+ * Gets the sign of a value.
+ *
+ * @param value The value.
+ * @return -1, 0 or 1.
+ */
+static int sign_of(real_t value) {
+    return os_RealCompare(&value, &ZERO);
+}
+
+/**
+ * Tells whether a value is zero.
+ *
+ * @param value The value.
+ * @return True if the value is zero.
+ */
+static bool is_zero(real_t value) {
+    return os_RealCompare(&value, &ZERO) == 0;
+}
@@ -0,0 +1,175 @@
+/**
+ * MathSolver for TI-84 CE - Step Storage
+ *
+ * Holds the calculation steps of a result without a limit on their
+ * number. The first MAX_STEPS steps live in the result itself; the ones
+ * after them are gathered in a small batch and appended to a scratch
+ * AppVar, so recording stays sequential and RAM use stays the same
+ * however long the expression. Steps are read back by index, a page at
+ * a time, when they are shown.
+ *
+ * Only the result that spilled last has its later steps in the AppVar.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fileioc.h>
+#include <ti/real.h>
+#include "headers/log.h"
+#include "headers/mathsolver.h"
+#include "headers/steps_private.h"
+
+/** Name of the scratch AppVar the steps past MAX_STEPS are written to */
+#define STEPS_APPVAR_NAME "MSSTEPS"
+
+/** Steps written to the AppVar at once, and read back from it at once */
+#define STEP_SPILL_BATCH 8
+
+/** Most steps the AppVar holds, keeping it under the largest variable size */
+#define MAX_SPILLED_STEPS (60000 / sizeof(CalculationStep))
+
+/** Result whose steps past MAX_STEPS are in the AppVar and the batch */
+static const CalculationResult* spill_owner = NULL;
+
+/** Steps recorded after the ones in the AppVar, not written yet */
+static CalculationStep spill_batch[STEP_SPILL_BATCH];
+
+/** Number of steps in the batch */
+static int spill_batched = 0;
+
+/** Number of steps written to the AppVar */
+static int spill_written = 0;
+
+/** Whether the AppVar could not take the last batch, so no more steps are kept */
+static bool spill_full = false;
+
+/** Steps last read back from the AppVar */
+static CalculationStep spill_page[STEP_SPILL_BATCH];
+
+/** Index among the spilled steps of the first step of the page, or -1 if none was read */
+static int spill_page_first = -1;
+
+/* ============================== Recording ============================== */
+
+/**
+ * Makes room for the next step of a result. The step is counted in the
+ * result at once; the caller fills it before recording another one.
+ *
+ * @param result Pointer to the result the step belongs to.
+ * @return Pointer to the step to fill, or NULL if no more steps can be kept.
+ */
+CalculationStep* next_step(CalculationResult* result) {
+    if (result->step_count < MAX_STEPS) {
+        return &result->steps[result->step_count++];
+    }
+
+    int spilled = result->step_count - MAX_STEPS;
+    if (spilled == 0) {
+        // The first step past the result starts a new AppVar
+        spill_owner = result;
+        spill_batched = 0;
+        spill_written = 0;
+        spill_full = false;
+        spill_page_first = -1;
+    } else if (spill_owner != result || spill_full) {
+        return NULL;
+    }
+
+    if (spilled >= (int)MAX_SPILLED_STEPS) {
+        return NULL;
+    }
+    if (spill_batched == STEP_SPILL_BATCH && !write_batch()) {
+        spill_full = true;
+        return NULL;
+    }
+
+    result->step_count++;
+    return &spill_batch[spill_batched++];
+}
+
+/**
+ * Appends the batch of steps to the AppVar.
+ *
+ * @return True if the steps were written, false if the AppVar could not take them.
+ */
+static bool write_batch(void) {
+    uint8_t handle = ti_Open(STEPS_APPVAR_NAME, spill_written == 0 ? "w" : "a");
+    if (!handle) {
+        LOG_ERROR("Failed to open the step AppVar");
+        return false;
+    }
+
+    size_t written = ti_Write(spill_batch, sizeof(CalculationStep), spill_batched, handle);
+    ti_Close(handle);
+    if (written != (size_t)spill_batched) {
+        LOG_WARNING("Step AppVar full after %d steps", spill_written);
+        return false;
+    }
+
+    spill_written += spill_batched;
+    spill_batched = 0;
+    return true;
+}
+
+/* ============================== Reading ============================== */
+
+/**
+ * Gets a step of a result by its index.
+ *
+ * @param result Pointer to the result.
+ * @param index Index of the step, from 0 to the step count of the result.
+ * @param step Pointer to the structure to copy the step to.
+ * @return True if the step was found, false if it is no longer kept.
+ */
+bool get_step(const CalculationResult* result, int index, CalculationStep* step) {
+    if (index < 0 || index >= result->step_count) {
+        return false;
+    }
+    if (index < MAX_STEPS) {
+        *step = result->steps[index];
+        return true;
+    }
+    if (spill_owner != result) {
+        return false;
+    }
+
+    int spilled = index - MAX_STEPS;
+    if (spilled >= spill_written) {
+        *step = spill_batch[spilled - spill_written];
+        return true;
+    }
+
+    // Read the page holding the step, unless it was read last
+    int first = spilled - spilled % STEP_SPILL_BATCH;
+    if (first != spill_page_first) {
+        uint8_t handle = ti_Open(STEPS_APPVAR_NAME, "r");
+        if (!handle) {
+            LOG_ERROR("Failed to open the step AppVar");
+            return false;
+        }
+        int count = spill_written - first < STEP_SPILL_BATCH ? spill_written - first : STEP_SPILL_BATCH;
+        bool read = ti_Seek(first * sizeof(CalculationStep), SEEK_SET, handle) != EOF &&
+                    ti_Read(spill_page, sizeof(CalculationStep), count, handle) == (size_t)count;
+        ti_Close(handle);
+        if (!read) {
+            spill_page_first = -1;
+            return false;
+        }
+        spill_page_first = first;
+    }
+
+    *step = spill_page[spilled - first];
+    return true;
+}
+
+/**
+ * Deletes the step AppVar; the steps past MAX_STEPS are lost.
+ */
+void discard_steps(void) {
+    ti_Delete(STEPS_APPVAR_NAME);
+    spill_owner = NULL;
+    spill_batched = 0;
+    spill_written = 0;
+    spill_full = false;
+    spill_page_first = -1;
+}
@@ -0,0 +1,141 @@
+/**
+ * MathSolver for TI-84 CE - Function Table
+ *
+ * Tabulates an expression over evenly spaced values of its variable. The
+ * expression is compiled once; each row only writes the variable and runs
+ * the program. Rows are computed when they are first asked for and kept
+ * in a small cache, so a table of thousands of rows costs nothing until
+ * it is scrolled through.
+ */
+
+#include <string.h>
+#include <ti/real.h>
+#include "headers/log.h"
+#include "headers/mathsolver.h"
+#include "headers/table_private.h"
+
+/** Row number of an empty cache slot */
+#define NO_ROW 0xFFFF
+
+/** Compiled form of the tabulated expression */
+static CompiledExpression table_program;
+
+/** Formatting of the arithmetic mode the table was prepared in */
+static ArithmeticFormat table_format;
+
+/** Symbol of the variable the table runs over */
+static uint8_t table_symbol;
+
+/** Variable as it was before the table wrote to it */
+static Variable saved_variable;
+
+/** Value of the variable on the first row */
+static real_t table_start;
+
+/** Increment of the variable between rows */
+static real_t table_step;
+
+/** Number of rows in the table */
+static uint16_t table_rows;
+
+/** Row held by each cache slot, or NO_ROW */
+static uint16_t cached_rows[TABLE_CACHE_ROWS];
+
+/** Value of the expression on the row held by each cache slot */
+static real_t cached_values[TABLE_CACHE_ROWS];
+
+/** Whether the expression is defined on the row held by each cache slot */
+static bool cached_defined[TABLE_CACHE_ROWS];
+
+/**
+ * Prepares a table of an expression.
+ * The table runs over the first variable the expression refers to; its
+ * value is restored by table_close.
+ *
+ * @param input The expression string.
+ * @param start Value of the variable on the first row.
+ * @param step Increment of the variable between rows.
+ * @param rows Number of rows, TABLE_MAX_ROWS at most.
+ * @return A PlotStatus telling whether the table is ready.
+ */
+PlotStatus table_init(const char* input, real_t start, real_t step, int rows) {
+    table_format = get_arithmetic_format(current_arithmetic_type, current_precision,
+                                         current_use_significant_digits);
+    if (!compile_expression_string(input, &table_program, &table_format)) {
+        return PLOT_INVALID;
+    }
+
+    int symbol = find_program_variable(&table_program);
+    if (symbol < 0) {
+        LOG_ERROR("Table expression has no variable");
+        return PLOT_NO_VARIABLE;
+    }
+    table_symbol = (uint8_t)symbol;
+
+    table_start = start;
+    table_step = step;
+    table_rows = rows > TABLE_MAX_ROWS ? TABLE_MAX_ROWS : rows;
+    saved_variable = variables[table_symbol];
+    memset(cached_rows, 0xFF, sizeof(cached_rows));
+
+    LOG_INFO("Table of %s over %s, %d rows", input, get_symbol_name(table_symbol), table_rows);
+    return PLOT_OK;
+}
+
+/**
+ * Restores the variable the table wrote to.
+ */
+void table_close(void) {
+    variables[table_symbol] = saved_variable;
+}
+
+/**
+ * Gets the number of rows of the table.
+ *
+ * @return The number of rows.
+ */
+uint16_t table_row_count(void) {
+    return table_rows;
+}
+
+/**
+ * Gets the name of the variable the table runs over.
+ *
+ * @return The name of the variable.
+ */
+const char* table_variable_name(void) {
+    return get_symbol_name(table_symbol);
+}
+
+/**
+ * Gets the value of the variable on a row.
+ * It is computed from the row number rather than by adding the step
+ * over and over, so rounding errors do not build up down the table.
+ *
+ * @param row The row number.
+ * @return The value of the variable.
+ */
+real_t table_x(uint16_t row) {
+    real_t index = os_Int24ToReal(row);
+    real_t offset = os_RealMul(&index, &table_step);
+    return os_RealAdd(&table_start, &offset);
+}
+
+/**
+ * Gets the value of the expression on a row, computing it if needed.
+ *
+ * @param row The row number.
+ * @param value Pointer set to the value of the expression.
+ * @return True if the expression is defined on the row, false otherwise.
+ */
+bool table_value(uint16_t row, real_t* value) {
+    uint8_t slot = row & (TABLE_CACHE_ROWS - 1);
+    if (cached_rows[slot] != row) {
+        set_symbol_value(table_symbol, table_x(row));
+        cached_values[slot] = run_program(&table_program, &table_format);
+        cached_defined[slot] = !is_value_undefined() && get_loop_status() == LOOP_OK;
+        cached_rows[slot] = row;
+    }
+    *value = cached_values[slot];
+    return cached_defined[slot];
+}
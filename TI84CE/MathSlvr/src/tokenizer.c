@@ -2,7 +2,8 @@
 #include <ti/real.h>
 #include "headers/log.h"
 #include "headers/mathsolver.h"
-#include "headers/tokenizer_public.h"
+#include "headers/profile.h"
+#include "headers/tokenizer_private.h"
 
 /**
  * Advances to the next character in the input string.
@@ -32,6 +33,91 @@ static void skip_whitespace(Tokenizer* tokenizer) {
     }
 }
 
+/**
+ * Keyword table entry.
+ */
+typedef struct {
+    const char* name;   /**< Lowercase spelling of the keyword */
+    uint8_t type;       /**< TOKEN_FUNCTION, TOKEN_CONSTANT or TOKEN_ITERATOR */
+    uint8_t id;         /**< FunctionType, ConstantId or NodeType */
+} Keyword;
+
+/** Number of slots in the keyword table (a power of two) */
+#define KEYWORD_SLOTS 16
+
+/**
+ * Computes the keyword table slot of an identifier.
+ * The hash is perfect over the keywords below: each one lands in its own
+ * slot, so a lookup costs one hash and at most one string compare. When a
+ * keyword is added, check that the slots stay distinct, and change the
+ * weights if they do not.
+ */
+#define KEYWORD_HASH(first, last, length) \
+    ((3u * (unsigned)(first) + (unsigned)(last) + (unsigned)(length)) & (KEYWORD_SLOTS - 1))
+
+/**
+ * Keywords, indexed by KEYWORD_HASH.
+ */
+static const Keyword KEYWORDS[KEYWORD_SLOTS] = {
+    [ 1] = { "sqrt", TOKEN_FUNCTION, FUNC_SQRT },
+    [ 4] = { "ln",   TOKEN_FUNCTION, FUNC_LN },
+    [ 5] = { "e",    TOKEN_CONSTANT, CONST_E },
+    [ 8] = { "prod", TOKEN_ITERATOR, NODE_PRODUCT },
+    [ 9] = { "sum",  TOKEN_ITERATOR, NODE_SUMMATION },
+    [10] = { "sin",  TOKEN_FUNCTION, FUNC_SIN },
+    [11] = { "pi",   TOKEN_CONSTANT, CONST_PI },
+    [12] = { "phi",  TOKEN_CONSTANT, CONST_PHI },
+    [13] = { "tan",  TOKEN_FUNCTION, FUNC_TAN },
+    [14] = { "log",  TOKEN_FUNCTION, FUNC_LOG },
+    [15] = { "cos",  TOKEN_FUNCTION, FUNC_COS },
+};
+
+/**
+ * Classifies an identifier token as a function, a constant, an iterator
+ * or a variable. Functions, constants and iterators get their
+ * FunctionType, ConstantId or NodeType in the token, and variables their
+ * symbol, so the parser never has to look at the name. A name that does
+ * not fit in the symbol table is a TOKEN_NONE with the symbol SYMBOL_NONE.
+ *
+ * @param token Pointer to the token to classify.
+ * @param name Lowercase name of the identifier.
+ */
+static void classify_identifier(Token* token, const char* name) {
+    size_t length = strlen(name);
+    const Keyword* keyword = &KEYWORDS[KEYWORD_HASH(name[0], name[length - 1], length)];
+
+    if (keyword->name != NULL && strcmp(keyword->name, name) == 0) {
+        token->type = (TokenType)keyword->type;
+        token->id = keyword->id;
+        return;
+    }
+
+    // if not consider it a variable
+    int symbol = resolve_symbol(name);
+    if (symbol < 0) {
+        LOG_ERROR("Too many variables");
+        token->type = TOKEN_NONE;
+        token->id = SYMBOL_NONE;
+        return;
+    }
+    token->type = TOKEN_VARIABLE;
+    token->id = (uint8_t)symbol;
+}
+
+/**
+ * Tells whether a character can start an identifier.
+ */
+static bool is_identifier_start(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+/**
+ * Tells whether a character is a decimal digit.
+ */
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
 /**
  * Initializes a tokenizer with the given input string.
  * Prepares the tokenizer to start tokenizing the input.
@@ -45,254 +131,146 @@ void tokenizer_init(Tokenizer* tokenizer, const char* input) {
     tokenizer->line = 1;
     tokenizer->column = 1;
 
-    log_debug("Tokenizer initialized");
-    log_message("Input string: %s", input);
+    LOG_DEBUG("Tokenizer initialized");
+    LOG_TRACE("Input string: %s", input);
     
     // Initialize with the first token
-    tokenizer->current_token = get_next_token(tokenizer);
+    next_token(tokenizer);
 }
 
 /**
- * Gets the next token from the input string.
- * Identifies numbers, variables, functions, and operators.
+ * Reads the next token from the input string into current_token.
  * 
  * @param tokenizer Pointer to the tokenizer.
- * @return The next token in the input string.
  */
-Token get_next_token(Tokenizer* tokenizer) {
+void next_token(Tokenizer* tokenizer) {
+    PROFILE_START(PROFILE_TOKENIZE);
+    read_token(tokenizer);
+    PROFILE_STOP(PROFILE_TOKENIZE);
+}
+
+/**
+ * Reads the next token from the input string into current_token.
+ * Identifies numbers, variables, functions, and operators. Tokens are
+ * not copied out of the input: a token is a type, a span of the input
+ * and, for each kind that has one, its preconverted value.
+ * 
+ * @param tokenizer Pointer to the tokenizer.
+ */
+static void read_token(Tokenizer* tokenizer) {
+    Token* token = &tokenizer->current_token;
+    const char* input = tokenizer->input;
+
     // Skip whitespace
     skip_whitespace(tokenizer);
     
+    token->id = 0;
+    token->position.start = tokenizer->position;
+    token->position.line = tokenizer->line;
+    token->position.column = tokenizer->column;
+
+    char current = input[tokenizer->position];
+
     // Check if we're at the end of the input
-    if (tokenizer->input[tokenizer->position] == '\0') {
-        Token token;
-        token.type = TOKEN_END;
-        token.value[0] = '\0';
-        token.position.start = tokenizer->position;
-        token.position.end = tokenizer->position;
-        token.position.line = tokenizer->line;
-        token.position.column = tokenizer->column;
+    if (current == '\0') {
+        token->type = TOKEN_END;
+        token->position.end = tokenizer->position;
 
-        log_debug("End of input reached");
-        return token;
+        LOG_DEBUG("End of input reached");
+        return;
     }
     
-    char current = tokenizer->input[tokenizer->position];
-    Token token;
-    token.position.start = tokenizer->position;
-    token.position.line = tokenizer->line;
-    token.position.column = tokenizer->column;
-    
     // Check for numbers
-    if ((current >= '0' && current <= '9') || current == '.') {
-        int i = 0;
+    if (is_digit(current) || current == '.') {
         bool has_decimal = false;
         
         // Collect all digits and decimal point
-        while ((tokenizer->input[tokenizer->position] >= '0' && 
-                tokenizer->input[tokenizer->position] <= '9') || 
-               (tokenizer->input[tokenizer->position] == '.' && !has_decimal)) {
-            
-            if (tokenizer->input[tokenizer->position] == '.') {
+        while (is_digit(input[tokenizer->position]) ||
+               (input[tokenizer->position] == '.' && !has_decimal)) {
+            if (input[tokenizer->position] == '.') {
                 has_decimal = true;
             }
-            
-            token.value[i++] = tokenizer->input[tokenizer->position];
             advance_position(tokenizer);
-            
-            // Prevent buffer overflow
-            if (i >= MAX_TOKEN_LENGTH - 1) break;
         }
         
-        // Check for scientific notation (e.g., 1.23e5 or 1.23E5)
-        if ((tokenizer->input[tokenizer->position] == 'e' || 
-             tokenizer->input[tokenizer->position] == 'E') && 
-            i < MAX_TOKEN_LENGTH - 2) { // Need space for 'e' and at least one digit
-            
-            token.value[i++] = tokenizer->input[tokenizer->position];
-            advance_position(tokenizer);
-            
-            // Handle optional sign
-            if ((tokenizer->input[tokenizer->position] == '+' || 
-                 tokenizer->input[tokenizer->position] == '-') && 
-                i < MAX_TOKEN_LENGTH - 1) {
-                
-                token.value[i++] = tokenizer->input[tokenizer->position];
-                advance_position(tokenizer);
-            }
-            
-            // Ensure at least one digit after 'e'
-            bool has_exponent_digit = false;
-            
-            while (tokenizer->input[tokenizer->position] >= '0' && 
-                   tokenizer->input[tokenizer->position] <= '9') {
-                
-                has_exponent_digit = true;
-                token.value[i++] = tokenizer->input[tokenizer->position];
-                advance_position(tokenizer);
-                
-                // Prevent buffer overflow
-                if (i >= MAX_TOKEN_LENGTH - 1) break;
+        // Check for scientific notation (e.g., 1.23e5 or 1.23E5), which
+        // needs at least one digit after the 'e' and its optional sign
+        char marker = input[tokenizer->position];
+        if (marker == 'e' || marker == 'E') {
+            int digit = tokenizer->position + 1;
+            if (input[digit] == '+' || input[digit] == '-') {
+                digit++;
             }
             
-            // If no digits after 'e', this isn't valid scientific notation
-            if (!has_exponent_digit) {
-                // We need to backtrack to before the 'e'
-                tokenizer->position -= (token.value[i-1] == '+' || token.value[i-1] == '-') ? 2 : 1;
-                i -= (token.value[i-1] == '+' || token.value[i-1] == '-') ? 2 : 1;
+            if (is_digit(input[digit])) {
+                while (tokenizer->position < digit) {
+                    advance_position(tokenizer);
+                }
+                while (is_digit(input[tokenizer->position])) {
+                    advance_position(tokenizer);
+                }
             }
         }
         
-        token.value[i] = '\0';
-        token.type = TOKEN_NUMBER;
-        token.position.end = tokenizer->position - 1;
+        token->type = TOKEN_NUMBER;
+        token->position.end = tokenizer->position - 1;
         
-        // Convert string to real_t number
-        token.real_value = os_StrToReal(token.value, NULL);
+        // Convert the literal straight from the input, whatever its length
+        token->real_value = parse_real(input + token->position.start,
+                                       tokenizer->position - token->position.start);
         
-        log_token("num.", token.type, token.value);
-        return token;
+        LOG_TOKEN("num.", token->type, input + token->position.start,
+                  tokenizer->position - token->position.start);
+        return;
     }
     
     // Check for variables and function names
-    if ((current >= 'a' && current <= 'z') || 
-        (current >= 'A' && current <= 'Z') ||
-        current == '_') {
-        
-        int i = 0;
+    if (is_identifier_start(current)) {
+        char name[MAX_TOKEN_LENGTH];
+        int length = 0;
         
         // Collect all letters, digits, and underscores
-        while ((tokenizer->input[tokenizer->position] >= 'a' && 
-                tokenizer->input[tokenizer->position] <= 'z') || 
-               (tokenizer->input[tokenizer->position] >= 'A' && 
-                tokenizer->input[tokenizer->position] <= 'Z') ||
-               (tokenizer->input[tokenizer->position] >= '0' && 
-                tokenizer->input[tokenizer->position] <= '9') ||
-               tokenizer->input[tokenizer->position] == '_') {
+        while (is_identifier_start(input[tokenizer->position]) ||
+               is_digit(input[tokenizer->position])) {
 
-            /* lowercase the character */
-            char temp = tokenizer->input[tokenizer->position];
-            temp = (temp >= 'A' && temp <= 'Z') ? temp + 32 : temp;
-            token.value[i++] = temp;
+            // Keep a lowercase copy of the name for the lookup; longer
+            // names are told apart by their first characters only
+            if (length < MAX_TOKEN_LENGTH - 1) {
+                char temp = input[tokenizer->position];
+                name[length++] = (temp >= 'A' && temp <= 'Z') ? temp + 32 : temp;
+            }
 
             advance_position(tokenizer);
-            
-            // Prevent buffer overflow
-            if (i >= MAX_TOKEN_LENGTH - 1) break;
         }
-        
-        token.value[i] = '\0';
+        name[length] = '\0';
         
         // Check if this is a mathematical constant or function
-        if (strcmp(token.value, "pi") == 0) {
-            token.type = TOKEN_PI;
-            
-            // Set real_value to pi
-            real_t pi;
-            pi.exp = 0;
-            pi.sign = 0;
-            // Mantissa for pi (3.14159...)
-            pi.mant[0] = 0x31;
-            pi.mant[1] = 0x41;
-            pi.mant[2] = 0x59;
-            pi.mant[3] = 0x26;
-            pi.mant[4] = 0x53;
-            pi.mant[5] = 0x58;
-            pi.mant[6] = 0x97;
-            
-            token.real_value = pi;
-        } else if (strcmp(token.value, "phi") == 0) {
-            token.type = TOKEN_PHI;
-            
-            // Set real_value to phi (golden ratio)
-            real_t phi;
-            phi.exp = 0;
-            phi.sign = 0;
-            // Mantissa for phi (1.618...)
-            phi.mant[0] = 0x16;
-            phi.mant[1] = 0x18;
-            phi.mant[2] = 0x03;
-            phi.mant[3] = 0x39;
-            phi.mant[4] = 0x88;
-            phi.mant[5] = 0x74;
-            phi.mant[6] = 0x98;
-            
-            token.real_value = phi;
-        } else if (strcmp(token.value, "sin") == 0 ||
-            strcmp(token.value, "cos") == 0 ||
-            strcmp(token.value, "tan") == 0 ||
-            strcmp(token.value, "log") == 0 ||
-            strcmp(token.value, "ln") == 0 ||
-            strcmp(token.value, "sqrt") == 0) {
-            token.type = TOKEN_FUNCTION;
-        } else {
-            // if not consider it a variable
-            token.type = TOKEN_VARIABLE;
-        }
+        classify_identifier(token, name);
         
-        token.position.end = tokenizer->position - 1;
-        log_token("func", token.type, token.value);
-        return token;
+        token->position.end = tokenizer->position - 1;
+        LOG_TOKEN("func", token->type, input + token->position.start,
+                  tokenizer->position - token->position.start);
+        return;
     }
     
     // Check for single-character tokens
-    token.value[0] = current;
-    token.value[1] = '\0';
     advance_position(tokenizer);
-    token.position.end = tokenizer->position - 1;
+    token->position.end = tokenizer->position - 1;
     
     switch (current) {
-        case '+': token.type = TOKEN_PLUS; break;
-        case '-': token.type = TOKEN_MINUS; break;
-        case '*': token.type = TOKEN_MULTIPLY; break;
-        case '/': token.type = TOKEN_DIVIDE; break;
-        case '^': token.type = TOKEN_POWER; break;
-        case '(': token.type = TOKEN_LEFT_PAREN; break;
-        case ')': token.type = TOKEN_RIGHT_PAREN; break;
-        case ',': token.type = TOKEN_COMMA; break;
-        case '!': token.type = TOKEN_FACTORIAL; break;
-        case (char)0xC4: 
-            token.type = TOKEN_PI;
-            // Set real_value to pi (same as above)
-            {
-                real_t pi;
-                pi.exp = 0;
-                pi.sign = 0;
-                // Mantissa for pi (3.14159...)
-                pi.mant[0] = 0x31;
-                pi.mant[1] = 0x41;
-                pi.mant[2] = 0x59;
-                pi.mant[3] = 0x26;
-                pi.mant[4] = 0x53;
-                pi.mant[5] = 0x58;
-                pi.mant[6] = 0x97;
-                
-                token.real_value = pi;
-            }
-            break;
-        case (char)0xD1: 
-            token.type = TOKEN_PHI;
-            // Set real_value to phi (same as above)
-            {
-                real_t phi;
-                phi.exp = 0;
-                phi.sign = 0;
-                // Mantissa for phi (1.618...)
-                phi.mant[0] = 0x16;
-                phi.mant[1] = 0x18;
-                phi.mant[2] = 0x03;
-                phi.mant[3] = 0x39;
-                phi.mant[4] = 0x88;
-                phi.mant[5] = 0x74;
-                phi.mant[6] = 0x98;
-                
-                token.real_value = phi;
-            }
-            break;
-        default:  token.type = TOKEN_NONE; break;
+        case '+': token->type = TOKEN_PLUS; break;
+        case '-': token->type = TOKEN_MINUS; break;
+        case '*': token->type = TOKEN_MULTIPLY; break;
+        case '/': token->type = TOKEN_DIVIDE; break;
+        case '^': token->type = TOKEN_POWER; break;
+        case '(': token->type = TOKEN_LEFT_PAREN; break;
+        case ')': token->type = TOKEN_RIGHT_PAREN; break;
+        case ',': token->type = TOKEN_COMMA; break;
+        case '!': token->type = TOKEN_FACTORIAL; break;
+        case (char)0xC4: token->type = TOKEN_CONSTANT; token->id = CONST_PI; break;
+        case (char)0xD1: token->type = TOKEN_CONSTANT; token->id = CONST_PHI; break;
+        default:  token->type = TOKEN_NONE; break;
     }
 
-    log_token_char("char", token.type, current);
-    
-    return token;
+    LOG_TOKEN("char", token->type, input + token->position.start, 1);
 }
@@ -11,8 +11,10 @@
 #include <string.h>
 #include <stdio.h>
 #include <ti/screen.h>
-#include "headers/kb_handler.h"
+#include "headers/editor.h"
+#include "../../common/headers/kb_handler.h"
 #include "headers/mathsolver.h"
+#include "headers/profile.h"
 #include "headers/ui_private.h"
 
 #define LOG_TAG "ui"
@@ -27,7 +29,10 @@ typedef enum {
     STATE_INPUT,    /**< Input state where the user enters expressions. */
     STATE_RESULT,   /**< Result state where the calculation result is displayed. */
     STATE_ERROR,    /**< Error state where error messages are shown. */
-    STATE_SETTINGS  /**< Settings state for configuring calculator options. */
+    STATE_SETTINGS, /**< Settings state for configuring calculator options. */
+    STATE_TABLE,    /**< Table state where the expression is tabulated over its variable. */
+    STATE_GRAPH,    /**< Graph state where the expression is plotted over its variable. */
+    STATE_SOLVE     /**< Solve state where a root of the equation is searched for. */
 } CalculatorState;
 
 /** Current state of the calculator. */
@@ -36,6 +41,18 @@ static CalculatorState current_state = STATE_INPUT;
 /** Buffer for storing the current expression entered by the user. */
 static char current_expression[MAX_INPUT_LENGTH] = "";
 
+/** Parsed form of current_expression, kept to recompute the result when the settings change. */
+static ExpressionNode* current_root = NULL;
+
+/** Parsed form of the expression being typed, or NULL when it has no preview. */
+static ExpressionNode* preview_root = NULL;
+
+/** Flag indicating whether current_result holds the result of current_expression. */
+static bool has_result = false;
+
+/** Whether current_result holds a root of the current equation */
+static bool has_solution = false;
+
 /** Buffer for storing error messages. */
 static char error_message[MAX_INPUT_LENGTH] = "";
 
@@ -45,9 +62,18 @@ static CalculationResult current_result;
 /** Tracks the current scroll position for displaying calculation steps. */
 static int step_scroll_position = 0;
 
+/** Arithmetic mode, and formatted values, of the result shown by the result view. */
+static ArithmeticType result_view_mode = ARITHMETIC_NORMAL;
+static char result_value_str[MAX_TOKEN_LENGTH];
+static char result_normal_str[MAX_TOKEN_LENGTH];
+static char result_diff_str[MAX_TOKEN_LENGTH];
+
 /** Flag indicating whether to show detailed calculation steps. */
 static bool show_step_details = false;
 
+/** First row of the function table shown on the screen. */
+static uint16_t table_top = 0;
+
 /** Flag indicating whether the calculator is running. */
 static bool running = true;
 
@@ -58,6 +84,26 @@ static bool waiting = false;
 #define SCREEN_ROWS 9     /**< Number of rows on the screen (0-8). */
 #define SCREEN_COLS 26    /**< Number of columns on the screen (0-25). */
 
+/** Screen row of the expression input, and of the preview of its value */
+#define INPUT_ROW 6
+#define PREVIEW_ROW 7
+
+/** Pause in typing before the value of the expression is previewed (in ms) */
+#define PREVIEW_DELAY_MS 150
+
+/** Last screen row of the panel of the result view, below its step counter. */
+#define RESULT_PANEL_LAST_ROW 7
+
+/** Time UP or DOWN is held before the steps scroll on their own, and between two steps (in ms). */
+#define SCROLL_REPEAT_DELAY_MS 400
+#define SCROLL_REPEAT_MS       80
+
+/** Rows of the function table shown at once. */
+#define TABLE_VISIBLE_ROWS 7
+
+/** Pixels the graph moves by for each arrow key press. */
+#define GRAPH_PAN_PIXELS 32
+
 /*
  *  _____        _     _   _ ___   _   _ _   _ _ _ _   _        
  * |_   _|____ _| |_  | | | |_ _| | | | | |_(_) (_) |_(_)___ ___
@@ -353,16 +399,85 @@ void show_input_prompt(void) {
     println("Enter expression:");
 }
 
+/**
+ * Builds the description of the operation of a calculation step.
+ * Variable names are taken from the source text of the expression.
+ * 
+ * @param step Pointer to the step to describe.
+ * @param buffer Buffer to store the description, at least MAX_INPUT_LENGTH long.
+ */
+static void describe_step_operation(CalculationStep* step, char* buffer) {
+    switch (step->operation) {
+        case STEP_SUBSTITUTE:
+            sprintf(buffer, "Substitute %.*s", step->span_length, &current_expression[step->span_start]);
+            break;
+        case STEP_ADD:              strcpy(buffer, "Add"); break;
+        case STEP_SUBTRACT:         strcpy(buffer, "Subtract"); break;
+        case STEP_MULTIPLY:         strcpy(buffer, "Multiply"); break;
+        case STEP_DIVIDE:           strcpy(buffer, "Divide"); break;
+        case STEP_POWER:            strcpy(buffer, "Power"); break;
+        case STEP_FACTORIAL:        strcpy(buffer, "Factorial"); break;
+        case STEP_DIVISION_BY_ZERO: strcpy(buffer, "Division by zero"); break;
+        case STEP_POWER_ERROR:      strcpy(buffer, "Power domain error"); break;
+        case STEP_FACTORIAL_ERROR:  strcpy(buffer, "Factorial domain error"); break;
+        case STEP_FACTORIAL_OVERFLOW: strcpy(buffer, "Factorial overflow"); break;
+        case STEP_FUNCTION:
+            strcpy(buffer, get_function_name((FunctionType)step->detail));
+            break;
+        case STEP_DOMAIN_ERROR:
+            sprintf(buffer, "%s domain error", get_function_name((FunctionType)step->detail));
+            break;
+        case STEP_NEWTON:           strcpy(buffer, "Newton step"); break;
+        case STEP_SECANT:           strcpy(buffer, "Secant step"); break;
+        case STEP_SUMMATION:        strcpy(buffer, "Sum"); break;
+        case STEP_PRODUCT:          strcpy(buffer, "Product"); break;
+        case STEP_INTERRUPTED:      strcpy(buffer, "Interrupted"); break;
+        case STEP_BOUNDS_ERROR:
+            sprintf(buffer, "%s bounds error", step->detail == NODE_SUMMATION ? "Sum" : "Product");
+            break;
+        default:
+            strcpy(buffer, "Unknown");
+            break;
+    }
+}
+
 /**
  * Displays the calculation result with step-by-step details if available.
  * 
  * This function shows the calculation result and allows the user to scroll
  * through individual calculation steps. It handles different formatting
- * depending on the current arithmetic mode.
+ * depending on the current arithmetic mode. The values of the summary are
+ * formatted here once, and kept for show_calculation_step to redraw the
+ * panel with while the steps are scrolled.
  * 
  * @param result Pointer to the calculation result structure to display.
  */
 void show_calculation_result(CalculationResult* result) {
+    result_view_mode = get_arithmetic_mode();
+    format_real(result->value, result_value_str);
+    if (result_view_mode != ARITHMETIC_NORMAL) {
+        real_t left = result->normal_value;
+        real_t right = result->value;
+        real_t diff = os_RealSub(&left, &right);
+        format_real(diff, result_diff_str);
+        format_real(result->normal_value, result_normal_str);
+    }
+
+    PROFILE_START(PROFILE_DRAW);
+    clear_screen();
+    show_calculation_step(result);
+    print_footer("\xef\xf0:Scroll <MODE>:Settings");
+    PROFILE_STOP(PROFILE_DRAW);
+}
+
+/**
+ * Redraws the step counter and the panel of the result view for the
+ * current scroll position, over what the view showed before. The header
+ * and footer are left as they are.
+ * 
+ * @param result Pointer to the calculation result shown by the view.
+ */
+static void show_calculation_step(CalculationResult* result) {
     int cnt = result->step_count;
     if (step_scroll_position < 0) {
         step_scroll_position = cnt;
@@ -370,65 +485,133 @@ void show_calculation_result(CalculationResult* result) {
     {
         step_scroll_position = 0;
     }
-    
-    clear_screen();
-    os_SetCursorPos(0,0);
-    print_format("%d/%d", step_scroll_position, cnt);
-    print_right(get_mode_str());
-        
-    char diff_str[MAX_TOKEN_LENGTH];
-    ArithmeticType mode = get_arithmetic_mode();
-    if (mode != ARITHMETIC_NORMAL) {
-        real_t left = result->normal_value;
-        real_t right = result->value;
-        real_t diff = os_RealSub(&left, &right);
-        format_real(diff, diff_str);        
-    }
 
-    char rst[MAX_TOKEN_LENGTH];
-    format_real(result->value, rst);
-    
+    // The counter is padded up to the mode, over the longer count it may replace
+    char* mode_str = get_mode_str();
+    char counter[SCREEN_COLS + 1];
+    sprintf(counter, "%d/%d", step_scroll_position, cnt);
+    os_SetCursorPos(0, 0);
+    print_format("%-*s", SCREEN_COLS - (int)strlen(mode_str), counter);
+    print_right(mode_str);
+
+    int row = 1;
     if (step_scroll_position == 0) {
-        os_SetCursorPos(2, 0);
-        println("Result:");
-        print_right(rst);
+        if (has_solution) {
+            // A root stored over a value the variable had is said so
+            draw_panel_row(row++, solve_replaced_value() ? "Replaced:" : "Solved for:", (char*)solve_variable_name());
+        } else {
+            draw_panel_row(row++, "", "");
+        }
+        draw_panel_row(row++, "Result:", "");
+        draw_panel_row(row++, "", result_value_str);
         
-        if (mode != ARITHMETIC_NORMAL) {
-            os_SetCursorPos(4, 0);
-            char norm[MAX_TOKEN_LENGTH];
-            format_real(result->normal_value, norm);
-            println("True Value:");
-            print_right(norm);
-            os_SetCursorPos(6, 0);
-            println("Diff:");
-            print_right(diff_str);
+        if (result_view_mode != ARITHMETIC_NORMAL) {
+            draw_panel_row(row++, "True Value:", "");
+            draw_panel_row(row++, "", result_normal_str);
+            draw_panel_row(row++, "Diff:", "");
+            draw_panel_row(row++, "", result_diff_str);
         }
     }
     else
     {
-        CalculationStep* step = &result->steps[step_scroll_position - 1];
-        os_SetCursorPos(1, 0);
-        println_format_right("Oper: %s", step->operation);
+        CalculationStep step_data;
+        CalculationStep* step = &step_data;
+        if (!get_step(result, step_scroll_position - 1, step)) {
+            draw_panel_row(row++, "", "Step unavailable");
+            while (row <= RESULT_PANEL_LAST_ROW) {
+                draw_panel_row(row++, "", "");
+            }
+            return;
+        }
+
+        char operation[MAX_INPUT_LENGTH];
+        char line[MAX_INPUT_LENGTH + 7];
+        char operand[MAX_TOKEN_LENGTH];
+        describe_step_operation(step, operation);
+
+        sprintf(line, "Oper: %s", operation);
+        draw_panel_row(row++, "", line);
         if(step->type == STEP_BINARY) {
-            print("Left:");
-            println_right(step->left_operand);
-            print("Right:");
-            println_right(step->right_operand);
+            format_step_value(result, step->left, operand);
+            draw_panel_row(row++, "Left:", operand);
+            format_step_value(result, step->right, operand);
+            draw_panel_row(row++, "Right:", operand);
         } else if(step->type == STEP_UNARY_LEFT) {
-            print("Operand:");
-            println_right(step->left_operand);
-            new_line();
+            format_step_value(result, step->left, operand);
+            draw_panel_row(row++, "Operand:", operand);
+            draw_panel_row(row++, "", "");
         } else if (step->type == STEP_UNARY_RIGHT)
         {
-            print("Operand:");
-            println_right(step->right_operand);
-            new_line();
+            format_step_value(result, step->right, operand);
+            draw_panel_row(row++, "Operand:", operand);
+            draw_panel_row(row++, "", "");
+        } else if (step->type == STEP_RANGE) {
+            format_step_value(result, step->left, operand);
+            draw_panel_row(row++, "From:", operand);
+            format_step_value(result, step->right, operand);
+            draw_panel_row(row++, "To:", operand);
+        } else if (step->type == STEP_ITERATION) {
+            format_step_value(result, step->left, operand);
+            draw_panel_row(row++, "x:", operand);
+            format_step_value(result, step->right, operand);
+            draw_panel_row(row++, "f(x):", operand);
+        }
+        char* label = step->type == STEP_ITERATION ? "Next:" : "Result:";
+        if (step->operation == STEP_DIVISION_BY_ZERO ||
+            step->operation == STEP_DOMAIN_ERROR ||
+            step->operation == STEP_POWER_ERROR ||
+            step->operation == STEP_FACTORIAL_ERROR ||
+            step->operation == STEP_BOUNDS_ERROR) {
+            draw_panel_row(row++, label, "Undefined");
+        } else if (step->operation == STEP_INTERRUPTED) {
+            draw_panel_row(row++, label, "Stopped");
+        } else if (step->operation == STEP_FACTORIAL_OVERFLOW) {
+            draw_panel_row(row++, label, "Overflow");
+        } else {
+            format_step_value(result, step->result, operand);
+            draw_panel_row(row++, label, operand);
         }
-        print("Result:");
-        println_right(step->result);
     }
 
-    print_footer("\xef\xf0:Scroll <MODE>:Settings");
+    // Blank the rows the previous panel may have used
+    while (row <= RESULT_PANEL_LAST_ROW) {
+        draw_panel_row(row++, "", "");
+    }
+}
+
+/**
+ * Formats a value of a step in the arithmetic settings of its result.
+ * 
+ * @param result Pointer to the result the step belongs to.
+ * @param value The value.
+ * @param buffer The buffer to store the formatted string, MAX_TOKEN_LENGTH long.
+ */
+static void format_step_value(const CalculationResult* result, real_t value, char* buffer) {
+    format_real_in_mode(value, result->arithmetic_mode, result->precision, result->use_significant_digits, buffer);
+}
+
+/**
+ * Draws a whole row of the result panel: a label on the left and a value
+ * aligned to the right, with spaces over whatever the row held before.
+ * 
+ * @param row The screen row to draw.
+ * @param label The text on the left of the row.
+ * @param value The text on the right of the row; it covers the label if both do not fit.
+ */
+static void draw_panel_row(int row, char* label, char* value) {
+    char line[SCREEN_COLS + 1];
+    int label_length = strlen(label);
+    int value_length = strlen(value);
+    if (label_length > SCREEN_COLS) label_length = SCREEN_COLS;
+    if (value_length > SCREEN_COLS) value_length = SCREEN_COLS;
+
+    memset(line, ' ', SCREEN_COLS);
+    memcpy(line, label, label_length);
+    memcpy(line + SCREEN_COLS - value_length, value, value_length);
+    line[SCREEN_COLS] = '\0';
+
+    os_SetCursorPos(row, 0);
+    print(line);
 }
 
 /**
@@ -496,6 +679,43 @@ void print_precision_type(void) {
         println_format("3. Type: %s", use_sig_digits ? "Sig.Digits" : "Dec.Places");
 }
 
+/**
+ * Displays the visible rows of the function table.
+ * Only these rows are computed; the table keeps the ones already seen.
+ */
+void show_table(void) {
+    char value[MAX_TOKEN_LENGTH];
+
+    clear_screen();
+    os_SetCursorPos(0, 0);
+    print_format("%d/%d", table_top + 1, table_row_count());
+    print_right(get_mode_str());
+
+    os_SetCursorPos(1, 0);
+    print((char*)table_variable_name());
+    print_right("Value");
+
+    for (int line = 0; line < TABLE_VISIBLE_ROWS; line++) {
+        uint16_t row = table_top + line;
+        if (row >= table_row_count()) {
+            break;
+        }
+
+        os_SetCursorPos(2 + line, 0);
+        format_real(table_x(row), value);
+        print(value);
+        real_t y;
+        if (table_value(row, &y)) {
+            format_real(y, value);
+            print_right(value);
+        } else {
+            print_right("Undefined");
+        }
+    }
+
+    print_footer("<ENT.>:Back Arrows:Scroll");
+}
+
 /**
  * Displays a footer for selecting precision.
  */
@@ -521,24 +741,249 @@ void print_select_precision(void) {
  * @return True if input was provided, false if canceled.
  */
 bool get_expression_input(char* buffer, int buffer_size) {
-    // Prepare for input
-    os_SetCursorPos(6, 0);
-    
-    // Make sure buffer is cleared
+    // The preview parses into the node pool, over the last tree
+    current_root = NULL;
     buffer[0] = '\0';
-    
-    // Wait a moment to ensure screen is updated
-    delay(100);
-    
-    // Get input - check documentation for exact parameters
-    // The first parameter might need to be NULL
-    os_GetStringInput("> ", buffer, buffer_size - 1);
-    
-    // Ensure null termination
-    buffer[buffer_size - 1] = '\0';
-    
+
+    editor_set_handlers(preview_changed, preview_idle, PREVIEW_DELAY_MS);
+    editor_set_recall(recall_history);
+    bool entered = edit_line(INPUT_ROW, "> ", buffer, buffer_size);
+
     // Check if input was provided or canceled
-    return (buffer[0] != '\0');
+    return entered && buffer[0] != '\0';
+}
+
+/**
+ * Copies an expression of the history into the line being edited.
+ * 
+ * @param back How far back the expression is, 0 being the newest.
+ * @param buffer Buffer to copy the expression to.
+ * @param buffer_size Size of the buffer.
+ * @return True if the expression was copied, false if the history is not that long.
+ */
+static bool recall_history(int back, char* buffer, int buffer_size) {
+    HistoryEntry entry;
+    if (!get_history(back, &entry)) {
+        return false;
+    }
+
+    int length = entry.length < buffer_size - 1 ? entry.length : buffer_size - 1;
+    memcpy(buffer, entry.text, length);
+    buffer[length] = '\0';
+    return true;
+}
+
+/**
+ * Parses the expression being typed again after a change. The parse
+ * resumes from where the text differs, so it is cheap enough for every key.
+ * 
+ * @param text The expression typed so far.
+ */
+static void preview_changed(const char* text) {
+    clear_preview();
+    preview_root = can_preview(text) ? parse_expression_incremental(text) : NULL;
+}
+
+/**
+ * Shows the value of the expression being typed, once typing pauses.
+ * A long sum or product gives way as soon as another key is pressed.
+ * 
+ * @param text The expression typed so far.
+ */
+static void preview_idle(const char* text) {
+    (void)text;
+    if (preview_root == NULL) {
+        return;
+    }
+
+    real_t value;
+    set_loop_progress_handler(stop_preview);
+    bool complete = evaluate_preview(preview_root, &value);
+    set_loop_progress_handler(NULL);
+    if (!complete) {
+        return;
+    }
+
+    char formatted[MAX_TOKEN_LENGTH + 2] = "=";
+    format_real(value, &formatted[1]);
+    os_SetCursorPos(PREVIEW_ROW, 0);
+    print_right(formatted);
+}
+
+/**
+ * Tells whether the expression being typed can be previewed: equations
+ * are solved, not evaluated, and an operator at the end still waits for
+ * its operand.
+ * 
+ * @param text The expression typed so far.
+ * @return True if the expression can be previewed.
+ */
+static bool can_preview(const char* text) {
+    int end = strlen(text);
+    while (end > 0 && text[end - 1] == ' ') {
+        end--;
+    }
+    return end > 0 && strchr(text, '=') == NULL && strchr("+-*/^(,", text[end - 1]) == NULL;
+}
+
+/**
+ * Clears the preview row.
+ */
+static void clear_preview(void) {
+    os_SetCursorPos(PREVIEW_ROW, 0);
+    print_format("%*s", SCREEN_COLS - 1, "");
+}
+
+/**
+ * Stops the evaluation of a preview when a key is pressed or released.
+ * 
+ * @param done Iterations done.
+ * @param total Iterations in all.
+ * @return True to go on, false to stop.
+ */
+static bool stop_preview(int done, int total) {
+    (void)done;
+    (void)total;
+    return !kb_has_event();
+}
+
+/**
+ * Gets a number from the user; it may be written as an expression.
+ * 
+ * @param row Screen row of the prompt.
+ * @param prompt The prompt to show.
+ * @param value Pointer set to the number entered.
+ * @return True if a number was entered, false if the input was canceled or invalid.
+ */
+static bool get_number_input(int row, const char* prompt, real_t* value) {
+    char buffer[MAX_INPUT_LENGTH];
+
+    buffer[0] = '\0';
+    if (!edit_line(row, prompt, buffer, MAX_INPUT_LENGTH) || buffer[0] == '\0') {
+        current_state = STATE_RESULT;
+        return false;
+    }
+
+    ExpressionNode* root = parse_expression_string(buffer);
+    if (root == NULL) {
+        strcpy(error_message, "Invalid number");
+        current_state = STATE_ERROR;
+        return false;
+    }
+
+    *value = evaluate_expression(root);
+    return true;
+}
+
+/**
+ * Asks for the range of the function table and prepares it.
+ * On failure the state is set to where the calculator goes next: back to
+ * the result if the user canceled, or to the error screen.
+ * 
+ * @return True if the table is ready, false otherwise.
+ */
+static bool setup_table(void) {
+    real_t start;
+    real_t step;
+    real_t rows;
+
+    draw_header();
+    print_centered("Table");
+    os_SetCursorPos(3, 0);
+    println_format_truncated("f=%s", current_expression);
+
+    bool entered = get_number_input(5, "Start: ", &start) &&
+                   get_number_input(6, "Step: ", &step) &&
+                   get_number_input(7, "Rows: ", &rows);
+
+    // The inputs and the table replaced the parsed expression
+    current_root = NULL;
+    if (!entered) {
+        return false;
+    }
+
+    // Clamp before converting, os_RealToInt24 fails past the range of an int24_t
+    real_t one = os_Int24ToReal(1);
+    real_t max_rows = os_Int24ToReal(TABLE_MAX_ROWS);
+    if (os_RealCompare(&rows, &one) < 0) {
+        strcpy(error_message, "Invalid row count");
+        current_state = STATE_ERROR;
+        return false;
+    }
+    if (os_RealCompare(&rows, &max_rows) > 0) {
+        rows = max_rows;
+    }
+
+    return check_plot_status(table_init(current_expression, start, step, os_RealToInt24(&rows)));
+}
+
+/**
+ * Asks for a guess and solves the current equation for its variable.
+ * On failure the state is set to where the calculator goes next: back to
+ * the result or the input if the user canceled, or to the error screen.
+ * 
+ * @return True if a root was found, false otherwise.
+ */
+static bool solve_current_equation(void) {
+    real_t guess;
+
+    draw_header();
+    print_centered("Solve");
+    os_SetCursorPos(3, 0);
+    println_format_truncated("%s", current_expression);
+
+    bool entered = get_number_input(5, "Guess: ", &guess);
+    current_root = NULL;
+    if (!entered) {
+        if (current_state == STATE_RESULT && !has_result && !has_solution) {
+            current_state = STATE_INPUT;
+        }
+        return false;
+    }
+
+    SolveStatus status = solve_equation(current_expression, guess, &current_result);
+
+    // The solver compiled the equation over the parsed expression
+    has_result = false;
+    switch (status) {
+        case SOLVE_OK:
+            has_solution = true;
+            return true;
+        case SOLVE_NO_VARIABLE:
+            strcpy(error_message, "No variable");
+            break;
+        case SOLVE_NO_ROOT:
+            strcpy(error_message, "No root found");
+            break;
+        default:
+            strcpy(error_message, "Invalid expression");
+            break;
+    }
+    has_solution = false;
+    current_state = STATE_ERROR;
+    return false;
+}
+
+/**
+ * Checks the outcome of preparing a table or a graph, going to the error
+ * screen if it failed.
+ * 
+ * @param status The outcome.
+ * @return True if the table or graph is ready, false otherwise.
+ */
+static bool check_plot_status(PlotStatus status) {
+    switch (status) {
+        case PLOT_OK:
+            return true;
+        case PLOT_NO_VARIABLE:
+            strcpy(error_message, "No variable");
+            break;
+        default:
+            strcpy(error_message, "Invalid expression");
+            break;
+    }
+    current_state = STATE_ERROR;
+    return false;
 }
 
 /**
@@ -580,8 +1025,8 @@ void adjust_precision(void) {
 
     waiting = true;
     while (waiting) {
+        kb_wait_event();
         kb_process();
-        delay(50);
     }
 }
 
@@ -600,6 +1045,50 @@ void input_state(void) {
     current_state = STATE_INPUT;
 }
 
+/**
+ * Returns to the result of the current expression, recomputed with the
+ * settings now in effect. Only the evaluator runs again, the expression
+ * is not parsed a second time.
+ */
+void result_state(void) {
+    if (!has_result) {
+        return;
+    }
+
+    LOG_INFO("Re-evaluating with the new settings.");
+    if (compute_result()) {
+        current_state = STATE_RESULT;
+    }
+}
+
+/**
+ * Sets the calculator state to table mode.
+ */
+void table_state(void) {
+    current_state = STATE_TABLE;
+}
+
+/**
+ * Leaves the function table or the graph for the result it was opened from.
+ */
+void back_to_result(void) {
+    current_state = STATE_RESULT;
+}
+
+/**
+ * Sets the calculator state to graph mode.
+ */
+void graph_state(void) {
+    current_state = STATE_GRAPH;
+}
+
+/**
+ * Sets the calculator state to solve mode.
+ */
+void solve_state(void) {
+    current_state = STATE_SOLVE;
+}
+
 /**
  * Sets the calculator state to settings mode.
  */
@@ -652,21 +1141,45 @@ void run_calculator_ui(void) {
                     if (get_expression_input(current_expression, MAX_INPUT_LENGTH)) {
                         // User entered an expression
                         if (strlen(current_expression) > 0) {
+#if LOG_ENABLED(LOG_LEVEL_TRACE)
                             int len = strlen(current_expression);
                             for (int i = 0; i < len; i++) {
-                                log_message("Char %d: '%c'  %2x", i, current_expression[i], current_expression[i]);
+                                LOG_TRACE("Char %d: '%c'  %2x", i, current_expression[i], current_expression[i]);
                             }
+#endif
                             // Set flag to prevent redisplaying input prompt
                             input_processed = true;
                             
+                            current_root = NULL;
+                            has_solution = false;
+
+                            // An equation is solved rather than evaluated
+                            if (strchr(current_expression, '=') != NULL) {
+                                has_result = false;
+                                current_state = STATE_SOLVE;
+                                break;
+                            }
+
                             // Evaluate the expression
-                            if (evaluate_expression_string(current_expression, &current_result)) {
+                            has_result = compute_result();
+                            if (has_result) {
+                                add_history(current_expression, &current_result);
                                 current_state = STATE_RESULT;
                                 step_scroll_position = 0;
                                 show_step_details = false;
                             } else {
                                 // Set error message
-                                strcpy(error_message, "Invalid expression");
+                                if (current_root != NULL) {
+                                    // It parsed, so it was stopped with ON
+                                    strcpy(error_message, "Interrupted");
+                                } else {
+                                    switch (get_parse_status()) {
+                                        case PARSE_TOO_COMPLEX: strcpy(error_message, "Too complex"); break;
+                                        case PARSE_TOO_LONG:    strcpy(error_message, "Too long"); break;
+                                        case PARSE_TOO_MANY_VARIABLES: strcpy(error_message, "Too many variables"); break;
+                                        default:                strcpy(error_message, "Invalid expression"); break;
+                                    }
+                                }
                                 current_state = STATE_ERROR;
                             }
                         }
@@ -684,8 +1197,8 @@ void run_calculator_ui(void) {
                 show_calculation_result(&current_result);
 
                 while (running && current_state == STATE_RESULT) {
+                    kb_wait_event();
                     kb_process();
-                    delay(50);
                 }
                 kb_clear();
                 break;
@@ -700,12 +1213,55 @@ void run_calculator_ui(void) {
 
                 break;
                 
+            case STATE_TABLE:
+                if (!setup_table()) {
+                    break;
+                }
+
+                table_top = 0;
+                register_table_kb();
+                show_table();
+                while (running && current_state == STATE_TABLE) {
+                    kb_wait_event();
+                    kb_process();
+                }
+                table_close();
+                kb_clear();
+                break;
+
+            case STATE_GRAPH: {
+                bool ready = check_plot_status(graph_open(current_expression));
+
+                // The graph compiled the expression over the parsed one
+                current_root = NULL;
+                if (!ready) {
+                    break;
+                }
+
+                register_graph_kb();
+                while (running && current_state == STATE_GRAPH) {
+                    kb_wait_event();
+                    kb_process();
+                }
+                graph_close();
+                kb_clear();
+                break;
+            }
+
+            case STATE_SOLVE:
+                if (solve_current_equation()) {
+                    add_history(current_expression, &current_result);
+                    step_scroll_position = 0;
+                    current_state = STATE_RESULT;
+                }
+                break;
+
             case STATE_SETTINGS:
                 show_settings_menu();
                 regiter_settings_kb();
                 while (running && current_state == STATE_SETTINGS) {
+                    kb_wait_event();
                     kb_process();
-                    delay(50);
                 }
                 kb_clear();
                 break;
@@ -735,7 +1291,12 @@ static void regiter_settings_kb(void) {
     kb_register_press(KEY_CLEAR, leave);
     waiting = false;
 
-    print_footer("<ENT.>:Input <1-3>:Change");
+    if (has_result) {
+        kb_register_press(KEY_MODE, result_state);
+        print_footer("<ENT.>:Input <MODE>:Back");
+    } else {
+        print_footer("<ENT.>:Input <1-3>:Change");
+    }
 }
 
 /**
@@ -787,15 +1348,35 @@ static void register_result_kb(void) {
     kb_register_press(KEY_CLEAR, leave);
     kb_register_press(KEY_UP, scroll_up);
     kb_register_press(KEY_DOWN, scroll_down);
+    kb_register_hold(KEY_UP, repeat_scroll_up, SCROLL_REPEAT_DELAY_MS, true, SCROLL_REPEAT_MS);
+    kb_register_hold(KEY_DOWN, repeat_scroll_down, SCROLL_REPEAT_DELAY_MS, true, SCROLL_REPEAT_MS);
+    kb_register_press(KEY_WINDOW, table_state);
+    kb_register_press(KEY_GRAPH, graph_state);
+    kb_register_press(KEY_MATH, solve_state);
     print_footer("<ENT.>:Input <CLEAR>:exit");
 }
 
+/**
+ * Registers key events for the function table.
+ */
+static void register_table_kb(void) {
+    kb_clear();
+    kb_register_press(KEY_ENTER, back_to_result);
+    kb_register_press(KEY_CLEAR, back_to_result);
+    kb_register_press(KEY_UP, table_row_up);
+    kb_register_press(KEY_DOWN, table_row_down);
+    kb_register_press(KEY_LEFT, table_page_up);
+    kb_register_press(KEY_RIGHT, table_page_down);
+}
+
 /**
  * Scrolls up through calculation steps.
  */
 static void scroll_up(void) {
     step_scroll_position--;
-    show_calculation_result(&current_result);
+    PROFILE_START(PROFILE_DRAW);
+    show_calculation_step(&current_result);
+    PROFILE_STOP(PROFILE_DRAW);
 }
 
 /**
@@ -803,7 +1384,124 @@ static void scroll_up(void) {
  */
 static void scroll_down(void) {
     step_scroll_position++;
-    show_calculation_result(&current_result);
+    PROFILE_START(PROFILE_DRAW);
+    show_calculation_step(&current_result);
+    PROFILE_STOP(PROFILE_DRAW);
+}
+
+/**
+ * Scrolls up through calculation steps while UP is held.
+ *
+ * @param hold_time Time the key has been held (in ms).
+ */
+static void repeat_scroll_up(int hold_time) {
+    (void)hold_time;
+    scroll_up();
+}
+
+/**
+ * Scrolls down through calculation steps while DOWN is held.
+ *
+ * @param hold_time Time the key has been held (in ms).
+ */
+static void repeat_scroll_down(int hold_time) {
+    (void)hold_time;
+    scroll_down();
+}
+
+/**
+ * Registers key events for the graph.
+ */
+static void register_graph_kb(void) {
+    kb_clear();
+    kb_register_press(KEY_ENTER, back_to_result);
+    kb_register_press(KEY_CLEAR, back_to_result);
+    kb_register_press(KEY_LEFT, graph_pan_left);
+    kb_register_press(KEY_RIGHT, graph_pan_right);
+    kb_register_press(KEY_UP, graph_pan_up);
+    kb_register_press(KEY_DOWN, graph_pan_down);
+    kb_register_press(KEY_ADD, graph_zoom_in);
+    kb_register_press(KEY_SUB, graph_zoom_out);
+}
+
+/**
+ * Moves the graph to the left.
+ */
+static void graph_pan_left(void) {
+    graph_pan(-GRAPH_PAN_PIXELS, 0);
+}
+
+/**
+ * Moves the graph to the right.
+ */
+static void graph_pan_right(void) {
+    graph_pan(GRAPH_PAN_PIXELS, 0);
+}
+
+/**
+ * Moves the graph up.
+ */
+static void graph_pan_up(void) {
+    graph_pan(0, GRAPH_PAN_PIXELS);
+}
+
+/**
+ * Moves the graph down.
+ */
+static void graph_pan_down(void) {
+    graph_pan(0, -GRAPH_PAN_PIXELS);
+}
+
+/**
+ * Zooms the graph in.
+ */
+static void graph_zoom_in(void) {
+    graph_zoom(true);
+}
+
+/**
+ * Zooms the graph out.
+ */
+static void graph_zoom_out(void) {
+    graph_zoom(false);
+}
+
+/**
+ * Moves the function table up by a row.
+ */
+static void table_row_up(void) {
+    if (table_top > 0) {
+        table_top--;
+        show_table();
+    }
+}
+
+/**
+ * Moves the function table down by a row.
+ */
+static void table_row_down(void) {
+    if (table_top + 1 < table_row_count()) {
+        table_top++;
+        show_table();
+    }
+}
+
+/**
+ * Moves the function table up by a screen.
+ */
+static void table_page_up(void) {
+    table_top = table_top > TABLE_VISIBLE_ROWS ? table_top - TABLE_VISIBLE_ROWS : 0;
+    show_table();
+}
+
+/**
+ * Moves the function table down by a screen.
+ */
+static void table_page_down(void) {
+    if (table_top + TABLE_VISIBLE_ROWS < table_row_count()) {
+        table_top += TABLE_VISIBLE_ROWS;
+        show_table();
+    }
 }
 
 /**
@@ -829,6 +1527,58 @@ static void update_precision(void) {
  * Miscellaneous utility functions for the calculator UI.
  */
 
+/**
+ * Computes the result of the current expression with the current settings.
+ * A result already in the cache is used as is; otherwise the expression is
+ * parsed, unless its tree is still around, then evaluated and cached.
+ * 
+ * @return True if the expression has a result, false if it is invalid.
+ */
+static bool compute_result(void) {
+    if (lookup_result(current_expression, &current_result)) {
+        return true;
+    }
+
+    if (current_root == NULL) {
+        current_root = parse_expression_string(current_expression);
+        if (current_root == NULL) {
+            return false;
+        }
+    }
+
+    // Long sums and products show how far they got and stop on ON
+    kb_ClearOnLatch();
+    set_loop_progress_handler(show_loop_progress);
+    evaluate_parsed_expression(current_root, &current_result);
+    set_loop_progress_handler(NULL);
+
+    if (current_result.interrupted) {
+        return false;
+    }
+    store_result(current_expression, &current_result);
+    return true;
+}
+
+/**
+ * Shows how far a sum or product has got on the last row, and tells it
+ * to stop when ON was pressed.
+ * 
+ * @param done Iterations done.
+ * @param total Iterations in all.
+ * @return True to go on, false to stop.
+ */
+static bool show_loop_progress(int done, int total) {
+    if (kb_On) {
+        kb_ClearOnLatch();
+        return false;
+    }
+
+    char status[SCREEN_COLS];
+    sprintf(status, "Working %d%% <ON>:Stop", (int)((long)done * 100 / total));
+    print_footer(status);
+    return true;
+}
+
 /**
  * Returns a string representation of the current arithmetic mode with precision.
  * 
@@ -1,87 +1,257 @@
 #include <ti/real.h>
+#include <string.h>
 #include "headers/log.h"
 #include "headers/mathsolver.h"
+#include "headers/variables_private.h"
 
 int variable_count = 0;
 int node_pool_index = 0;
 Variable variables[MAX_VARIABLES];
 
+/** First character of the name of a released slot, which no name starts with */
+#define RELEASED_SLOT '\x01'
+
 /**
  * Sets a variable value.
- * 
+ *
  * @param name The name of the variable.
  * @param value The value to assign to the variable.
  */
 void set_variable(const char* name, real_t value) {
-    // Check if variable already exists
-    for (int i = 0; i < variable_count; i++) {
-        if (strcmp(variables[i].name, name) == 0) {
-            variables[i].value = value;
-            variables[i].is_defined = true;
-            log_variable(name, value);
-            return;
-        }
-    }
-    
-    // Add new variable if we have room
-    if (variable_count < MAX_VARIABLES) {
-        strncpy(variables[variable_count].name, name, MAX_TOKEN_LENGTH - 1);
-        variables[variable_count].name[MAX_TOKEN_LENGTH - 1] = '\0';
-        variables[variable_count].value = value;
-        variables[variable_count].is_defined = true;
-        variable_count++;
-        log_variable(name, value);
+    int symbol = intern_symbol(name);
+    if (symbol < 0) {
+        LOG_ERROR("Symbol table full");
+        return;
     }
+
+    variables[symbol].value = value;
+    variables[symbol].is_defined = true;
+    LOG_VARIABLE(name, value);
 }
 
 /**
  * Gets a variable value.
- * 
+ *
  * @param name The name of the variable.
  * @param found Pointer to a boolean that will be set to true if the variable is found, false otherwise.
  * @return The value of the variable, or 0 if not found.
  */
 real_t get_variable(const char* name, bool* found) {
-    // Check for built-in constants
-    if (is_constant(name)) {
-        *found = true;
-        if (strcmp(name, "pi") == 0 || strcmp(name, "PI") == 0)
-            return PI;
-        else if (strcmp(name, "e") == 0 || strcmp(name, "E") == 0)
-            return E;
-        else if (strcmp(name, "phi") == 0 || strcmp(name, "PHI") == 0)
-            return PHI;
-    }
-    
-    // Special case: Check for the π character (ASCII 196)
-    if (name[0] == (char)0xC4 && name[1] == '\0') {
-        *found = true;
-        return PI;
+    int constant = lookup_constant(name);
+    if (constant >= 0) {
+        return get_symbol_value(SYMBOL_CONSTANT | constant, found);
     }
 
-    // Check user-defined variables
-    for (int i = 0; i < variable_count; i++) {
-        if (strcmp(variables[i].name, name) == 0 && variables[i].is_defined) {
-            *found = true;
-            real_t value = variables[i].value;
-            log_variable(name, value);
-            return value;
-        }
+    int symbol = find_symbol(name);
+    if (symbol < 0) {
+        *found = false;
+        LOG_ERROR("Variable not found");
+        return ZERO;
     }
-    
-    *found = false;
-    log_error("Variable not found");
-    return ZERO;
+    return get_symbol_value(symbol, found);
 }
 
 /**
  * Checks if a name is a mathematical constant.
- * 
+ *
  * @param name The name to check.
  * @return True if the name is a constant, false otherwise.
  */
 bool is_constant(const char* name) {
-    return (strcmp(name, "pi") == 0 || strcmp(name, "PI") == 0 || 
-            strcmp(name, "e") == 0 || strcmp(name, "E") == 0 ||
-            strcmp(name, "phi") == 0 || strcmp(name, "PHI") == 0);
+    return lookup_constant(name) >= 0;
+}
+
+/* ============================== Symbols ============================== */
+
+/**
+ * Resolves a name to a symbol, once, when an expression is parsed.
+ * Constants resolve to SYMBOL_CONSTANT plus their ConstantId; any other
+ * name gets a slot in the symbol table, even if it has no value yet, and
+ * keeps it until release_undefined_symbols if it never gets one.
+ *
+ * @param name The name to resolve.
+ * @return The symbol, or -1 if the symbol table is full.
+ */
+int resolve_symbol(const char* name) {
+    int constant = lookup_constant(name);
+    if (constant >= 0) {
+        return SYMBOL_CONSTANT | constant;
+    }
+    return intern_symbol(name);
+}
+
+/**
+ * Gets the value of a symbol.
+ *
+ * @param symbol The symbol, as returned by resolve_symbol.
+ * @param found Pointer to a boolean set to true if the symbol has a value.
+ * @return The value of the symbol, or 0 if it has none.
+ */
+real_t get_symbol_value(uint8_t symbol, bool* found) {
+    if (symbol & SYMBOL_CONSTANT) {
+        *found = true;
+        switch (symbol & ~SYMBOL_CONSTANT) {
+            case CONST_PI:  return PI;
+            case CONST_E:   return E;
+            default:        return PHI;
+        }
+    }
+
+    Variable* variable = &variables[symbol];
+    *found = variable->is_defined;
+    if (!variable->is_defined) {
+        LOG_ERROR("Variable not found");
+        return ZERO;
+    }
+
+    LOG_VARIABLE(variable->name, variable->value);
+    return variable->value;
+}
+
+/**
+ * Sets the value of a variable symbol.
+ * Faster than set_variable for a variable written over and over, since
+ * the name is only looked up once, by resolve_symbol.
+ *
+ * @param symbol The symbol, as returned by resolve_symbol; not a constant.
+ * @param value The value to assign.
+ */
+void set_symbol_value(uint8_t symbol, real_t value) {
+    variables[symbol].value = value;
+    variables[symbol].is_defined = true;
+}
+
+/**
+ * Releases the slots of the names that have no value. Such a name only
+ * means something to the tree or program it was parsed into, so this is
+ * done when a parse starts over the node pool: names that were mistyped,
+ * half typed or used once do not keep a slot for good. The slots are
+ * released in place, so a variable that has a value never moves and a
+ * symbol held for it, by a table or a graph, stays valid.
+ */
+void release_undefined_symbols(void) {
+    for (int slot = 0; slot < MAX_VARIABLES; slot++) {
+        Variable* variable = &variables[slot];
+        if (variable->name[0] != '\0' && variable->name[0] != RELEASED_SLOT && !variable->is_defined) {
+            // The probe sequences of other names may run through the slot
+            variable->name[0] = RELEASED_SLOT;
+            variable_count--;
+        }
+    }
+    LOG_DEBUG("Symbol table holds %d variables", variable_count);
+}
+
+/**
+ * Gets the name of a symbol.
+ *
+ * @param symbol The symbol, as returned by resolve_symbol.
+ * @return The name of the symbol.
+ */
+const char* get_symbol_name(uint8_t symbol) {
+    if (symbol & SYMBOL_CONSTANT) {
+        switch (symbol & ~SYMBOL_CONSTANT) {
+            case CONST_PI:  return "pi";
+            case CONST_E:   return "e";
+            default:        return "phi";
+        }
+    }
+    return variables[symbol].name;
+}
+
+/**
+ * Looks up the constant a name refers to.
+ *
+ * @param name The name to look up.
+ * @return The ConstantId of the name, or -1 if it is not a constant.
+ */
+static int lookup_constant(const char* name) {
+    // The π character (ASCII 196)
+    if (name[0] == (char)0xC4 && name[1] == '\0') {
+        return CONST_PI;
+    }
+
+    if (strcmp(name, "pi") == 0 || strcmp(name, "PI") == 0) {
+        return CONST_PI;
+    } else if (strcmp(name, "e") == 0 || strcmp(name, "E") == 0) {
+        return CONST_E;
+    } else if (strcmp(name, "phi") == 0 || strcmp(name, "PHI") == 0) {
+        return CONST_PHI;
+    }
+    return -1;
+}
+
+/**
+ * Hashes a name into the symbol table (FNV-1a).
+ *
+ * @param name The name to hash.
+ * @return The home slot of the name.
+ */
+static uint8_t hash_symbol(const char* name) {
+    uint8_t hash = 0x81;
+    while (*name) {
+        hash = (uint8_t)((hash ^ (uint8_t)*name++) * 0x93);
+    }
+    return hash & (MAX_VARIABLES - 1);
+}
+
+/**
+ * Finds the slot of a name in the symbol table. Released slots are
+ * probed past; only an empty one ends the search.
+ *
+ * @param name The name to find.
+ * @return The slot of the name, or -1 if it is not in the table.
+ */
+static int find_symbol(const char* name) {
+    uint8_t slot = hash_symbol(name);
+    for (int probe = 0; probe < MAX_VARIABLES; probe++) {
+        if (variables[slot].name[0] == '\0') {
+            return -1;
+        }
+        if (strcmp(variables[slot].name, name) == 0) {
+            return slot;
+        }
+        slot = (slot + 1) & (MAX_VARIABLES - 1);
+    }
+    return -1;
+}
+
+/**
+ * Finds the slot of a name in the symbol table, adding the name if needed.
+ * A new name takes the first released slot on its probe sequence, or
+ * else the empty slot that ends it.
+ *
+ * @param name The name to intern.
+ * @return The slot of the name, or -1 if the table is full.
+ */
+static int intern_symbol(const char* name) {
+    uint8_t slot = hash_symbol(name);
+    int free_slot = -1;
+    for (int probe = 0; probe < MAX_VARIABLES; probe++) {
+        Variable* variable = &variables[slot];
+        if (variable->name[0] == '\0') {
+            if (free_slot < 0) {
+                free_slot = slot;
+            }
+            break;
+        }
+        if (variable->name[0] == RELEASED_SLOT) {
+            if (free_slot < 0) {
+                free_slot = slot;
+            }
+        } else if (strcmp(variable->name, name) == 0) {
+            return slot;
+        }
+        slot = (slot + 1) & (MAX_VARIABLES - 1);
+    }
+    if (free_slot < 0) {
+        return -1;
+    }
+
+    Variable* variable = &variables[free_slot];
+    strncpy(variable->name, name, MAX_TOKEN_LENGTH - 1);
+    variable->name[MAX_TOKEN_LENGTH - 1] = '\0';
+    variable->value = ZERO;
+    variable->is_defined = false;
+    variable_count++;
+    return free_slot;
 }
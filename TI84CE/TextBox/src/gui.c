@@ -14,6 +14,31 @@ static GUISettings _settings_ = {
     .highlight_color = 0x10        /**< Default highlight color */
 };
 
+/** Number of frames begun and not yet ended. */
+static int frame_depth = 0;
+
+/** Whether a refresh was asked for during the current frame. */
+static bool frame_pending = false;
+
+/** Number of glyphs kept rendered; ASCII 32 to 127 all get their own slot. */
+#define GLYPH_CACHE_SIZE 96
+
+/** Size of a glyph sprite: width and height bytes, then one byte per pixel. */
+#define GLYPH_SPRITE_SIZE (2 + GUI_CHAR_WIDTH * GUI_CHAR_HEIGHT)
+
+/** Font the glyphs are rendered from, the one graphx draws text with. */
+static const uint8_t* glyph_font = NULL;
+
+/** Rendered glyphs, one character per slot. */
+static uint8_t glyph_sprites[GLYPH_CACHE_SIZE][GLYPH_SPRITE_SIZE];
+
+/** Character held by each slot of the cache, or -1 if the slot is empty. */
+static int glyph_chars[GLYPH_CACHE_SIZE];
+
+/** Text colors the cached glyphs were rendered in. */
+static int glyph_fg_color = -1;
+static int glyph_bg_color = -1;
+
 /**
  * @brief Returns a pointer to the current GUI settings.
  * @return Pointer to the GUISettings structure.
@@ -33,10 +58,41 @@ void GUI_init(void) {
     gfx_SetTextBGColor(BG_COLOR);
     gfx_SetMonospaceFont(GUI_CHAR_WIDTH); 
     gfx_SetFontHeight(GUI_CHAR_HEIGHT); 
+    glyph_font = gfx_SetFontData(NULL);  /**< Keep the default font to render glyphs from */
 }
 
+/**
+ * @brief Shows what was drawn in the draw buffer on the screen.
+ *
+ * Inside a frame the buffer is only shown when the outermost frame ends,
+ * so widgets that update on the same keystroke are shown with one blit.
+ */
 void GUI_refresh(void) {
-    gfx_BlitBuffer();  /**< Swap the draw buffer to display the changes */
+    if (frame_depth > 0) {
+        frame_pending = true;  /**< Shown by GUI_end_frame */
+        return;
+    }
+    gfx_BlitBuffer();  /**< Copy the draw buffer to the screen to display the changes */
+}
+
+/**
+ * @brief Starts a frame; refreshes until the matching GUI_end_frame are batched.
+ *
+ * Frames may be nested, only the outermost one shows the buffer.
+ */
+void GUI_begin_frame(void) {
+    frame_depth++;
+}
+
+/**
+ * @brief Ends a frame, and shows the draw buffer if a refresh was asked for during it.
+ */
+void GUI_end_frame(void) {
+    if (frame_depth == 0) return;
+    if (--frame_depth == 0 && frame_pending) {
+        frame_pending = false;
+        gfx_BlitBuffer();
+    }
 }
 
 /**
@@ -124,7 +180,7 @@ void GUI_reset_text_colors(void) {
 void GUI_write_text(int x, int y, const char* text) {
         gfx_SetTextFGColor(_settings_.text_color);  /**< Set the text foreground color */
     gfx_SetTextBGColor(_settings_.bg_color);    /**< Set the text background color */
-    gfx_PrintStringXY(text, x, y);              /**< Print the string at the specified position */
+    GUI_draw_glyphs(x, y, text, strlen(text));  /**< Draw the string at the specified position */
 }
 
 /**
@@ -180,7 +236,7 @@ void GUI_print_text_column(int x, int y, const char* text) {
 void GUI_print_text(int x, int y, const char* text) {
         
     // Log text length for debugging
-    log_message("Text length: %d", strlen(text));
+    LOG_TRACE("Text length: %d", strlen(text));
     
     // Call internal function with full-width parameters
     _GUI_print_text_internal(x, y, text, -1, false);
@@ -253,11 +309,74 @@ static void _GUI_print_text_internal(int x, int y, const char* text, int max_wid
 static void GUI_put_text(int x, int y, const char* text) {
     GUISettings* settings = GUI_get_settings();
 
-    int width = gfx_GetStringWidth(text);               /**< Get the width of the string */
-    
+    int length = strlen(text);
+    GUI_draw_glyphs(x, y, text, length);                /**< The glyph cells draw their own background */
+
     gfx_SetColor(settings->bg_color);
-    gfx_FillRectangle(x, y, width, GUI_LINE_HEIGHT);    /**< Clear the area where the text will be printed */
+    gfx_HorizLine(x, y + GUI_CHAR_HEIGHT, length * GUI_CHAR_WIDTH);  /**< Clear the line spacing below */
+}
+/**
+ * @brief Gets the glyph of a character in the current text colors.
+ *
+ * A glyph is rendered from the font into an opaque sprite the first time
+ * it is drawn, and kept until another character takes its slot or the
+ * text colors change.
+ * @param c The character.
+ * @return The sprite of the glyph.
+ */
+static gfx_sprite_t* GUI_get_glyph(unsigned char c) {
+    // Glyphs in other colors are no use any more
+    if (glyph_fg_color != _settings_.text_color || glyph_bg_color != _settings_.bg_color) {
+        memset(glyph_chars, -1, sizeof(glyph_chars));
+        glyph_fg_color = _settings_.text_color;
+        glyph_bg_color = _settings_.bg_color;
+    }
+
+    int slot = c % GLYPH_CACHE_SIZE;
+    gfx_sprite_t* sprite = (gfx_sprite_t*)glyph_sprites[slot];
+    if (glyph_chars[slot] == c) {
+        return sprite;
+    }
 
-    gfx_SetColor(_settings_.text_color);                /**< Set the text color */
-    gfx_PrintStringXY(text, x, y);                      /**< Print the string at the specified position */
+    // Each glyph of the font is one byte per row, leftmost pixel first
+    const uint8_t* rows = glyph_font + c * GUI_CHAR_HEIGHT;
+    uint8_t* pixel = sprite->data;
+    sprite->width = GUI_CHAR_WIDTH;
+    sprite->height = GUI_CHAR_HEIGHT;
+    for (int row = 0; row < GUI_CHAR_HEIGHT; row++) {
+        uint8_t bits = rows[row];
+        for (int col = 0; col < GUI_CHAR_WIDTH; col++) {
+            *pixel++ = (bits & 0x80) ? glyph_fg_color : glyph_bg_color;
+            bits <<= 1;
+        }
+    }
+    glyph_chars[slot] = c;
+    return sprite;
 }
+
+/**
+ * @brief Draws a run of characters in fixed-width cells from the glyph cache.
+ *
+ * Unlike the graphx text routines, the cells are opaque: the background is
+ * drawn with the glyph, so the area needs no clearing first.
+ * @param x The x-coordinate of the first cell.
+ * @param y The y-coordinate of the cells.
+ * @param text The characters to draw.
+ * @param length The number of characters to draw.
+ */
+static void GUI_draw_glyphs(int x, int y, const char* text, int length) {
+    // The run is drawn without clipping when it lies on the screen
+    bool on_screen = x >= 0 && y >= 0 &&
+                     x + length * GUI_CHAR_WIDTH <= LCD_WIDTH &&
+                     y + GUI_CHAR_HEIGHT <= LCD_HEIGHT;
+
+    for (int i = 0; i < length; i++, x += GUI_CHAR_WIDTH) {
+        gfx_sprite_t* glyph = GUI_get_glyph((unsigned char)text[i]);
+        if (on_screen) {
+            gfx_Sprite_NoClip(glyph, x, y);
+        } else {
+            gfx_Sprite(glyph, x, y);
+        }
+    }
+}
+
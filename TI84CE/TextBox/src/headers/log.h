@@ -14,5 +14,6 @@
 
 #include <ti/real.h>
 #include "log_public.h"
+#include "../../../common/log_macros.h"
 
 #endif // LOG_H
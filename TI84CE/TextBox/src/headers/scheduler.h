@@ -0,0 +1,35 @@
+/**
+ * Cooperative Task Scheduler for TI-84 CE
+ *
+ * Runs background jobs in the idle time between keystrokes. A task does a
+ * small slice of its work each time it runs and tells whether it has more
+ * to do. The keyboard is polled between slices, so a slice should stay
+ * short next to the key repeat interval.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdbool.h>
+
+/**
+ * Callback type for a task slice.
+ *
+ * @param obj Pointer to the object the task works on.
+ * @return True if the task has more work to do, false once it is done.
+ */
+typedef bool (*TaskCallback)(void* obj);
+
+/**
+ * Internal structure for task registration.
+ */
+typedef struct {
+    bool active;                 /**< Whether this entry is active */
+    int id;                      /**< Unique ID for this task */
+    TaskCallback run;            /**< Function that runs a slice of the task */
+    void* obj;                   /**< Pointer to the object the task works on */
+} TaskEntry;
+
+#include "scheduler_public.h"
+
+#endif // SCHEDULER_H
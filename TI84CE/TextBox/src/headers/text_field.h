@@ -58,15 +58,24 @@ struct TextField {
 
     // Text properties
 
-    /** Pointer to the text content of the field. */
+    /**
+     * Buffer of the text, with a gap where it was last edited.
+     * Use text_field_get_text to read it as a string.
+     */
     char* text;
 
     /** Current length of the text in the field. */
     int text_length;
 
-    /** Total buffer size allocated for the text. */
+    /** Size of the buffer, text and gap. */
     int buffer_size;
 
+    /** Start of the gap; the text before it is text[0] to text[gap_start - 1]. */
+    int gap_start;
+
+    /** End of the gap; the text after it is text[gap_end] to text[buffer_size - 1]. */
+    int gap_end;
+
     /** Cursor position in the text (character index). */
     int cursor_position;
 
@@ -90,6 +99,26 @@ struct TextField {
     /** Whether the text field is read-only. */
     bool read_only;
 
+    // Drawing state
+
+    /** Whether the whole field must be drawn again on the next draw. */
+    bool needs_redraw;
+
+    /** First character index whose cell must be drawn again, or -1 if none. */
+    int dirty_start;
+
+    /** Scroll offset the field was last drawn with. */
+    int drawn_scroll_offset;
+
+    /** Cursor position the field was last drawn with. */
+    int drawn_cursor_position;
+
+    /** Whether the cursor was shown when the field was last drawn. */
+    bool drawn_cursor_visible;
+
+    /** Whether the right scroll indicator was shown when the field was last drawn. */
+    bool drawn_right_indicator;
+
     // Callbacks
 
     /**
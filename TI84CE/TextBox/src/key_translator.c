@@ -32,6 +32,214 @@ static Key last_physical_key = KEY_NONE;
 /** IDs of registered key callbacks. */
 static int key_callback_ids[3] = {-1, -1, -1};
 
+/** Translation tables of KEY_VALUES. */
+enum {
+    KEY_TABLE_NORMAL,   /**< No 2nd, no alpha. */
+    KEY_TABLE_2ND,      /**< 2nd, whether or not alpha is on. */
+    KEY_TABLE_ALPHA,    /**< Alpha; lowercase letters are made from it. */
+    KEY_TABLE_COUNT
+};
+
+/** Position of a key mask in its group, for the table initializers. */
+#define KEY_BIT(mask) ((mask) == 0x01 ? 0 : (mask) == 0x02 ? 1 : (mask) == 0x04 ? 2 : \
+                       (mask) == 0x08 ? 3 : (mask) == 0x10 ? 4 : (mask) == 0x20 ? 5 : \
+                       (mask) == 0x40 ? 6 : 7)
+
+_Static_assert(FUNC_E <= UINT8_MAX && FUNC_STRING <= UINT8_MAX,
+               "Character values must fit in the translation tables");
+
+/**
+ * Character values of the keys, indexed by table, keypad group and
+ * position of the key in its group. Keys left out translate to CHAR_NULL.
+ */
+static const uint8_t KEY_VALUES[KEY_TABLE_COUNT][8][8] = {
+    [KEY_TABLE_NORMAL] = {
+        // Group 1: Graph, Trace, Zoom, Window, Y=, 2nd, Mode, Del
+        [1] = {
+            [KEY_BIT(kb_Graph)]    = FUNC_GRAPH,
+            [KEY_BIT(kb_Trace)]    = FUNC_TRACE,
+            [KEY_BIT(kb_Zoom)]     = FUNC_ZOOM,
+            [KEY_BIT(kb_Window)]   = FUNC_WINDOW,
+            [KEY_BIT(kb_Yequ)]     = FUNC_Y_EQUALS,
+            [KEY_BIT(kb_2nd)]      = CHAR_2ND,      // Should be handled by char_process_mode_key
+            [KEY_BIT(kb_Mode)]     = CHAR_MODE,
+            [KEY_BIT(kb_Del)]      = CHAR_DEL,
+        },
+        // Group 2: Sto, Ln, Log, x², 1/x, Math, Alpha
+        [2] = {
+            [KEY_BIT(kb_Sto)]      = FUNC_STO,
+            [KEY_BIT(kb_Ln)]       = FUNC_LN,
+            [KEY_BIT(kb_Log)]      = FUNC_LOG,
+            [KEY_BIT(kb_Square)]   = FUNC_SQUARE,
+            [KEY_BIT(kb_Recip)]    = FUNC_RECIP,
+            [KEY_BIT(kb_Math)]     = FUNC_MATH,
+            [KEY_BIT(kb_Alpha)]    = CHAR_ALPHA,    // Should be handled by char_process_mode_key
+        },
+        // Group 3: 0, 1, 4, 7, ,, sin, apps, x
+        [3] = {
+            [KEY_BIT(kb_0)]        = '0',
+            [KEY_BIT(kb_1)]        = '1',
+            [KEY_BIT(kb_4)]        = '4',
+            [KEY_BIT(kb_7)]        = '7',
+            [KEY_BIT(kb_Comma)]    = ',',
+            [KEY_BIT(kb_Sin)]      = FUNC_SIN,
+            [KEY_BIT(kb_Apps)]     = FUNC_APPS,
+            [KEY_BIT(kb_GraphVar)] = FUNC_X_VAR,
+        },
+        // Group 4: ., 2, 5, 8, (, cos, prgm, stat
+        [4] = {
+            [KEY_BIT(kb_DecPnt)]   = '.',
+            [KEY_BIT(kb_2)]        = '2',
+            [KEY_BIT(kb_5)]        = '5',
+            [KEY_BIT(kb_8)]        = '8',
+            [KEY_BIT(kb_LParen)]   = '(',
+            [KEY_BIT(kb_Cos)]      = FUNC_COS,
+            [KEY_BIT(kb_Prgm)]     = FUNC_PRGM,
+            [KEY_BIT(kb_Stat)]     = FUNC_STAT,
+        },
+        // Group 5: (-), 3, 6, 9, ), tan, vars
+        [5] = {
+            [KEY_BIT(kb_Chs)]      = '-',
+            [KEY_BIT(kb_3)]        = '3',
+            [KEY_BIT(kb_6)]        = '6',
+            [KEY_BIT(kb_9)]        = '9',
+            [KEY_BIT(kb_RParen)]   = ')',
+            [KEY_BIT(kb_Tan)]      = FUNC_TAN,
+            [KEY_BIT(kb_Vars)]     = FUNC_VARS,
+        },
+        // Group 6: Enter, +, -, *, /, ^, clear
+        [6] = {
+            [KEY_BIT(kb_Enter)]    = CHAR_ENTER,
+            [KEY_BIT(kb_Add)]      = '+',
+            [KEY_BIT(kb_Sub)]      = '-',
+            [KEY_BIT(kb_Mul)]      = '*',
+            [KEY_BIT(kb_Div)]      = '/',
+            [KEY_BIT(kb_Power)]    = '^',
+            [KEY_BIT(kb_Clear)]    = CHAR_CLEAR,
+        },
+        // Group 7: down, left, right, up
+        [7] = {
+            [KEY_BIT(kb_Down)]     = CHAR_DOWN,
+            [KEY_BIT(kb_Left)]     = CHAR_LEFT,
+            [KEY_BIT(kb_Right)]    = CHAR_RIGHT,
+            [KEY_BIT(kb_Up)]       = CHAR_UP,
+        },
+    },
+    [KEY_TABLE_2ND] = {
+        // Group 2: Sto, Ln, Log, x², 1/x, Math, Alpha
+        [2] = {
+            [KEY_BIT(kb_Recip)]    = FUNC_X_INV,    // ^-1
+            [KEY_BIT(kb_Square)]   = FUNC_ROOT,     // sqrt(
+            [KEY_BIT(kb_Log)]      = FUNC_10_X,     // 10^
+            [KEY_BIT(kb_Ln)]       = FUNC_EXP,      // e^x
+            [KEY_BIT(kb_Sto)]      = FUNC_RECALL,
+            [KEY_BIT(kb_Math)]     = FUNC_TEST,
+        },
+        // Group 3: 0, 1, 4, 7, ,, sin, apps, x
+        [3] = {
+            [KEY_BIT(kb_Sin)]      = FUNC_SIN_INV,  // asin(
+            [KEY_BIT(kb_7)]        = 'u',
+            [KEY_BIT(kb_Apps)]     = FUNC_MATRIX,
+            [KEY_BIT(kb_GraphVar)] = FUNC_DRAW,
+            [KEY_BIT(kb_4)]        = FUNC_ANGLE,
+        },
+        // Group 4: ., 2, 5, 8, (, cos, prgm, stat
+        [4] = {
+            [KEY_BIT(kb_Cos)]      = FUNC_COS_INV,  // acos(
+            [KEY_BIT(kb_8)]        = 'v',
+            [KEY_BIT(kb_LParen)]   = '{',
+            [KEY_BIT(kb_Prgm)]     = FUNC_LIST,
+            [KEY_BIT(kb_Stat)]     = FUNC_PROBABILITY,
+            [KEY_BIT(kb_5)]        = FUNC_MEM,
+        },
+        // Group 5: (-), 3, 6, 9, ), tan, vars
+        [5] = {
+            [KEY_BIT(kb_Tan)]      = FUNC_TAN_INV,  // atan(
+            [KEY_BIT(kb_9)]        = 'w',
+            [KEY_BIT(kb_RParen)]   = '}',
+            [KEY_BIT(kb_Chs)]      = FUNC_ENTRY,
+            [KEY_BIT(kb_Vars)]     = FUNC_STRING,
+            [KEY_BIT(kb_3)]        = FUNC_SOLVE,
+            [KEY_BIT(kb_6)]        = FUNC_PARAMETRIC,
+        },
+        // Group 6: Enter, +, -, *, /, ^, clear
+        [6] = {
+            [KEY_BIT(kb_Power)]    = FUNC_PI,       // π
+            [KEY_BIT(kb_Div)]      = FUNC_E,        // Constant e
+            [KEY_BIT(kb_Mul)]      = 0xc1,          // ´[´ on the TI-84+ CE
+            [KEY_BIT(kb_Sub)]      = ']',
+            [KEY_BIT(kb_Enter)]    = CHAR_ENTER,
+            [KEY_BIT(kb_Add)]      = FUNC_MEM_ADD,
+            [KEY_BIT(kb_Clear)]    = FUNC_RESET,
+        },
+        // Group 7: down, left, right, up
+        [7] = {
+            [KEY_BIT(kb_Up)]       = CHAR_PGUP,
+            [KEY_BIT(kb_Down)]     = CHAR_PGDN,
+            [KEY_BIT(kb_Left)]     = CHAR_HOME,
+            [KEY_BIT(kb_Right)]    = CHAR_END,
+        },
+    },
+    [KEY_TABLE_ALPHA] = {
+        // Group 2: Sto, Ln, Log, x², 1/x, Math, Alpha
+        [2] = {
+            [KEY_BIT(kb_Math)]     = 'A',
+            [KEY_BIT(kb_Recip)]    = 'D',
+            [KEY_BIT(kb_Square)]   = 'I',
+            [KEY_BIT(kb_Log)]      = 'N',
+            [KEY_BIT(kb_Ln)]       = 'S',
+            [KEY_BIT(kb_Sto)]      = 'X',
+        },
+        // Group 3: 0, 1, 4, 7, ,, sin, apps, x
+        [3] = {
+            [KEY_BIT(kb_Apps)]     = 'B',
+            [KEY_BIT(kb_Sin)]      = 'E',
+            [KEY_BIT(kb_7)]        = 'O',
+            [KEY_BIT(kb_4)]        = 'T',
+            [KEY_BIT(kb_1)]        = 'Y',
+            [KEY_BIT(kb_0)]        = ' ',           // Space
+            [KEY_BIT(kb_Comma)]    = 'J',
+        },
+        // Group 4: ., 2, 5, 8, (, cos, prgm, stat
+        [4] = {
+            [KEY_BIT(kb_Prgm)]     = 'C',
+            [KEY_BIT(kb_Cos)]      = 'F',
+            [KEY_BIT(kb_8)]        = 'P',
+            [KEY_BIT(kb_5)]        = 'U',
+            [KEY_BIT(kb_2)]        = 'Z',
+            [KEY_BIT(kb_DecPnt)]   = ':',
+            [KEY_BIT(kb_LParen)]   = 'K',
+        },
+        // Group 5: (-), 3, 6, 9, ), tan, vars
+        [5] = {
+            [KEY_BIT(kb_Tan)]      = 'G',
+            [KEY_BIT(kb_6)]        = 'V',
+            [KEY_BIT(kb_3)]        = 0x5b,          // Theta
+            [KEY_BIT(kb_Chs)]      = '?',
+            [KEY_BIT(kb_9)]        = 'Q',
+            [KEY_BIT(kb_RParen)]   = 'L',
+        },
+        // Group 6: Enter, +, -, *, /, ^, clear
+        [6] = {
+            [KEY_BIT(kb_Power)]    = 'H',
+            [KEY_BIT(kb_Div)]      = 'M',
+            [KEY_BIT(kb_Mul)]      = 'R',
+            [KEY_BIT(kb_Sub)]      = 'W',
+            [KEY_BIT(kb_Add)]      = '"',
+            // Keep other keys the same
+            [KEY_BIT(kb_Enter)]    = CHAR_ENTER,
+            [KEY_BIT(kb_Clear)]    = CHAR_CLEAR,
+        },
+        // Arrow keys (Group 7) - keep the same in all modes
+        [7] = {
+            [KEY_BIT(kb_Down)]     = CHAR_DOWN,
+            [KEY_BIT(kb_Left)]     = CHAR_LEFT,
+            [KEY_BIT(kb_Right)]    = CHAR_RIGHT,
+            [KEY_BIT(kb_Up)]       = CHAR_UP,
+        },
+    },
+};
+
 /**
  * Initialize the key translator subsystem.
  * Sets up the necessary state and registers callbacks with the keyboard layer.
@@ -40,11 +248,11 @@ static int key_callback_ids[3] = {-1, -1, -1};
  */
 void char_init(void* field) {
     if (char_initialized) {
-        log_message("char_init: Already initialized.");
+        LOG_DEBUG("char_init: Already initialized.");
         return;
     }
     
-    log_message("char_init: Initializing key translator subsystem.");
+    LOG_DEBUG("char_init: Initializing key translator subsystem.");
     
     // Ensure keyboard layer is initialized
     key_init();
@@ -67,7 +275,7 @@ void char_init(void* field) {
     key_callback_ids[2] = key_register_up(field, on_key_up);
     
     char_initialized = true;
-    log_message("char_init: Key translator subsystem initialized.");
+    LOG_DEBUG("char_init: Key translator subsystem initialized.");
 }
 
 /**
@@ -76,11 +284,11 @@ void char_init(void* field) {
  */
 void char_deinit(void) {
     if (!char_initialized) {
-        log_message("char_deinit: Subsystem not initialized.");
+        LOG_DEBUG("char_deinit: Subsystem not initialized.");
         return;
     }
     
-    log_message("char_deinit: Cleaning up key translator subsystem.");
+    LOG_DEBUG("char_deinit: Cleaning up key translator subsystem.");
     
     // Unregister keyboard callbacks
     for (int i = 0; i < 3; i++) {
@@ -91,34 +299,34 @@ void char_deinit(void) {
     }
     
     char_initialized = false;
-    log_message("char_deinit: Key translator subsystem cleaned up.");
+    LOG_DEBUG("char_deinit: Key translator subsystem cleaned up.");
 }
 
 int register_mode_change_callback(ModeChangeCallback callback) {
-    log_message("register_mode_change_callback: Registering mode change callback.");
+    LOG_DEBUG("register_mode_change_callback: Registering mode change callback.");
     
     // Store the callback
     if (mode_change_callback != NULL) {
-        log_message("register_mode_change_callback: Callback already registered.");
+        LOG_DEBUG("register_mode_change_callback: Callback already registered.");
         return -1; // Error: callback already registered
     }
     mode_change_callback = callback;
     
-    log_message("register_mode_change_callback: Callback registered successfully.");
+    LOG_DEBUG("register_mode_change_callback: Callback registered successfully.");
     return 0; // Success
 }
 
 int unregister_mode_change_callback(void) {
-    log_message("unregister_mode_change_callback: Unregistering mode change callback.");
+    LOG_DEBUG("unregister_mode_change_callback: Unregistering mode change callback.");
     
     // Clear the callback
     if (mode_change_callback == NULL) {
-        log_message("unregister_mode_change_callback: No callback registered.");
+        LOG_DEBUG("unregister_mode_change_callback: No callback registered.");
         return -1; // Error: no callback registered
     }
     mode_change_callback = NULL;
     
-    log_message("unregister_mode_change_callback: Callback unregistered successfully.");
+    LOG_DEBUG("unregister_mode_change_callback: Callback unregistered successfully.");
     return 0; // Success
 }
 
@@ -130,7 +338,7 @@ int unregister_mode_change_callback(void) {
  * @return The ID of the registered callback, or -1 if registration failed.
  */
 int char_register_down(void* obj, CharDownCallback callback) {
-    log_message("char_register_down: Registering down callback.");
+    LOG_DEBUG("char_register_down: Registering down callback.");
     if (!char_initialized) char_init(obj);
     
     // Find an empty slot
@@ -144,7 +352,7 @@ int char_register_down(void* obj, CharDownCallback callback) {
     
     // If no slot available, return error
     if (slot < 0) {
-        log_message("char_register_down: No available slot for callback.");
+        LOG_WARNING("char_register_down: No available slot for callback.");
         return -1;
     }
     
@@ -154,7 +362,7 @@ int char_register_down(void* obj, CharDownCallback callback) {
     char_callbacks[slot].callback.down = callback;
     char_callbacks[slot].type = CHAR_CB_DOWN;
     
-    log_message("char_register_down: Down callback registered successfully.");
+    LOG_DEBUG("char_register_down: Down callback registered successfully.");
     return char_callbacks[slot].id;
 }
 
@@ -168,7 +376,7 @@ int char_register_down(void* obj, CharDownCallback callback) {
  * @return The ID of the registered callback, or -1 if registration failed.
  */
 int char_register_press(void* obj, CharPressCallback callback, int repeat_delay_ms, int repeat_interval_ms) {
-    log_message("char_register_press: Registering press callback.");
+    LOG_DEBUG("char_register_press: Registering press callback.");
     if (!char_initialized) char_init(obj);
     
     // Find an empty slot
@@ -182,7 +390,7 @@ int char_register_press(void* obj, CharPressCallback callback, int repeat_delay_
     
     // If no slot available, return error
     if (slot < 0) {
-        log_message("char_register_press: No available slot for callback.");
+        LOG_WARNING("char_register_press: No available slot for callback.");
         return -1;
     }
     
@@ -194,7 +402,7 @@ int char_register_press(void* obj, CharPressCallback callback, int repeat_delay_
     char_callbacks[slot].repeat_delay = repeat_delay_ms;
     char_callbacks[slot].repeat_interval = repeat_interval_ms;
     
-    log_message("char_register_press: Press callback registered successfully.");
+    LOG_DEBUG("char_register_press: Press callback registered successfully.");
     return char_callbacks[slot].id;
 }
 
@@ -206,7 +414,7 @@ int char_register_press(void* obj, CharPressCallback callback, int repeat_delay_
  * @return The ID of the registered callback, or -1 if registration failed.
  */
 int char_register_up(void* obj, CharUpCallback callback) {
-    log_message("char_register_up: Registering up callback.");
+    LOG_DEBUG("char_register_up: Registering up callback.");
     if (!char_initialized) char_init(obj);
     
     // Find an empty slot
@@ -220,7 +428,7 @@ int char_register_up(void* obj, CharUpCallback callback) {
     
     // If no slot available, return error
     if (slot < 0) {
-        log_message("char_register_up: No available slot for callback.");
+        LOG_WARNING("char_register_up: No available slot for callback.");
         return -1;
     }
     
@@ -230,7 +438,7 @@ int char_register_up(void* obj, CharUpCallback callback) {
     char_callbacks[slot].callback.up = callback;
     char_callbacks[slot].type = CHAR_CB_UP;
     
-    log_message("char_register_up: Up callback registered successfully.");
+    LOG_DEBUG("char_register_up: Up callback registered successfully.");
     return char_callbacks[slot].id;
 }
 
@@ -241,7 +449,7 @@ int char_register_up(void* obj, CharUpCallback callback) {
  * @return True if the callback was successfully unregistered, false otherwise.
  */
 bool char_unregister(int callback_id) {
-    log_message("char_unregister: Unregistering callback with ID %d.", callback_id);
+    LOG_DEBUG("char_unregister: Unregistering callback with ID %d.", callback_id);
     if (!char_initialized) return false;
     
     bool success = false;
@@ -254,9 +462,9 @@ bool char_unregister(int callback_id) {
     }
     
     if (success) {
-        log_message("char_unregister: Callback unregistered successfully.");
+        LOG_DEBUG("char_unregister: Callback unregistered successfully.");
     } else {
-        log_message("char_unregister: Callback ID %d not found.", callback_id);
+        LOG_DEBUG("char_unregister: Callback ID %d not found.", callback_id);
     }
     return success;
 }
@@ -266,13 +474,13 @@ bool char_unregister(int callback_id) {
  * Deactivates all callback entries.
  */
 void char_clear_callbacks(void) {
-    log_message("char_clear_callbacks: Clearing all registered callbacks.");
+    LOG_DEBUG("char_clear_callbacks: Clearing all registered callbacks.");
     if (!char_initialized) return;
     
     for (int i = 0; i < MAX_CHAR_CALLBACKS; i++) {
         char_callbacks[i].active = false;
     }
-    log_message("char_clear_callbacks: All callbacks cleared.");
+    LOG_DEBUG("char_clear_callbacks: All callbacks cleared.");
 }
 
 /**
@@ -283,7 +491,7 @@ void char_clear_callbacks(void) {
  * @return The translated character value of the pressed key.
  */
 int char_get_char(void* field) {
-    log_message("char_get_char: Waiting for any character input.");
+    LOG_TRACE("char_get_char: Waiting for any character input.");
     if (!char_initialized) char_init(field);
     
     // Wait for a key press and process it completely
@@ -292,7 +500,30 @@ int char_get_char(void* field) {
     // Return the translated value
     CharValue result = last_key_value = char_translate_key(key);
     
-    log_message("char_get_char: Received character input: %d.", result);
+    LOG_TRACE("char_get_char: Received character input: %d.", result);
+    return result;
+}
+
+/**
+ * Get the next character input without blocking.
+ * The keyboard is polled once; a value is returned when a key press
+ * completes, as char_get_char does.
+ * 
+ * @param field A pointer to the field object for registering callbacks.
+ * @return The translated character value of the key, or CHAR_NULL if no key press completed.
+ */
+int char_poll(void* field) {
+    if (!char_initialized) char_init(field);
+    
+    Key key = key_poll();
+    if (key == KEY_NONE) {
+        return CHAR_NULL;
+    }
+    
+    // Return the translated value
+    CharValue result = last_key_value = char_translate_key(key);
+    
+    LOG_TRACE("char_poll: Received character input: %d.", result);
     return result;
 }
 
@@ -302,7 +533,7 @@ int char_get_char(void* field) {
  * @return The current keyboard mode.
  */
 KeyboardMode char_get_mode(void) {
-    log_message("char_get_mode: Current mode is %d.", current_mode);
+    LOG_TRACE("char_get_mode: Current mode is %d.", current_mode);
     return current_mode;
 }
 
@@ -312,7 +543,7 @@ KeyboardMode char_get_mode(void) {
  * @param mode The new keyboard mode to set.
  */
 void char_set_mode(KeyboardMode mode) {
-    log_message("char_set_mode: Setting mode to %d.", mode);
+    LOG_TRACE("char_set_mode: Setting mode to %d.", mode);
     current_mode = mode;
 }
 
@@ -326,39 +557,39 @@ bool char_process_mode_key(Key key) {
     if (key != KEY_2ND && key != KEY_ALPHA) {
         return false;
     }
-    log_message("char_process_mode_key: Current mode is %d.", current_mode);
-    log_message("is 2nd      : %x", current_mode & KB_MODE_2ND);
-    log_message("is alpha    : %x", current_mode & KB_MODE_ALPHA);	
-    log_message("is lower    : %x", current_mode & KB_MODE_LOWER);
-    log_message("is lock     : %x", current_mode & KB_MODE_LOCK);
+    LOG_TRACE("char_process_mode_key: Current mode is %d.", current_mode);
+    LOG_TRACE("is 2nd      : %x", current_mode & KB_MODE_2ND);
+    LOG_TRACE("is alpha    : %x", current_mode & KB_MODE_ALPHA);	
+    LOG_TRACE("is lower    : %x", current_mode & KB_MODE_LOWER);
+    LOG_TRACE("is lock     : %x", current_mode & KB_MODE_LOCK);
 
     KeyboardMode old_mode = current_mode; // Store the old mode for logging
 
     if (key == KEY_2ND) {
         // 2nd key pressed - toggle 2nd mode
-        log_message("char_process_mode_key: 2nd key pressed.");
+        LOG_TRACE("char_process_mode_key: 2nd key pressed.");
         current_mode ^= KB_MODE_2ND;
     } 
     else if (key == KEY_ALPHA) {
         // Alpha key pressed
-        log_message("char_process_mode_key: Alpha key pressed.");
+        LOG_TRACE("char_process_mode_key: Alpha key pressed.");
 
         if ((current_mode & KB_MODE_ALPHA) == 0) {
-            log_message("char_process_mode_key: Changing to alpha mode.");
+            LOG_TRACE("char_process_mode_key: Changing to alpha mode.");
             current_mode |= KB_MODE_ALPHA;                      // Set alpha mode
         } else if ((current_mode & KB_MODE_LOWER) == 0) {
-            log_message("char_process_mode_key: Changing to alpha lower mode.");
+            LOG_TRACE("char_process_mode_key: Changing to alpha lower mode.");
             // If we are in alpha mode, change to alpha lower
             current_mode |= KB_MODE_ALPHA_LOWER;                // Set alpha lower mode
         } else if (current_mode & KB_MODE_LOWER) {
-            log_message("char_process_mode_key: Changing to normal.");
+            LOG_TRACE("char_process_mode_key: Changing to normal.");
             // If we are in lower mode, return to normal mode
             current_mode = current_mode & ~KB_MODE_ALPHA_LOWER; // Remove alpha lower mode
             current_mode = current_mode & ~KB_MODE_LOCK;        // Remove locked mode
         }
         
         if (current_mode & KB_MODE_2ND) {
-            log_message("char_process_mode_key: Changing to locked mode.");
+            LOG_TRACE("char_process_mode_key: Changing to locked mode.");
             current_mode |= KB_MODE_LOCK;                       // Set locked mode
         } 
         current_mode = current_mode & ~KB_MODE_2ND;             // Remove 2nd mode
@@ -366,277 +597,67 @@ bool char_process_mode_key(Key key) {
 
     // Check if the mode has changed and invoke the callback if registered
     if (old_mode != current_mode && mode_change_callback) {
-        log_message("char_process_mode_key: Mode change detected, invoking callback.");
+        LOG_TRACE("char_process_mode_key: Mode change detected, invoking callback.");
         mode_change_callback(current_mode);
     } else {
-        log_message("char_process_mode_key: No mode change detected.");
+        LOG_TRACE("char_process_mode_key: No mode change detected.");
     }
 
-    log_message("char_process_mode_key: New mode is %d.", current_mode);
-    log_message("is 2nd      : %x", current_mode & KB_MODE_2ND);
-    log_message("is alpha    : %x", current_mode & KB_MODE_ALPHA);	
-    log_message("is lower    : %x", current_mode & KB_MODE_LOWER);
-    log_message("is lock     : %x", current_mode & KB_MODE_LOCK);
+    LOG_TRACE("char_process_mode_key: New mode is %d.", current_mode);
+    LOG_TRACE("is 2nd      : %x", current_mode & KB_MODE_2ND);
+    LOG_TRACE("is alpha    : %x", current_mode & KB_MODE_ALPHA);	
+    LOG_TRACE("is lower    : %x", current_mode & KB_MODE_LOWER);
+    LOG_TRACE("is lock     : %x", current_mode & KB_MODE_LOCK);
     
     return true;
 }
 
-/**
- * Helper function to translate keys in normal mode (no 2nd, no alpha).
- * 
- * @param key The physical key to translate.
- * @return The translated character value, or CHAR_NULL if no mapping exists.
- */
-static int translate_normal_mode(Key key) {
-    int group = KEY_GROUP(key);
-    int mask = KEY_MASK(key);
-    
-    // Group 1: Graph, Trace, Zoom, Window, Y=, 2nd, Mode, Del
-    if (group == 1) {
-        if (mask == kb_Graph)    return FUNC_GRAPH;
-        if (mask == kb_Trace)    return FUNC_TRACE;
-        if (mask == kb_Zoom)     return FUNC_ZOOM;
-        if (mask == kb_Window)   return FUNC_WINDOW;
-        if (mask == kb_Yequ)     return FUNC_Y_EQUALS;
-        if (mask == kb_2nd)      return CHAR_2ND;     // Should be handled by char_process_mode_key
-        if (mask == kb_Mode)     return CHAR_MODE;
-        if (mask == kb_Del)      return CHAR_DEL;
-    }
-    // Group 2: Sto, Ln, Log, x², 1/x, Math, Alpha
-    else if (group == 2) {
-        if (mask == kb_Sto)      return FUNC_STO;
-        if (mask == kb_Ln)       return FUNC_LN;
-        if (mask == kb_Log)      return FUNC_LOG;
-        if (mask == kb_Square)   return FUNC_SQUARE;
-        if (mask == kb_Recip)    return FUNC_RECIP;
-        if (mask == kb_Math)     return FUNC_MATH;
-        if (mask == kb_Alpha)    return CHAR_ALPHA;   // Should be handled by char_process_mode_key
-    }
-    // Group 3: 0, 1, 4, 7, ,, sin, apps, x
-    else if (group == 3) {
-        if (mask == kb_0)        return '0';
-        if (mask == kb_1)        return '1';
-        if (mask == kb_4)        return '4';
-        if (mask == kb_7)        return '7';
-        if (mask == kb_Comma)    return ',';
-        if (mask == kb_Sin)      return FUNC_SIN;
-        if (mask == kb_Apps)     return FUNC_APPS;
-        if (mask == kb_GraphVar) return FUNC_X_VAR;
-    }
-    // Group 4: ., 2, 5, 8, (, cos, prgm, stat
-    else if (group == 4) {
-        if (mask == kb_DecPnt)  return '.';
-        if (mask == kb_2)       return '2';
-        if (mask == kb_5)       return '5';
-        if (mask == kb_8)       return '8';
-        if (mask == kb_LParen)  return '(';
-        if (mask == kb_Cos)     return FUNC_COS;
-        if (mask == kb_Prgm)    return FUNC_PRGM;
-        if (mask == kb_Stat)    return FUNC_STAT;
-    }
-    // Group 5: (-), 3, 6, 9, ), tan, vars
-    else if (group == 5) {
-        if (mask == kb_Chs)      return '-';
-        if (mask == kb_3)        return '3';
-        if (mask == kb_6)        return '6';
-        if (mask == kb_9)        return '9';
-        if (mask == kb_RParen)   return ')';
-        if (mask == kb_Tan)      return FUNC_TAN;
-        if (mask == kb_Vars)     return FUNC_VARS;
-    }
-    // Group 6: Enter, +, -, *, /, ^, clear
-    else if (group == 6) {
-        if (mask == kb_Enter)    return CHAR_ENTER;
-        if (mask == kb_Add)      return '+';
-        if (mask == kb_Sub)      return '-';
-        if (mask == kb_Mul)      return '*';
-        if (mask == kb_Div)      return '/';
-        if (mask == kb_Power)    return '^';
-        if (mask == kb_Clear)    return CHAR_CLEAR;
-    }
-    // Group 7: down, left, right, up
-    else if (group == 7) {
-        if (mask == kb_Down)     return CHAR_DOWN;
-        if (mask == kb_Left)     return CHAR_LEFT;
-        if (mask == kb_Right)    return CHAR_RIGHT;
-        if (mask == kb_Up)       return CHAR_UP;
-    }
-    
-    return CHAR_NULL;
-}
-
-/**
- * Helper function to translate keys in alpha mode.
- * 
- * @param key The physical key to translate.
- * @param is_lower Whether we're in lowercase alpha mode.
- * @return The translated character value, or CHAR_NULL if no mapping exists.
- */
-static int translate_alpha_mode(Key key, bool is_lower) {
-    int group = KEY_GROUP(key);
-    int mask = KEY_MASK(key);
-    
-    // Group 2: Sto, Ln, Log, x², 1/x, Math, Alpha
-    if (group == 2) {
-        if (mask == kb_Math)     return is_lower ? 'a' : 'A';
-        if (mask == kb_Recip)    return is_lower ? 'd' : 'D';
-        if (mask == kb_Square)   return is_lower ? 'i' : 'I';
-        if (mask == kb_Log)      return is_lower ? 'n' : 'N';
-        if (mask == kb_Ln)       return is_lower ? 's' : 'S';
-        if (mask == kb_Sto)      return is_lower ? 'x' : 'X';
-    }
-    // Group 3: 0, 1, 4, 7, ,, sin, apps, x
-    else if (group == 3) {
-        if (mask == kb_Apps)     return is_lower ? 'b' : 'B';
-        if (mask == kb_Sin)      return is_lower ? 'e' : 'E';
-        if (mask == kb_7)        return is_lower ? 'o' : 'O';
-        if (mask == kb_4)        return is_lower ? 't' : 'T';
-        if (mask == kb_1)        return is_lower ? 'y' : 'Y';
-        if (mask == kb_0)        return ' ';  // Space
-        if (mask == kb_Comma)    return is_lower ? 'j' : 'J';
-    }
-    // Group 4: ., 2, 5, 8, (, cos, prgm, stat
-    else if (group == 4) {
-        if (mask == kb_Prgm)     return is_lower ? 'c' : 'C';
-        if (mask == kb_Cos)      return is_lower ? 'f' : 'F';
-        if (mask == kb_8)        return is_lower ? 'p' : 'P';
-        if (mask == kb_5)        return is_lower ? 'u' : 'U';
-        if (mask == kb_2)        return is_lower ? 'z' : 'Z';
-        if (mask == kb_DecPnt)   return ':';
-        if (mask == kb_LParen)   return is_lower ? 'k' : 'K';
-    }
-    // Group 5: (-), 3, 6, 9, ), tan, vars
-    else if (group == 5) {
-        if (mask == kb_Tan)      return is_lower ? 'g' : 'G';
-        if (mask == kb_6)        return is_lower ? 'v' : 'V';
-        if (mask == kb_3)        return 0x5b; // Theta
-        if (mask == kb_Chs)      return '?';
-        if (mask == kb_9)        return is_lower ? 'q' : 'Q';
-        if (mask == kb_RParen)   return is_lower ? 'l' : 'L';
-    }
-    // Group 6: Enter, +, -, *, /, ^, clear
-    else if (group == 6) {
-        if (mask == kb_Power)    return is_lower ? 'h' : 'H';
-        if (mask == kb_Div)      return is_lower ? 'm' : 'M';
-        if (mask == kb_Mul)      return is_lower ? 'r' : 'R';
-        if (mask == kb_Sub)      return is_lower ? 'w' : 'W';
-        if (mask == kb_Add)      return '"';
-        // Keep other keys the same
-        if (mask == kb_Enter)    return CHAR_ENTER;
-        if (mask == kb_Clear)    return CHAR_CLEAR;
-    }
-    // Arrow keys (Group 7) - keep the same in all modes
-    else if (group == 7) {
-        if (mask == kb_Down)     return CHAR_DOWN;
-        if (mask == kb_Left)     return CHAR_LEFT;
-        if (mask == kb_Right)    return CHAR_RIGHT;
-        if (mask == kb_Up)       return CHAR_UP;
-    }
-    
-    return CHAR_NULL;
-}
-
-/**
- * Helper function to translate keys in 2nd mode.
- * 
- * @param key The physical key to translate.
- * @return The translated character value, or CHAR_NULL if no mapping exists.
- */
-static int translate_2nd_mode(Key key) {
-    int group = KEY_GROUP(key);
-    int mask = KEY_MASK(key);
-    
-    // Group 2: Sto, Ln, Log, x², 1/x, Math, Alpha
-    if (group == 2) {
-        if (mask == kb_Recip)    return FUNC_X_INV;     // ^-1
-        if (mask == kb_Square)   return FUNC_ROOT;      // sqrt(
-        if (mask == kb_Log)      return FUNC_10_X;      // 10^
-        if (mask == kb_Ln)       return FUNC_EXP;       // e^x
-        if (mask == kb_Sto)      return FUNC_RECALL;
-        if (mask == kb_Math)     return FUNC_TEST;
-    }
-    // Group 3: 0, 1, 4, 7, ,, sin, apps, x
-    else if (group == 3) {
-        if (mask == kb_Sin)      return FUNC_SIN_INV;   // asin(
-        if (mask == kb_7)        return 'u';
-        if (mask == kb_Apps)     return FUNC_MATRIX;
-        if (mask == kb_GraphVar) return FUNC_DRAW;
-        if (mask == kb_4)        return FUNC_ANGLE;
-    }
-    // Group 4: ., 2, 5, 8, (, cos, prgm, stat
-    else if (group == 4) {
-        if (mask == kb_Cos)      return FUNC_COS_INV;   // acos(
-        if (mask == kb_8)        return 'v';
-        if (mask == kb_LParen)   return '{';
-        if (mask == kb_Prgm)     return FUNC_LIST;
-        if (mask == kb_Stat)     return FUNC_PROBABILITY;
-        if (mask == kb_5)        return FUNC_MEM;
-    }
-    // Group 5: (-), 3, 6, 9, ), tan, vars
-    else if (group == 5) {
-        if (mask == kb_Tan)      return FUNC_TAN_INV;   // atan(
-        if (mask == kb_9)        return 'w';
-        if (mask == kb_RParen)   return '}';
-        if (mask == kb_Chs)      return FUNC_ENTRY;
-        if (mask == kb_Vars)     return FUNC_STRING;
-        if (mask == kb_3)        return FUNC_SOLVE;
-        if (mask == kb_6)        return FUNC_PARAMETRIC;
-    }
-    // Group 6: Enter, +, -, *, /, ^, clear
-    else if (group == 6) {
-        if (mask == kb_Power)    return FUNC_PI;        // π
-        if (mask == kb_Div)      return FUNC_E;         // Constant e
-        if (mask == kb_Mul)      return 0xc1;           // ´[´ on the TI-84+ CE
-        if (mask == kb_Sub)      return ']';
-        if (mask == kb_Enter)    return CHAR_ENTER;
-        if (mask == kb_Add)      return FUNC_MEM_ADD;
-        if (mask == kb_Clear)    return FUNC_RESET;
-    }
-    // Group 7: down, left, right, up
-    else if (group == 7) {
-        if (mask == kb_Up)       return CHAR_PGUP;
-        if (mask == kb_Down)     return CHAR_PGDN;
-        if (mask == kb_Left)     return CHAR_HOME;
-        if (mask == kb_Right)    return CHAR_END;
-    }
-    
-    return CHAR_NULL;
-}
-
 /**
  * Translate a physical key to a character value based on the current keyboard mode.
+ * The value is read from KEY_VALUES, so every key takes the same time.
  * 
  * @param key The physical key to translate.
  * @return The translated character value, or CHAR_NULL if no mapping exists.
  */
 int char_translate_key(Key key) {
-    log_message("char_translate_key: Translating key %d.", key);
+    LOG_TRACE("char_translate_key: Translating key %d.", key);
     
     // Special mode keys - not translated
     if (key == KEY_2ND || key == KEY_ALPHA) {
         return (key == KEY_2ND) ? CHAR_2ND : CHAR_ALPHA;
     }
     
+    int group = KEY_GROUP(key);
+    int mask = KEY_MASK(key);
+    if (group < 1 || mask == 0) {
+        LOG_TRACE("char_translate_key: No mapping found for key %d.", key);
+        return CHAR_NULL;
+    }
+    
+    // Position of the key in its group
+    int bit = 0;
+    while ((mask & 1) == 0) {
+        mask >>= 1;
+        bit++;
+    }
+    
     // Get current mode flags
     bool is_2nd = (current_mode & KB_MODE_2ND) != 0;
     bool is_alpha = (current_mode & KB_MODE_ALPHA) != 0;
     bool is_lower = (current_mode & KB_MODE_LOWER) != 0;
     
-    // Call appropriate translation function based on mode
-    int result;
-    if (is_alpha && !is_2nd) {
-        result = translate_alpha_mode(key, is_lower);
-    } else if (is_2nd) {
-        result = translate_2nd_mode(key);
-    } else {
-        result = translate_normal_mode(key);
+    // 2nd takes over from alpha; lowercase letters share the alpha table
+    int table = is_2nd ? KEY_TABLE_2ND : is_alpha ? KEY_TABLE_ALPHA : KEY_TABLE_NORMAL;
+    int result = KEY_VALUES[table][group][bit];
+    if (table == KEY_TABLE_ALPHA && is_lower && result >= 'A' && result <= 'Z') {
+        result += 'a' - 'A';
     }
     
     // If no mapping was found in any mode, return CHAR_NULL
     if (result == CHAR_NULL) {
-        log_message("char_translate_key: No mapping found for key %d.", key);
+        LOG_TRACE("char_translate_key: No mapping found for key %d.", key);
     } else {
-        log_message("char_translate_key: Translated key %d to character value %d.", key, result);
+        LOG_TRACE("char_translate_key: Translated key %d to character value %d.", key, result);
     }
     
     return result;
@@ -649,7 +670,7 @@ int char_translate_key(Key key) {
  * @param buffer The buffer to store the string representation.
  */
 void char_value_to_string(int value, char* buffer) {
-    log_message("char_value_to_string: Converting value %d to string.", value);
+    LOG_TRACE("char_value_to_string: Converting value %d to string.", value);
     if (!buffer) return;
     
     // Handle special control characters
@@ -712,7 +733,7 @@ void char_value_to_string(int value, char* buffer) {
         // Handle any other values
         sprintf(buffer, "VAL-%d", value);
     }
-    log_message("char_value_to_string: Converted value %d to string '%s'.", value, buffer);
+    LOG_TRACE("char_value_to_string: Converted value %d to string '%s'.", value, buffer);
 }
 
 /**
@@ -722,7 +743,7 @@ void char_value_to_string(int value, char* buffer) {
  * @param key The key that was pressed down.
  */
 static void on_key_down(void* sender, Key key) {
-    log_message("on_key_down: Key down event for key %d.", key);
+    LOG_TRACE("on_key_down: Key down event for key %d.", key);
     
     // Process mode keys first
     if (char_process_mode_key(key)) {
@@ -748,7 +769,7 @@ static void on_key_down(void* sender, Key key) {
     if (!(current_mode & KB_MODE_LOCK)) {
         current_mode &= ~(KB_MODE_ALPHA | KB_MODE_LOWER);
     }
-    log_message("on_key_down: Key down event processed for key %d.", key);
+    LOG_TRACE("on_key_down: Key down event processed for key %d.", key);
 }
 
 /**
@@ -758,7 +779,7 @@ static void on_key_down(void* sender, Key key) {
  * @param key The key that was pressed.
  */
 static void on_key_press(void* sender, Key key) {
-    log_message("on_key_press: Key press event for key %d.", key);
+    LOG_TRACE("on_key_press: Key press event for key %d.", key);
     
     // Skip if this is a mode key or if it's different from our last key
     if (key == KEY_2ND || key == KEY_ALPHA || key != last_physical_key) {
@@ -771,7 +792,7 @@ static void on_key_press(void* sender, Key key) {
             char_callbacks[i].callback.press(sender, last_key_value);
         }
     }
-    log_message("on_key_press: Key press event processed for key %d.", key);
+    LOG_TRACE("on_key_press: Key press event processed for key %d.", key);
 }
 
 /**
@@ -781,7 +802,7 @@ static void on_key_press(void* sender, Key key) {
  * @param key The key that was released.
  */
 static void on_key_up(void* sender, Key key) {
-    log_message("on_key_up: Key up event for key %d.", key);
+    LOG_TRACE("on_key_up: Key up event for key %d.", key);
     
     // Skip if this is a mode key or if it's different from our last key
     if (key == KEY_2ND || key == KEY_ALPHA || key != last_physical_key) {
@@ -798,5 +819,5 @@ static void on_key_up(void* sender, Key key) {
     // Reset last key values
     last_key_value = CHAR_NULL;
     last_physical_key = KEY_NONE;
-    log_message("on_key_up: Key up event processed for key %d.", key);
+    LOG_TRACE("on_key_up: Key up event processed for key %d.", key);
 }
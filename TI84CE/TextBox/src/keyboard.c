@@ -3,6 +3,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include "headers/keyboard_private.h"
+#include "headers/scheduler.h"
 
 #include "headers/log.h"
 
@@ -13,22 +14,27 @@
 static CallbackEntry callbacks[MAX_CALLBACKS];   /**< Array of callback entries */
 static int next_callback_id = 1;                 /**< Next available callback ID (starts at 1) */
 static bool initialized = false;                 /**< Whether the keyboard handler has been initialized */
+static bool continuous = false;                  /**< Whether the keypad is scanning by itself */
 
 // Default configuration for key handling
-static int key_sensitivity = 50;     /**< Sensitivity for key polling in milliseconds */
 static int key_repeat_delay = 500;   /**< Initial delay before key repeat in milliseconds */
 static int key_repeat_interval = 100; /**< Interval between repeated keys in milliseconds */
 
+// State of the key being processed by key_poll
+static Key held_key = KEY_NONE;           /**< Key held down, or KEY_NONE */
+static unsigned long last_repeat_time = 0; /**< Time of the last press event of the held key */
+static int wait_delay = -1;               /**< Time before the next press event, -1 before the first */
+
 /**
  * Initialize the keyboard subsystem.
  */
 void key_init(void) {
     if (initialized) {
-        log_message("Keyboard subsystem already initialized.");
+        LOG_DEBUG("Keyboard subsystem already initialized.");
         return;
     }
 
-    log_message("Initializing keyboard subsystem...");
+    LOG_DEBUG("Initializing keyboard subsystem...");
     
     // Clear all callback entries
     memset(callbacks, 0, sizeof(callbacks));
@@ -39,7 +45,7 @@ void key_init(void) {
     next_callback_id = 1;
     initialized = true;
     
-    log_message("Keyboard subsystem initialized.");
+    LOG_DEBUG("Keyboard subsystem initialized.");
 }
 
 /**
@@ -51,7 +57,7 @@ void key_init(void) {
 int key_register_down(void* obj, KeyDownCallback callback) {
     if (!initialized) key_init();
 
-    log_message("Registering key down callback...");
+    LOG_DEBUG("Registering key down callback...");
     
     // Find an empty slot
     int slot = -1;
@@ -64,7 +70,7 @@ int key_register_down(void* obj, KeyDownCallback callback) {
     
     // If no slot available, return error
     if (slot < 0) {
-        log_message("Failed to register key down callback: No available slots.");
+        LOG_WARNING("Failed to register key down callback: No available slots.");
         return -1;
     }
     
@@ -75,7 +81,7 @@ int key_register_down(void* obj, KeyDownCallback callback) {
     callbacks[slot].callback.down = callback;
     callbacks[slot].type = CB_DOWN;
 
-    log_message("Key down callback registered successfully.");
+    LOG_DEBUG("Key down callback registered successfully.");
     
     return callbacks[slot].id;
 }
@@ -91,7 +97,7 @@ int key_register_down(void* obj, KeyDownCallback callback) {
 int key_register_press(void* obj, KeyPressCallback callback, int repeat_delay_ms, int repeat_interval_ms) {
     if (!initialized) key_init();
 
-    log_message("Registering key press callback...");
+    LOG_DEBUG("Registering key press callback...");
     
     // Find an empty slot
     int slot = -1;
@@ -104,7 +110,7 @@ int key_register_press(void* obj, KeyPressCallback callback, int repeat_delay_ms
     
     // If no slot available, return error
     if (slot < 0) {
-        log_message("Failed to register key press callback: No available slots.");
+        LOG_WARNING("Failed to register key press callback: No available slots.");
         return -1;
     }
     
@@ -117,7 +123,7 @@ int key_register_press(void* obj, KeyPressCallback callback, int repeat_delay_ms
     callbacks[slot].repeat_delay = repeat_delay_ms;
     callbacks[slot].repeat_interval = repeat_interval_ms;
 
-    log_message("Key press callback registered successfully.");
+    LOG_DEBUG("Key press callback registered successfully.");
     
     return callbacks[slot].id;
 }
@@ -131,7 +137,7 @@ int key_register_press(void* obj, KeyPressCallback callback, int repeat_delay_ms
 int key_register_up(void* obj, KeyUpCallback callback) {
     if (!initialized) key_init();
 
-    log_message("Registering key up callback...");
+    LOG_DEBUG("Registering key up callback...");
     
     // Find an empty slot
     int slot = -1;
@@ -144,7 +150,7 @@ int key_register_up(void* obj, KeyUpCallback callback) {
     
     // If no slot available, return error
     if (slot < 0) {
-        log_message("Failed to register key up callback: No available slots.");
+        LOG_WARNING("Failed to register key up callback: No available slots.");
         return -1;
     }
     
@@ -155,7 +161,7 @@ int key_register_up(void* obj, KeyUpCallback callback) {
     callbacks[slot].callback.up = callback;
     callbacks[slot].type = CB_UP;
 
-    log_message("Key up callback registered successfully.");
+    LOG_DEBUG("Key up callback registered successfully.");
     
     return callbacks[slot].id;
 }
@@ -169,17 +175,17 @@ int key_register_up(void* obj, KeyUpCallback callback) {
 bool key_unregister(int callback_id) {
     if (!initialized) return false;
 
-    log_message("Unregistering callback with ID %d...", callback_id);
+    LOG_DEBUG("Unregistering callback with ID %d...", callback_id);
     
     for (int i = 0; i < MAX_CALLBACKS; i++) {
         if (callbacks[i].active && callbacks[i].id == callback_id) {
             callbacks[i].active = false;
-            log_message("Callback with ID %d unregistered successfully.", callback_id);
+            LOG_DEBUG("Callback with ID %d unregistered successfully.", callback_id);
             return true;
         }
     }
 
-    log_message("Failed to unregister callback with ID %d: Not found.", callback_id);
+    LOG_WARNING("Failed to unregister callback with ID %d: Not found.", callback_id);
     
     return false;
 }
@@ -190,29 +196,27 @@ bool key_unregister(int callback_id) {
 void key_clear_callbacks(void) {
     if (!initialized) return;
 
-    log_message("Clearing all registered callbacks...");
+    LOG_DEBUG("Clearing all registered callbacks...");
     
     for (int i = 0; i < MAX_CALLBACKS; i++) {
         callbacks[i].active = false;
     }
 
-    log_message("All callbacks cleared.");
+    LOG_DEBUG("All callbacks cleared.");
 }
 
 /**
  * Configure key processing parameters.
  * 
- * @param sensitivity polling sensitivity in milliseconds
  * @param repeat_delay time before key repeat starts in milliseconds
  * @param repeat_interval interval between repeated keys in milliseconds
  */
-void key_configure(int sensitivity, int repeat_delay, int repeat_interval) {
-    if (sensitivity > 0) key_sensitivity = sensitivity;
+void key_configure(int repeat_delay, int repeat_interval) {
     if (repeat_delay > 0) key_repeat_delay = repeat_delay;
     if (repeat_interval > 0) key_repeat_interval = repeat_interval;
     
-    log_message("Key configuration updated: sensitivity=%d, repeat_delay=%d, repeat_interval=%d", 
-                key_sensitivity, key_repeat_delay, key_repeat_interval);
+    LOG_DEBUG("Key configuration updated: repeat_delay=%d, repeat_interval=%d", 
+              key_repeat_delay, key_repeat_interval);
 }
 
 /**
@@ -227,109 +231,160 @@ static unsigned long key_get_millis(void) {
 }
 
 /**
- * Wait for a key press and process it completely.
- * This is a blocking function that handles the entire key lifecycle:
- * - Waits for a key to be pressed
- * - Processes down callbacks
- * - Handles repeat logic and callbacks
+ * Process the keyboard without blocking.
+ * Each call scans the keyboard once and moves the key lifecycle forward:
+ * - Processes down callbacks when a key goes down
+ * - Processes press callbacks when the key goes down, then on repeat
  * - Processes up callbacks when the key is released
  * 
- * @return The key that was pressed and released.
+ * @return The key that was just released, or KEY_NONE if no key press completed.
  */
-Key key_wait(void) {
+Key key_poll(void) {
     if (!initialized) key_init();
-    log_message("Waiting for key...");
-    log_message("key_sensitivity: %d", key_sensitivity);
-    log_message("key_repeat_delay: %d", key_repeat_delay);
-    log_message("key_repeat_interval: %d", key_repeat_interval);
-    
-    Key key = KEY_NONE;
-    bool key_down = false;
-    
-    // Wait for a key press
-    while (!key_down) {
-        kb_Scan();
-        
-        // Check each key group
-        for (int group = 1; group <= 7; group++) {
-            uint8_t group_state = kb_Data[group];
-            if (!group_state) continue;
-            
-            // A key is pressed in this group, check which one
-            for (int bit = 0; bit < 8; bit++) {
-                uint8_t mask = 1 << bit;
-                if (!(group_state & mask)) continue;
-                
-                // Found the pressed key
-                key_down = true;
-                key = (Key)((group << 8) | mask);
-                
-                // Process key down callbacks
-                for (int i = 0; i < MAX_CALLBACKS; i++) {
-                    if (callbacks[i].active && callbacks[i].type == CB_DOWN) {
-                        callbacks[i].callback.down(callbacks[i].obj, key);
-                    }
-                }
-                break;
-            }
-            if (key_down) break;
+    if (!continuous) kb_Scan();
+
+    // Look for a new key press
+    if (held_key == KEY_NONE) {
+        held_key = find_pressed_key();
+        if (held_key == KEY_NONE) {
+            return KEY_NONE;
         }
-        
-        // If no key is pressed yet, delay a bit to reduce CPU usage
-        if (!key_down) {
-            delay(key_sensitivity);
+
+        // Process key down callbacks
+        for (int i = 0; i < MAX_CALLBACKS; i++) {
+            if (callbacks[i].active && callbacks[i].type == CB_DOWN) {
+                callbacks[i].callback.down(callbacks[i].obj, held_key);
+            }
         }
+
+        last_repeat_time = key_get_millis();
+        wait_delay = -1;
     }
-    
-    // Key is now pressed, handle repeat logic
-    unsigned long start_time = key_get_millis();
-    unsigned long last_repeat_time = start_time;
-    int wait_delay = -1;
-    
+
     // Process repeats while key is held down
-    do {
+    if (kb_Data[KEY_GROUP(held_key)] & KEY_MASK(held_key)) {
         unsigned long current_time = key_get_millis();
         unsigned long elapsed = current_time - last_repeat_time;
-        
+
         // Check if it's time for a repeat
-        log_message("wait_delay: %d elapsed: %lu", wait_delay, elapsed);
+        LOG_TRACE("wait_delay: %d elapsed: %lu", wait_delay, elapsed);
         if ((int)elapsed >= wait_delay) {
-            log_message("Processing callbacks");
-            
+            LOG_TRACE("Processing callbacks");
+
             // Process press callbacks
             for (int i = 0; i < MAX_CALLBACKS; i++) {
                 if (callbacks[i].active && callbacks[i].type == CB_PRESS) {
-                    callbacks[i].callback.press(callbacks[i].obj, key);
+                    callbacks[i].callback.press(callbacks[i].obj, held_key);
                 }
             }
-            
+
             // Update timing for next repeat
             wait_delay = (wait_delay == -1) ? key_repeat_delay : key_repeat_interval;
             last_repeat_time = current_time;
         }
-        log_message("wait_delay: %d ", wait_delay);
-        
-        // Small delay to reduce CPU usage
-        delay(key_sensitivity);
-        
-        // Check if key is still pressed
-        kb_Scan();
-        uint8_t group = KEY_GROUP(key);
-        uint8_t mask = KEY_MASK(key);
-        key_down = (kb_Data[group] & mask) != 0;        
-    } while (key_down);
-    
+        return KEY_NONE;
+    }
+
     // Key has been released, process up callbacks
+    Key key = held_key;
+    held_key = KEY_NONE;
     for (int i = 0; i < MAX_CALLBACKS; i++) {
         if (callbacks[i].active && callbacks[i].type == CB_UP) {
             callbacks[i].callback.up(callbacks[i].obj, key);
         }
     }
-    
-    log_message("Key processed: %d", key);
+
+    LOG_TRACE("Key processed: %d", key);
     return key;
 }
 
+/**
+ * Spend the time until the next key poll.
+ * A slice of a background task runs if one is scheduled; otherwise the
+ * keypad scans by itself and the CPU halts between interrupts until a
+ * key goes down or up, or the held key is due to repeat.
+ */
+void key_idle(void) {
+    if (task_run_next()) return;
+
+    start_continuous_scan();
+    while (!key_event_due()) {
+        cpu_idle();
+    }
+}
+
+/**
+ * Wait for a key press and process it completely.
+ * This is a blocking function that handles the entire key lifecycle
+ * through key_poll, running background tasks while it waits.
+ * 
+ * @return The key that was pressed and released.
+ */
+Key key_wait(void) {
+    LOG_TRACE("Waiting for key...");
+
+    Key key;
+    while ((key = key_poll()) == KEY_NONE) {
+        key_idle();
+    }
+    return key;
+}
+
+/**
+ * Tell whether key_poll has something to do: a key went down, the held
+ * key was released, or its next press event is due.
+ * 
+ * @return True if an event is due.
+ */
+static bool key_event_due(void) {
+    if (held_key == KEY_NONE) {
+        return find_pressed_key() != KEY_NONE;
+    }
+    if (!(kb_Data[KEY_GROUP(held_key)] & KEY_MASK(held_key))) {
+        return true;
+    }
+    return (long)(key_get_millis() - last_repeat_time) >= wait_delay;
+}
+
+/**
+ * Put the keypad in continuous-scan mode if it is not already, so kb_Data
+ * follows the keys without kb_Scan.
+ */
+static void start_continuous_scan(void) {
+    if (!continuous) {
+        kb_SetMode(MODE_3_CONTINUOUS);
+        continuous = true;
+    }
+}
+
+/**
+ * Halt the CPU until the next interrupt.
+ */
+static void cpu_idle(void) {
+    __asm__ volatile ("ei\n\thalt");
+}
+
+/**
+ * Find the first key pressed in the last scan.
+ * 
+ * @return The key, or KEY_NONE if no key is pressed.
+ */
+static Key find_pressed_key(void) {
+    for (int group = 1; group <= 7; group++) {
+        uint8_t group_state = kb_Data[group];
+        if (!group_state) continue;
+
+        // A key is pressed in this group, check which one
+        for (int bit = 0; bit < 8; bit++) {
+            uint8_t mask = 1 << bit;
+            if (group_state & mask) {
+                return (Key)((group << 8) | mask);
+            }
+        }
+    }
+    return KEY_NONE;
+}
+
 /**
  * Check if a specific key is currently pressed.
  * Note: This does not process callbacks, it just checks the key state.
@@ -338,8 +393,8 @@ Key key_wait(void) {
  * @return True if the key is pressed, false otherwise.
  */
 bool key_is_pressed(Key key) {
-    // Scan the keyboard
-    kb_Scan();
+    // Scan the keyboard, unless the keypad is scanning by itself
+    if (!continuous) kb_Scan();
     
     int group = KEY_GROUP(key);
     int mask = KEY_MASK(key);
@@ -65,91 +65,6 @@ void log_message(const char* format, ...) {
     va_end(args);    
 }
 
-/**
- * Logs an informational message.
- * 
- * @param format Format string similar to printf.
- * @param ... Variable arguments for the format string.
- */
-void log_info(const char* format, ...) {
-    #ifndef DEBUG
-    return;
-    #endif
-
-    va_list args;
-    va_start(args, format);
-    print_log("INFO", format, args);
-    va_end(args);
-}
-
-/**
- * Logs a warning message.
- * 
- * @param format Format string similar to printf.
- * @param ... Variable arguments for the format string.
- */
-void log_warning(const char* format, ...) {
-    #ifndef DEBUG
-    return;
-    #endif
-
-    va_list args;
-    va_start(args, format);
-    print_log("WARNING", format, args);
-    va_end(args);
-}
-
-/**
- * Logs a critical error message.
- * 
- * @param format Format string similar to printf.
- * @param ... Variable arguments for the format string.
- */
-void log_critical(const char* format, ...) {
-    #ifndef DEBUG
-    return;
-    #endif
-
-    va_list args;
-    va_start(args, format);
-    print_log("CRITICAL", format, args);
-    va_end(args);
-}
-
-/**
- * Logs a debug message.
- * 
- * @param format Format string similar to printf.
- * @param ... Variable arguments for the format string.
- */
-void log_debug(const char* format, ...) {
-    #ifndef DEBUG
-    return;
-    #endif
-
-    va_list args;
-    va_start(args, format);
-    print_log("DEBUG", format, args);
-    va_end(args);
-}
-
-/**
- * Logs an error message.
- * 
- * @param format Format string similar to printf.
- * @param ... Variable arguments for the format string.
- */
-void log_error(const char* format, ...) {
-    #ifndef DEBUG
-    return;
-    #endif
-
-    va_list args;
-    va_start(args, format);
-    print_log("ERROR", format, args);
-    va_end(args);
-}
-
 /**
  * Logs a variable value.
  * 
@@ -169,16 +84,3 @@ void log_variable(const char* name, real_t value) {
 void log_operation(const char* operation, char* result) {
     log_message("OP: %s = %.6f", operation, result);
 }
-
-/**
- * Helper function to format and print log messages.
- * 
- * @param tag The log level tag (e.g., INFO, WARNING).
- * @param format Format string similar to printf.
- * @param args Variable argument list.
- */
-static void print_log(const char* tag, const char* format, va_list args) {
-    static char msg[MAX_LOG_MSG_LENGTH];
-    vsnprintf(msg, MAX_LOG_MSG_LENGTH - 2, format, args);
-    dbg_printf("%s: %s\n", tag, msg);
-}
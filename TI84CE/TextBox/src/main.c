@@ -97,6 +97,8 @@ static int old_main(void) {
     TextResult result;
     
     while (running) {
+        GUI_begin_frame();
+        
         // Clear screen
         gfx_FillScreen(BG_COLOR);
         
@@ -109,7 +111,9 @@ static int old_main(void) {
         GUI_write_text(20, 140, "Press [ENTER] to submit");
         GUI_write_text(20, 160, "Press [CLEAR] to exit");
         
-        // Draw the text fields
+        // Draw the text fields; the screen was cleared under them
+        text_field_invalidate(&username_field);
+        text_field_invalidate(&password_field);
         text_field_draw(&username_field);
         text_field_draw(&password_field);
         
@@ -120,6 +124,7 @@ static int old_main(void) {
         
         // Update screen using GUI_refresh
         GUI_refresh();
+        GUI_end_frame();
         
         // Process input for the username field
         if (!username_field.is_active && !password_field.is_active) {
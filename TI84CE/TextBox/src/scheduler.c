@@ -0,0 +1,100 @@
+#include <tice.h>
+#include <string.h>
+#include "headers/scheduler_private.h"
+
+#include "headers/log.h"
+
+// Maximum number of tasks that can be scheduled
+#define MAX_TASKS 8
+
+// Static state variables
+static TaskEntry tasks[MAX_TASKS];   /**< Array of task entries */
+static int next_task_id = 1;         /**< Next available task ID (starts at 1) */
+static int next_slot = 0;            /**< Slot to look at first for the next slice */
+
+/**
+ * Schedule a task to run in idle time.
+ *
+ * @param obj Pointer to the object the task works on.
+ * @param run The function that runs a slice of the task.
+ * @return The ID of the task, or -1 if scheduling failed.
+ */
+int task_add(void* obj, TaskCallback run) {
+    LOG_DEBUG("Scheduling task...");
+
+    // Find an empty slot
+    int slot = -1;
+    for (int i = 0; i < MAX_TASKS; i++) {
+        if (!tasks[i].active) {
+            slot = i;
+            break;
+        }
+    }
+
+    // If no slot available, return error
+    if (slot < 0) {
+        LOG_WARNING("Failed to schedule task: No available slots.");
+        return -1;
+    }
+
+    // Set up the task entry
+    tasks[slot].obj = obj;
+    tasks[slot].active = true;
+    tasks[slot].id = next_task_id++;
+    tasks[slot].run = run;
+
+    LOG_DEBUG("Task %d scheduled.", tasks[slot].id);
+
+    return tasks[slot].id;
+}
+
+/**
+ * Remove a task before it is done.
+ *
+ * @param task_id The ID of the task to remove.
+ * @return True if the task was removed, false if it was not found.
+ */
+bool task_remove(int task_id) {
+    for (int i = 0; i < MAX_TASKS; i++) {
+        if (tasks[i].active && tasks[i].id == task_id) {
+            tasks[i].active = false;
+            LOG_DEBUG("Task %d removed.", task_id);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Check whether any task is waiting to run.
+ *
+ * @return True if a task is scheduled, false otherwise.
+ */
+bool task_pending(void) {
+    for (int i = 0; i < MAX_TASKS; i++) {
+        if (tasks[i].active) return true;
+    }
+    return false;
+}
+
+/**
+ * Run one slice of the next task, taking the tasks in turn.
+ * A task that reports it is done is removed.
+ *
+ * @return True if a slice was run, false if no task is scheduled.
+ */
+bool task_run_next(void) {
+    for (int n = 0; n < MAX_TASKS; n++) {
+        int slot = (next_slot + n) % MAX_TASKS;
+        if (!tasks[slot].active) continue;
+
+        next_slot = (slot + 1) % MAX_TASKS;
+        int id = tasks[slot].id;
+        if (!tasks[slot].run(tasks[slot].obj)) {
+            // The task may have been removed, and its slot reused, while it ran
+            task_remove(id);
+        }
+        return true;
+    }
+    return false;
+}
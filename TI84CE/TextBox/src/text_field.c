@@ -7,18 +7,37 @@
 #include "headers/key_translator.h"
 #include "headers/text_field_private.h"
 #include "headers/gui.h"
+#include "headers/scheduler.h"
 
 #include "headers/log.h"
 
-// Default initial buffer size
-#define INITIAL_BUFFER_SIZE 64
+// Number of text fields that can hold text at the same time
+#define MAX_TEXT_FIELDS 4
+
+// Size of the buffer of a text field, terminator included
+#define TEXT_BUFFER_SIZE 256
+
+/** ID of the press callback of the focused text field. */
+static int focus_callback_id = -1;
+
+/** ID of the task that redraws a text field, or -1 if none is scheduled. */
+static int redraw_task_id = -1;
+
+/** Text field the redraw task draws. */
+static TextField* redraw_field = NULL;
+
+/** Text buffers of the fields, taken from a fixed arena instead of the heap. */
+static char text_arena[MAX_TEXT_FIELDS][TEXT_BUFFER_SIZE];
+
+/** Whether each buffer of the arena belongs to a field. */
+static bool text_arena_used[MAX_TEXT_FIELDS];
 
 /**
  * Initialize a text field.
  */
 void text_field_init(TextField* field, int x, int y, int width, bool has_border) {
     if (!field) return;
-    log_message("Initializing text field at (%d, %d) with width %d", x, y, width);
+    LOG_DEBUG("Initializing text field at (%d, %d) with width %d", x, y, width);
     
     memset(field, 0, sizeof(TextField));
     field->x = x;
@@ -32,12 +51,11 @@ void text_field_init(TextField* field, int x, int y, int width, bool has_border)
     // Calculate maximum visible characters
     field->max_visible_chars = (width - 2*PADDING_X) / GUI_CHAR_WIDTH;
     
-    // Allocate initial buffer
-    field->buffer_size = INITIAL_BUFFER_SIZE;
-    field->text = (char*)malloc(field->buffer_size);
-    if (field->text) {
-        field->text[0] = '\0';
-    }
+    // Take a buffer from the arena; the whole of it starts as the gap
+    field->text = arena_alloc();
+    field->buffer_size = field->text ? TEXT_BUFFER_SIZE : 0;
+    field->gap_start = 0;
+    field->gap_end = field->buffer_size;
     
     // Initialize other values
     field->text_length = 0;
@@ -52,7 +70,11 @@ void text_field_init(TextField* field, int x, int y, int width, bool has_border)
     field->on_changed = NULL;
     field->on_enter = NULL;
     
-    log_message("Text field initialized successfully");
+    // Nothing has been drawn yet
+    field->needs_redraw = true;
+    field->dirty_start = -1;
+    
+    LOG_DEBUG("Text field initialized successfully");
 }
 
 /**
@@ -60,44 +82,107 @@ void text_field_init(TextField* field, int x, int y, int width, bool has_border)
  */
 void text_field_free(TextField* field) {
     if (!field) return;
-    log_message("Freeing text field resources");
+    LOG_DEBUG("Freeing text field resources");
+    
+    if (redraw_field == field) {
+        cancel_redraw();
+    }
     
     if (field->text) {
-        free(field->text);
+        arena_free(field->text);
         field->text = NULL;
     }
     field->buffer_size = 0;
+    field->gap_start = 0;
+    field->gap_end = 0;
     field->text_length = 0;
-    log_message("Text field resources freed");
+    LOG_DEBUG("Text field resources freed");
 }
 
 /**
- * Ensure the buffer is large enough for the given size.
+ * Take a text buffer from the arena.
+ * 
+ * @return A buffer of TEXT_BUFFER_SIZE characters, or NULL if all are in use.
  */
-static bool ensure_buffer_size(TextField* field, int needed_size) {
-    if (!field || !field->text) return false;
-    log_message("Ensuring buffer size: needed %d, current %d", needed_size, field->buffer_size);
-    
-    if (needed_size <= field->buffer_size) {
-        return true; // Already large enough
+static char* arena_alloc(void) {
+    for (int i = 0; i < MAX_TEXT_FIELDS; i++) {
+        if (!text_arena_used[i]) {
+            text_arena_used[i] = true;
+            return text_arena[i];
+        }
     }
-    
-    // Calculate new size (double until sufficient)
-    int new_size = field->buffer_size;
-    while (new_size < needed_size) {
-        new_size *= 2;
+    LOG_ERROR("No text buffer left for the text field");
+    return NULL;
+}
+
+/**
+ * Give a text buffer back to the arena.
+ * 
+ * @param buffer The buffer taken with arena_alloc.
+ */
+static void arena_free(char* buffer) {
+    for (int i = 0; i < MAX_TEXT_FIELDS; i++) {
+        if (text_arena[i] == buffer) {
+            text_arena_used[i] = false;
+        }
     }
-    
-    // Reallocate
-    char* new_buffer = (char*)realloc(field->text, new_size);
-    if (!new_buffer) {
-        return false;
+}
+
+/**
+ * Move the gap to a position in the text. Edits at the gap need no
+ * shifting; moving it costs the characters it moves over, so edits made
+ * near each other stay cheap.
+ * 
+ * @param field The text field.
+ * @param position The character index to move the gap to.
+ */
+static void move_gap(TextField* field, int position) {
+    if (position < field->gap_start) {
+        int count = field->gap_start - position;
+        memmove(field->text + field->gap_end - count, field->text + position, count);
+        field->gap_start -= count;
+        field->gap_end -= count;
+    } else if (position > field->gap_start) {
+        int count = position - field->gap_start;
+        memmove(field->text + field->gap_start, field->text + field->gap_end, count);
+        field->gap_start += count;
+        field->gap_end += count;
     }
-    
-    field->text = new_buffer;
-    field->buffer_size = new_size;
-    log_message("Buffer size ensured: new size %d", field->buffer_size);
-    return true;
+}
+
+/**
+ * Get a character of the text, wherever the gap is.
+ * 
+ * @param field The text field.
+ * @param index The character index, below text_length.
+ * @return The character.
+ */
+static char text_char_at(TextField* field, int index) {
+    return index < field->gap_start ? field->text[index]
+                                    : field->text[index + field->gap_end - field->gap_start];
+}
+
+/**
+ * Note that the cells from a character index to the end of the field must
+ * be drawn again. An edit moves every character after it, so the cells up
+ * to the end all change.
+ * 
+ * @param field The text field.
+ * @param index The first character index that changed.
+ */
+static void mark_dirty(TextField* field, int index) {
+    if (field->dirty_start < 0 || index < field->dirty_start) {
+        field->dirty_start = index;
+    }
+}
+
+/**
+ * Have the whole field drawn again on the next draw, for when the screen
+ * behind it was cleared or drawn over.
+ */
+void text_field_invalidate(TextField* field) {
+    if (!field) return;
+    field->needs_redraw = true;
 }
 
 /**
@@ -105,18 +190,20 @@ static bool ensure_buffer_size(TextField* field, int needed_size) {
  */
 void text_field_clear(TextField* field) {
     if (!field || !field->text) return;
-    log_message("Clearing text field");
+    LOG_DEBUG("Clearing text field");
     
-    field->text[0] = '\0';
+    field->gap_start = 0;
+    field->gap_end = field->buffer_size;
     field->text_length = 0;
     field->cursor_position = 0;
     field->scroll_offset = 0;
+    mark_dirty(field, 0);
     
     // Trigger on_changed callback if registered
     if (field->on_changed) {
         field->on_changed(field);
     }
-    log_message("Text field cleared");
+    LOG_DEBUG("Text field cleared");
 }
 
 /**
@@ -124,31 +211,43 @@ void text_field_clear(TextField* field) {
  */
 void text_field_set_text(TextField* field, const char* text) {
     if (!field || !text) return;
-    log_message("Setting text field content: \"%s\"", text);
+    LOG_DEBUG("Setting text field content: \"%s\"", text);
     
+    if (!field->text) return;
+    
+    // One character of the buffer is kept for the terminator
     int length = strlen(text);
-    if (ensure_buffer_size(field, length + 1)) {
-        strcpy(field->text, text);
-        field->text_length = length;
-        
-        // Reset cursor and scroll
-        field->cursor_position = length;
-        ensure_cursor_visible(field);
-        
-        // Trigger on_changed callback if registered
-        if (field->on_changed) {
-            field->on_changed(field);
-        }
+    if (length > field->buffer_size - 1) {
+        LOG_WARNING("Text too long for the text field, truncated to %d characters", field->buffer_size - 1);
+        length = field->buffer_size - 1;
     }
-    log_message("Text field content set successfully");
+    memcpy(field->text, text, length);
+    field->text_length = length;
+    field->gap_start = length;
+    field->gap_end = field->buffer_size;
+    mark_dirty(field, 0);
+    
+    // Reset cursor and scroll
+    field->cursor_position = length;
+    ensure_cursor_visible(field);
+    
+    // Trigger on_changed callback if registered
+    if (field->on_changed) {
+        field->on_changed(field);
+    }
+    LOG_DEBUG("Text field content set successfully");
 }
 
 /**
  * Get the current text content of the field.
+ * The gap is moved to the end of the text, which leaves the text as a
+ * string at the start of the buffer; it stays valid until the next edit.
  */
 const char* text_field_get_text(TextField* field) {
     if (!field || !field->text) return "";
-    log_message("Getting text field content");
+    LOG_DEBUG("Getting text field content");
+    move_gap(field, field->text_length);
+    field->text[field->text_length] = '\0';
     return field->text;
 }
 
@@ -157,7 +256,7 @@ const char* text_field_get_text(TextField* field) {
  */
 void text_field_set_read_only(TextField* field, bool read_only) {
     if (!field) return;
-    log_message("Setting text field read-only mode to %s", read_only ? "true" : "false");
+    LOG_DEBUG("Setting text field read-only mode to %s", read_only ? "true" : "false");
     field->read_only = read_only;
 }
 
@@ -166,9 +265,10 @@ void text_field_set_read_only(TextField* field, bool read_only) {
  */
 void text_field_set_password_mode(TextField* field, bool password_mode, char password_char) {
     if (!field) return;
-    log_message("Setting password mode to %s with char '%c'", password_mode ? "enabled" : "disabled", password_char);
+    LOG_DEBUG("Setting password mode to %s with char '%c'", password_mode ? "enabled" : "disabled", password_char);
     field->password_mode = password_mode;
     field->password_char = password_char;
+    mark_dirty(field, 0);
 }
 
 /**
@@ -208,17 +308,14 @@ void text_field_on_enter(TextField* field, void (*callback)(TextField* field)) {
  */
 static void text_field_insert_char(TextField* field, char c) {
     if (!field || field->read_only) return;
-    log_message("Inserting character '%c' at position %d", c, field->cursor_position);
-    
-    // If we have a selection, delete it first
-    if (ensure_buffer_size(field, field->text_length + 2)) {
-        // Shift characters after cursor
-        for (int i = field->text_length; i >= field->cursor_position; i--) {
-            field->text[i + 1] = field->text[i];
-        }
-        
-        // Insert the new character
-        field->text[field->cursor_position] = c;
+    LOG_TRACE("Inserting character '%c' at position %d", c, field->cursor_position);
+    
+    // One character of the gap is kept for the terminator
+    if (field->text && field->gap_end - field->gap_start > 1) {
+        // Insert the new character into the gap
+        move_gap(field, field->cursor_position);
+        mark_dirty(field, field->cursor_position);
+        field->text[field->gap_start++] = c;
         field->text_length++;
         field->cursor_position++;
         
@@ -229,7 +326,7 @@ static void text_field_insert_char(TextField* field, char c) {
             field->on_changed(field);
         }
     }
-    log_message("Character inserted successfully");
+    LOG_TRACE("Character inserted successfully");
 }
 
 /**
@@ -237,16 +334,15 @@ static void text_field_insert_char(TextField* field, char c) {
  */
 static void text_field_backspace(TextField* field) {
     if (!field || field->read_only) return;
-    log_message("Performing backspace at position %d", field->cursor_position);
+    LOG_TRACE("Performing backspace at position %d", field->cursor_position);
     
     if (field->cursor_position > 0) {
-        // Shift characters at and after cursor
-        for (int i = field->cursor_position - 1; i < field->text_length; i++) {
-            field->text[i] = field->text[i + 1];
-        }
-        
+        // Widen the gap over the character before the cursor
+        move_gap(field, field->cursor_position);
+        field->gap_start--;
         field->text_length--;
         field->cursor_position--;
+        mark_dirty(field, field->cursor_position);
         
         ensure_cursor_visible(field);
         
@@ -255,7 +351,7 @@ static void text_field_backspace(TextField* field) {
             field->on_changed(field);
         }
     }
-    log_message("Backspace completed");
+    LOG_TRACE("Backspace completed");
 }
 
 /**
@@ -263,16 +359,15 @@ static void text_field_backspace(TextField* field) {
  */
 static void text_field_delete(TextField* field) {
     if (!field || field->read_only) return;
-    log_message("Deleting character at position %d", field->cursor_position);
+    LOG_TRACE("Deleting character at position %d", field->cursor_position);
     
     // Only proceed if we're not at the end of the text
     if (field->cursor_position < field->text_length) {
-        // Shift characters after cursor
-        for (int i = field->cursor_position; i < field->text_length; i++) {
-            field->text[i] = field->text[i + 1];
-        }
-        
+        // Widen the gap over the character at the cursor
+        move_gap(field, field->cursor_position);
+        field->gap_end++;
         field->text_length--;
+        mark_dirty(field, field->cursor_position);
         
         // Cursor position stays the same
         ensure_cursor_visible(field);
@@ -282,7 +377,7 @@ static void text_field_delete(TextField* field) {
             field->on_changed(field);
         }
     }
-    log_message("Character deleted");
+    LOG_TRACE("Character deleted");
 }
 
 /**
@@ -342,7 +437,7 @@ static void process_navigation(TextField* field, int value) {
  */
 static void process_character_input(TextField* field, int value) {
     if (!field || field->read_only) return;
-    log_message("Processing character input: %d", value);
+    LOG_TRACE("Processing character input: %d", value);
     
     // Handle printable ASCII characters
     if (value >= 32 && value <= 126) {
@@ -355,14 +450,94 @@ static void process_character_input(TextField* field, int value) {
 }
 
 /**
- * Draw the text field.
+ * Get the space the left scroll indicator takes before the text.
+ *
+ * @param field The text field.
+ * @return The width taken by the indicator, in pixels.
  */
-void text_field_draw(TextField* field) {
-    if (!field) return;
-    log_message("Drawing text field at (%d, %d)", field->x, field->y);
-    
+static int content_offset(TextField* field) {
+    return field->scroll_offset > 0 ? GUI_CHAR_WIDTH : 0;
+}
+
+/**
+ * Get the number of character cells shown in the field.
+ *
+ * @param field The text field.
+ * @return The number of cells after the left scroll indicator.
+ */
+static int display_chars(TextField* field) {
+    return (field->width - 2*field->padding_x - content_offset(field)) / GUI_CHAR_WIDTH;
+}
+
+/**
+ * Get the x-coordinate of the cell of a character.
+ *
+ * @param field The text field.
+ * @param index The character index, at or after the scroll offset.
+ * @return The x-coordinate of the left of the cell.
+ */
+static int cell_x(TextField* field, int index) {
+    return field->x + field->padding_x + content_offset(field) +
+           (index - field->scroll_offset) * GUI_CHAR_WIDTH;
+}
+
+/**
+ * Draw one character cell of the field, or clear it past the end of the text.
+ *
+ * @param field The text field.
+ * @param index The character index of the cell.
+ */
+static void draw_cell(TextField* field, int index) {
+    int x = cell_x(field, index);
+    int y = field->y + field->padding_y;
+
+    if (index < field->text_length) {
+        // The glyph cell is drawn with its background
+        char glyph[2] = { field->password_mode ? field->password_char : text_char_at(field, index), '\0' };
+        GUI_write_text(x, y, glyph);
+    } else {
+        gfx_SetColor(GUI_get_settings()->bg_color);
+        gfx_FillRectangle(x, y, GUI_CHAR_WIDTH, GUI_CHAR_HEIGHT);
+    }
+}
+
+/**
+ * Draw the cursor line, or erase it with the background color.
+ *
+ * @param field The text field.
+ * @param position The cursor position to draw at.
+ * @param color The color of the line.
+ */
+static void draw_cursor(TextField* field, int position, int color) {
+    int cursor_x = cell_x(field, position);
+    int content_y = field->y + field->padding_y;
+    gfx_SetColor(color);
+    gfx_Line(cursor_x, content_y, cursor_x, content_y + GUI_CHAR_HEIGHT);
+}
+
+/**
+ * Draw the right scroll indicator.
+ *
+ * @param field The text field.
+ */
+static void draw_right_indicator(TextField* field) {
+    // Right scroll indicator as a small triangle
+    gfx_SetColor(GUI_get_settings()->text_color);
+    int tri_x = field->x + field->width - 8;
+    int tri_y = field->y + field->padding_y + GUI_CHAR_HEIGHT/2;
+    gfx_Line(tri_x, tri_y - 3, tri_x + 4, tri_y); // Top line of triangle
+    gfx_Line(tri_x + 4, tri_y, tri_x, tri_y + 3); // Bottom line of triangle
+    gfx_Line(tri_x, tri_y - 3, tri_x, tri_y + 3); // Vertical line to close triangle
+}
+
+/**
+ * Draw the whole text field: background, border, scroll indicators, text and cursor.
+ *
+ * @param field The text field.
+ */
+static void draw_full(TextField* field) {
     GUISettings* settings = GUI_get_settings();
-    
+
     // Draw background and border
     // Clear the area
     gfx_SetColor(settings->bg_color);
@@ -372,18 +547,15 @@ void text_field_draw(TextField* field) {
         gfx_SetColor(settings->text_color);
         gfx_Rectangle(field->x, field->y, field->width, field->height);
     }
-    
+
     // Calculate visible area
     int content_x = field->x + field->padding_x;
     int content_y = field->y + field->padding_y;
-    
+
     // Create a temporary buffer for the visible text
     char visible_text[128]; // Assuming max_visible_chars is less than 128
     memset(visible_text, 0, sizeof(visible_text));
-    
-    // Adjust visible area when scrolling
-    int content_offset = 0;
-    
+
     // Draw scroll indicators if needed
     if (field->scroll_offset > 0) {
         // Left scroll indicator as a small triangle
@@ -393,18 +565,15 @@ void text_field_draw(TextField* field) {
         gfx_Line(tri_x + 4, tri_y - 3, tri_x, tri_y); // Top line of triangle
         gfx_Line(tri_x, tri_y, tri_x + 4, tri_y + 3); // Bottom line of triangle
         gfx_Line(tri_x + 4, tri_y - 3, tri_x + 4, tri_y + 3); // Vertical line to close triangle
-        
-        // Adjust content offset to make room for the indicator
-        content_offset = GUI_CHAR_WIDTH;
     }
-    
+
     // Extract visible portion of the text
     int visible_length = field->text_length - field->scroll_offset;
-    int max_display_chars = (field->width - 2*field->padding_x - content_offset) / GUI_CHAR_WIDTH;
+    int max_display_chars = display_chars(field);
     if (visible_length > max_display_chars) {
         visible_length = max_display_chars;
     }
-    
+
     if (visible_length > 0 && field->text) {
         if (field->password_mode) {
             // In password mode, fill with password char
@@ -413,38 +582,98 @@ void text_field_draw(TextField* field) {
             }
             visible_text[visible_length] = '\0';
         } else {
-            // Normal text display
-            strncpy(visible_text, field->text + field->scroll_offset, visible_length);
+            // Normal text display, read around the gap
+            for (int i = 0; i < visible_length; i++) {
+                visible_text[i] = text_char_at(field, field->scroll_offset + i);
+            }
             visible_text[visible_length] = '\0';
         }
     }
-    
+
     // Draw the visible text
     GUI_reset_text_colors();
-    GUI_write_text(content_x + content_offset, content_y, visible_text);
-    
+    GUI_write_text(content_x + content_offset(field), content_y, visible_text);
+
     // Draw cursor if active
     if (field->is_active) {
-        int cursor_x = content_x + content_offset + 
-                      (field->cursor_position - field->scroll_offset) * GUI_CHAR_WIDTH;
-        gfx_SetColor(settings->text_color);
-        gfx_Line(cursor_x, content_y, cursor_x, content_y + GUI_CHAR_HEIGHT);
+        draw_cursor(field, field->cursor_position, settings->text_color);
     }
-    
+
     // Draw right scroll indicator if needed
     if (field->scroll_offset + max_display_chars < field->text_length) {
-        // Right scroll indicator as a small triangle
-        gfx_SetColor(settings->text_color);
-        int tri_x = field->x + field->width - 8;
-        int tri_y = content_y + GUI_CHAR_HEIGHT/2;
-        gfx_Line(tri_x, tri_y - 3, tri_x + 4, tri_y); // Top line of triangle
-        gfx_Line(tri_x + 4, tri_y, tri_x, tri_y + 3); // Bottom line of triangle
-        gfx_Line(tri_x, tri_y - 3, tri_x, tri_y + 3); // Vertical line to close triangle
+        draw_right_indicator(field);
     }
 }
 
+/**
+ * Draw only what changed since the field was last drawn: the cells of the
+ * edited text and the cursor. The scroll offset must not have changed.
+ *
+ * @param field The text field.
+ */
+static void draw_changes(TextField* field) {
+    GUISettings* settings = GUI_get_settings();
+    int visible_end = field->scroll_offset + display_chars(field);
+
+    // Erase the old cursor, and draw back the column of the cell under it
+    bool cursor_moved = field->drawn_cursor_position != field->cursor_position ||
+                        field->drawn_cursor_visible != field->is_active;
+    if (cursor_moved && field->drawn_cursor_visible) {
+        draw_cursor(field, field->drawn_cursor_position, settings->bg_color);
+        if (field->drawn_cursor_position < visible_end &&
+            (field->dirty_start < 0 || field->drawn_cursor_position < field->dirty_start)) {
+            draw_cell(field, field->drawn_cursor_position);
+        }
+    }
+
+    // Draw the cells of the edited text, up to the end of the field
+    if (field->dirty_start >= 0) {
+        int first = field->dirty_start > field->scroll_offset ? field->dirty_start : field->scroll_offset;
+        for (int i = first; i < visible_end; i++) {
+            draw_cell(field, i);
+        }
+    }
+
+    // The new cursor goes over the cells drawn again
+    if (field->is_active && (cursor_moved || field->dirty_start >= 0)) {
+        draw_cursor(field, field->cursor_position, settings->text_color);
+    }
+
+    // The last cell and the cursor after it may lie under the right scroll indicator
+    if (field->drawn_right_indicator && (cursor_moved || field->dirty_start >= 0)) {
+        draw_right_indicator(field);
+    }
+}
+
+/**
+ * Draw the text field. Only the cells that changed since the last draw are
+ * drawn, unless the field scrolled, the right scroll indicator came or went,
+ * or text_field_invalidate was called; then the whole field is drawn.
+ */
+void text_field_draw(TextField* field) {
+    if (!field) return;
+    LOG_TRACE("Drawing text field at (%d, %d)", field->x, field->y);
+
+    bool right_indicator = field->scroll_offset + display_chars(field) < field->text_length;
+    if (field->needs_redraw ||
+        field->scroll_offset != field->drawn_scroll_offset ||
+        right_indicator != field->drawn_right_indicator) {
+        draw_full(field);
+    } else {
+        draw_changes(field);
+    }
+
+    // Remember what is on screen now
+    field->needs_redraw = false;
+    field->dirty_start = -1;
+    field->drawn_scroll_offset = field->scroll_offset;
+    field->drawn_cursor_position = field->cursor_position;
+    field->drawn_cursor_visible = field->is_active;
+    field->drawn_right_indicator = right_indicator;
+}
+
 static void on_key_press(void* sender, int value) {
-    log_message("on_key_press_callback: Key press event for value %d", value);
+    LOG_TRACE("on_key_press_callback: Key press event for value %d", value);
 
     TextField* field = (TextField*)sender;
     
@@ -476,24 +705,64 @@ static void on_key_press(void* sender, int value) {
             process_character_input(field, value);
     }
     
-    // Redraw the field
-    text_field_draw(field);
+    schedule_redraw(field);
+}
+
+/**
+ * Redraw a text field in the next idle slice instead of right away, so
+ * the edits of several key events are shown with one draw.
+ */
+static void schedule_redraw(TextField* field) {
+    if (redraw_task_id >= 0) return;
+
+    redraw_task_id = task_add(field, redraw_task);
+    if (redraw_task_id < 0) {
+        // No task slot is free; draw now
+        text_field_draw(field);
+        GUI_refresh();
+        return;
+    }
+    redraw_field = field;
+}
+
+/**
+ * Task that draws a text field and shows it.
+ * 
+ * @param obj The text field.
+ * @return False, the field is drawn in one slice.
+ */
+static bool redraw_task(void* obj) {
+    redraw_task_id = -1;
+    redraw_field = NULL;
+    text_field_draw((TextField*)obj);
     GUI_refresh();
+    return false;
 }
 
 /**
- * Give focus to a text field and process input until focus is lost.
- * This now uses the procedural char_get_char() approach.
+ * Drop a scheduled redraw.
  */
-TextResult text_field_activate(TextField* field) {
-    if (!field) return TEXT_RESULT_CANCEL;
-    log_message("Text field gaining focus");
+static void cancel_redraw(void) {
+    if (redraw_task_id >= 0) {
+        task_remove(redraw_task_id);
+        redraw_task_id = -1;
+        redraw_field = NULL;
+    }
+}
+
+/**
+ * Give focus to a text field without waiting for input.
+ * Input is then handled by text_field_poll until text_field_blur is called.
+ */
+void text_field_focus(TextField* field) {
+    if (!field) return;
+    LOG_DEBUG("Text field gaining focus");
     
     // Initialize character handling
     char_init(field);
     
     // Register for key press callback for repeats
-    int text_field_callback_id = char_register_press(field, on_key_press, 500, 100);
+    focus_callback_id = char_register_press(field, on_key_press, 500, 100);
     
     // Mark field as active
     field->is_active = true;
@@ -501,65 +770,106 @@ TextResult text_field_activate(TextField* field) {
     // Draw the field initially
     text_field_draw(field);
     GUI_refresh();
+}
+
+/**
+ * Handle the input that arrived for the focused text field, without blocking.
+ * Characters are inserted by the press callback; this handles the keys that
+ * end or clear the input.
+ * 
+ * @param field The focused text field.
+ * @param result Set to the result of the field when it is done.
+ * @return True if the field is done and should lose focus, false otherwise.
+ */
+bool text_field_poll(TextField* field, TextResult* result) {
+    if (!field) {
+        *result = TEXT_RESULT_CANCEL;
+        return true;
+    }
     
-    // Process input until done
-    TextResult result = TEXT_RESULT_CANCEL;
-    bool processing = true;
+    // The mode indicator refreshes the screen while the keys are polled;
+    // batch its refreshes so a key is shown with one blit
+    GUI_begin_frame();
     
-    while (processing) {
-        // Get the next character input (this blocks until a key is pressed)
-        // The key_wait inside char_get_char will trigger our callback for repeats
-        int value = char_get_char(field);
-        
-        // Handle non-repeating actions here
-        switch (value) {
-            case CHAR_ENTER:
-                if (field->on_enter) {
-                    field->on_enter(field);
-                }
-                
-                if (field->next_field) {
-                    result = TEXT_RESULT_NEXT;
-                } else {
-                    result = TEXT_RESULT_ENTER;
-                }
-                processing = false;
-                break;
-                
-            case CHAR_CLEAR:
-                if (!field->read_only && field->text_length > 0) {
-                    text_field_clear(field);
-                } else if (field->text_length == 0) {
-                    // Exit if text field is already empty and Clear is pressed
-                    result = TEXT_RESULT_CLEAR;
-                    processing = false;
-                }
-                break;
-                
-            default:
-                break;
-        }
-        
-        // Redraw the field after each key press
-        text_field_draw(field);
-        GUI_refresh();
+    // Poll for the next character input
+    // The key_poll inside char_poll triggers our callback for repeats
+    int value = char_poll(field);
+    if (value == CHAR_NULL) {
+        GUI_end_frame();
+        return false;
+    }
+    
+    // Handle non-repeating actions here
+    bool done = false;
+    switch (value) {
+        case CHAR_ENTER:
+            if (field->on_enter) {
+                field->on_enter(field);
+            }
+            
+            *result = field->next_field ? TEXT_RESULT_NEXT : TEXT_RESULT_ENTER;
+            done = true;
+            break;
+            
+        case CHAR_CLEAR:
+            if (!field->read_only && field->text_length > 0) {
+                text_field_clear(field);
+            } else if (field->text_length == 0) {
+                // Exit if text field is already empty and Clear is pressed
+                *result = TEXT_RESULT_CLEAR;
+                done = true;
+            }
+            break;
+            
+        default:
+            break;
     }
     
+    // Redraw the field after each key press, in the next idle slice
+    schedule_redraw(field);
+    GUI_end_frame();
+    return done;
+}
+
+/**
+ * Take the focus away from a text field.
+ */
+void text_field_blur(TextField* field) {
+    if (!field) return;
+    
     // Clean up
-    if (text_field_callback_id >= 0) {
-        char_unregister(text_field_callback_id);
-        text_field_callback_id = -1;
+    if (focus_callback_id >= 0) {
+        char_unregister(focus_callback_id);
+        focus_callback_id = -1;
     }
     
     // Mark field as inactive when done
     field->is_active = false;
     
-    // Final redraw to show inactive state
+    // Final redraw to show inactive state, which covers any scheduled one
+    cancel_redraw();
     text_field_draw(field);
     GUI_refresh();
     char_deinit(); // Clean up char subsystem
-    field = NULL; // Clear reference to field
+}
+
+/**
+ * Give focus to a text field and process input until focus is lost.
+ * Background tasks run in the idle time between keystrokes.
+ */
+TextResult text_field_activate(TextField* field) {
+    if (!field) return TEXT_RESULT_CANCEL;
+    
+    text_field_focus(field);
+    
+    // Process input until done
+    TextResult result = TEXT_RESULT_CANCEL;
+    while (!text_field_poll(field, &result)) {
+        key_idle();
+    }
+    
+    text_field_blur(field);
     
-    log_message("Text field focus processing completed with result %d", result);
+    LOG_DEBUG("Text field focus processing completed with result %d", result);
     return result;
 }
@@ -89,6 +89,12 @@ Get-ChildItem .\src\*.c | ForEach-Object {
     Write-Line " - "
 }
 
+# The shared layers in common have their headers created next to them
+Get-ChildItem (Join-Path $myPath "common\*.c") | ForEach-Object { 
+    & $CreateHeaders -SourceFile $_.FullName 
+    Write-Line " - "
+}
+
 Write-Host "<#" -ForegroundColor DarkGray
 Write-Host " #  ___      _ _    _ _ " -ForegroundColor DarkGray
 Write-Host " # | _ )_  _(_) |__| (_)_ _  __ _ " -ForegroundColor DarkGray
@@ -0,0 +1,621 @@
+#include <tice.h>
+#include <keypadc.h>
+#include <string.h>
+#include "headers/kb_handler.h"
+#include "headers/kb_handler_private.h"
+
+/**
+ * Structure representing a callback entry.
+ */
+typedef struct {
+    bool active;                    /**< Whether this entry is active. */
+    KBCallbackID id;                /**< Unique ID for this callback. */
+    CombinedKey key;                /**< The key associated with this callback. */
+    CallbackType type;              /**< The type of callback (press, release, hold). */
+    union {
+        KBPressCallback press;      /**< Function pointer for press callback. */
+        KBReleaseCallback release;  /**< Function pointer for release callback. */
+        KBHoldCallback hold;        /**< Function pointer for hold callback. */
+        void (*any_press)(CombinedKey key); /**< Function pointer for any key press callback. */
+    } callback;
+    unsigned long press_time;       /**< Time when the key was first pressed (for hold detection). */
+    int hold_trigger_time;          /**< Time to wait before triggering a hold event (in ms). */
+    bool hold_repeat;               /**< Whether the hold event should repeat. */
+    int hold_interval;              /**< Interval between hold events when repeating (in ms). */
+    unsigned long last_hold_time;   /**< Time of the last hold event. */
+    bool is_any_key;                /**< Whether this is a callback for any key. */
+    uint8_t next;                   /**< Next callback of the same key, or NO_CALLBACK. */
+} CallbackEntry;
+
+/** Slot index that ends a list of callbacks */
+#define NO_CALLBACK 0xFF
+
+/** Number of kb_Data groups; group 0 holds no keys */
+#define KB_GROUPS 8
+
+_Static_assert(KB_MAX_CALLBACKS < NO_CALLBACK, "Callback slots must fit in a byte");
+
+// Static state variables
+static CallbackEntry callbacks[KB_MAX_CALLBACKS];   /**< Array of callback entries. */
+static int next_callback_id = 1;                    /**< Next available callback ID (starts at 1). */
+static bool initialized = false;                    /**< Whether the keyboard handler has been initialized. */
+static CombinedKey last_key_pressed = 0;            /**< The last key that was pressed. */
+
+// Callbacks indexed by key, so a scan only visits the keys that changed
+static uint8_t key_callbacks[KB_GROUPS][8];         /**< First callback of each key, by group and bit. */
+static uint8_t any_key_callbacks = NO_CALLBACK;     /**< First any-key callback. */
+static uint8_t hold_keys[KB_GROUPS];                /**< Keys with a hold callback, by group. */
+static uint8_t previous_state[KB_GROUPS];           /**< Keyboard state at the last scan. */
+static uint8_t table_version = 0;                   /**< Bumped whenever a callback is removed. */
+static bool continuous = false;                     /**< Whether the keypad is scanning by itself. */
+
+/**
+ * Checks if a specific key is pressed
+ * 
+ * @param combined_key One of the KEY_* constants
+ * @return true if the key is pressed, false otherwise
+ */
+bool kb_is_key_pressed(CombinedKey combined_key) {
+    int group = KEY_GROUP(combined_key);
+    int mask = KEY_MASK(combined_key);
+    return (kb_Data[group] & mask) ? true : false;
+}
+
+/**
+ * Initializes the keyboard handler.
+ */
+void kb_init(void) {
+    if (initialized) return;
+
+    // Clear all callback entries
+    memset(callbacks, 0, sizeof(callbacks));
+    for (int i = 0; i < KB_MAX_CALLBACKS; i++) {
+        callbacks[i].active = false;
+    }
+    memset(key_callbacks, NO_CALLBACK, sizeof(key_callbacks));
+    any_key_callbacks = NO_CALLBACK;
+    memset(hold_keys, 0, sizeof(hold_keys));
+    memset(previous_state, 0, sizeof(previous_state));
+
+    next_callback_id = 1;
+    last_key_pressed = 0;
+    initialized = true;
+}
+
+/**
+ * Registers a callback for key press events.
+ * 
+ * @param key The key to associate with the callback.
+ * @param callback The function to call when the key is pressed.
+ * @return The ID of the registered callback, or -1 if registration failed.
+ */
+KBCallbackID kb_register_press(CombinedKey key, KBPressCallback callback) {
+    return register_callback(key, CB_PRESS, (void*)callback, 0, false, 0);
+}
+
+/**
+ * Registers a callback for key release events.
+ * 
+ * @param key The key to associate with the callback.
+ * @param callback The function to call when the key is released.
+ * @return The ID of the registered callback, or -1 if registration failed.
+ */
+KBCallbackID kb_register_release(CombinedKey key, KBReleaseCallback callback) {
+    return register_callback(key, CB_RELEASE, (void*)callback, 0, false, 0);
+}
+
+/**
+ * Registers a callback for key hold events.
+ * 
+ * @param key The key to associate with the callback.
+ * @param callback The function to call when the key is held.
+ * @param trigger_time_ms The time to wait before triggering the hold event (in ms).
+ * @param repeat Whether the hold event should repeat.
+ * @param repeat_interval_ms The interval between hold events when repeating (in ms).
+ * @return The ID of the registered callback, or -1 if registration failed.
+ */
+KBCallbackID kb_register_hold(CombinedKey key, KBHoldCallback callback, 
+                              int trigger_time_ms, bool repeat, int repeat_interval_ms) {
+    return register_callback(key, CB_HOLD, (void*)callback, 
+                             trigger_time_ms, repeat, repeat_interval_ms);
+}
+
+/**
+ * Registers a callback for any key press.
+ * 
+ * @param callback The function to call when any key is pressed.
+ * @return The ID of the registered callback, or -1 if registration failed.
+ */
+KBCallbackID kb_register_any_press(void (*callback)(CombinedKey key)) {
+    if (!initialized) kb_init();
+
+    // Find an empty slot
+    int slot = -1;
+    for (int i = 0; i < KB_MAX_CALLBACKS; i++) {
+        if (!callbacks[i].active) {
+            slot = i;
+            break;
+        }
+    }
+
+    // If no slot available, return error
+    if (slot < 0) return -1;
+
+    // Set up the callback entry
+    callbacks[slot].active = true;
+    callbacks[slot].id = next_callback_id++;
+    callbacks[slot].key = 0; // Not used for any-key callbacks
+    callbacks[slot].type = CB_PRESS;
+    callbacks[slot].is_any_key = true;
+    callbacks[slot].callback.any_press = callback;
+    link_callback(slot);
+
+    return callbacks[slot].id;
+}
+
+/**
+ * Unregisters a callback by its ID.
+ * 
+ * @param callback_id The ID of the callback to unregister.
+ * @return True if the callback was successfully unregistered, false otherwise.
+ */
+bool kb_unregister_id(KBCallbackID callback_id) {
+    if (!initialized) kb_init();
+
+    for (int i = 0; i < KB_MAX_CALLBACKS; i++) {
+        if (callbacks[i].active && callbacks[i].id == callback_id) {
+            unlink_callback(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Unregisters all callbacks associated with a specific key.
+ * 
+ * @param key The key whose callbacks should be unregistered.
+ * @return The number of callbacks that were unregistered.
+ */
+int kb_unregister(CombinedKey key) {
+    if (!initialized) kb_init();
+
+    int count = 0;
+    for (int i = 0; i < KB_MAX_CALLBACKS; i++) {
+        if (callbacks[i].active && !callbacks[i].is_any_key && callbacks[i].key == key) {
+            unlink_callback(i);
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Clears all registered callbacks.
+ */
+void kb_clear(void) {
+    if (!initialized) return;
+
+    for (int i = 0; i < KB_MAX_CALLBACKS; i++) {
+        callbacks[i].active = false;
+    }
+    memset(key_callbacks, NO_CALLBACK, sizeof(key_callbacks));
+    any_key_callbacks = NO_CALLBACK;
+    memset(hold_keys, 0, sizeof(hold_keys));
+    table_version++;
+    debounce();
+}
+
+/**
+ * Gets the last key that was pressed.
+ * 
+ * @return The last key that was pressed, or 0 if no key has been pressed.
+ */
+CombinedKey kb_get_last_key(void) {
+    return last_key_pressed;
+}
+
+/**
+ * Clears the last key pressed.
+ */
+void kb_clear_last_key(void) {
+    last_key_pressed = 0;
+}
+
+/**
+ * Processes keyboard events and triggers callbacks as necessary.
+ * The scan is compared with the previous one, so only the keys that went
+ * down or up are visited, and only the callbacks of those keys run; keys
+ * held down are visited again only if they have a hold callback.
+ */
+void kb_process(void) {
+    if (!initialized) kb_init();
+
+    // Get current time for hold timing
+    unsigned long current_time = get_millis();
+
+    // Scan keyboard once, unless the keypad keeps kb_Data up to date itself
+    if (!continuous) kb_Scan();
+
+    // Take the changes before any callback runs, as callbacks may scan again
+    uint8_t state[KB_GROUPS];
+    uint8_t changed[KB_GROUPS];
+    for (int group = 1; group < KB_GROUPS; group++) {
+        state[group] = kb_Data[group];
+        changed[group] = state[group] ^ previous_state[group];
+        previous_state[group] = state[group];
+    }
+
+    // A callback that removes callbacks ends the pass, the lists it walks are gone
+    uint8_t version = table_version;
+
+    for (int group = 1; group < KB_GROUPS; group++) {
+        for (int bit = 0; changed[group] >> bit; bit++) {
+            uint8_t mask = 1 << bit;
+            if (!(changed[group] & mask)) continue;
+
+            CombinedKey current_key = MAKE_KEY(group, mask);
+            bool is_pressed = (state[group] & mask) != 0;
+
+            if (is_pressed) {
+                // Store as the last key pressed
+                last_key_pressed = current_key;
+
+                for (uint8_t i = any_key_callbacks; i != NO_CALLBACK; i = callbacks[i].next) {
+                    callbacks[i].callback.any_press(current_key);
+                    if (table_version != version) return;
+                }
+            }
+
+            for (uint8_t i = key_callbacks[group][bit]; i != NO_CALLBACK; i = callbacks[i].next) {
+                CallbackEntry* cb = &callbacks[i];
+                switch (cb->type) {
+                    case CB_PRESS:
+                        if (is_pressed) cb->callback.press();
+                        break;
+
+                    case CB_RELEASE:
+                        if (!is_pressed) cb->callback.release();
+                        break;
+
+                    case CB_HOLD:
+                        // Track when key is first pressed
+                        if (is_pressed) {
+                            cb->press_time = current_time;
+                            cb->last_hold_time = 0;
+                        }
+                        break;
+                }
+                if (table_version != version) return;
+            }
+        }
+    }
+
+    // Keys held down only matter to hold callbacks
+    for (int group = 1; group < KB_GROUPS; group++) {
+        uint8_t held = state[group] & hold_keys[group];
+        for (int bit = 0; held >> bit; bit++) {
+            if (!(held & (1 << bit))) continue;
+
+            for (uint8_t i = key_callbacks[group][bit]; i != NO_CALLBACK; i = callbacks[i].next) {
+                CallbackEntry* cb = &callbacks[i];
+                if (cb->type != CB_HOLD ||
+                    current_time - cb->press_time < (unsigned long)cb->hold_trigger_time) {
+                    continue;
+                }
+
+                // Initial trigger or repeat trigger
+                if (cb->last_hold_time == 0 ||
+                    (cb->hold_repeat &&
+                     (current_time - cb->last_hold_time >= (unsigned long)cb->hold_interval))) {
+
+                    // Calculate how long the key has been held
+                    int hold_duration = (int)(current_time - cb->press_time);
+
+                    // Trigger the callback
+                    cb->callback.hold(hold_duration);
+                    cb->last_hold_time = current_time;
+                    if (table_version != version) return;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Sleeps until there is something for kb_process to do: a key went down
+ * or up, or a hold callback is due.
+ * The keypad is put in continuous-scan mode, so kb_Data follows the keys
+ * without kb_Scan, and the CPU is halted between interrupts; the OS keeps
+ * its timer and keypad interrupts running, which bounds the time it takes
+ * to notice a key to a few milliseconds.
+ */
+void kb_wait_event(void) {
+    kb_wait_event_timeout(-1);
+}
+
+/**
+ * Sleeps like kb_wait_event, but no longer than a given time.
+ *
+ * @param timeout_ms Longest time to sleep (in ms), or -1 for no limit.
+ * @return True if there is something for kb_process to do, false if the time ran out.
+ */
+bool kb_wait_event_timeout(int timeout_ms) {
+    if (!initialized) kb_init();
+    start_continuous_scan();
+
+    unsigned long start = get_millis();
+    unsigned long due = 0;
+    bool hold_pending = next_hold_due(&due);
+
+    while (!keys_changed()) {
+        unsigned long now = get_millis();
+        if (hold_pending && (long)(now - due) >= 0) {
+            return true;
+        }
+        if (timeout_ms >= 0 && (long)(now - start) >= timeout_ms) {
+            return false;
+        }
+        cpu_idle();
+    }
+    return true;
+}
+
+/**
+ * Tells, without waiting, whether a key went down or up since the last
+ * call to kb_process. Lets a long computation give way to typing.
+ *
+ * @return True if the keys changed.
+ */
+bool kb_has_event(void) {
+    if (!continuous) kb_Scan();
+    return keys_changed();
+}
+
+/**
+ * Waits for a key to be pressed and released.
+ */
+void kb_wait_any(void) {
+    start_continuous_scan();
+    while (!any_key_down()) {
+        cpu_idle();
+    }
+    debounce();
+}
+
+/**
+ * Waits until no keys are pressed.
+ * The keypad is handed back to the OS afterwards, so its input routines
+ * can be used next.
+ */
+void debounce(void) {
+    last_key_pressed = 0;
+    start_continuous_scan();
+    while (any_key_down()) {
+        cpu_idle();
+    }
+    kb_Reset();
+    continuous = false;
+
+    // Nothing is down now; keys pressed from here on are new presses
+    memset(previous_state, 0, sizeof(previous_state));
+}
+
+/**
+ * Puts the keypad in continuous-scan mode if it is not already.
+ */
+static void start_continuous_scan(void) {
+    if (!continuous) {
+        kb_SetMode(MODE_3_CONTINUOUS);
+        continuous = true;
+    }
+}
+
+/**
+ * Halts the CPU until the next interrupt.
+ */
+static void cpu_idle(void) {
+    __asm__ volatile ("ei\n\thalt");
+}
+
+/**
+ * Tells whether any key is down, from the data the keypad last scanned.
+ *
+ * @return True if a key is down.
+ */
+static bool any_key_down(void) {
+    for (int group = 1; group < KB_GROUPS; group++) {
+        if (kb_Data[group]) return true;
+    }
+    return false;
+}
+
+/**
+ * Tells whether a key went down or up since the last call to kb_process.
+ *
+ * @return True if the keys changed.
+ */
+static bool keys_changed(void) {
+    for (int group = 1; group < KB_GROUPS; group++) {
+        if (kb_Data[group] != previous_state[group]) return true;
+    }
+    return false;
+}
+
+/**
+ * Finds when the next hold callback of the keys held down is due.
+ *
+ * @param due Pointer set to the time of the earliest hold event (in ms).
+ * @return True if a hold event is pending, false otherwise.
+ */
+static bool next_hold_due(unsigned long* due) {
+    bool pending = false;
+    for (int group = 1; group < KB_GROUPS; group++) {
+        uint8_t held = previous_state[group] & hold_keys[group];
+        for (int bit = 0; held >> bit; bit++) {
+            if (!(held & (1 << bit))) continue;
+
+            for (uint8_t i = key_callbacks[group][bit]; i != NO_CALLBACK; i = callbacks[i].next) {
+                if (callbacks[i].type != CB_HOLD) continue;
+
+                unsigned long time;
+                if (callbacks[i].last_hold_time == 0) {
+                    time = callbacks[i].press_time + callbacks[i].hold_trigger_time;
+                } else if (callbacks[i].hold_repeat) {
+                    time = callbacks[i].last_hold_time + callbacks[i].hold_interval;
+                } else {
+                    continue;
+                }
+                if (!pending || (long)(time - *due) < 0) {
+                    *due = time;
+                    pending = true;
+                }
+            }
+        }
+    }
+    return pending;
+}
+
+/**
+ * Registers a callback internally.
+ * 
+ * @param key The key to associate with the callback.
+ * @param type The type of callback (press, release, hold).
+ * @param callback_func The function pointer for the callback.
+ * @param hold_time The time to wait before triggering a hold event (in ms).
+ * @param repeat Whether the hold event should repeat.
+ * @param repeat_interval The interval between hold events when repeating (in ms).
+ * @return The ID of the registered callback, or -1 if registration failed.
+ */
+static KBCallbackID register_callback(CombinedKey key, CallbackType type, void* callback_func,
+                                      int hold_time, bool repeat, int repeat_interval) {
+    if (!initialized) kb_init();
+
+    // Keys are a single bit of groups 1 to 7
+    if (KEY_GROUP(key) < 1 || KEY_GROUP(key) >= KB_GROUPS || !KEY_MASK(key)) return -1;
+
+    // Find an empty slot
+    int slot = -1;
+    for (int i = 0; i < KB_MAX_CALLBACKS; i++) {
+        if (!callbacks[i].active) {
+            slot = i;
+            break;
+        }
+    }
+
+    // If no slot available, return error
+    if (slot < 0) return -1;
+
+    // Set up the callback entry
+    callbacks[slot].active = true;
+    callbacks[slot].id = next_callback_id++;
+    callbacks[slot].key = key;
+    callbacks[slot].type = type;
+    callbacks[slot].is_any_key = false;
+
+    // Set the appropriate callback function
+    switch (type) {
+        case CB_PRESS:
+            callbacks[slot].callback.press = (KBPressCallback)callback_func;
+            break;
+        case CB_RELEASE:
+            callbacks[slot].callback.release = (KBReleaseCallback)callback_func;
+            break;
+        case CB_HOLD:
+            callbacks[slot].callback.hold = (KBHoldCallback)callback_func;
+            callbacks[slot].hold_trigger_time = hold_time;
+            callbacks[slot].hold_repeat = repeat;
+            callbacks[slot].hold_interval = repeat_interval;
+            break;
+    }
+
+    link_callback(slot);
+
+    return callbacks[slot].id;
+}
+
+/**
+ * Gets the bit of a key within its kb_Data group.
+ *
+ * @param key The key.
+ * @return The bit number, 0 to 7.
+ */
+static int key_bit(CombinedKey key) {
+    int bit = 0;
+    while (!(KEY_MASK(key) & (1 << bit))) {
+        bit++;
+    }
+    return bit;
+}
+
+/**
+ * Gets the list a callback belongs to: the any-key list or that of its key.
+ *
+ * @param slot The slot of the callback.
+ * @return Pointer to the first slot of the list.
+ */
+static uint8_t* callback_list(int slot) {
+    if (callbacks[slot].is_any_key) {
+        return &any_key_callbacks;
+    }
+    return &key_callbacks[KEY_GROUP(callbacks[slot].key)][key_bit(callbacks[slot].key)];
+}
+
+/**
+ * Adds a callback at the end of its list, so callbacks of a key run in
+ * the order they were registered.
+ *
+ * @param slot The slot of the callback.
+ */
+static void link_callback(int slot) {
+    uint8_t* link = callback_list(slot);
+    while (*link != NO_CALLBACK) {
+        link = &callbacks[*link].next;
+    }
+    *link = (uint8_t)slot;
+    callbacks[slot].next = NO_CALLBACK;
+
+    if (callbacks[slot].type == CB_HOLD && !callbacks[slot].is_any_key) {
+        hold_keys[KEY_GROUP(callbacks[slot].key)] |= KEY_MASK(callbacks[slot].key);
+    }
+}
+
+/**
+ * Removes a callback from its list and frees its slot.
+ *
+ * @param slot The slot of the callback.
+ */
+static void unlink_callback(int slot) {
+    uint8_t* list = callback_list(slot);
+    uint8_t* link = list;
+    while (*link != (uint8_t)slot) {
+        link = &callbacks[*link].next;
+    }
+    *link = callbacks[slot].next;
+    callbacks[slot].active = false;
+    table_version++;
+
+    if (callbacks[slot].is_any_key) return;
+
+    // The key keeps its hold bit only while it has a hold callback left
+    CombinedKey key = callbacks[slot].key;
+    hold_keys[KEY_GROUP(key)] &= ~KEY_MASK(key);
+    for (uint8_t i = *list; i != NO_CALLBACK; i = callbacks[i].next) {
+        if (callbacks[i].type == CB_HOLD) {
+            hold_keys[KEY_GROUP(key)] |= KEY_MASK(key);
+        }
+    }
+}
+
+/**
+ * Gets the current time in milliseconds.
+ * 
+ * @return The current time in milliseconds, derived from the calculator's timer.
+ */
+unsigned long get_millis(void) {
+    // On the TI-84 CE, timer_1_Counter runs at 32768 Hz
+    // Convert to milliseconds (approximately)
+    return (unsigned long)(timer_1_Counter / 32.768);
+}
@@ -0,0 +1,86 @@
+/**
+ * Leveled Logging Macros for TI-84 CE Projects
+ *
+ * Shared by every project that provides a log_message() sink. Each macro
+ * compiles to nothing when its level is above LOG_LEVEL, arguments
+ * included, so release builds pay no logging cost at all.
+ *
+ * LOG_LEVEL is normally set by makefile.common. When it is not, debug
+ * builds log everything and release builds log nothing.
+ */
+
+#ifndef LOG_MACROS_H
+#define LOG_MACROS_H
+
+/* ============================== Log Levels ============================== */
+
+/** No logging */
+#define LOG_LEVEL_NONE      0
+
+/** Errors only */
+#define LOG_LEVEL_ERROR     1
+
+/** Errors and warnings */
+#define LOG_LEVEL_WARNING   2
+
+/** Informational messages (program flow, user actions) */
+#define LOG_LEVEL_INFO      3
+
+/** Debug messages */
+#define LOG_LEVEL_DEBUG     4
+
+/** Per-token, per-node and per-key tracing */
+#define LOG_LEVEL_TRACE     5
+
+#ifndef LOG_LEVEL
+#ifdef DEBUG
+#define LOG_LEVEL LOG_LEVEL_TRACE
+#else
+#define LOG_LEVEL LOG_LEVEL_NONE
+#endif
+#endif
+
+/**
+ * Tells whether messages of a level are compiled in.
+ * Usable in #if to drop code that only prepares log arguments.
+ */
+#define LOG_ENABLED(level) (LOG_LEVEL >= (level))
+
+/* ============================== Log Macros ============================== */
+
+/*
+ * The first argument must be a string literal, so the level tag is
+ * joined to the format at compile time.
+ */
+
+#if LOG_ENABLED(LOG_LEVEL_ERROR)
+#define LOG_ERROR(...)   log_message("ERROR: " __VA_ARGS__)
+#else
+#define LOG_ERROR(...)   ((void)0)
+#endif
+
+#if LOG_ENABLED(LOG_LEVEL_WARNING)
+#define LOG_WARNING(...) log_message("WARNING: " __VA_ARGS__)
+#else
+#define LOG_WARNING(...) ((void)0)
+#endif
+
+#if LOG_ENABLED(LOG_LEVEL_INFO)
+#define LOG_INFO(...)    log_message("INFO: " __VA_ARGS__)
+#else
+#define LOG_INFO(...)    ((void)0)
+#endif
+
+#if LOG_ENABLED(LOG_LEVEL_DEBUG)
+#define LOG_DEBUG(...)   log_message("DEBUG: " __VA_ARGS__)
+#else
+#define LOG_DEBUG(...)   ((void)0)
+#endif
+
+#if LOG_ENABLED(LOG_LEVEL_TRACE)
+#define LOG_TRACE(...)   log_message("TRACE: " __VA_ARGS__)
+#else
+#define LOG_TRACE(...)   ((void)0)
+#endif
+
+#endif // LOG_MACROS_H